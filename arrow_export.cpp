@@ -0,0 +1,241 @@
+// Standard C++ headers
+#include <algorithm>         // For max
+#include <initializer_list>  // For the columns of a record batch
+#include <mutex>             // For mutex, lock_guard
+#include <new>               // For bad_alloc
+#include <stdexcept>         // For runtime_error
+
+// Third-party library headers
+#include <arrow/api.h>         // Arrays, builders, schemas, record batches
+#include <arrow/io/file.h>     // FileOutputStream
+#include <arrow/ipc/writer.h>  // IPC file writer
+
+// Project header
+#include "arrow_export.h"
+
+using namespace std;
+
+/*
+ * Arrow Export - Implementation Notes
+ *
+ * Arrow reports errors through arrow::Status / arrow::Result instead of
+ * exceptions. Inside this file we propagate them with the ARROW_* macros
+ * and convert to runtime_error once, at the public function boundary, so
+ * callers see the same error style as the rest of DocxParser.
+ *
+ * Every shard owns its builders and output streams behind its own lock;
+ * the only shared state is the pair of id counters, taken together under
+ * idLock_ so a document's style ids are contiguous.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    shared_ptr<arrow::DataType> dictionaryString() {
+        return arrow::dictionary(arrow::int32(), arrow::utf8());
+    }
+
+    shared_ptr<arrow::Schema> documentsSchema() {
+        return arrow::schema({
+            arrow::field("doc_id", arrow::uint32(), false),
+            arrow::field("path", arrow::utf8(), false),
+            arrow::field("style_count", arrow::uint32(), false),
+        });
+    }
+
+    shared_ptr<arrow::Schema> stylesSchema() {
+        return arrow::schema({
+            arrow::field("style_id", arrow::uint32(), false),
+            arrow::field("doc_id", arrow::uint32(), false),
+            arrow::field("name", dictionaryString(), false),
+            arrow::field("type", dictionaryString(), false),
+            arrow::field("font", dictionaryString(), false),
+            arrow::field("font_size", arrow::utf8(), false),
+        });
+    }
+
+    shared_ptr<arrow::Schema> propertiesSchema() {
+        return arrow::schema({
+            arrow::field("style_id", arrow::uint32(), false),
+            arrow::field("key", dictionaryString(), false),
+            arrow::field("value", arrow::utf8(), false),
+        });
+    }
+
+    /// One IPC file and the schema of its record batches
+    class IpcTable {
+    public:
+        arrow::Status open(const string& path, shared_ptr<arrow::Schema> schema) {
+            schema_ = move(schema);
+            ARROW_ASSIGN_OR_RAISE(stream_, arrow::io::FileOutputStream::Open(path));
+            auto options = arrow::ipc::IpcWriteOptions::Defaults();
+            // Files hold one dictionary per column, so later batches may only extend it
+            options.emit_dictionary_deltas = true;
+            ARROW_ASSIGN_OR_RAISE(writer_, arrow::ipc::MakeFileWriter(stream_, schema_, options));
+            return arrow::Status::OK();
+        }
+
+        /// Writes the builders' rows as one record batch; the builders start over
+        arrow::Status flush(initializer_list<arrow::ArrayBuilder*> columns) {
+            const int64_t rows = (*columns.begin())->length();
+            if (rows == 0) return arrow::Status::OK();
+            vector<shared_ptr<arrow::Array>> arrays;
+            arrays.reserve(columns.size());
+            for (auto* column : columns) {
+                ARROW_ASSIGN_OR_RAISE(auto array, column->Finish());
+                arrays.push_back(move(array));
+            }
+            return writer_->WriteRecordBatch(*arrow::RecordBatch::Make(schema_, rows, move(arrays)));
+        }
+
+        arrow::Status close() {
+            ARROW_RETURN_NOT_OK(writer_->Close());
+            return stream_->Close();
+        }
+
+    private:
+        shared_ptr<arrow::Schema> schema_;
+        shared_ptr<arrow::io::FileOutputStream> stream_;
+        shared_ptr<arrow::ipc::RecordBatchWriter> writer_;
+    };
+
+    void check(const arrow::Status& status, const string& shardPrefix) {
+        if (!status.ok()) throw runtime_error("Arrow export of " + shardPrefix + " failed: " + status.ToString());
+    }
+
+} // namespace
+
+    /**
+     * @brief Builders and files of one shard
+     *
+     * Dictionary builders keep their memo tables across Finish(), so each
+     * batch carries the dictionary so far and the writer emits the delta.
+     */
+    struct ArrowExporter::Shard {
+        mutex lock;
+        string prefix;
+        bool opened = false;
+
+        IpcTable documents, styles, properties;
+
+        arrow::UInt32Builder docIds, docStyleCounts;
+        arrow::StringBuilder docPaths;
+
+        arrow::UInt32Builder styleIds, styleDocIds;
+        arrow::StringDictionary32Builder styleNames, styleTypes, styleFonts;
+        arrow::StringBuilder styleSizes;
+
+        arrow::UInt32Builder propStyleIds;
+        arrow::StringDictionary32Builder propKeys;
+        arrow::StringBuilder propValues;
+
+        arrow::Status open() {
+            ARROW_RETURN_NOT_OK(documents.open(prefix + ".documents.arrow", documentsSchema()));
+            ARROW_RETURN_NOT_OK(styles.open(prefix + ".styles.arrow", stylesSchema()));
+            ARROW_RETURN_NOT_OK(properties.open(prefix + ".properties.arrow", propertiesSchema()));
+            opened = true;
+            return arrow::Status::OK();
+        }
+
+        arrow::Status flushDocuments() { return documents.flush({&docIds, &docPaths, &docStyleCounts}); }
+
+        arrow::Status flushStyles() {
+            return styles.flush({&styleIds, &styleDocIds, &styleNames, &styleTypes, &styleFonts, &styleSizes});
+        }
+
+        arrow::Status flushProperties() { return properties.flush({&propStyleIds, &propKeys, &propValues}); }
+
+        arrow::Status append(const DocumentStyles& doc, uint32_t docId, uint32_t styleId, size_t rowsPerBatch) {
+            const auto full = [rowsPerBatch](const arrow::ArrayBuilder& column) {
+                return static_cast<size_t>(column.length()) >= rowsPerBatch;
+            };
+            ARROW_RETURN_NOT_OK(docIds.Append(docId));
+            ARROW_RETURN_NOT_OK(docPaths.Append(doc.path));
+            ARROW_RETURN_NOT_OK(docStyleCounts.Append(static_cast<uint32_t>(doc.styles.size())));
+            if (full(docIds)) ARROW_RETURN_NOT_OK(flushDocuments());
+
+            for (const auto& style : doc.styles) {
+                ARROW_RETURN_NOT_OK(styleIds.Append(styleId));
+                ARROW_RETURN_NOT_OK(styleDocIds.Append(docId));
+                ARROW_RETURN_NOT_OK(styleNames.Append(style.name));
+                ARROW_RETURN_NOT_OK(styleTypes.Append(style.type));
+                ARROW_RETURN_NOT_OK(styleFonts.Append(style.fontName));
+                ARROW_RETURN_NOT_OK(styleSizes.Append(style.fontSize));
+                if (full(styleIds)) ARROW_RETURN_NOT_OK(flushStyles());
+
+                for (const auto& prop : style.properties) {
+                    ARROW_RETURN_NOT_OK(propStyleIds.Append(styleId));
+                    ARROW_RETURN_NOT_OK(propKeys.Append(prop.first));
+                    ARROW_RETURN_NOT_OK(propValues.Append(prop.second));
+                    if (full(propStyleIds)) ARROW_RETURN_NOT_OK(flushProperties());
+                }
+                ++styleId;
+            }
+            return arrow::Status::OK();
+        }
+
+        arrow::Status close() {
+            ARROW_RETURN_NOT_OK(flushDocuments());
+            ARROW_RETURN_NOT_OK(flushStyles());
+            ARROW_RETURN_NOT_OK(flushProperties());
+            ARROW_RETURN_NOT_OK(documents.close());
+            ARROW_RETURN_NOT_OK(styles.close());
+            return properties.close();
+        }
+    };
+
+    ArrowExporter::ArrowExporter(string prefix, ArrowExportOptions options)
+        : prefix_(move(prefix)), options_(options) {
+        options_.shards = max<size_t>(1, options_.shards);
+        options_.rowsPerBatch = max<size_t>(1, options_.rowsPerBatch);
+        shards_.reserve(options_.shards);
+        for (size_t shard = 0; shard < options_.shards; ++shard) {
+            shards_.push_back(make_unique<Shard>());
+            shards_.back()->prefix = prefix_ + "-" + to_string(shard);
+        }
+    }
+
+    ArrowExporter::~ArrowExporter() {
+        if (finished_) return;
+        try {
+            finish();
+        } catch (...) {
+        }
+    }
+
+    void ArrowExporter::add(const DocumentStyles& document) {
+        uint32_t docId, firstStyle;
+        {
+            lock_guard<mutex> guard(idLock_);
+            docId = nextDocument_++;
+            firstStyle = nextStyle_;
+            nextStyle_ += static_cast<uint32_t>(document.styles.size());
+        }
+        Shard& shard = *shards_[docId % shards_.size()];
+        lock_guard<mutex> guard(shard.lock);
+        try {
+            if (!shard.opened) check(shard.open(), shard.prefix);
+            check(shard.append(document, docId, firstStyle, options_.rowsPerBatch), shard.prefix);
+        } catch (const bad_alloc& e) {
+            // Allocation failures inside Arrow surface in the same error style
+            throw runtime_error("Arrow export of " + shard.prefix + " failed: " + e.what());
+        }
+    }
+
+    vector<string> ArrowExporter::finish() {
+        finished_ = true;
+        vector<string> written;
+        for (auto& shard : shards_) {
+            lock_guard<mutex> guard(shard->lock);
+            if (!shard->opened) continue;
+            shard->opened = false;
+            check(shard->close(), shard->prefix);
+            for (const char* table : {".documents.arrow", ".styles.arrow", ".properties.arrow"}) {
+                written.push_back(shard->prefix + table);
+            }
+        }
+        return written;
+    }
+
+} // namespace DocxParser
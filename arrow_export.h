@@ -0,0 +1,83 @@
+#ifndef ARROW_EXPORT_H
+#define ARROW_EXPORT_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "docx_style_parser.h"
+
+/**
+ * @brief Columnar export of extracted style sets as Arrow IPC files
+ *
+ * Each shard is written as three Arrow IPC files:
+ * - <prefix>-<shard>.documents.arrow: doc_id, path, style_count
+ * - <prefix>-<shard>.styles.arrow:    style_id, doc_id, name, type, font, font_size
+ * - <prefix>-<shard>.properties.arrow: style_id, key, value
+ *
+ * doc_id and style_id are global across shards and follow the order in
+ * which documents are added, so the shard files can be concatenated or
+ * queried together. Low-cardinality string columns (name, type, font, key)
+ * are dictionary-encoded with int32 indices; later record batches extend
+ * the dictionary with deltas.
+ *
+ * Only available when built with TYPSTYLE_WITH_ARROW.
+ */
+namespace DocxParser {
+
+struct ArrowExportOptions {
+    size_t shards = 1;             ///< Documents are dealt to shards in turn
+    size_t rowsPerBatch = 65536;   ///< A table's rows are written out once it holds this many
+};
+
+/**
+ * @brief Streams documents into Arrow IPC shards
+ *
+ * Documents are handed to add() from any thread (typically the batch
+ * workers, through BatchOptions::onItem) and appended to their shard's
+ * builders under that shard's lock; a table becomes a record batch once
+ * it reaches rowsPerBatch rows, so memory stays bounded by the shard count
+ * rather than the corpus. A shard's files are created with its first
+ * document, so there are never more shards than documents.
+ */
+class ArrowExporter {
+public:
+    ArrowExporter(std::string prefix, ArrowExportOptions options = {});
+
+    /// Finishes the export if finish() was not called; errors are dropped
+    ~ArrowExporter();
+
+    ArrowExporter(const ArrowExporter&) = delete;
+    ArrowExporter& operator=(const ArrowExporter&) = delete;
+
+    /**
+     * @brief Appends one document to the next shard; thread-safe
+     * @throws std::runtime_error if Arrow reports an error
+     */
+    void add(const DocumentStyles& document);
+
+    /**
+     * @brief Writes the remaining rows and closes every file
+     * @return Paths of all files written
+     * @throws std::runtime_error if Arrow reports an error
+     */
+    std::vector<std::string> finish();
+
+private:
+    struct Shard;
+
+    std::string prefix_;
+    ArrowExportOptions options_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    bool finished_ = false;
+
+    std::mutex idLock_;
+    uint32_t nextDocument_ = 0;
+    uint32_t nextStyle_ = 0;
+};
+
+} // namespace DocxParser
+
+#endif // ARROW_EXPORT_H
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <set>
+#include <thread>
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include "arrow_export.h"
+
+using namespace DocxParser;
+
+namespace {
+
+std::vector<std::shared_ptr<arrow::RecordBatch>> readBatches(const std::string& path) {
+    auto file = arrow::io::ReadableFile::Open(path).ValueOrDie();
+    auto reader = arrow::ipc::RecordBatchFileReader::Open(file).ValueOrDie();
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    for (int i = 0; i < reader->num_record_batches(); ++i) batches.push_back(reader->ReadRecordBatch(i).ValueOrDie());
+    return batches;
+}
+
+DocumentStyles makeDocument(int doc) {
+    DocumentStyles document;
+    document.path = "doc" + std::to_string(doc) + ".docx";
+    for (int i = 0; i < 2; ++i) {
+        StyleInfo style;
+        style.name = i ? "Heading " + std::to_string(doc) : "Normal";
+        style.type = "paragraph";
+        style.fontName = "Calibri";
+        style.fontSize = "22";
+        style.properties["outlineLvl"] = "0";
+        document.styles.push_back(std::move(style));
+    }
+    return document;
+}
+
+} // namespace
+
+/**
+ * @brief Shards must keep global ids, flush full batches and extend dictionaries
+ */
+TEST(ArrowExportTest, WritesShardedTables) {
+    ArrowExporter exporter("arrow_export_test", {2, 4});
+    for (int doc = 0; doc < 5; ++doc) exporter.add(makeDocument(doc));
+    auto files = exporter.finish();
+    ASSERT_EQ(files.size(), 6u);
+
+    // Documents are dealt in turn: the second shard holds documents 1 and 3
+    auto docs = readBatches("arrow_export_test-1.documents.arrow");
+    ASSERT_EQ(docs.size(), 1u);
+    EXPECT_EQ(docs[0]->num_rows(), 2);
+    auto docIds = std::static_pointer_cast<arrow::UInt32Array>(docs[0]->column(0));
+    EXPECT_EQ(docIds->Value(1), 3u);
+
+    auto styles = readBatches("arrow_export_test-1.styles.arrow");
+    ASSERT_EQ(styles.size(), 1u);
+    EXPECT_EQ(styles[0]->num_rows(), 4);
+    auto styleIds = std::static_pointer_cast<arrow::UInt32Array>(styles[0]->column(0));
+    EXPECT_EQ(styleIds->Value(2), 6u);  // Document 3 starts after six styles
+    EXPECT_EQ(styles[0]->column(2)->type_id(), arrow::Type::DICTIONARY);
+
+    // Six styles at four rows per batch; the second batch adds "Heading 4" to the dictionary
+    styles = readBatches("arrow_export_test-0.styles.arrow");
+    ASSERT_EQ(styles.size(), 2u);
+    EXPECT_EQ(styles[1]->num_rows(), 2);
+    auto names = std::static_pointer_cast<arrow::DictionaryArray>(styles[1]->column(2));
+    EXPECT_EQ(names->dictionary()->length(), 4);
+    auto dictionary = std::static_pointer_cast<arrow::StringArray>(names->dictionary());
+    EXPECT_EQ(dictionary->GetString(names->GetValueIndex(1)), "Heading 4");
+
+    auto props = readBatches("arrow_export_test-0.properties.arrow");
+    ASSERT_EQ(props.size(), 2u);
+    EXPECT_EQ(props[0]->num_rows() + props[1]->num_rows(), 6);
+
+    for (const auto& file : files) std::remove(file.c_str());
+}
+
+/**
+ * @brief Concurrent add() must give every document and style exactly one id
+ */
+TEST(ArrowExportTest, AddsFromManyThreads) {
+    constexpr int kThreads = 4, kPerThread = 50;
+    ArrowExporter exporter("arrow_export_threads", {3, 16});
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; ++t) {
+        producers.emplace_back([&, t] {
+            for (int i = 0; i < kPerThread; ++i) exporter.add(makeDocument(t * kPerThread + i));
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    auto files = exporter.finish();
+    ASSERT_EQ(files.size(), 9u);
+
+    std::set<uint32_t> docIds, styleIds;
+    for (int shard = 0; shard < 3; ++shard) {
+        const std::string prefix = "arrow_export_threads-" + std::to_string(shard);
+        for (const auto& batch : readBatches(prefix + ".documents.arrow")) {
+            auto ids = std::static_pointer_cast<arrow::UInt32Array>(batch->column(0));
+            for (int64_t row = 0; row < ids->length(); ++row) docIds.insert(ids->Value(row));
+        }
+        for (const auto& batch : readBatches(prefix + ".styles.arrow")) {
+            auto ids = std::static_pointer_cast<arrow::UInt32Array>(batch->column(0));
+            for (int64_t row = 0; row < ids->length(); ++row) styleIds.insert(ids->Value(row));
+        }
+    }
+    constexpr uint32_t kDocuments = kThreads * kPerThread;
+    EXPECT_EQ(docIds.size(), kDocuments);
+    EXPECT_EQ(*docIds.rbegin(), kDocuments - 1);
+    EXPECT_EQ(styleIds.size(), 2 * kDocuments);
+    EXPECT_EQ(*styleIds.rbegin(), 2 * kDocuments - 1);
+
+    for (const auto& file : files) std::remove(file.c_str());
+}
@@ -0,0 +1,441 @@
+// Standard C++ headers
+#include <algorithm>   // For min
+#include <cstdio>      // For snprintf, FILE
+#include <filesystem>  // For output paths and atomic renames
+#include <functional>  // For hash
+#include <sstream>     // For parsing protocol lines
+#include <stdexcept>   // For runtime_error
+
+// Platform headers for flushing shard files to disk
+#ifdef _WIN32
+#include <io.h>       // For _commit, _fileno
+#else
+#include <fcntl.h>    // For open
+#include <unistd.h>   // For fsync, close
+#endif
+
+// Project headers
+#include "batch_cluster.h"
+#include "mapped_file.h"
+#include "style_snapshot.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/*
+ * Batch Cluster - Implementation Notes
+ *
+ * Leases:
+ * - The manifest is cut into ranges of leaseSize documents up front; a range
+ *   is Pending, Leased (with owner and deadline) or Done.
+ * - grantLease() hands out Pending ranges first, then Leased ranges whose
+ *   deadline passed. Expiry is therefore checked lazily, when an agent asks
+ *   for work, and needs no timer thread.
+ * - A connection that drops returns its leases to Pending at once.
+ * - Extraction is deterministic, so a late result of an expired lease is as
+ *   good as any: the first result for a range wins, later ones are STALE.
+ *
+ * Threads: one acceptor, plus one handler per agent connection. All range
+ * state lives under lock_. Shard files are written outside the lock to a
+ * temp file that is fsynced, renamed into place, and the directory fsynced
+ * after the rename, so a crash never leaves a half-written shard.
+ *
+ * Sizes announced by the peer (RESULT bytes, LEASE count) are checked
+ * against kMaxResultBytes and kMaxLeasePaths before anything is allocated
+ * for them; a larger value is a protocol error that drops the connection.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    const char kShardMagic[4] = {'T', 'S', 'R', 'S'};
+    constexpr uint32_t kShardVersion = 1;
+    constexpr int kMaxWaitMs = 500;
+    constexpr size_t kMaxResultBytes = size_t(1) << 30;  // 1 GiB per result shard
+    constexpr size_t kMaxLeasePaths = size_t(1) << 20;
+
+    void putU32(string& out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    void putString(string& out, const string& value) {
+        putU32(out, static_cast<uint32_t>(value.size()));
+        out += value;
+    }
+
+    /**
+     * @brief Bounds-checked reader over shard bytes
+     */
+    class ShardReader {
+    public:
+        ShardReader(const char* data, size_t size) : p_(data), end_(data + size) {}
+
+        uint32_t u32() {
+            need(4);
+            const auto* u = reinterpret_cast<const unsigned char*>(p_);
+            p_ += 4;
+            return uint32_t(u[0]) | uint32_t(u[1]) << 8 | uint32_t(u[2]) << 16 | uint32_t(u[3]) << 24;
+        }
+
+        string str() {
+            const uint32_t length = u32();
+            need(length);
+            string value(p_, length);
+            p_ += length;
+            return value;
+        }
+
+        bool atEnd() const { return p_ == end_; }
+
+    private:
+        void need(size_t n) const {
+            if (static_cast<size_t>(end_ - p_) < n) {
+                throw runtime_error("Result shard is truncated");
+            }
+        }
+
+        const char* p_;
+        const char* end_;
+    };
+
+    string shardName(uint32_t range) {
+        char name[32];
+        snprintf(name, sizeof(name), "shard-%06u.tsrs", range);
+        return name;
+    }
+
+    // Forces a file's contents to disk
+    bool writeDurably(const string& path, const string& data) {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file) return false;
+        bool ok = fwrite(data.data(), 1, data.size(), file) == data.size() && fflush(file) == 0;
+#ifdef _WIN32
+        ok = ok && _commit(_fileno(file)) == 0;
+#else
+        ok = ok && fsync(fileno(file)) == 0;
+#endif
+        return fclose(file) == 0 && ok;
+    }
+
+    // Makes a rename within directory durable; NTFS journals renames itself
+    bool syncDirectory(const fs::path& directory) {
+#ifdef _WIN32
+        (void)directory;
+        return true;
+#else
+        const int handle = open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+        if (handle < 0) return false;
+        const bool ok = fsync(handle) == 0;
+        close(handle);
+        return ok;
+#endif
+    }
+
+    void writeFileAtomically(const string& path, const string& data) {
+        // Per-thread temp name: two handlers may store the same range at once
+        const string tempPath = path + "." + to_string(hash<thread::id>{}(this_thread::get_id())) + ".tmp";
+        error_code error;
+        if (!writeDurably(tempPath, data)) {
+            fs::remove(tempPath, error);
+            throw runtime_error("Failed to write " + tempPath);
+        }
+        fs::rename(tempPath, path, error);
+        if (error) {
+            fs::remove(tempPath, error);
+            throw runtime_error("Failed to rename shard into place: " + path);
+        }
+        if (!syncDirectory(fs::path(path).parent_path())) {
+            throw runtime_error("Failed to sync the shard directory of " + path);
+        }
+    }
+
+} // namespace
+
+    string encodeResultShard(const ResultShard& shard) {
+        string out(kShardMagic, sizeof(kShardMagic));
+        putU32(out, kShardVersion);
+        putU32(out, shard.range);
+        putU32(out, static_cast<uint32_t>(shard.items.size()));
+        for (const auto& item : shard.items) {
+            putString(out, item.document.path);
+            putString(out, item.error);
+            putString(out, serializeStyleSet(item.document.styles));
+        }
+        return out;
+    }
+
+    ResultShard decodeResultShard(const char* data, size_t size) {
+        if (size < 16 || !equal(kShardMagic, kShardMagic + 4, data)) {
+            throw runtime_error("Not a result shard");
+        }
+        ShardReader reader(data + 4, size - 4);
+        if (reader.u32() != kShardVersion) {
+            throw runtime_error("Unsupported result shard version");
+        }
+        ResultShard shard;
+        shard.range = reader.u32();
+        const uint32_t count = reader.u32();
+        for (uint32_t i = 0; i < count; ++i) {
+            BatchItem item;
+            item.document.path = reader.str();
+            item.error = reader.str();
+            const string snapshot = reader.str();
+            item.document.styles = deserializeStyleSet(snapshot.data(), snapshot.size());
+            shard.items.push_back(move(item));
+        }
+        if (!reader.atEnd()) {
+            throw runtime_error("Trailing bytes after result shard");
+        }
+        return shard;
+    }
+
+    ResultShard readResultShard(const string& path) {
+        MappedFile mapped(path);
+        return decodeResultShard(mapped.data(), mapped.size());
+    }
+
+    BatchCoordinator::BatchCoordinator(vector<string> paths, CoordinatorOptions options)
+        : paths_(move(paths)), options_(move(options)) {
+        // Agents refuse leases longer than kMaxLeasePaths
+        options_.leaseSize = min(max<size_t>(options_.leaseSize, 1), kMaxLeasePaths);
+        if (options_.outputDirectory.empty()) {
+            throw runtime_error("The coordinator needs an output directory");
+        }
+        error_code error;
+        fs::create_directories(options_.outputDirectory, error);
+        if (error) {
+            throw runtime_error("Failed to create output directory " + options_.outputDirectory + ": " +
+                                error.message());
+        }
+
+        ranges_.resize((paths_.size() + options_.leaseSize - 1) / options_.leaseSize);
+        report_.documents = paths_.size();
+        report_.ranges = ranges_.size();
+        for (uint32_t range = 0; range < ranges_.size(); ++range) {
+            report_.shardFiles.push_back((fs::path(options_.outputDirectory) / shardName(range)).string());
+        }
+        listener_ = TcpSocket::listen(options_.host, options_.port);
+    }
+
+    BatchCoordinator::~BatchCoordinator() {
+        stop();
+    }
+
+    CoordinatorReport BatchCoordinator::run() {
+        if (ranges_.empty()) return report_;
+        acceptor_ = thread(&BatchCoordinator::acceptLoop, this);
+        {
+            unique_lock<mutex> lock(lock_);
+            finished_.wait(lock, [&] { return completed_ == ranges_.size() && unacknowledged_ == 0; });
+        }
+        stop();
+        lock_guard<mutex> guard(lock_);
+        return report_;
+    }
+
+    void BatchCoordinator::stop() {
+        {
+            lock_guard<mutex> guard(lock_);
+            stopping_ = true;
+            // Unblocks handlers waiting for their agent's next line
+            for (auto& client : clients_) client->shutdown();
+        }
+        if (acceptor_.joinable()) acceptor_.join();
+        for (auto& handler : handlers_) {
+            if (handler.joinable()) handler.join();
+        }
+    }
+
+    void BatchCoordinator::acceptLoop() {
+        uint64_t connections = 0;
+        while (true) {
+            {
+                lock_guard<mutex> guard(lock_);
+                if (stopping_) return;
+            }
+            // Poll so that stop() is noticed without closing the socket under accept()
+            try {
+                if (!listener_.waitReadable(100)) continue;
+                auto client = make_shared<TcpSocket>(listener_.accept());
+                lock_guard<mutex> guard(lock_);
+                if (stopping_) return;
+                clients_.push_back(client);
+                handlers_.emplace_back(&BatchCoordinator::serveAgent, this, client, ++connections);
+            } catch (const runtime_error&) {
+                // A connection that failed during accept is the agent's problem
+            }
+        }
+    }
+
+    void BatchCoordinator::serveAgent(shared_ptr<TcpSocket> socket, uint64_t connection) {
+        bool unacknowledged = false;  // Stored a result but the ACK did not go out
+        try {
+            string line;
+            while (socket->readLine(line)) {
+                istringstream in(line);
+                string verb;
+                in >> verb;
+                if (verb == "NEXT") {
+                    socket->sendAll(grantLease(connection));
+                } else if (verb == "RESULT") {
+                    uint32_t range = 0;
+                    size_t bytes = 0;
+                    if (!(in >> range >> bytes) || range >= ranges_.size()) {
+                        throw runtime_error("Malformed RESULT line");
+                    }
+                    if (bytes > kMaxResultBytes) {
+                        throw runtime_error("Result shard of " + to_string(bytes) + " bytes is too large");
+                    }
+                    const string payload = socket->readBytes(bytes);
+                    const bool stored = storeResult(range, payload);
+                    unacknowledged = stored;
+                    socket->sendAll(stored ? "ACK\n" : "STALE\n");
+                    if (stored) acknowledged();
+                    unacknowledged = false;
+                } else {
+                    throw runtime_error("Unknown agent message: " + verb);
+                }
+            }
+        } catch (const exception&) {
+            // Protocol, I/O or allocation error: drop the agent, its leases are released below
+        }
+
+        {
+            lock_guard<mutex> guard(lock_);
+            for (auto& range : ranges_) {
+                if (range.state == RangeState::Leased && range.owner == connection) {
+                    range.state = RangeState::Pending;
+                    ++report_.leasesExpired;
+                }
+            }
+        }
+        if (unacknowledged) acknowledged();
+    }
+
+    // run() only stops once the last ACK is out, so every agent learns its result counted
+    void BatchCoordinator::acknowledged() {
+        lock_guard<mutex> guard(lock_);
+        if (--unacknowledged_ == 0 && completed_ == ranges_.size()) finished_.notify_all();
+    }
+
+    string BatchCoordinator::grantLease(uint64_t connection) {
+        const auto now = chrono::steady_clock::now();
+        lock_guard<mutex> guard(lock_);
+        if (completed_ == ranges_.size()) return "DONE\n";
+
+        // Prefer untouched ranges; fall back to the first expired lease
+        size_t chosen = ranges_.size();
+        auto nextDeadline = chrono::steady_clock::time_point::max();
+        for (size_t i = 0; i < ranges_.size(); ++i) {
+            const Range& range = ranges_[i];
+            if (range.state == RangeState::Pending) {
+                chosen = i;
+                break;
+            }
+            if (range.state == RangeState::Leased) {
+                if (range.deadline <= now && chosen == ranges_.size()) chosen = i;
+                nextDeadline = min(nextDeadline, range.deadline);
+            }
+        }
+        if (chosen == ranges_.size()) {
+            const auto untilExpiry = chrono::duration_cast<chrono::milliseconds>(nextDeadline - now).count();
+            return "WAIT " + to_string(max<long long>(1, min<long long>(untilExpiry, kMaxWaitMs))) + "\n";
+        }
+
+        Range& range = ranges_[chosen];
+        if (range.state == RangeState::Leased) ++report_.leasesExpired;
+        range.state = RangeState::Leased;
+        range.owner = connection;
+        range.deadline = now + options_.leaseTimeout;
+        ++report_.leasesGranted;
+
+        const size_t first = chosen * options_.leaseSize;
+        const size_t count = min(options_.leaseSize, paths_.size() - first);
+        string reply = "LEASE " + to_string(chosen) + " " + to_string(count) + "\n";
+        for (size_t i = first; i < first + count; ++i) reply += paths_[i] + "\n";
+        return reply;
+    }
+
+    bool BatchCoordinator::storeResult(uint32_t range, const string& payload) {
+        {
+            lock_guard<mutex> guard(lock_);
+            if (ranges_[range].state == RangeState::Done) {
+                ++report_.staleResults;
+                return false;
+            }
+        }
+
+        // Validate before it becomes the range's result
+        const ResultShard shard = decodeResultShard(payload.data(), payload.size());
+        const size_t first = size_t(range) * options_.leaseSize;
+        if (shard.range != range || shard.items.size() != min(options_.leaseSize, paths_.size() - first)) {
+            throw runtime_error("Result shard does not match its lease");
+        }
+        size_t failed = 0;
+        for (const auto& item : shard.items) {
+            if (!item.error.empty()) ++failed;
+        }
+        // Concurrent results for one range carry identical bytes, so either rename may win
+        writeFileAtomically(report_.shardFiles[range], payload);
+
+        lock_guard<mutex> guard(lock_);
+        if (ranges_[range].state == RangeState::Done) {
+            ++report_.staleResults;
+            return false;
+        }
+        ranges_[range].state = RangeState::Done;
+        report_.failedDocuments += failed;
+        ++completed_;
+        ++unacknowledged_;
+        return true;
+    }
+
+    size_t runBatchAgent(const AgentOptions& options) {
+        TcpSocket socket = TcpSocket::connect(options.host, options.port);
+        BatchRunner runner(options.batch);
+        size_t accepted = 0;
+        try {
+            string line;
+            while (true) {
+                socket.sendAll("NEXT " + options.name + "\n");
+                if (!socket.readLine(line)) break;
+                istringstream in(line);
+                string verb;
+                in >> verb;
+                if (verb == "DONE") break;
+                if (verb == "WAIT") {
+                    int waitMs = 0;
+                    in >> waitMs;
+                    this_thread::sleep_for(chrono::milliseconds(waitMs));
+                    continue;
+                }
+                if (verb != "LEASE") {
+                    throw runtime_error("Unexpected coordinator reply: " + line);
+                }
+
+                ResultShard shard;
+                size_t count = 0;
+                if (!(in >> shard.range >> count) || count > kMaxLeasePaths) {
+                    throw runtime_error("Malformed LEASE line: " + line);
+                }
+                vector<string> paths(count);
+                for (auto& path : paths) {
+                    if (!socket.readLine(path)) throw runtime_error("Lease ended early");
+                }
+                shard.items = runner.run(paths);
+
+                const string payload = encodeResultShard(shard);
+                socket.sendAll("RESULT " + to_string(shard.range) + " " + to_string(payload.size()) + "\n");
+                socket.sendAll(payload);
+                if (!socket.readLine(line)) break;
+                if (line == "ACK") ++accepted;
+            }
+        } catch (const exception&) {
+            // The coordinator closed the connection: the batch is complete, or it is
+            // gone (or spoke nonsense) and our lease will be handed to someone else
+        }
+        return accepted;
+    }
+
+} // namespace DocxParser
@@ -0,0 +1,144 @@
+#ifndef BATCH_CLUSTER_H
+#define BATCH_CLUSTER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "batch_runner.h"
+#include "tcp_socket.h"
+
+/**
+ * @brief Batch extraction spread over several hosts
+ *
+ * A coordinator splits the manifest into fixed ranges of documents and
+ * leases them to agents over TCP. Each agent runs the in-process
+ * BatchRunner on its range and sends back a result shard, which the
+ * coordinator writes to its output directory. Leases that are not
+ * completed in time, or whose agent disconnects, go back to the pool.
+ *
+ * Protocol (one connection per agent, text lines, binary payloads):
+ *   agent:       NEXT <agent-name>
+ *   coordinator: LEASE <range> <count>, then <count> path lines
+ *              | WAIT <ms>   (every range is leased; ask again later)
+ *              | DONE
+ *   agent:       RESULT <range> <bytes>, then <bytes> of result shard
+ *   coordinator: ACK | STALE (the range was already completed)
+ */
+namespace DocxParser {
+
+/**
+ * @brief Extraction results of one range, as exchanged and stored
+ */
+struct ResultShard {
+    uint32_t range = 0;
+    std::vector<BatchItem> items;  ///< path, error and styles of each document
+};
+
+/**
+ * @brief Encodes a shard ("TSRS" v1; styles as style snapshots)
+ */
+std::string encodeResultShard(const ResultShard& shard);
+
+/**
+ * @throws std::runtime_error if the data is not a complete shard
+ */
+ResultShard decodeResultShard(const char* data, size_t size);
+
+/**
+ * @brief Reads a shard file written by the coordinator
+ * @throws std::runtime_error if the file is missing or corrupt
+ */
+ResultShard readResultShard(const std::string& path);
+
+struct CoordinatorOptions {
+    std::string host = "0.0.0.0";  ///< Listen address
+    uint16_t port = 0;              ///< 0 = any free port (see BatchCoordinator::port())
+    size_t leaseSize = 64;          ///< Documents per range
+    std::chrono::milliseconds leaseTimeout{std::chrono::minutes(10)};
+    std::string outputDirectory;    ///< Receives one shard-<range>.tsrs per range
+};
+
+struct CoordinatorReport {
+    size_t documents = 0;
+    size_t ranges = 0;
+    size_t leasesGranted = 0;
+    size_t leasesExpired = 0;   ///< Timed out or dropped with their connection
+    size_t staleResults = 0;    ///< Results for ranges that were already complete
+    size_t failedDocuments = 0;
+    std::vector<std::string> shardFiles;  ///< In range order
+};
+
+class BatchCoordinator {
+public:
+    /**
+     * @brief Binds the listening socket; agents may connect once this returns
+     * @throws std::runtime_error if the port or output directory is unusable
+     */
+    BatchCoordinator(std::vector<std::string> paths, CoordinatorOptions options);
+    ~BatchCoordinator();
+
+    BatchCoordinator(const BatchCoordinator&) = delete;
+    BatchCoordinator& operator=(const BatchCoordinator&) = delete;
+
+    uint16_t port() const { return listener_.localPort(); }
+
+    /**
+     * @brief Serves agents until every range has a result, then disconnects them
+     */
+    CoordinatorReport run();
+
+private:
+    enum class RangeState { Pending, Leased, Done };
+
+    struct Range {
+        RangeState state = RangeState::Pending;
+        uint64_t owner = 0;  ///< Connection holding the lease
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    void acceptLoop();
+    void serveAgent(std::shared_ptr<TcpSocket> socket, uint64_t connection);
+    std::string grantLease(uint64_t connection);
+    bool storeResult(uint32_t range, const std::string& payload);
+    void acknowledged();
+    void stop();
+
+    std::vector<std::string> paths_;
+    CoordinatorOptions options_;
+    TcpSocket listener_;
+
+    std::mutex lock_;
+    std::condition_variable finished_;
+    std::vector<Range> ranges_;
+    size_t completed_ = 0;
+    size_t unacknowledged_ = 0;  ///< Stored results whose ACK is still being sent
+    bool stopping_ = false;
+    CoordinatorReport report_;
+    std::vector<std::shared_ptr<TcpSocket>> clients_;
+    std::vector<std::thread> handlers_;
+    std::thread acceptor_;
+};
+
+struct AgentOptions {
+    std::string host = "127.0.0.1";
+    uint16_t port = 0;
+    std::string name = "agent";
+    BatchOptions batch;  ///< Local parallelism for each leased range
+};
+
+/**
+ * @brief Works leases until the coordinator reports DONE or goes away
+ * @return Number of ranges whose results the coordinator accepted
+ * @throws std::runtime_error if the coordinator cannot be reached at all
+ */
+size_t runBatchAgent(const AgentOptions& options);
+
+} // namespace DocxParser
+
+#endif // BATCH_CLUSTER_H
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <cstdint>
+#include <future>
+#include <thread>
+#include "batch_cluster.h"
+
+using namespace DocxParser;
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path freshDirectory(const std::string& name) {
+    auto directory = fs::temp_directory_path() / name;
+    fs::remove_all(directory);
+    return directory;
+}
+
+} // namespace
+
+/**
+ * @brief Shards survive an encode/decode round trip, failures included
+ */
+TEST(BatchClusterTest, ResultShardRoundTrip) {
+    ResultShard shard;
+    shard.range = 7;
+    shard.items.resize(2);
+    shard.items[0].document.path = "sample.docx";
+    shard.items[0].document.styles = extractDocxStyles("sample.docx");
+    shard.items[1].document.path = "missing.docx";
+    shard.items[1].error = "Failed to open DOCX file";
+
+    const std::string bytes = encodeResultShard(shard);
+    auto decoded = decodeResultShard(bytes.data(), bytes.size());
+    EXPECT_EQ(decoded.range, 7u);
+    ASSERT_EQ(decoded.items.size(), 2u);
+    EXPECT_EQ(decoded.items[0].document.styles.size(), shard.items[0].document.styles.size());
+    EXPECT_EQ(decoded.items[0].document.styles[0].name, shard.items[0].document.styles[0].name);
+    EXPECT_EQ(decoded.items[1].error, shard.items[1].error);
+    EXPECT_THROW(decodeResultShard(bytes.data(), bytes.size() - 1), std::runtime_error);
+}
+
+/**
+ * @brief Several loopback agents complete the manifest; a hung agent's lease is reassigned
+ * and an oversized result only drops its own connection
+ */
+TEST(BatchClusterTest, LoopbackAgentsCompleteManifest) {
+    std::vector<std::string> paths;
+    for (int i = 0; i < 20; ++i) paths.push_back(i == 5 ? "nonexistent.docx" : "sample.docx");
+
+    const auto directory = freshDirectory("typstyle_cluster_test");
+    CoordinatorOptions options;
+    options.host = "127.0.0.1";
+    options.leaseSize = 3;
+    options.leaseTimeout = std::chrono::milliseconds(300);
+    options.outputDirectory = directory.string();
+    BatchCoordinator coordinator(paths, options);
+    auto report = std::async(std::launch::async, [&] { return coordinator.run(); });
+
+    // Takes the first lease and never answers
+    TcpSocket hung = TcpSocket::connect("127.0.0.1", coordinator.port());
+    hung.sendAll("NEXT hung\n");
+    std::string line;
+    ASSERT_TRUE(hung.readLine(line));
+    EXPECT_EQ(line, "LEASE 0 3");
+
+    // Announces a result no coordinator should allocate for; only its connection is dropped
+    TcpSocket rogue = TcpSocket::connect("127.0.0.1", coordinator.port());
+    rogue.sendAll("RESULT 1 " + std::to_string(SIZE_MAX) + "\n");
+
+    std::vector<std::future<size_t>> agents;
+    for (int a = 0; a < 3; ++a) {
+        AgentOptions agent;
+        agent.port = coordinator.port();
+        agent.name = "agent-" + std::to_string(a);
+        agent.batch.threads = 2;
+        agents.push_back(std::async(std::launch::async, runBatchAgent, agent));
+    }
+
+    size_t accepted = 0;
+    for (auto& agent : agents) accepted += agent.get();
+    auto result = report.get();
+    EXPECT_EQ(result.ranges, 7u);
+    EXPECT_EQ(accepted, result.ranges);
+    EXPECT_GE(result.leasesExpired, 1u);
+    EXPECT_EQ(result.failedDocuments, 1u);
+
+    // Shards cover the manifest in order
+    size_t next = 0;
+    for (const auto& file : result.shardFiles) {
+        for (const auto& item : readResultShard(file).items) {
+            ASSERT_LT(next, paths.size());
+            EXPECT_EQ(item.document.path, paths[next]);
+            EXPECT_EQ(item.error.empty(), paths[next] == "sample.docx");
+            ++next;
+        }
+    }
+    EXPECT_EQ(next, paths.size());
+    fs::remove_all(directory);
+}
@@ -0,0 +1,517 @@
+// Standard C++ headers
+#include <algorithm>   // For sort, max_element
+#include <atomic>      // For the shared FIFO cursor
+#include <chrono>      // For per-document timing
+#include <cmath>       // For fabs
+#include <deque>       // For per-worker work queues
+#include <exception>   // For exception_ptr
+#include <memory>      // For shared bundles
+#include <fstream>     // For cost model files
+#include <functional>  // For greater<>
+#include <mutex>       // For queue locks
+#include <queue>       // For priority_queue
+#include <stdexcept>   // For runtime_error
+#include <thread>      // For worker threads
+
+// Third-party library headers
+#include <zip.h>      // For central directory lookups (libzip)
+
+// Project headers
+#include "batch_runner.h"
+#include "document_bundle.h"
+
+using namespace std;
+
+/*
+ * Batch Runner - Implementation Notes
+ *
+ * Work stealing in a nutshell:
+ * - Every worker owns a deque and takes work from its front.
+ * - Deques are filled largest-first, so each worker starts on its biggest job.
+ * - A worker with an empty deque picks the deque with the most estimated
+ *   work left and steals from its back (the smallest job there), which
+ *   disturbs the owner's plan the least.
+ *
+ * Nothing is added to the queues after start-up, so a worker can stop as
+ * soon as every deque is empty.
+ *
+ * Bundles (.zip/.tar of documents) are expanded into one item per member
+ * before scheduling, so members spread over all workers like any other
+ * input. Workers share the bundle's mapping. Readahead only sees plain
+ * files: member paths are left out of its list, and workers report
+ * consumed() only for plain files, so the list and the workers stay in step.
+ *
+ * Sniffing happens on the worker, inside the timed extraction, so a
+ * rejected input shows up in the report as the few microseconds it cost.
+ *
+ * Hardware counters count the thread that opened them, so every worker
+ * opens its own set and brackets each stage with reads of it. Per-item
+ * samples are summed into document classes after the run; nothing is
+ * shared between workers while they run.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    using Clock = chrono::steady_clock;
+
+    double elapsedMicros(Clock::time_point start) {
+        return chrono::duration<double, micro>(Clock::now() - start).count();
+    }
+
+    struct WorkerQueue {
+        mutex lock;
+        deque<size_t> items;
+        double remainingMicros = 0;
+    };
+
+    // Where an item's bytes come from: a plain file, a bundle member, or a bundle that failed to open
+    struct ItemSource {
+        shared_ptr<const DocumentBundle> bundle;
+        size_t member = 0;
+        string error;
+    };
+
+    /**
+     * @brief First exception thrown by onItem on any worker
+     *
+     * An exception must not escape a std::thread, so workers hand it over
+     * here, stop taking work, and run() rethrows it after the join.
+     */
+    class FirstError {
+    public:
+        void capture() {
+            lock_guard<mutex> guard(lock_);
+            if (!error_) error_ = current_exception();
+            failed_.store(true, memory_order_relaxed);
+        }
+
+        bool failed() const { return failed_.load(memory_order_relaxed); }
+
+        void rethrowIfAny() const {
+            if (error_) rethrow_exception(error_);
+        }
+
+    private:
+        mutex lock_;
+        exception_ptr error_;
+        atomic<bool> failed_{false};
+    };
+
+    // Plain files are prefetched; bundle members live in a mapping that is already open
+    bool prefetchable(const ItemSource& source) {
+        return !source.bundle && source.error.empty();
+    }
+
+    string rejection(const InputSniff& input) {
+        return string("Rejected: ") + input.detail;
+    }
+
+    /**
+     * @brief Adds the counter deltas of one stage to the item, also when the stage throws
+     */
+    class StageScope {
+    public:
+        StageScope(BatchItem& item, BatchStage stage, PerfCounters* counters)
+            : sample_(item.perf[static_cast<size_t>(stage)]), counters_(counters) {
+            if (counters_) counters_->start();
+        }
+        ~StageScope() {
+            if (counters_) sample_ += counters_->stop();
+        }
+
+    private:
+        PerfSample& sample_;
+        PerfCounters* counters_;
+    };
+
+    void extractItem(BatchItem& item, const ItemSource& source, const StreamOptions& stream,
+                     PerfCounters* counters) {
+        const auto start = Clock::now();
+        try {
+            // Collected aside and kept only on success: a failed item has no styles
+            vector<StyleInfo> styles;
+            auto collect = [&](StyleInfo& style) { styles.push_back(move(style)); };
+            if (!source.error.empty()) {
+                item.input = sniffInput(item.document.path);
+                item.error = source.error;
+            } else if (source.bundle) {
+                // Flat XML inside a bundle would need a parse from memory; not worth it
+                {
+                    StageScope stage(item, BatchStage::Sniff, counters);
+                    item.input = source.bundle->sniffMember(source.member);
+                }
+                if (item.input.kind != InputKind::Zip || item.input.truncated) {
+                    item.error = rejection(item.input);
+                } else {
+                    StageScope stage(item, BatchStage::Parse, counters);
+                    source.bundle->visitMember(source.member, collect, stream);
+                }
+            } else {
+                // Two small reads; non-DOCX inputs never get as far as libzip
+                {
+                    StageScope stage(item, BatchStage::Sniff, counters);
+                    item.input = sniffInput(item.document.path);
+                }
+                if (item.input.kind == InputKind::FlatXml) {
+                    StageScope stage(item, BatchStage::Parse, counters);
+                    visitFlatXmlStyles(item.document.path, collect, stream);
+                } else if (item.input.extractable()) {
+                    unique_ptr<zip_t, zip_close_t> zip(nullptr, &zip_close);
+                    {
+                        StageScope stage(item, BatchStage::Open, counters);
+                        zip = openDocxFile(item.document.path);
+                    }
+                    StageScope stage(item, BatchStage::Parse, counters);
+                    visitStylesXml(zip.get(), collect, stream);
+                } else {
+                    item.error = rejection(item.input);
+                }
+            }
+            if (item.error.empty()) item.document.styles = move(styles);
+        } catch (const exception& e) {
+            item.error = e.what();
+        }
+        item.measuredMicros = elapsedMicros(start);
+    }
+
+    // Counters for the calling worker, if counting is on and possible
+    unique_ptr<PerfCounters> workerCounters(const PerfReport& perf) {
+        return perf.available ? make_unique<PerfCounters>() : nullptr;
+    }
+
+    const char* perfClassName(const BatchItem& item) {
+        if (!item.error.empty()) return "failed";
+        if (item.input.kind == InputKind::FlatXml) return "flat XML";
+        if (item.sizes.stylesBytes < 64 * 1024) return "docx <64K";
+        if (item.sizes.stylesBytes <= 1024 * 1024) return "docx 64K-1M";
+        return "docx >1M";
+    }
+
+    void summarizePerf(const vector<BatchItem>& items, PerfReport& perf) {
+        const char* const order[] = {"docx <64K", "docx 64K-1M", "docx >1M", "flat XML", "failed"};
+        for (const char* name : order) {
+            PerfClassCounters counters;
+            counters.name = name;
+            for (const auto& item : items) {
+                if (counters.name != perfClassName(item)) continue;
+                ++counters.documents;
+                for (size_t s = 0; s < kBatchStages; ++s) counters.stages[s] += item.perf[s];
+            }
+            if (counters.documents > 0) perf.classes.push_back(move(counters));
+        }
+    }
+
+    PartSizes probeItem(const BatchItem& item, const ItemSource& source) {
+        if (!source.error.empty()) return PartSizes();
+        return source.bundle ? source.bundle->probeMember(source.member) : probePartSizes(item.document.path);
+    }
+
+    // Solves the 3x3 system a * x = b in place; false if it is singular
+    bool solve3(double a[3][3], double b[3], double x[3]) {
+        for (int col = 0; col < 3; ++col) {
+            int pivot = col;
+            for (int row = col + 1; row < 3; ++row) {
+                if (fabs(a[row][col]) > fabs(a[pivot][col])) pivot = row;
+            }
+            if (fabs(a[pivot][col]) < 1e-12) return false;
+            swap(a[col], a[pivot]);
+            swap(b[col], b[pivot]);
+            for (int row = col + 1; row < 3; ++row) {
+                const double factor = a[row][col] / a[col][col];
+                for (int k = col; k < 3; ++k) a[row][k] -= factor * a[col][k];
+                b[row] -= factor * b[col];
+            }
+        }
+        for (int row = 2; row >= 0; --row) {
+            double sum = b[row];
+            for (int k = row + 1; k < 3; ++k) sum -= a[row][k] * x[k];
+            x[row] = sum / a[row][row];
+        }
+        return true;
+    }
+
+} // namespace
+
+    const char* batchStageName(BatchStage stage) {
+        static const char* const names[kBatchStages] = {"sniff", "open", "parse"};
+        return names[static_cast<size_t>(stage)];
+    }
+
+    CostModel CostModel::load(const string& path) {
+        CostModel model;
+        ifstream in(path);
+        CostModel parsed;
+        if (in >> parsed.fixedMicros >> parsed.perStylesByte >> parsed.perDocumentByte) {
+            model = parsed;
+        }
+        return model;
+    }
+
+    void CostModel::save(const string& path) const {
+        ofstream out(path, ios::trunc);
+        out << fixedMicros << " " << perStylesByte << " " << perDocumentByte << "\n";
+        if (!out) {
+            throw runtime_error("Failed to write cost model: " + path);
+        }
+    }
+
+    PartSizes probePartSizes(const string& filePath) {
+        PartSizes sizes;
+        int zipError = 0;
+        unique_ptr<zip_t, zip_close_t> zip(zip_open(filePath.c_str(), ZIP_RDONLY, &zipError), &zip_close);
+        if (!zip) return sizes;
+
+        zip_stat_t stats = {};
+        if (zip_stat(zip.get(), "word/styles.xml", 0, &stats) == 0 && (stats.valid & ZIP_STAT_SIZE)) {
+            sizes.stylesBytes = stats.size;
+        }
+        if (zip_stat(zip.get(), "word/document.xml", 0, &stats) == 0 && (stats.valid & ZIP_STAT_SIZE)) {
+            sizes.documentBytes = stats.size;
+        }
+        return sizes;
+    }
+
+    double simulateMakespan(const vector<double>& durations, size_t workers) {
+        if (workers == 0) return 0;
+        // Min-heap of the times at which each worker becomes idle
+        priority_queue<double, vector<double>, greater<>> idleAt;
+        for (size_t i = 0; i < workers; ++i) idleAt.push(0.0);
+        double makespan = 0;
+        for (double duration : durations) {
+            const double finish = idleAt.top() + duration;
+            idleAt.pop();
+            idleAt.push(finish);
+            makespan = max(makespan, finish);
+        }
+        return makespan;
+    }
+
+    CostModel calibrateCostModel(const vector<BatchItem>& items, const CostModel& fallback) {
+        // Normal equations of time ~ c0 + c1 * styles + c2 * document
+        double a[3][3] = {};
+        double b[3] = {};
+        size_t samples = 0;
+        for (const auto& item : items) {
+            if (!item.error.empty()) continue;
+            const double row[3] = {1.0, double(item.sizes.stylesBytes), double(item.sizes.documentBytes)};
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) a[i][j] += row[i] * row[j];
+                b[i] += row[i] * item.measuredMicros;
+            }
+            ++samples;
+        }
+        double x[3];
+        if (samples < 8 || !solve3(a, b, x)) return fallback;
+
+        CostModel fitted;
+        fitted.fixedMicros = max(0.0, x[0]);
+        fitted.perStylesByte = max(0.0, x[1]);
+        fitted.perDocumentByte = max(0.0, x[2]);
+        return fitted;
+    }
+
+    BatchRunner::BatchRunner(BatchOptions options) : options_(move(options)) {
+        if (options_.threads == 0) {
+            options_.threads = max(1u, thread::hardware_concurrency());
+        }
+    }
+
+    vector<BatchItem> BatchRunner::run(const vector<string>& inputs) {
+        // Bundles become one item per member document
+        vector<string> paths;
+        vector<ItemSource> sources;
+        for (const auto& input : inputs) {
+            if (DocumentBundle::isBundlePath(input)) {
+                try {
+                    auto bundle = make_shared<const DocumentBundle>(input);
+                    for (size_t m = 0; m < bundle->members().size(); ++m) {
+                        paths.push_back(bundle->memberPath(m));
+                        sources.push_back({bundle, m, {}});
+                    }
+                } catch (const exception& e) {
+                    paths.push_back(input);
+                    sources.push_back({nullptr, 0, e.what()});
+                }
+                continue;
+            }
+            paths.push_back(input);
+            sources.emplace_back();
+        }
+
+        vector<BatchItem> items(paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) {
+            items[i].index = i;
+            items[i].document.path = paths[i];
+        }
+
+        const size_t threadCount = max<size_t>(1, min(options_.threads, paths.size()));
+        report_ = BatchReport();
+        report_.threads = threadCount;
+        if (options_.perfCounters) {
+            // Probe once here: unavailable counters are reported, not retried per worker
+            PerfCounters probe;
+            report_.perf.enabled = true;
+            report_.perf.available = probe.available();
+            report_.perf.status = probe.status();
+            for (size_t e = 0; e < kPerfEvents; ++e) report_.perf.counted[e] = probe.has(static_cast<PerfEvent>(e));
+        }
+
+        const auto start = Clock::now();
+        vector<thread> workers;
+        workers.reserve(threadCount);
+        FirstError callbackError;
+        auto notify = [&](BatchItem& item) {
+            if (options_.onItem) {
+                try {
+                    options_.onItem(item);
+                } catch (...) {
+                    callbackError.capture();
+                }
+            }
+            if (!options_.retainStyles) vector<StyleInfo>().swap(item.document.styles);
+        };
+
+        if (options_.policy == SchedulePolicy::Fifo) {
+            vector<string> prefetchOrder;
+            if (options_.readahead.maxWindow > 0) {
+                for (size_t i = 0; i < paths.size(); ++i) {
+                    if (prefetchable(sources[i])) prefetchOrder.push_back(paths[i]);
+                }
+            }
+            ReadaheadPipeline readahead(move(prefetchOrder), options_.readahead);
+            atomic<size_t> next{0};
+            for (size_t w = 0; w < threadCount; ++w) {
+                workers.emplace_back([&] {
+                    const auto counters = workerCounters(report_.perf);
+                    for (size_t i = next++; i < items.size() && !callbackError.failed(); i = next++) {
+                        if (prefetchable(sources[i])) readahead.consumed();
+                        // FIFO only needs sizes for the report and calibration; probing here
+                        // keeps that I/O parallel and warms the directory for the extraction
+                        items[i].sizes = probeItem(items[i], sources[i]);
+                        items[i].estimatedMicros = options_.costModel.estimate(
+                            items[i].sizes.stylesBytes, items[i].sizes.documentBytes);
+                        extractItem(items[i], sources[i], options_.stream, counters.get());
+                        notify(items[i]);
+                    }
+                });
+            }
+            for (auto& worker : workers) worker.join();
+            report_.readahead = readahead.finish();
+        } else {
+            // Probing only reads central directories, but it is still I/O: do it in parallel
+            atomic<size_t> nextProbe{0};
+            for (size_t w = 0; w < threadCount; ++w) {
+                workers.emplace_back([&] {
+                    for (size_t i = nextProbe++; i < items.size(); i = nextProbe++) {
+                        items[i].sizes = probeItem(items[i], sources[i]);
+                        items[i].estimatedMicros = options_.costModel.estimate(
+                            items[i].sizes.stylesBytes, items[i].sizes.documentBytes);
+                    }
+                });
+            }
+            for (auto& worker : workers) worker.join();
+            workers.clear();
+
+            vector<size_t> order(items.size());
+            for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+            stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                return items[a].estimatedMicros > items[b].estimatedMicros;
+            });
+
+            // Workers start roughly in this order (each takes its deque's front), so
+            // it is also the order to prefetch in; the probe already cached the
+            // central directories, ranges mode now advises the styles entries
+            vector<string> prefetchOrder;
+            if (options_.readahead.maxWindow > 0) {
+                for (size_t index : order) {
+                    if (prefetchable(sources[index])) prefetchOrder.push_back(paths[index]);
+                }
+            }
+            ReadaheadPipeline readahead(move(prefetchOrder), options_.readahead);
+
+            // Greedy LPT deal: each job goes to the least loaded deque
+            vector<WorkerQueue> queues(threadCount);
+            priority_queue<pair<double, size_t>, vector<pair<double, size_t>>, greater<>> loads;
+            for (size_t w = 0; w < threadCount; ++w) loads.emplace(0.0, w);
+            for (size_t index : order) {
+                auto least = loads.top();
+                loads.pop();
+                queues[least.second].items.push_back(index);
+                queues[least.second].remainingMicros += items[index].estimatedMicros;
+                loads.emplace(least.first + items[index].estimatedMicros, least.second);
+            }
+
+            auto takeOwn = [&](size_t w, size_t& index) {
+                lock_guard<mutex> guard(queues[w].lock);
+                if (queues[w].items.empty()) return false;
+                index = queues[w].items.front();
+                queues[w].items.pop_front();
+                queues[w].remainingMicros -= items[index].estimatedMicros;
+                return true;
+            };
+
+            auto steal = [&](size_t thief, size_t& index) {
+                for (;;) {
+                    size_t victim = threadCount;
+                    double most = 0;
+                    for (size_t w = 0; w < threadCount; ++w) {
+                        if (w == thief) continue;
+                        lock_guard<mutex> guard(queues[w].lock);
+                        if (!queues[w].items.empty() && (victim == threadCount || queues[w].remainingMicros > most)) {
+                            victim = w;
+                            most = queues[w].remainingMicros;
+                        }
+                    }
+                    if (victim == threadCount) return false;
+
+                    lock_guard<mutex> guard(queues[victim].lock);
+                    if (queues[victim].items.empty()) continue;  // Raced with the owner; rescan
+                    index = queues[victim].items.back();
+                    queues[victim].items.pop_back();
+                    queues[victim].remainingMicros -= items[index].estimatedMicros;
+                    return true;
+                }
+            };
+
+            for (size_t w = 0; w < threadCount; ++w) {
+                workers.emplace_back([&, w] {
+                    const auto counters = workerCounters(report_.perf);
+                    size_t index;
+                    while (!callbackError.failed() && (takeOwn(w, index) || steal(w, index))) {
+                        if (prefetchable(sources[index])) readahead.consumed();
+                        extractItem(items[index], sources[index], options_.stream, counters.get());
+                        notify(items[index]);
+                    }
+                });
+            }
+            for (auto& worker : workers) worker.join();
+            report_.readahead = readahead.finish();
+        }
+
+        callbackError.rethrowIfAny();
+        report_.makespanMs = elapsedMicros(start) / 1000.0;
+
+        vector<double> inputOrder, sizeOrder;
+        vector<pair<double, double>> byEstimate;
+        for (const auto& item : items) {
+            if (!item.error.empty()) ++report_.failed;
+            report_.inputs.add(item.input);
+            report_.totalWorkMs += item.measuredMicros / 1000.0;
+            inputOrder.push_back(item.measuredMicros / 1000.0);
+            byEstimate.emplace_back(options_.costModel.estimate(item.sizes.stylesBytes, item.sizes.documentBytes),
+                                    item.measuredMicros / 1000.0);
+        }
+        stable_sort(byEstimate.begin(), byEstimate.end(),
+                    [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (const auto& entry : byEstimate) sizeOrder.push_back(entry.second);
+
+        report_.fifoMakespanMs = simulateMakespan(inputOrder, threadCount);
+        report_.largestFirstMakespanMs = simulateMakespan(sizeOrder, threadCount);
+        report_.calibrated = calibrateCostModel(items, options_.costModel);
+        if (report_.perf.available) summarizePerf(items, report_.perf);
+        return items;
+    }
+
+} // namespace DocxParser
@@ -0,0 +1,193 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "docx_style_parser.h"
+#include "input_sniffer.h"
+#include "perf_counters.h"
+#include "readahead.h"
+
+/**
+ * @brief Parallel extraction of many documents
+ *
+ * The runner extracts a list of documents on a pool of worker threads and
+ * returns the results in input order. Two scheduling policies exist:
+ *
+ * - Fifo: workers take documents from one shared queue in input order.
+ * - LargestFirst: documents are ordered by estimated cost (from the sizes in
+ *   the zip central directory), dealt to per-worker deques greedily by
+ *   estimated load, and idle workers steal from the busiest deque.
+ *
+ * With FIFO a few huge archives picked up late dominate the finish time
+ * (makespan); starting them first lets the small ones fill the gaps.
+ */
+namespace DocxParser {
+
+enum class SchedulePolicy {
+    Fifo,
+    LargestFirst,
+};
+
+/**
+ * @brief Linear model of extraction time from uncompressed part sizes
+ *
+ * estimate(us) = fixedMicros + perStylesByte * styles.xml size
+ *                            + perDocumentByte * document.xml size
+ */
+struct CostModel {
+    double fixedMicros = 300.0;
+    double perStylesByte = 0.02;
+    double perDocumentByte = 0.001;
+
+    double estimate(uint64_t stylesBytes, uint64_t documentBytes) const {
+        return fixedMicros + perStylesByte * stylesBytes + perDocumentByte * documentBytes;
+    }
+
+    /// Reads "fixed perStylesByte perDocumentByte"; keeps defaults if the file is missing
+    static CostModel load(const std::string& path);
+    /// @throws std::runtime_error if the file cannot be written
+    void save(const std::string& path) const;
+};
+
+/**
+ * @brief Uncompressed sizes of the parts that drive extraction cost
+ */
+struct PartSizes {
+    uint64_t stylesBytes = 0;   ///< word/styles.xml
+    uint64_t documentBytes = 0; ///< word/document.xml
+};
+
+/**
+ * @brief Reads part sizes from the central directory without inflating anything
+ * @return Zero sizes if the file is not a readable archive
+ */
+PartSizes probePartSizes(const std::string& filePath);
+
+/**
+ * @brief Steps of one document's extraction, measured separately with BatchOptions::perfCounters
+ *
+ * Sniff reads the head and tail of the input; Open reads the zip central
+ * directory; Parse inflates styles.xml, parses it and builds the styles.
+ * Flat XML and bundle members have no Open step of their own.
+ */
+enum class BatchStage { Sniff, Open, Parse };
+
+constexpr size_t kBatchStages = 3;
+
+/// "sniff", "open", "parse"
+const char* batchStageName(BatchStage stage);
+
+/**
+ * @brief Outcome of one document
+ */
+struct BatchItem {
+    size_t index = 0;         ///< Position in run()'s result, for consumers that see items out of order
+    DocumentStyles document;  ///< path always set; styles empty on failure or without retainStyles
+    std::string error;        ///< Empty on success
+    InputSniff input;         ///< What the input turned out to be (sniffed before extraction)
+    PartSizes sizes;
+    double estimatedMicros = 0;
+    double measuredMicros = 0;
+    std::array<PerfSample, kBatchStages> perf;  ///< Counters per stage; zero unless counted
+};
+
+struct BatchOptions {
+    size_t threads = 0;  ///< 0 = hardware concurrency
+    SchedulePolicy policy = SchedulePolicy::LargestFirst;
+    CostModel costModel;
+    ReadaheadOptions readahead;  ///< Prefetch upcoming inputs (off by default)
+    bool perfCounters = false;   ///< Count cycles, instructions, cache and branch misses per stage
+    StreamOptions stream;        ///< Per-document extraction (quickFormatOnly = false for every style)
+    /// Called on the worker thread as soon as an item is extracted, in completion
+    /// order; lets consumers such as exporters overlap with the rest of the batch.
+    /// If it throws, no further items are started and run() rethrows the first
+    /// exception once the workers have stopped.
+    std::function<void(BatchItem&)> onItem;
+    /// Keep every item's styles in run()'s result. Consumers that take what they
+    /// need in onItem turn this off, so the corpus is never in memory at once;
+    /// the callback may then move document.styles out of the item, and whatever
+    /// it leaves is released as soon as it returns.
+    bool retainStyles = true;
+};
+
+/**
+ * @brief Counter totals of one class of documents
+ */
+struct PerfClassCounters {
+    std::string name;  ///< "docx <64K", "docx 64K-1M", "docx >1M" (styles.xml size), "flat XML", "failed"
+    size_t documents = 0;
+    std::array<PerfSample, kBatchStages> stages;
+};
+
+/**
+ * @brief Hardware counter report of a batch run (BatchOptions::perfCounters)
+ */
+struct PerfReport {
+    bool enabled = false;    ///< Counting was requested
+    bool available = false;  ///< At least one counter could be opened
+    std::string status;      ///< Why counters are missing; empty if all opened
+    std::array<bool, kPerfEvents> counted{};      ///< Events actually counted
+    std::vector<PerfClassCounters> classes;  ///< Classes with documents, in the order above
+};
+
+/**
+ * @brief Timing summary of a batch run
+ */
+struct BatchReport {
+    size_t threads = 0;
+    size_t failed = 0;
+    double makespanMs = 0;        ///< Wall time of the extraction phase
+    double totalWorkMs = 0;       ///< Sum of per-document times
+    double fifoMakespanMs = 0;    ///< FIFO list schedule replayed with measured times
+    double largestFirstMakespanMs = 0; ///< Largest-first schedule replayed with measured times
+    CostModel calibrated;         ///< Least-squares fit of the measured times
+    ReadaheadStats readahead;
+    InputKindCounts inputs;       ///< Items by sniffed input kind
+    PerfReport perf;
+};
+
+class BatchRunner {
+public:
+    explicit BatchRunner(BatchOptions options);
+
+    /**
+     * @brief Extracts all documents; failures are recorded, not thrown
+     *
+     * Inputs ending in .zip or .tar are bundles: each .docx inside becomes
+     * an item named "<bundle>!/<member>", read straight from the bundle (see
+     * DocumentBundle). A bundle that cannot be read becomes one failed item.
+     *
+     * Every input is sniffed first (see sniffInput()): flat XML documents
+     * are extracted as such, and encrypted, legacy, Pages and unknown inputs
+     * fail at once with a "Rejected: ..." error instead of reaching libzip.
+     * @return One item per document, in input order (members in bundle order)
+     */
+    std::vector<BatchItem> run(const std::vector<std::string>& inputs);
+
+    /// Report of the last run()
+    const BatchReport& report() const { return report_; }
+
+private:
+    BatchOptions options_;
+    BatchReport report_;
+};
+
+/**
+ * @brief Makespan of greedy list scheduling (each item goes to the first idle worker)
+ * @param durations Item durations in dispatch order
+ */
+double simulateMakespan(const std::vector<double>& durations, size_t workers);
+
+/**
+ * @brief Fits a CostModel to measured items by least squares
+ * @return fallback if there are too few items to fit
+ */
+CostModel calibrateCostModel(const std::vector<BatchItem>& items, const CostModel& fallback);
+
+} // namespace DocxParser
+
+#endif // BATCH_RUNNER_H
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include "batch_runner.h"
+
+using namespace DocxParser;
+
+/**
+ * @brief Replay of list scheduling shows why huge late jobs hurt FIFO
+ */
+TEST(BatchRunnerTest, SimulatesMakespan) {
+    // Two workers, the big job arrives last under FIFO
+    std::vector<double> fifo = {1, 1, 1, 1, 8};
+    std::vector<double> largestFirst = {8, 1, 1, 1, 1};
+    EXPECT_DOUBLE_EQ(simulateMakespan(fifo, 2), 10.0);
+    EXPECT_DOUBLE_EQ(simulateMakespan(largestFirst, 2), 8.0);
+}
+
+/**
+ * @brief Both policies return every input, in input order
+ */
+TEST(BatchRunnerTest, KeepsInputOrderAndRecordsFailures) {
+    std::vector<std::string> paths = {"sample.docx", "nonexistent.docx", "sample.docx", "sample.docx"};
+    for (auto policy : {SchedulePolicy::Fifo, SchedulePolicy::LargestFirst}) {
+        BatchOptions options;
+        options.threads = 3;
+        options.policy = policy;
+        std::atomic<size_t> notified{0};
+        options.onItem = [&](const BatchItem&) { ++notified; };
+        BatchRunner runner(options);
+        auto items = runner.run(paths);
+        EXPECT_EQ(notified.load(), paths.size());
+
+        ASSERT_EQ(items.size(), paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) {
+            EXPECT_EQ(items[i].document.path, paths[i]);
+        }
+        EXPECT_FALSE(items[0].document.styles.empty());
+        EXPECT_FALSE(items[1].error.empty());
+        EXPECT_GT(items[2].sizes.stylesBytes, 0u);
+        EXPECT_EQ(runner.report().failed, 1u);
+    }
+}
+
+/**
+ * @brief An exception from onItem stops the batch and comes out of run(), not std::terminate
+ */
+TEST(BatchRunnerTest, RethrowsOnItemException) {
+    const std::vector<std::string> paths(64, "sample.docx");
+    for (auto policy : {SchedulePolicy::Fifo, SchedulePolicy::LargestFirst}) {
+        BatchOptions options;
+        options.threads = 4;
+        options.policy = policy;
+        std::atomic<size_t> notified{0};
+        options.onItem = [&](const BatchItem&) {
+            if (++notified == 3) throw std::runtime_error("exporter failed");
+        };
+        BatchRunner runner(options);
+        EXPECT_THROW(runner.run(paths), std::runtime_error);
+        EXPECT_LT(notified.load(), paths.size());
+    }
+}
+
+/**
+ * @brief Without retainStyles, onItem sees (and may take) the styles and the result keeps none
+ */
+TEST(BatchRunnerTest, DropsStylesAfterOnItemWithoutRetain) {
+    const std::vector<std::string> paths(8, "sample.docx");
+    for (auto policy : {SchedulePolicy::Fifo, SchedulePolicy::LargestFirst}) {
+        BatchOptions options;
+        options.threads = 3;
+        options.policy = policy;
+        options.retainStyles = false;
+        std::atomic<size_t> taken{0};
+        options.onItem = [&](BatchItem& item) {
+            std::vector<StyleInfo> styles = std::move(item.document.styles);
+            if (!styles.empty()) ++taken;
+        };
+        BatchRunner runner(options);
+        const auto items = runner.run(paths);
+        EXPECT_EQ(taken.load(), paths.size());
+        for (const auto& item : items) {
+            EXPECT_TRUE(item.error.empty());
+            EXPECT_TRUE(item.document.styles.empty());
+        }
+    }
+}
+
+/**
+ * @brief A document that fails halfway keeps none of the styles parsed before the error
+ */
+TEST(BatchRunnerTest, FailedItemHasNoStyles) {
+    const auto path = (std::filesystem::temp_directory_path() / "typstyle_batch_partial.xml").string();
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "<?xml version=\"1.0\"?><pkg:package xmlns:pkg=\"http://schemas.microsoft.com/office/2006/xmlPackage\">"
+               "<pkg:part pkg:name=\"/word/styles.xml\"><pkg:xmlData><w:styles xmlns:w=\"urn:w\">"
+               "<w:style w:type=\"paragraph\" w:styleId=\"A\"><w:name w:val=\"A\"/><w:qFormat/></w:style>"
+               "<w:style w:type=\"paragraph\" w:styleId=\"B\"><w:name w:val=\"B\"/><w:qFormat/></w:style>"
+               "<w:style w:type=\"paragraph\" w:styleId=\"C\"><w:name w:val=</w:style>";
+    }
+    BatchRunner runner(BatchOptions{});
+    const auto items = runner.run({path});
+    ASSERT_EQ(items.size(), 1u);
+    EXPECT_FALSE(items[0].error.empty());
+    EXPECT_TRUE(items[0].document.styles.empty());
+    std::filesystem::remove(path);
+}
+
+/**
+ * @brief Calibration recovers a known linear cost model
+ */
+TEST(BatchRunnerTest, CalibratesCostModel) {
+    std::vector<BatchItem> items(20);
+    for (size_t i = 0; i < items.size(); ++i) {
+        items[i].sizes.stylesBytes = 1000 * (i + 1);
+        items[i].sizes.documentBytes = 5000 * (i % 4);
+        items[i].measuredMicros = 100 + 0.5 * items[i].sizes.stylesBytes + 0.01 * items[i].sizes.documentBytes;
+    }
+    auto model = calibrateCostModel(items, CostModel());
+    EXPECT_NEAR(model.fixedMicros, 100, 1e-6);
+    EXPECT_NEAR(model.perStylesByte, 0.5, 1e-9);
+    EXPECT_NEAR(model.perDocumentByte, 0.01, 1e-9);
+}
@@ -0,0 +1,361 @@
+// Standard C++ headers
+#include <algorithm>  // For find, all_of
+#include <cctype>     // For tolower
+#include <cstring>    // For memcmp
+#include <memory>     // For unique_ptr
+#include <stdexcept>  // For runtime_error
+
+// Third-party library headers
+#include <zip.h>   // For opening member archives (libzip)
+#include <zlib.h>  // For inflating deflated members
+
+// Project header
+#include "document_bundle.h"
+#include "scratch_buffer.h"
+
+using namespace std;
+
+/*
+ * Document Bundle - Implementation Notes
+ *
+ * Both directory formats are parsed here rather than through libzip or a
+ * tar library, because the one thing needed from them - where a member's
+ * bytes start in the bundle - is exactly what libzip does not expose.
+ *
+ * Zip: the end-of-central-directory record (zip64 when counts or offsets
+ * overflow 32 bits, as they do for multi-gigabyte exports) locates the
+ * central directory; each entry gives method, sizes and the offset of the
+ * member's local header, whose own name and extra lengths give the data
+ * offset. Encrypted members and methods other than stored and deflated are
+ * skipped.
+ *
+ * Tar: 512-byte headers, each followed by the member data padded to 512
+ * bytes. Names longer than the ustar fields come from a preceding pax
+ * ("path=") or GNU ('L') header. Only regular files are members.
+ *
+ * Every offset and length read from the bundle is checked against the
+ * mapping before it is used; a bundle cut off mid-transfer fails cleanly.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    constexpr size_t kMaxPooledBuffer = 64u << 20;
+    // Deflate expands at most 1032:1 (plus slack for tiny streams); a member declaring more lies about its size
+    constexpr uint64_t kMaxDeflateRatio = 1032;
+
+    using InflateBuffer = ScratchBuffer<struct InflateBufferTag>;
+
+    uint16_t readU16(const unsigned char* p) {
+        return static_cast<uint16_t>(p[0] | p[1] << 8);
+    }
+
+    uint32_t readU32(const unsigned char* p) {
+        return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 |
+               static_cast<uint32_t>(p[3]) << 24;
+    }
+
+    uint64_t readU64(const unsigned char* p) {
+        return static_cast<uint64_t>(readU32(p)) | static_cast<uint64_t>(readU32(p + 4)) << 32;
+    }
+
+    bool endsWithDocx(const string& name) {
+        if (name.size() < 5) return false;
+        string extension = name.substr(name.size() - 5);
+        for (auto& c : extension) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        return extension == ".docx";
+    }
+
+    // Octal numeric field, or GNU base-256 when the high bit of the first byte is set
+    uint64_t tarNumber(const unsigned char* field, size_t length) {
+        uint64_t value = 0;
+        if (field[0] & 0x80) {
+            for (size_t i = 1; i < length; ++i) value = value << 8 | field[i];
+            return value;
+        }
+        for (size_t i = 0; i < length && field[i]; ++i) {
+            if (field[i] == ' ') continue;
+            if (field[i] < '0' || field[i] > '7') break;
+            value = value * 8 + (field[i] - '0');
+        }
+        return value;
+    }
+
+    string tarString(const unsigned char* field, size_t length) {
+        const char* text = reinterpret_cast<const char*>(field);
+        return string(text, find(text, text + length, '\0'));
+    }
+
+    // "len key=value\n" records of a pax extended header
+    string paxPath(const char* data, size_t size) {
+        string path;
+        size_t pos = 0;
+        while (pos < size) {
+            size_t length = 0;
+            size_t digits = pos;
+            while (digits < size && data[digits] >= '0' && data[digits] <= '9') {
+                length = length * 10 + (data[digits++] - '0');
+            }
+            if (length == 0 || pos + length > size) break;
+            const string record(data + digits + 1, data + pos + length - 1);  // Without the newline
+            if (record.compare(0, 5, "path=") == 0) path = record.substr(5);
+            pos += length;
+        }
+        return path;
+    }
+
+} // namespace
+
+    DocumentBundle::DocumentBundle(const string& path) : path_(path), file_(path) {
+        const auto* data = reinterpret_cast<const unsigned char*>(file_.data());
+        const size_t size = file_.size();
+        if (size >= 4 && readU32(data) == 0x04034b50) {
+            readZipDirectory();
+        } else if (size >= 4 && readU32(data) == 0x06054b50) {
+            // Empty zip
+        } else if (size >= 512 && memcmp(data + 257, "ustar", 5) == 0) {
+            readTarDirectory();
+        } else {
+            throw runtime_error("Not a zip or tar bundle: " + path);
+        }
+    }
+
+    bool DocumentBundle::isBundlePath(const string& path) {
+        if (path.size() < 4) return false;
+        string extension = path.substr(path.size() - 4);
+        for (auto& c : extension) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        return extension == ".zip" || extension == ".tar";
+    }
+
+    string DocumentBundle::memberPath(size_t index) const {
+        return path_ + "!/" + members_.at(index).name;
+    }
+
+    void DocumentBundle::readZipDirectory() {
+        const auto* data = reinterpret_cast<const unsigned char*>(file_.data());
+        const uint64_t size = file_.size();
+        auto corrupt = [&](const char* what) {
+            return runtime_error("Corrupt zip bundle " + path_ + ": " + what);
+        };
+
+        // End of central directory: 22 bytes plus a comment of up to 64 KiB
+        if (size < 22) throw corrupt("too short");
+        uint64_t eocd = size - 22;
+        const uint64_t lowest = size > 22 + 0xFFFF ? size - 22 - 0xFFFF : 0;
+        while (readU32(data + eocd) != 0x06054b50) {
+            if (eocd == lowest) throw corrupt("no end of central directory");
+            --eocd;
+        }
+        uint64_t entries = readU16(data + eocd + 10);
+        uint64_t directorySize = readU32(data + eocd + 12);
+        uint64_t directoryOffset = readU32(data + eocd + 16);
+
+        // Zip64 end of central directory, through its locator just before the classic record
+        if (eocd >= 20 && readU32(data + eocd - 20) == 0x07064b50) {
+            const uint64_t zip64 = readU64(data + eocd - 20 + 8);
+            if (size < 56 || zip64 > size - 56 || readU32(data + zip64) != 0x06064b50) throw corrupt("bad zip64 record");
+            entries = readU64(data + zip64 + 32);
+            directorySize = readU64(data + zip64 + 40);
+            directoryOffset = readU64(data + zip64 + 48);
+        }
+        if (directoryOffset > size || directorySize > size - directoryOffset) throw corrupt("directory out of range");
+
+        uint64_t pos = directoryOffset;
+        const uint64_t end = directoryOffset + directorySize;
+        for (uint64_t i = 0; i < entries; ++i) {
+            if (end - pos < 46 || readU32(data + pos) != 0x02014b50) throw corrupt("bad directory entry");
+            const unsigned char* entry = data + pos;
+            const uint16_t flags = readU16(entry + 8);
+            const uint16_t method = readU16(entry + 10);
+            const uint16_t nameLength = readU16(entry + 28);
+            const uint16_t extraLength = readU16(entry + 30);
+            const uint16_t commentLength = readU16(entry + 32);
+            const uint64_t entryLength = 46ull + nameLength + extraLength + commentLength;
+            if (end - pos < entryLength) throw corrupt("bad directory entry");
+
+            BundleMember member;
+            member.name.assign(reinterpret_cast<const char*>(entry + 46), nameLength);
+            member.crc32 = readU32(entry + 16);
+            member.storedBytes = readU32(entry + 20);
+            member.size = readU32(entry + 24);
+            uint64_t localHeader = readU32(entry + 42);
+
+            // Zip64 extra field: only the values whose 32-bit fields overflowed, in this order
+            const unsigned char* extraEnd = entry + 46 + nameLength + extraLength;
+            for (const unsigned char* extra = entry + 46 + nameLength; extra + 4 <= extraEnd;) {
+                const uint16_t id = readU16(extra);
+                const uint16_t length = readU16(extra + 2);
+                if (length > extraEnd - (extra + 4)) throw corrupt("bad extra field");
+                if (id == 0x0001) {
+                    const unsigned char* value = extra + 4;
+                    const unsigned char* valueEnd = value + length;
+                    if (member.size == 0xFFFFFFFF && value + 8 <= valueEnd) {
+                        member.size = readU64(value);
+                        value += 8;
+                    }
+                    if (member.storedBytes == 0xFFFFFFFF && value + 8 <= valueEnd) {
+                        member.storedBytes = readU64(value);
+                        value += 8;
+                    }
+                    if (localHeader == 0xFFFFFFFF && value + 8 <= valueEnd) localHeader = readU64(value);
+                }
+                extra += 4 + length;
+            }
+            pos += entryLength;
+
+            const bool encrypted = flags & 0x0001;
+            if (!endsWithDocx(member.name) || encrypted || (method != 0 && method != 8)) continue;
+            member.deflated = method == 8;
+
+            if (localHeader > size - 30 || readU32(data + localHeader) != 0x04034b50) throw corrupt("bad local header");
+            member.dataOffset = localHeader + 30 + readU16(data + localHeader + 26) + readU16(data + localHeader + 28);
+            if (member.dataOffset > size || member.storedBytes > size - member.dataOffset) {
+                throw corrupt("member data out of range");
+            }
+            if (!member.deflated && member.storedBytes != member.size) throw corrupt("stored size mismatch");
+            members_.push_back(move(member));
+        }
+    }
+
+    void DocumentBundle::readTarDirectory() {
+        const auto* data = reinterpret_cast<const unsigned char*>(file_.data());
+        const uint64_t size = file_.size();
+        string longName;
+        for (uint64_t pos = 0; pos + 512 <= size;) {
+            const unsigned char* header = data + pos;
+            if (all_of(header, header + 512, [](unsigned char c) { return c == 0; })) break;  // End of archive
+
+            unsigned checksum = 0;
+            for (size_t i = 0; i < 512; ++i) checksum += (i >= 148 && i < 156) ? ' ' : header[i];
+            if (checksum != tarNumber(header + 148, 8)) {
+                throw runtime_error("Corrupt tar bundle " + path_ + ": bad header checksum");
+            }
+
+            const uint64_t memberSize = tarNumber(header + 124, 12);
+            const uint64_t dataOffset = pos + 512;
+            if (memberSize > size - dataOffset) throw runtime_error("Corrupt tar bundle " + path_ + ": truncated");
+            const char type = static_cast<char>(header[156]);
+            const char* memberData = reinterpret_cast<const char*>(data + dataOffset);
+
+            if (type == 'x') {
+                longName = paxPath(memberData, memberSize);
+            } else if (type == 'L') {
+                longName = string(memberData, find(memberData, memberData + memberSize, '\0'));
+            } else if (type == '0' || type == '\0') {
+                string name = longName;
+                if (name.empty()) {
+                    const string prefix = tarString(header + 345, 155);
+                    name = (prefix.empty() ? "" : prefix + "/") + tarString(header, 100);
+                }
+                longName.clear();
+                if (endsWithDocx(name)) {
+                    BundleMember member;
+                    member.name = move(name);
+                    member.dataOffset = dataOffset;
+                    member.storedBytes = memberSize;
+                    member.size = memberSize;
+                    members_.push_back(move(member));
+                }
+            } else if (type != 'g') {
+                longName.clear();  // Directories, links, ...: the long name was theirs
+            }
+            pos = dataOffset + (memberSize + 511) / 512 * 512;
+        }
+    }
+
+    StreamReport DocumentBundle::visitMember(size_t index, StyleVisitorRef visitor, const StreamOptions& options) const {
+        const BundleMember& member = members_.at(index);
+        const char* window = file_.data() + member.dataOffset;
+
+        // Deflated members are inflated into a buffer this thread reuses for its next
+        // member; a visitor that opens another member meanwhile borrows a private one
+        InflateBuffer scratch(kMaxPooledBuffer);
+        vector<char>& inflated = scratch.get();
+        if (member.deflated) {
+            // Members over 4 GiB are not DOCX files worth supporting; avoid the chunking
+            if (member.storedBytes > UINT32_MAX || member.size > UINT32_MAX ||
+                member.size > member.storedBytes * kMaxDeflateRatio + 1024) {
+                throw runtime_error("Bundle member too large: " + memberPath(index));
+            }
+            inflated.resize(member.size);
+            z_stream stream = {};
+            if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) throw runtime_error("Failed to initialize zlib");
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(window));
+            stream.next_out = reinterpret_cast<Bytef*>(inflated.data());
+            stream.avail_in = static_cast<uInt>(member.storedBytes);
+            stream.avail_out = static_cast<uInt>(member.size);
+            const int status = inflate(&stream, Z_FINISH);
+            const uLong produced = stream.total_out;
+            inflateEnd(&stream);
+            if (status != Z_STREAM_END || produced != member.size ||
+                crc32(0, reinterpret_cast<const Bytef*>(inflated.data()), static_cast<uInt>(produced)) != member.crc32) {
+                throw runtime_error("Corrupt deflated member: " + memberPath(index));
+            }
+            window = inflated.data();
+        }
+
+        zip_error_t error;
+        zip_error_init(&error);
+        zip_source_t* source = zip_source_buffer_create(window, member.size, 0, &error);
+        zip_t* archive = source ? zip_open_from_source(source, ZIP_RDONLY, &error) : nullptr;
+        if (!archive) {
+            if (source) zip_source_free(source);
+            const string message = zip_error_strerror(&error);
+            zip_error_fini(&error);
+            throw runtime_error("Failed to open bundle member " + memberPath(index) + ": " + message);
+        }
+        zip_error_fini(&error);
+        unique_ptr<zip_t, zip_close_t> zip(archive, &zip_close);  // Also frees the source
+
+        StreamReport report = visitStylesXml(zip.get(), visitor, options);
+        zip.reset();
+        return report;
+    }
+
+    InputSniff DocumentBundle::sniffMember(size_t index) const {
+        const BundleMember& member = members_.at(index);
+        const char* window = file_.data() + member.dataOffset;
+        if (!member.deflated) {
+            const size_t head = static_cast<size_t>(min<uint64_t>(member.size, kSniffWindow));
+            return sniffBytes(window, head, window + (member.size - head), head);
+        }
+
+        char head[kSniffWindow];
+        z_stream stream = {};
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) throw runtime_error("Failed to initialize zlib");
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(window));
+        stream.avail_in = static_cast<uInt>(min<uint64_t>(member.storedBytes, UINT32_MAX));
+        stream.next_out = reinterpret_cast<Bytef*>(head);
+        stream.avail_out = static_cast<uInt>(min<uint64_t>(member.size, sizeof(head)));
+        inflate(&stream, Z_SYNC_FLUSH);
+        const size_t produced = stream.total_out;
+        inflateEnd(&stream);
+        return sniffBytes(head, produced, nullptr, 0);
+    }
+
+    PartSizes DocumentBundle::probeMember(size_t index) const {
+        PartSizes sizes;
+        const BundleMember& member = members_.at(index);
+        if (member.deflated) return sizes;
+
+        zip_error_t error;
+        zip_error_init(&error);
+        zip_source_t* source = zip_source_buffer_create(file_.data() + member.dataOffset, member.size, 0, &error);
+        zip_t* archive = source ? zip_open_from_source(source, ZIP_RDONLY, &error) : nullptr;
+        if (!archive && source) zip_source_free(source);
+        zip_error_fini(&error);
+        if (!archive) return sizes;
+        unique_ptr<zip_t, zip_close_t> zip(archive, &zip_close);
+
+        zip_stat_t stats = {};
+        if (zip_stat(zip.get(), "word/styles.xml", 0, &stats) == 0 && (stats.valid & ZIP_STAT_SIZE)) {
+            sizes.stylesBytes = stats.size;
+        }
+        if (zip_stat(zip.get(), "word/document.xml", 0, &stats) == 0 && (stats.valid & ZIP_STAT_SIZE)) {
+            sizes.documentBytes = stats.size;
+        }
+        return sizes;
+    }
+
+} // namespace DocxParser
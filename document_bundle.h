@@ -0,0 +1,95 @@
+#ifndef DOCUMENT_BUNDLE_H
+#define DOCUMENT_BUNDLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "batch_runner.h"
+#include "docx_style_parser.h"
+#include "input_sniffer.h"
+#include "mapped_file.h"
+
+/**
+ * @brief .docx files inside .zip and .tar bundles, read in place
+ *
+ * Export tools deliver documents by the thousand in one archive. Instead of
+ * unpacking it to disk, the bundle is memory-mapped once and each member
+ * .docx is opened as a libzip archive over the bytes it occupies:
+ *
+ * - Stored zip members and tar members are contiguous in the bundle, so the
+ *   member archive is a zip_source window over the mapping; nothing is
+ *   copied and the page cache serves every read.
+ * - Deflated zip members are inflated into a per-thread buffer that is
+ *   reused for the next member, so steady-state extraction does not allocate.
+ *
+ * Members are named "<bundle>!/<path inside the bundle>".
+ */
+namespace DocxParser {
+
+/**
+ * @brief One .docx inside a bundle
+ */
+struct BundleMember {
+    std::string name;         ///< Path inside the bundle
+    uint64_t dataOffset = 0;  ///< First byte of the member's data in the bundle
+    uint64_t storedBytes = 0; ///< Bytes the data occupies in the bundle
+    uint64_t size = 0;        ///< Size of the .docx itself
+    uint32_t crc32 = 0;       ///< Zip members only
+    bool deflated = false;
+};
+
+class DocumentBundle {
+public:
+    /**
+     * @brief Maps the bundle and reads its directory
+     * @throws std::runtime_error if the file cannot be mapped or is not a
+     *         readable zip or tar archive
+     */
+    explicit DocumentBundle(const std::string& path);
+
+    /// True for paths batch mode treats as bundles (.zip, .tar; case-insensitive)
+    static bool isBundlePath(const std::string& path);
+
+    const std::string& path() const { return path_; }
+
+    /// The .docx members, in bundle order; other members are skipped
+    const std::vector<BundleMember>& members() const { return members_; }
+
+    /// "<bundle>!/<member name>"
+    std::string memberPath(size_t index) const;
+
+    /**
+     * @brief Runs visitStylesXml() on a member; safe to call from several threads
+     * @throws std::runtime_error if the member is corrupt or not a DOCX
+     */
+    StreamReport visitMember(size_t index, StyleVisitorRef visitor, const StreamOptions& options = {}) const;
+
+    /**
+     * @brief Classifies a member by its bytes (see sniffBytes())
+     *
+     * Stored members are sniffed at both ends; of a deflated member only
+     * the first kSniffWindow bytes are inflated, so the ZIP trailer is not checked.
+     */
+    InputSniff sniffMember(size_t index) const;
+
+    /**
+     * @brief Part sizes of a stored member from its central directory
+     *
+     * Deflated members report zero sizes: finding them would mean inflating
+     * the member, which is most of the cost of extracting it.
+     */
+    PartSizes probeMember(size_t index) const;
+
+private:
+    void readZipDirectory();
+    void readTarDirectory();
+
+    std::string path_;
+    MappedFile file_;
+    std::vector<BundleMember> members_;
+};
+
+} // namespace DocxParser
+
+#endif // DOCUMENT_BUNDLE_H
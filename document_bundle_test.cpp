@@ -0,0 +1,283 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include <zlib.h>
+#include "batch_runner.h"
+#include "document_bundle.h"
+
+using namespace DocxParser;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+std::string fingerprint(const std::vector<StyleInfo>& styles) {
+    std::string out;
+    for (const auto& style : styles) {
+        out += style.name + "|" + style.fontName + "|" + style.fontSize;
+        for (const auto& prop : style.properties) out += "|" + prop.first + "=" + prop.second;
+        out += "\n";
+    }
+    return out;
+}
+
+std::string visitAll(const DocumentBundle& bundle, size_t index) {
+    std::vector<StyleInfo> styles;
+    bundle.visitMember(index, [&](StyleInfo& style) { styles.push_back(std::move(style)); });
+    return fingerprint(styles);
+}
+
+void appendLe(std::string& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) out += static_cast<char>(value >> (8 * i) & 0xFF);
+}
+
+/**
+ * @brief Zip bundle: a stored and a deflated copy of a DOCX plus a non-DOCX member
+ *
+ * Written by hand so the member methods are exactly these; libzip may
+ * store a member that deflate does not shrink.
+ */
+void writeZipBundle(const std::string& path, const std::string& docx) {
+    struct Member {
+        std::string name;
+        std::string data;
+        bool deflate;
+    };
+    const Member members[] = {
+        {"custodian-a/stored.docx", docx, false},
+        {"custodian-b/deflated.DOCX", docx, true},
+        {"notes.txt", "chain of custody", true},
+    };
+    std::string zip, directory;
+    for (const auto& member : members) {
+        std::string stored = member.data;
+        if (member.deflate) {
+            z_stream stream = {};
+            ASSERT_EQ(deflateInit2(&stream, 6, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY), Z_OK);
+            stored.resize(deflateBound(&stream, member.data.size()));
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(member.data.data()));
+            stream.avail_in = static_cast<uInt>(member.data.size());
+            stream.next_out = reinterpret_cast<Bytef*>(&stored[0]);
+            stream.avail_out = static_cast<uInt>(stored.size());
+            ASSERT_EQ(deflate(&stream, Z_FINISH), Z_STREAM_END);
+            stored.resize(stream.total_out);
+            deflateEnd(&stream);
+        }
+        const uLong crc = crc32(0, reinterpret_cast<const Bytef*>(member.data.data()),
+                                static_cast<uInt>(member.data.size()));
+        const uint64_t offset = zip.size();
+        std::string common;  // Version needed .. extra length, shared by both headers
+        appendLe(common, 20, 2);
+        appendLe(common, 0, 2);
+        appendLe(common, member.deflate ? 8 : 0, 2);
+        appendLe(common, 0, 4);  // DOS time and date
+        appendLe(common, crc, 4);
+        appendLe(common, stored.size(), 4);
+        appendLe(common, member.data.size(), 4);
+        appendLe(common, member.name.size(), 2);
+        appendLe(common, 0, 2);
+
+        appendLe(zip, 0x04034b50, 4);
+        zip += common + member.name + stored;
+
+        appendLe(directory, 0x02014b50, 4);
+        appendLe(directory, 20, 2);  // Version made by
+        directory += common;
+        appendLe(directory, 0, 2);   // Comment length
+        appendLe(directory, 0, 2);   // Disk
+        appendLe(directory, 0, 2);   // Internal attributes
+        appendLe(directory, 0, 4);   // External attributes
+        appendLe(directory, offset, 4);
+        directory += member.name;
+    }
+    const uint64_t directoryOffset = zip.size();
+    zip += directory;
+    appendLe(zip, 0x06054b50, 4);
+    appendLe(zip, 0, 4);  // Disk numbers
+    appendLe(zip, 3, 2);
+    appendLe(zip, 3, 2);
+    appendLe(zip, directory.size(), 4);
+    appendLe(zip, directoryOffset, 4);
+    appendLe(zip, 0, 2);
+    std::ofstream(path, std::ios::binary) << zip;
+}
+
+void appendTarHeader(std::string& tar, const std::string& name, char type, size_t size) {
+    char header[512] = {};
+    std::strncpy(header, name.c_str(), 99);
+    std::snprintf(header + 100, 8, "%07o", 0644);
+    std::snprintf(header + 124, 12, "%011o", static_cast<unsigned>(size));
+    header[156] = type;
+    std::memcpy(header + 257, "ustar", 6);
+    std::memcpy(header + 263, "00", 2);
+    std::memset(header + 148, ' ', 8);
+    unsigned checksum = 0;
+    for (unsigned char c : header) checksum += c;
+    std::snprintf(header + 148, 8, "%06o", checksum);
+    tar.append(header, sizeof(header));
+}
+
+void appendTarMember(std::string& tar, const std::string& name, const std::string& data) {
+    if (name.size() > 99) {
+        // pax extended header carrying the full path
+        std::string record = " path=" + name + "\n";
+        size_t length = record.size();
+        while (std::to_string(length).size() + record.size() != length) length = std::to_string(length).size() + record.size();
+        record = std::to_string(length) + record;
+        appendTarHeader(tar, "PaxHeader", 'x', record.size());
+        tar += record;
+        tar.append((512 - record.size() % 512) % 512, '\0');
+    }
+    appendTarHeader(tar, name, '0', data.size());
+    tar += data;
+    tar.append((512 - data.size() % 512) % 512, '\0');
+}
+
+} // namespace
+
+TEST(DocumentBundleTest, RecognizesBundlePaths) {
+    EXPECT_TRUE(DocumentBundle::isBundlePath("export/hold-2024.zip"));
+    EXPECT_TRUE(DocumentBundle::isBundlePath("EXPORT.TAR"));
+    EXPECT_FALSE(DocumentBundle::isBundlePath("letter.docx"));
+}
+
+/**
+ * @brief Stored members are windows over the bundle, deflated ones are inflated; both extract alike
+ */
+TEST(DocumentBundleTest, ReadsZipMembersInPlace) {
+    const std::string docx = readFile("sample.docx");
+    const auto path = (fs::temp_directory_path() / "typstyle_bundle_test.zip").string();
+    writeZipBundle(path, docx);
+
+    DocumentBundle bundle(path);
+    ASSERT_EQ(bundle.members().size(), 2u);
+    EXPECT_EQ(bundle.members()[0].name, "custodian-a/stored.docx");
+    EXPECT_FALSE(bundle.members()[0].deflated);
+    EXPECT_TRUE(bundle.members()[1].deflated);
+    EXPECT_EQ(bundle.members()[1].size, docx.size());
+    EXPECT_EQ(bundle.memberPath(1), path + "!/custodian-b/deflated.DOCX");
+
+    const std::string expected = fingerprint(extractDocxStyles("sample.docx"));
+    EXPECT_EQ(visitAll(bundle, 0), expected);
+    EXPECT_EQ(visitAll(bundle, 1), expected);
+    EXPECT_GT(bundle.probeMember(0).stylesBytes, 0u);
+
+    // Visitors may open another member of the bundle; the inner inflate gets its own buffer
+    size_t nested = 0;
+    bundle.visitMember(1, [&](StyleInfo&) {
+        if (nested++ == 0) {
+            EXPECT_EQ(visitAll(bundle, 1), expected);
+        }
+    });
+    EXPECT_GT(nested, 1u);
+    fs::remove(path);
+}
+
+/**
+ * @brief A deflated member claiming far more bytes than its data can inflate to is rejected unread
+ */
+TEST(DocumentBundleTest, RejectsImplausibleMemberSize) {
+    const auto path = (fs::temp_directory_path() / "typstyle_bundle_size.zip").string();
+    writeZipBundle(path, readFile("sample.docx"));
+    std::string zip = readFile(path);
+    const std::string name = "custodian-b/deflated.DOCX";
+    const size_t entry = zip.rfind(name) - 46;  // Central directory entry
+    const char claimed[4] = {'\xF0', '\xFF', '\xFF', '\x7F'};
+    zip.replace(entry + 24, 4, claimed, 4);
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << zip;
+
+    DocumentBundle bundle(path);
+    ASSERT_EQ(bundle.members().size(), 2u);
+    try {
+        visitAll(bundle, 1);
+        FAIL() << "Expected visitMember to throw";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("too large"), std::string::npos) << e.what();
+    }
+    fs::remove(path);
+}
+
+/**
+ * @brief A zip64 extra field longer than its entry's extra area is rejected before it is read
+ */
+TEST(DocumentBundleTest, RejectsOverlongExtraField) {
+    const auto path = (fs::temp_directory_path() / "typstyle_bundle_extra.zip").string();
+    writeZipBundle(path, readFile("sample.docx"));
+    std::string zip = readFile(path);
+    const std::string name = "custodian-b/deflated.DOCX";
+    const size_t entry = zip.rfind(name) - 46;  // Central directory entry
+    // The name's last 4 bytes become a zip64 extra header claiming 0xFFF0 bytes; the entry length is unchanged
+    const uint16_t nameLength = static_cast<uint16_t>(name.size() - 4);
+    const char lengths[4] = {static_cast<char>(nameLength), 0, 4, 0};
+    zip.replace(entry + 28, 4, lengths, 4);
+    const char header[4] = {'\x01', '\x00', '\xF0', '\xFF'};
+    zip.replace(entry + 46 + nameLength, 4, header, 4);
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << zip;
+
+    try {
+        DocumentBundle bundle(path);
+        FAIL() << "Expected the bundle to be rejected";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("bad extra field"), std::string::npos) << e.what();
+    }
+    fs::remove(path);
+}
+
+TEST(DocumentBundleTest, ReadsTarMembersWithLongNames) {
+    const std::string docx = readFile("sample.docx");
+    const std::string longName = std::string(120, 'd') + "/matter.docx";
+    std::string tar;
+    appendTarMember(tar, "short.docx", docx);
+    appendTarMember(tar, "readme.txt", "not a document");
+    appendTarMember(tar, longName, docx);
+    tar.append(1024, '\0');
+    const auto path = (fs::temp_directory_path() / "typstyle_bundle_test.tar").string();
+    std::ofstream(path, std::ios::binary) << tar;
+
+    DocumentBundle bundle(path);
+    ASSERT_EQ(bundle.members().size(), 2u);
+    EXPECT_EQ(bundle.members()[0].name, "short.docx");
+    EXPECT_EQ(bundle.members()[1].name, longName);
+    EXPECT_EQ(visitAll(bundle, 1), fingerprint(extractDocxStyles("sample.docx")));
+    fs::remove(path);
+}
+
+/**
+ * @brief Batch mode expands bundles in place and reports unreadable ones as one failed item
+ */
+TEST(DocumentBundleTest, BatchRunnerExpandsBundles) {
+    const auto path = (fs::temp_directory_path() / "typstyle_batch_bundle.zip").string();
+    writeZipBundle(path, readFile("sample.docx"));
+    const auto broken = (fs::temp_directory_path() / "typstyle_broken_bundle.zip").string();
+    std::ofstream(broken, std::ios::binary) << "PK\x03\x04 cut off";
+
+    for (auto policy : {SchedulePolicy::Fifo, SchedulePolicy::LargestFirst}) {
+        BatchOptions options;
+        options.threads = 2;
+        options.policy = policy;
+        options.readahead.maxWindow = 4;
+        BatchRunner runner(options);
+        auto items = runner.run({"sample.docx", path, broken});
+        // Members and the broken bundle are never handed to readahead
+        EXPECT_EQ(runner.report().readahead.unreadable, 0u);
+        EXPECT_LE(runner.report().readahead.prefetched, 1u);
+        ASSERT_EQ(items.size(), 4u);
+        EXPECT_EQ(items[1].document.path, path + "!/custodian-a/stored.docx");
+        EXPECT_EQ(items[2].document.path, path + "!/custodian-b/deflated.DOCX");
+        EXPECT_EQ(fingerprint(items[1].document.styles), fingerprint(items[0].document.styles));
+        EXPECT_EQ(fingerprint(items[2].document.styles), fingerprint(items[0].document.styles));
+        EXPECT_EQ(items[3].document.path, broken);
+        EXPECT_FALSE(items[3].error.empty());
+        EXPECT_EQ(runner.report().failed, 1u);
+    }
+    fs::remove(path);
+    fs::remove(broken);
+}
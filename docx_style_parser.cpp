@@ -1,15 +1,22 @@
 // Standard C++ headers
-#include <iostream>   // For console I/O (cout, cerr)
-#include <stdexcept>  // For standard exceptions (runtime_error)
+#include <algorithm>   // For max, min
+#include <cstdio>      // For the flat XML file source (fopen, fread)
+#include <cstring>     // For memcpy
+#include <filesystem>  // For file_size
+#include <mutex>       // For once_flag / call_once
+#include <stdexcept>   // For standard exceptions (runtime_error)
 
 // Third-party library headers
 #include <zip.h>      // For ZIP archive handling (libzip)
 #include <zipconf.h>  // ZIP configuration constants
-#include <libxml/parser.h>  // For XML parsing (libxml2)
-#include <libxml/tree.h>    // For XML DOM tree handling
+#include <libxml/parser.h>  // For xmlInitParser (libxml2)
 
 // Project header
 #include "docx_style_parser.h"  // Our own header with declarations
+#include "input_sniffer.h"      // For naming what a non-DOCX input is
+#include "scratch_buffer.h"     // For the transcoding buffers
+#include "text_encoding.h"      // For encoding detection and UTF-8 conversion
+#include "xml_backend.h"        // For the parse event interface
 
 // Using the standard namespace to avoid prefixing std::
 // Note: In header files, it's better to explicitly use std:: to avoid namespace pollution
@@ -23,7 +30,8 @@ using namespace std;
  *
  * Key Concepts:
  * 1. ZIP Handling: Uses libzip to read the compressed archive
- * 2. XML Parsing: Uses libxml2 to process the XML data
+ * 2. XML Parsing: A backend from xml_backend.h (libxml2 by default) reports
+ *    elements and text as events; StyleEventBuilder turns them into styles
  * 3. Memory Management: Uses smart pointers (unique_ptr) for automatic cleanup
  * 4. Error Handling: Uses exceptions (try/catch) for error reporting
  *
@@ -41,6 +49,26 @@ using namespace std;
 
 namespace DocxParser {
 
+/**
+ * @brief Initializes libxml2 exactly once per process
+ *
+ * @details
+ * libxml2 sets up global tables (character encodings, memory hooks,
+ * thread-local error storage) lazily. Two threads racing through that lazy
+ * setup is undefined behaviour, so we run xmlInitParser() up front.
+ *
+ * std::call_once guarantees a single call even when many threads arrive
+ * together; the losers block until the winner has finished.
+ */
+    void initializeParser() {
+        static once_flag initialized;
+        call_once(initialized, [] { xmlInitParser(); });
+    }
+
+    void shutdownParser() {
+        xmlCleanupParser();
+    }
+
 /**
  * @brief Opens a DOCX file (which is a ZIP archive) and returns a handle
  * @param filePath Path to the DOCX file to open (const reference)
@@ -112,6 +140,12 @@ namespace DocxParser {
                 ? "Error code: " + to_string(zipError)
                 : "Unknown error";
 
+            // libzip only says "not a zip archive"; say what the file is instead
+            const InputSniff sniff = sniffInput(filePath);
+            if (!sniff.extractable()) {
+                errorMsg += " (" + sniff.detail + ")";
+            }
+
             throw runtime_error(errorMsg);
         }
 
@@ -186,283 +220,433 @@ namespace DocxParser {
         return buffer;
     }
 
-// XML parsing functions
-/**
- * @brief Parses raw XML data into a libxml2 document object
- * @param xmlData Raw XML data to parse
- * @return unique_ptr managing the xmlDoc with custom deleter
- * @throws runtime_error if parsing fails
- *
- * @details
- * Uses libxml2 to parse the XML content from memory. The returned
- * document object can be traversed using libxml2's DOM API.
- */
+namespace {
+
     /**
-     * @brief Demonstrates C library integration pattern
+     * @brief Builds StyleInfo records from parse events and hands them to a visitor
      *
-     * Common Patterns Used:
-     * 1. C Library Integration:
-     *    - Wraps C-style pointers in smart pointers
-     *    - Uses function pointer as custom deleter
-     * 2. Memory Safety:
-     *    - Ensures xmlFreeDoc is always called
-     * 3. Error Checking:
-     *    - Validates parser output
+     * @details
+     * Levels count from the style container (the root of styles.xml, or the
+     * first styles element of a flat document):
+     * 1. w:style; type and styleId come from its attributes
+     * 2. its children: w:name, the quick-format markers, rPr, pPr, and any
+     *    other element, stored as a property
+     * 3. children of rPr and pPr, stored as properties; rFonts and sz also
+     *    fill fontName and fontSize, spacing and ind keep their attributes
+     *    as "spacing.before" etc. (twentieths of a point). A theme font
+     *    reference (asciiTheme, hAnsiTheme) is kept as "fontTheme".
+     * A property is the element's w:val, or else its text content.
+     *
+     * If asked to, w:docDefaults at level 1 is read into a StyleInfo of its
+     * own: its rPrDefault/pPrDefault wrappers are skipped, so their rPr and
+     * pPr count as level 2 and are keyed exactly like a style's.
+     *
+     * One StyleInfo is refilled for every style, so its strings keep their
+     * capacity between styles.
      */
-    unique_ptr<xmlDoc, void (*)(xmlDocPtr)> parseXml(const vector<char> &xmlData) {
-        // xmlReadMemory parses XML from a memory buffer (not from file)
-        // Parameters:
-        // 1. Pointer to XML data (vector's data() method)
-        // 2. Size of data
-        // 3. "Filename" for error messages
-        // 4. Encoding (NULL for auto-detect)
-        // 5. Parser options (0 for defaults)
-        xmlDocPtr doc = xmlReadMemory(xmlData.data(), xmlData.size(), "styles.xml", NULL, 0);
-
-        if (!doc) {  // Check if parsing succeeded
-            throw runtime_error("Failed to parse styles.xml content");
+    class StyleEventBuilder : public XmlEventHandler {
+    public:
+        StyleEventBuilder(StyleVisitorRef visitor, StreamReport& report, bool quickFormatOnly,
+                          const char* container, StyleInfo* docDefaults = nullptr)
+            : visitor_(visitor), report_(report), quickFormatOnly_(quickFormatOnly), container_(container),
+              docDefaults_(docDefaults) {}
+
+        void startElement(string_view name, const XmlAttribute* attributes, size_t count) override {
+            const int depth = depth_++;
+            if (containerDepth_ < 0) {
+                if (!container_ || name == container_) containerDepth_ = depth;
+                return;
+            }
+            int level = depth - containerDepth_;
+            if (inDefaults_ && level > 1) {
+                if (level == 2) return;  // rPrDefault, pPrDefault
+                --level;
+            }
+            switch (level) {
+                case 1:
+                    inDefaults_ = docDefaults_ && name == "docDefaults";
+                    inStyle_ = inDefaults_ || name == "style";
+                    if (inStyle_) beginStyle(attributes, count);
+                    break;
+                case 2:
+                    if (!inStyle_) break;
+                    if (name == "qFormat") {
+                        quickFormat_ = true;
+                    } else if (name == "semiHidden") {
+                        hidden_ = true;
+                    } else if (name == "name" && !named_) {
+                        named_ = true;
+                        if (auto value = find(attributes, count, "val")) style_.name.assign(*value);
+                    }
+                    section_ = name == "rPr" ? Section::Run : name == "pPr" ? Section::Paragraph : Section::Other;
+                    if (section_ == Section::Other) beginProperty(name, attributes, count, depth);
+                    break;
+                case 3:
+                    if (!inStyle_ || section_ == Section::Other) break;
+                    if (section_ == Section::Run) {
+                        if (name == "rFonts") {
+                            // The first font name and theme font reference present, in attribute order
+                            bool named = false, themed = false;
+                            for (size_t i = 0; i < count && !(named && themed); ++i) {
+                                const string_view attribute = attributes[i].name;
+                                if (!named && (attribute == "ascii" || attribute == "hAnsi" || attribute == "eastAsia")) {
+                                    style_.fontName.assign(attributes[i].value);
+                                    named = true;
+                                } else if (!themed && (attribute == "asciiTheme" || attribute == "hAnsiTheme")) {
+                                    style_.properties["fontTheme"].assign(attributes[i].value);
+                                    themed = true;
+                                }
+                            }
+                        } else if (name == "sz") {
+                            if (auto value = find(attributes, count, "val")) style_.fontSize.assign(*value);
+                        }
+                    } else if (name == "spacing" || name == "ind") {
+                        for (size_t i = 0; i < count; ++i) {
+                            string key(name);
+                            key += '.';
+                            key += attributes[i].name;
+                            style_.properties[key].assign(attributes[i].value);
+                        }
+                    }
+                    beginProperty(name, attributes, count, depth);
+                    break;
+                default:
+                    break;
+            }
         }
 
-        // Create unique_ptr with custom deleter function (xmlFreeDoc)
-        // The function pointer syntax looks complex but ensures proper cleanup
-        return unique_ptr<xmlDoc, void (*)(xmlDocPtr)>(doc, xmlFreeDoc);
-    }
+        bool endElement(string_view) override {
+            const int depth = --depth_;
+            if (containerDepth_ < 0) return true;
+            if (capturing_ && depth == captureDepth_) {
+                capturing_ = false;
+                style_.properties[captureName_] = captureText_;
+            }
+            if (depth == containerDepth_) return false;  // Nothing after the container is needed
+            if (!inStyle_ || depth != containerDepth_ + 1) return true;
+            inStyle_ = false;
+            if (inDefaults_) {
+                inDefaults_ = false;
+                *docDefaults_ = std::move(style_);
+                return true;
+            }
+            if (quickFormatOnly_ && (!quickFormat_ || hidden_)) return true;
+            if (report_.styles++ == 0) report_.bytesBeforeFirstStyle = report_.inflatedBytes;
+            report_.stopped = visitor_(style_) == VisitAction::Stop;
+            return !report_.stopped;
+        }
 
-/**
- * @brief Finds all style nodes in the parsed XML document
- * @param doc Parsed XML document
- * @return Vector of pointers to style nodes
- *
- * @details
- * Searches the XML document for all <w:style> elements which
- * represent individual style definitions in the DOCX file.
- */
-    /**
-     * @brief Shows XML DOM traversal pattern
-     *
-     * Common Patterns Used:
-     * 1. Tree Traversal:
-     *    - Iterates through child/sibling pointers
-     *    - Uses depth-first search
-     * 2. Filter Pattern:
-     *    - Collects nodes matching criteria
-     * 3. C String Handling:
-     *    - Uses xmlStrcmp for XML string comparison
+        void characters(string_view text) override {
+            if (capturing_) captureText_.append(text);
+        }
+
+        bool foundContainer() const { return containerDepth_ >= 0; }
+
+    private:
+        enum class Section { Other, Run, Paragraph };
+
+        static const string_view* find(const XmlAttribute* attributes, size_t count, string_view name) {
+            for (size_t i = 0; i < count; ++i) {
+                if (attributes[i].name == name) return &attributes[i].value;
+            }
+            return nullptr;
+        }
+
+        void beginStyle(const XmlAttribute* attributes, size_t count) {
+            style_.name.clear();
+            style_.type.clear();
+            style_.fontName.clear();
+            style_.fontSize.clear();
+            style_.properties.clear();
+            quickFormat_ = hidden_ = named_ = false;
+            section_ = Section::Other;
+
+            // Paragraph styles are the main extraction target; typesetters
+            // use them more than anything else
+            if (auto type = find(attributes, count, "type")) style_.type.assign(*type);
+            // basedOn, link and next refer to other styles by this id, not by
+            // name; keeping it as a property lets every exporter carry it unchanged
+            if (auto styleId = find(attributes, count, "styleId")) style_.properties["styleId"].assign(*styleId);
+        }
+
+        void beginProperty(string_view name, const XmlAttribute* attributes, size_t count, int depth) {
+            if (auto value = find(attributes, count, "val")) {
+                style_.properties[string(name)].assign(*value);
+                return;
+            }
+            capturing_ = true;
+            captureDepth_ = depth;
+            captureName_.assign(name);
+            captureText_.clear();
+        }
+
+        StyleVisitorRef visitor_;
+        StreamReport& report_;
+        const bool quickFormatOnly_;
+        const char* container_;  // Local name, or nullptr for the root
+        StyleInfo* docDefaults_;  // Filled from w:docDefaults, or nullptr to skip it
+
+        int depth_ = 0;
+        int containerDepth_ = -1;
+        bool inStyle_ = false;
+        bool inDefaults_ = false;  // Reading w:docDefaults into style_
+        bool quickFormat_ = false;
+        bool hidden_ = false;
+        bool named_ = false;
+        Section section_ = Section::Other;
+
+        bool capturing_ = false;
+        int captureDepth_ = 0;
+        string captureName_;
+        string captureText_;
+
+        StyleInfo style_;
+    };
+
+    // Bytes read before deciding on the encoding; covers BOM and declaration
+    constexpr size_t kSniffBytes = 512;
+
+    // Transcoding buffers a thread keeps between parts; larger ones are released
+    constexpr size_t kMaxPooledTranscode = 4u << 20;
+    using RawPartBuffer = ScratchBuffer<struct RawPartTag>;
+    using Utf8PartBuffer = ScratchBuffer<struct Utf8PartTag, string>;
+
+    /*
+     * Auto parses parts up to this size with InSitu and larger ones with
+     * LibxmlSax (see `TypStyleBench backends`). Typical styles parts are
+     * 30-300 KB, where in-situ parsing wins clearly; above this size bounded
+     * memory and early stop (nothing is inflated after VisitAction::Stop)
+     * matter more than parse speed.
      */
-    vector <xmlNodePtr> findStyleNodes(xmlDocPtr doc) {
-        // Create empty vector to store node pointers
-        vector<xmlNodePtr> styleNodes;
-
-        // Get root element of XML document
-        xmlNodePtr root = xmlDocGetRootElement(doc);
-
-        // Iterate through all child nodes of root
-        // Unlike Python's for loops, this is a manual linked list traversal:
-        // - Start with first child (root->children)
-        // - Continue while node is not null (node)
-        // - Move to next sibling (node = node->next)
-        for (xmlNodePtr node = root->children; node; node = node->next) {
-            // Check if node is an element node (not text/comment/etc)
-            // and if its name is "style"
-            if (node->type == XML_ELEMENT_NODE &&
-                xmlStrcmp(node->name, (const xmlChar *) "style") == 0) {
-                // Check for required qFormat and exclude semiHidden
-                bool hasQFormat = false;
-                bool isHidden = false;
-                for (xmlNodePtr child = node->children; child; child = child->next) {
-                    if (child->type == XML_ELEMENT_NODE) {
-                        if (xmlStrcmp(child->name, (const xmlChar *) "qFormat") == 0) {
-                            hasQFormat = true;
-                        } else if (xmlStrcmp(child->name, (const xmlChar *) "semiHidden") == 0) {
-                            isHidden = true;
-                        }
-                    }
-                }
-                if (hasQFormat && !isHidden) {
-                    // Add node pointer to vector
-                    styleNodes.push_back(node);
-                }
+    constexpr uint64_t kAutoInSituMaxBytes = 1u << 20;
+
+    class ZipEntrySource : public XmlSource {
+    public:
+        ZipEntrySource(zip_file_t* file, uint64_t& inflatedBytes) : file_(file), inflatedBytes_(inflatedBytes) {}
+
+        size_t read(char* buffer, size_t size) override {
+            const zip_int64_t got = zip_fread(file_, buffer, size);
+            if (got < 0) {
+                throw runtime_error("Failed to read styles.xml content");
             }
+            inflatedBytes_ += static_cast<uint64_t>(got);
+            return static_cast<size_t>(got);
         }
-        return styleNodes;
-    }
 
-// Style processing functions
-/**
- * @brief Extracts font-related properties from a run properties node
- * @param rPrNode XML node containing run properties (rPr)
- * @param[out] style StyleInfo struct to populate with font data
- *
- * @details
- * Processes the rPr node to extract:
- * - Font names (ascii, hAnsi, eastAsia)
- * - Font size (sz)
- * Any found properties are stored in the StyleInfo struct.
- */
+    private:
+        zip_file_t* file_;
+        uint64_t& inflatedBytes_;
+    };
+
+    class FileSource : public XmlSource {
+    public:
+        explicit FileSource(const string& path) : file_(fopen(path.c_str(), "rb"), &fclose), path_(path) {
+            if (!file_) {
+                throw runtime_error("Failed to open flat XML document: " + path);
+            }
+        }
+
+        size_t read(char* buffer, size_t size) override {
+            const size_t got = fread(buffer, 1, size, file_.get());
+            if (got < size && ferror(file_.get())) {
+                throw runtime_error("Failed to read flat XML document: " + path_);
+            }
+            return got;
+        }
+
+    private:
+        unique_ptr<FILE, int (*)(FILE*)> file_;
+        string path_;
+    };
+
+    class MemorySource : public XmlSource {
+    public:
+        MemorySource(const char* data, size_t size, uint64_t* consumed = nullptr)
+            : data_(data), size_(size), consumed_(consumed) {}
+
+        size_t read(char* buffer, size_t size) override {
+            const size_t n = min(size, size_);
+            memcpy(buffer, data_, n);
+            data_ += n;
+            size_ -= n;
+            if (consumed_) *consumed_ += n;
+            return n;
+        }
+
+    private:
+        const char* data_;
+        size_t size_;
+        uint64_t* consumed_;
+    };
+
     /**
-     * @brief Extracts font properties from XML node
-     * @param rPrNode XML node pointer (xmlNodePtr)
-     * @param style Reference to StyleInfo to modify
-     *
-     * Beginner Notes:
-     * - xmlNodePtr is a pointer to libxml2's node structure
-     * - &style means we modify the original object (not a copy)
-     * - The function walks through XML child nodes using:
-     *   - node->children: Start of child nodes list
-     *   - node->next: Move to next sibling node
-     *   - node->type: Check if node is an element (XML_ELEMENT_NODE)
+     * @brief Reads the head of a source for encoding detection, then replays it
      */
+    class HeadSource : public XmlSource {
+    public:
+        explicit HeadSource(XmlSource& inner) : inner_(inner) {
+            head_.resize(kSniffBytes);
+            size_t size = 0;
+            for (size_t got = 1; size < head_.size() && got > 0; size += got) {
+                got = inner_.read(head_.data() + size, head_.size() - size);
+            }
+            head_.resize(size);
+        }
+
+        const char* head() const { return head_.data(); }
+        size_t headSize() const { return head_.size(); }
+
+        size_t read(char* buffer, size_t size) override {
+            if (replayed_ < head_.size()) {
+                const size_t n = min(size, head_.size() - replayed_);
+                memcpy(buffer, head_.data() + replayed_, n);
+                replayed_ += n;
+                return n;
+            }
+            return inner_.read(buffer, size);
+        }
+
+    private:
+        XmlSource& inner_;
+        vector<char> head_;
+        size_t replayed_ = 0;
+    };
+
+    XmlBackend chooseBackend(const StreamOptions& options, uint64_t partBytes, const DetectedEncoding& detected) {
+        XmlBackend backend = options.backend;
+        if (backend == XmlBackend::Auto) {
+            backend = partBytes <= kAutoInSituMaxBytes ? XmlBackend::InSitu : XmlBackend::LibxmlSax;
+        }
+        // Encodings outside UTF-8/16 and Latin-1 are left to libxml2's converters
+        if (detected.encoding == TextEncoding::Other && xmlBackendLimitedEncodings(backend)) {
+            backend = XmlBackend::LibxmlSax;
+        }
+        return backend;
+    }
+
     /**
-     * @brief Demonstrates property extraction pattern
+     * @brief Parses one part with the backend chosen for it
+     * @param partBytes Size of the part if known, for Auto; UINT64_MAX otherwise
      *
-     * Common Patterns Used:
-     * 1. Visitor Pattern:
-     *    - Visits each node to extract properties
-     * 2. Out Parameter:
-     *    - Modifies style object passed by reference
-     * 3. String Conversion:
-     *    - Converts XML strings to C++ strings
+     * UTF-16 and 8-bit legacy parts are converted to UTF-8 first; libxml2's
+     * own transcoding layer is much slower. They are read whole for that.
      */
-    void extractFontProperties(xmlNodePtr rPrNode, StyleInfo &style) {
-        // Iterate through all child nodes of rPrNode
-        for (xmlNodePtr child = rPrNode->children; child; child = child->next) {
-            // Skip non-element nodes (text nodes, comments etc)
-            if (child->type != XML_ELEMENT_NODE) continue;
-
-            // Convert XML node name (xmlChar*) to C++ string
-            // reinterpret_cast is used to convert between pointer types
-            string nodeName(reinterpret_cast<const char *>(child->name));
-
-            if (nodeName == "rFonts") {
-                // Handle font name properties
-                // Iterate through all attributes of the node
-                for (xmlAttr *attr = child->properties; attr; attr = attr->next) {
-                    string attrName(reinterpret_cast<const char *>(attr->name));
-
-                    // We're interested in these font name attributes
-                    if (attrName == "ascii" || attrName == "hAnsi" || attrName == "eastAsia") {
-                        // Get attribute value - returns allocated string we must free
-                        xmlChar *value = xmlGetProp(child, attr->name);
-                        if (value) {
-                            // Store font name in style struct
-                            style.fontName = reinterpret_cast<char *>(value);
-                            // Free the allocated string - C++ doesn't have garbage collection
-                            xmlFree(value);
-                            break; // Just get the first font name we find
-                        }
-                    }
-                }
-            } else if (nodeName == "sz") {
-                // Handle font size property
-                xmlChar *size = xmlGetProp(child, (const xmlChar *) "val");
-                if (size) {
-                    style.fontSize = reinterpret_cast<char *>(size);
-                    xmlFree(size);  // Don't forget to free allocated memory!
-                }
+    void parseStylesPart(HeadSource& source, uint64_t partBytes, StyleEventBuilder& builder,
+                         const StreamOptions& options, StreamReport& report, bool huge, const char* documentName) {
+        XmlParseOptions parse;
+        parse.chunkBytes = max<size_t>(options.chunkBytes, 1);
+        parse.huge = huge;
+
+        const DetectedEncoding detected = detectXmlEncoding(source.head(), source.headSize());
+        if (!needsTranscoding(detected)) {
+            const XmlBackend backend = chooseBackend(options, partBytes, detected);
+            report.buffered = !xmlBackendStreams(backend);
+            parseXmlEvents(backend, source, builder, parse, documentName);
+            return;
+        }
+
+        // Borrowed, not owned: a visitor that starts another extraction on
+        // this thread gets buffers of its own
+        Utf8PartBuffer utf8Scratch(kMaxPooledTranscode);
+        string& utf8 = utf8Scratch.get();
+        {
+            RawPartBuffer partScratch(kMaxPooledTranscode);
+            vector<char>& part = partScratch.get();
+            part.clear();
+            for (size_t got = 1; got > 0;) {
+                const size_t used = part.size();
+                part.resize(used + max<size_t>(parse.chunkBytes, 64 * 1024));
+                got = source.read(part.data() + used, part.size() - used);
+                part.resize(used + got);
             }
+            transcodeToUtf8(part.data(), part.size(), detected, utf8);
         }
+
+        report.buffered = true;
+        // The declaration still names the original encoding; the backend ignores it
+        parse.utf8 = true;
+        MemorySource memory(utf8.data(), utf8.size());
+        parseXmlEvents(chooseBackend(options, utf8.size(), detected), memory, builder, parse, documentName);
     }
 
+} // namespace
+
 /**
- * @brief Extracts non-font style properties from a style node
- * @param node XML style node to process
- * @param[out] style StyleInfo struct to populate with properties
+ * @brief Inflates and parses styles.xml in lockstep
  *
  * @details
- * Processes the style node to extract all properties including:
- * - Style type
- * - Base style
- * - Any other style attributes
- * Properties are stored in the StyleInfo's properties map.
+ * The streaming backends get the part chunk by chunk straight from
+ * zip_fread, and StyleEventBuilder keeps only the style being read, so
+ * memory stays flat whatever the size of the part. Returning false from
+ * the builder's endElement stops the parser, so nothing after a Stop is
+ * inflated.
  */
-    void extractStyleName(xmlNodePtr node, StyleInfo &style) {
-        // Look for w:name child element
-        for (xmlNodePtr child = node->children; child; child = child->next) {
-            if (child->type == XML_ELEMENT_NODE &&
-                xmlStrcmp(child->name, (const xmlChar *) "name") == 0) {
-                if (auto val = xmlGetProp(child, (const xmlChar *) "val")) {
-                    style.name = reinterpret_cast<char *>(val);
-                    xmlFree(val);
-                }
-                break; // Found name element, stop searching
-            }
+    StreamReport visitStylesXml(zip_t *zip, StyleVisitorRef visitor, const StreamOptions& options) {
+        unique_ptr<zip_file_t, zip_fclose_t> stylesFile(zip_fopen(zip, "word/styles.xml", 0), &zip_fclose);
+        if (!stylesFile) {
+            throw runtime_error("styles.xml not found in DOCX archive");
         }
+        zip_stat_t stats = {};
+        const uint64_t partBytes = zip_stat(zip, "word/styles.xml", 0, &stats) == 0 && (stats.valid & ZIP_STAT_SIZE)
+            ? stats.size : UINT64_MAX;
+
+        StreamReport report;
+        ZipEntrySource entry(stylesFile.get(), report.inflatedBytes);
+        HeadSource source(entry);
+        StyleEventBuilder builder(visitor, report, options.quickFormatOnly, nullptr, options.docDefaults);
+        parseStylesPart(source, partBytes, builder, options, report, false, "styles.xml");
+        return report;
     }
 
-    /**
-     * @brief Processes XML node properties into StyleInfo
-     * @param node XML node to process
-     * @param style StyleInfo to populate with properties
-     *
-     * @details Handles both attribute-based values (val) and node content
-     */
-    void processXmlProperties(xmlNodePtr node, StyleInfo& style) {
-        if (node->type != XML_ELEMENT_NODE) return;
-
-        string propName(reinterpret_cast<const char*>(node->name));
-        xmlChar* val = xmlGetProp(node, (const xmlChar*)"val");
-        if (val) {
-            style.properties[propName] = reinterpret_cast<char*>(val);
-            xmlFree(val);
-        } else {
-            xmlChar* content = xmlNodeGetContent(node);
-            if (content) {
-                style.properties[propName] = reinterpret_cast<char*>(content);
-                xmlFree(content);
-            }
-        }
+    StreamReport visitStylesPart(const char* data, size_t size, StyleVisitorRef visitor, const StreamOptions& options) {
+        StreamReport report;
+        MemorySource memory(data, size, &report.inflatedBytes);
+        HeadSource source(memory);
+        StyleEventBuilder builder(visitor, report, options.quickFormatOnly, nullptr, options.docDefaults);
+        parseStylesPart(source, size, builder, options, report, false, "styles.xml");
+        return report;
     }
 
-    void extractOtherProperties(xmlNodePtr node, StyleInfo &style) {
-        for (xmlNodePtr prop = node->children; prop; prop = prop->next) {
-            if (prop->type != XML_ELEMENT_NODE) continue;
-
-            string propName(reinterpret_cast<const char *>(prop->name));
-            if (propName == "rPr") {
-                extractFontProperties(prop, style);
-                // Process all rPr children as properties
-                for (xmlNodePtr child = prop->children; child; child = child->next) {
-                    processXmlProperties(child, style);
-                }
-            } else if (propName == "pPr") {
-                // Process all pPr children as properties
-                for (xmlNodePtr child = prop->children; child; child = child->next) {
-                    processXmlProperties(child, style);
-                }
-            } else {
-                // Handle properties directly
-                processXmlProperties(prop, style);
-            }
-        }
+    StreamReport visitDocxStyles(const string &filePath, StyleVisitorRef visitor, const StreamOptions& options) {
+        auto zip = openDocxFile(filePath);
+        return visitStylesXml(zip.get(), visitor, options);
+    }
+
+    StreamReport streamStylesXml(zip_t *zip, const function<void(StyleInfo&&)>& onStyle,
+                                 const StreamOptions& options) {
+        return visitStylesXml(zip, [&](StyleInfo& style) { onStyle(std::move(style)); }, options);
+    }
+
+    StreamReport streamDocxStyles(const string &filePath, const function<void(StyleInfo&&)>& onStyle,
+                                  const StreamOptions& options) {
+        auto zip = openDocxFile(filePath);
+        return streamStylesXml(zip.get(), onStyle, options);
     }
 
 /**
- * @brief Processes a single style node into a StyleInfo struct
- * @param node XML node representing a style definition
- * @return StyleInfo containing all extracted style data
+ * @brief Visits the styles of a flat XML Word document
  *
  * @details
- * This is the main style processing function that:
- * 1. Extracts basic style attributes (name, type)
- * 2. Processes all child nodes for properties
- * 3. Returns a fully populated StyleInfo struct
+ * Flat OPC keeps every part of the package in one XML file, styles.xml
+ * under pkg:part/pkg:xmlData; Word 2003 XML has w:styles below its root.
+ * Either way the first styles element holds the style definitions, and
+ * parsing stops when it closes. Such files embed images as base64 text,
+ * so XmlParseOptions::huge lifts libxml2's 10 MB text node limit.
  */
-    StyleInfo processStyleNode(xmlNodePtr node) {
-        StyleInfo style;
-
-        extractStyleName(node, style);
-
-        if (auto type = xmlGetProp(node, (const xmlChar *) "type")) {
-            // There are two types we need to pay attention to in styles.xml
-            // one is paragraph, this is the main extraction target
-            // as typesetters use paragraph based style more than anything else.
-            // So we first get the type of the style.
-            style.type = reinterpret_cast<char *>(type);
-            xmlFree(type);
+    StreamReport visitFlatXmlStyles(const string &filePath, StyleVisitorRef visitor, const StreamOptions& options) {
+        error_code error;
+        const uintmax_t fileBytes = filesystem::file_size(filePath, error);
+
+        StreamReport report;
+        FileSource file(filePath);
+        HeadSource source(file);
+        StyleEventBuilder builder(visitor, report, options.quickFormatOnly, "styles", options.docDefaults);
+        parseStylesPart(source, error ? UINT64_MAX : static_cast<uint64_t>(fileBytes), builder, options, report,
+                        true, filePath.c_str());
+        if (!builder.foundContainer()) {
+            throw runtime_error("No styles in flat XML document: " + filePath);
         }
-
-        extractOtherProperties(node, style);
-        return style;
+        return report;
     }
 
 // Main interface
@@ -495,15 +679,34 @@ namespace DocxParser {
  *    - Transforms XML nodes into StyleInfo objects
  */
 vector<StyleInfo> DocxParser::extractDocxStyles(const string &filePath) {
-    auto zip = DocxParser::openDocxFile(filePath);
-    auto stylesXml = DocxParser::readStylesXml(zip.get());
-    auto doc = DocxParser::parseXml(stylesXml);
-    auto styleNodes = DocxParser::findStyleNodes(doc.get());
-
     vector<StyleInfo> styles;
-    for (auto node: styleNodes) {
-        styles.push_back(processStyleNode(node));
-    }
-
+    DocxParser::streamDocxStyles(filePath, [&](StyleInfo&& style) { styles.push_back(std::move(style)); });
     return styles;
 }
+
+vector<StyleInfo> DocxParser::extractAllDocxStyles(const string &filePath) {
+    return extractDocxStyleSheet(filePath).styles;
+}
+
+StyleSheet DocxParser::extractDocxStyleSheet(const string &filePath) {
+    StyleSheet sheet;
+    StreamOptions options;
+    options.quickFormatOnly = false;
+    options.docDefaults = &sheet.docDefaults;
+    DocxParser::streamDocxStyles(filePath, [&](StyleInfo&& style) {
+        // Heading table, while the style is at hand
+        auto level = style.properties.find("outlineLvl");
+        if (style.type == "paragraph" && level != style.properties.end() && level->second.size() == 1 &&
+            level->second[0] >= '0' && level->second[0] <= '8') {
+            const size_t n = static_cast<size_t>(level->second[0] - '0');
+            const string builtIn = "heading " + to_string(n + 1);
+            size_t& slot = sheet.headingLevels[n];
+            if (slot == StyleSheet::kNoStyle ||
+                (style.name == builtIn && sheet.styles[slot].name != builtIn)) {
+                slot = sheet.styles.size();
+            }
+        }
+        sheet.styles.push_back(std::move(style));
+    }, options);
+    return sheet;
+}
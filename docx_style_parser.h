@@ -1,10 +1,17 @@
 #ifndef DOCX_STYLE_PARSER_H
 #define DOCX_STYLE_PARSER_H
 
+#include <array>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 #include <map>
 #include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "xml_backend.h"
 
 // Forward declarations for libzip
 typedef struct zip zip_t;
@@ -12,20 +19,9 @@ typedef struct zip_file zip_file_t;
 typedef struct zip_stat zip_stat_t;
 typedef struct zip_error zip_error_t;
 
-// Forward declarations for libxml2
-struct _xmlDoc;
-typedef _xmlDoc xmlDoc;
-typedef _xmlDoc* xmlDocPtr;
-struct _xmlNode;
-typedef _xmlNode xmlNode;
-typedef _xmlNode* xmlNodePtr;
-struct _xmlAttr;
-typedef _xmlAttr xmlAttr;
-
 // Function pointer types for deleters
 typedef int (*zip_close_t)(zip_t*);
 typedef int (*zip_fclose_t)(zip_file_t*);
-typedef void (*xmlDoc_deleter)(xmlDoc*);
 
 /**
  * @brief Contains information about a DOCX style
@@ -49,6 +45,99 @@ struct StyleInfo {
     StyleInfo& operator=(StyleInfo&&) = default;
 };
 
+/**
+ * @brief Styles extracted from one document
+ *
+ * Unit of work for tools that process many documents (index, exporters).
+ */
+struct DocumentStyles {
+    std::string path;              ///< Path of the source document
+    std::vector<StyleInfo> styles; ///< Styles in extraction order
+};
+
+/**
+ * @brief Every style of a document plus its heading hierarchy
+ *
+ * Word marks heading styles with w:outlineLvl (0 = heading level 1). The
+ * level table is filled while the styles are extracted, so consumers never
+ * scan the style list for it.
+ */
+struct StyleSheet {
+    static constexpr size_t kNoStyle = static_cast<size_t>(-1);
+
+    std::vector<StyleInfo> styles;        ///< All definitions, in document order
+    std::array<size_t, 9> headingLevels;  ///< [n] = index in styles of heading level n + 1, or kNoStyle
+    StyleInfo docDefaults;                ///< w:docDefaults run and paragraph properties, keyed like a style's
+
+    StyleSheet() { headingLevels.fill(kNoStyle); }
+};
+
+/**
+ * @brief Tuning for the streaming extraction path
+ */
+struct StreamOptions {
+    size_t chunkBytes = 64 * 1024;  ///< Bytes inflated and handed to the parser per step
+    bool quickFormatOnly = true;    ///< Only visible quick-format styles (Word's style gallery)
+    /// Parser for styles.xml. Auto: InSitu for parts up to 1 MiB, LibxmlSax
+    /// (streaming) above. Encodings only libxml2 knows always use LibxmlSax.
+    DocxParser::XmlBackend backend = DocxParser::XmlBackend::Auto;
+    /// If set, filled from w:docDefaults (not a style, so never passed to the visitor)
+    StyleInfo* docDefaults = nullptr;
+};
+
+/**
+ * @brief What a streaming extraction did
+ */
+struct StreamReport {
+    uint64_t inflatedBytes = 0;          ///< Bytes of styles.xml read from the archive
+    uint64_t bytesBeforeFirstStyle = 0;  ///< inflatedBytes when the first style was emitted
+    size_t styles = 0;                   ///< Styles passed to the callback
+    bool buffered = false;               ///< The part was read whole (transcoding or a non-streaming backend)
+    bool stopped = false;                ///< The visitor returned VisitAction::Stop
+};
+
+/**
+ * @brief What a style visitor wants next
+ */
+enum class VisitAction { Continue, Stop };
+
+/**
+ * @brief Non-owning reference to a style visitor (lambda, functor or function)
+ *
+ * @details
+ * The visitor is called as visitor(StyleInfo&) and returns VisitAction, or
+ * void for "always continue". The style is a view into the extractor's
+ * scratch object: it is valid for the duration of the call only, and the
+ * visitor may move from it. Unlike std::function nothing is copied or
+ * allocated; the reference must not outlive the visitor it was made from,
+ * which holds for the usual use as a by-value function argument.
+ */
+class StyleVisitorRef {
+public:
+    template <typename Visitor,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<Visitor>, StyleVisitorRef>::value>>
+    StyleVisitorRef(Visitor&& visitor)
+        : object_(const_cast<void*>(static_cast<const void*>(&visitor))),
+          call_(&invoke<std::remove_reference_t<Visitor>>) {}
+
+    VisitAction operator()(StyleInfo& style) const { return call_(object_, style); }
+
+private:
+    template <typename Visitor>
+    static VisitAction invoke(void* object, StyleInfo& style) {
+        Visitor& visitor = *static_cast<Visitor*>(object);
+        if constexpr (std::is_void<decltype(visitor(style))>::value) {
+            visitor(style);
+            return VisitAction::Continue;
+        } else {
+            return visitor(style);
+        }
+    }
+
+    void* object_;
+    VisitAction (*call_)(void*, StyleInfo&);
+};
+
 /**
  * @brief Namespace for DOCX style parsing functionality
  *
@@ -84,6 +173,31 @@ struct StyleInfo {
  */
 namespace DocxParser {
 
+/*
+ * Thread safety:
+ * Every function below keeps its mutable state in per-call objects (zip
+ * handle, parser state, buffers), so different threads may extract
+ * concurrently without external locking. The only process-wide state is
+ * libxml2's own, which initializeParser() sets up exactly once.
+ */
+
+/**
+ * @brief One-time global initialization of libxml2
+ *
+ * Idempotent and safe to call from several threads at once; only the first
+ * call does any work. Every parsing entry point calls it, so explicit calls
+ * are only needed to move the cost out of the first request.
+ */
+void initializeParser();
+
+/**
+ * @brief Releases libxml2's global state
+ *
+ * Optional. Call at most once, at process exit, after every extraction
+ * thread has finished; no parsing function may be used afterwards.
+ */
+void shutdownParser();
+
 /**
  * @brief Opens a DOCX file and returns a zip archive handle
  * @param filePath Path to the DOCX file
@@ -101,40 +215,72 @@ std::unique_ptr<zip_t, zip_close_t> openDocxFile(const std::string& filePath) no
 std::vector<char> readStylesXml(zip_t* zip) noexcept(false);  // throws std::runtime_error
 
 /**
- * @brief Parses XML data into a document object
- * @param xmlData Raw XML data to parse
- * @return Unique pointer to XML document with custom deleter
- * @throws std::runtime_error if XML parsing fails
+ * @brief Calls visitor for each style while styles.xml is still being inflated
+ * @param zip Open zip archive handle
+ * @param visitor Called with each style in document order, as soon as its
+ *        closing tag has been parsed; returning VisitAction::Stop ends the
+ *        extraction without reading the rest of the part
+ * @throws std::runtime_error if styles.xml is missing, unreadable or malformed;
+ *         exceptions thrown by the visitor propagate unchanged
+ *
+ * @details
+ * With a streaming backend the part is read with zip_fread in chunks of
+ * options.chunkBytes and parsed as it arrives; only the style being read is
+ * kept, so memory stays at one chunk, the parser's input window and one
+ * style, whatever the size of the part. LibxmlDom and InSitu read the part
+ * whole, and so do UTF-16 and legacy 8-bit parts, which are transcoded to
+ * UTF-8 first.
+ *
+ * Nothing is collected: one StyleInfo is refilled for every style, so its
+ * strings keep their capacity and a visitor that only inspects styles
+ * allocates nothing per style beyond the property map's nodes.
+ */
+StreamReport visitStylesXml(zip_t* zip, StyleVisitorRef visitor,
+                            const StreamOptions& options = {}) noexcept(false);  // throws std::runtime_error
+
+/**
+ * @brief Opens filePath and runs visitStylesXml() on it
+ *
+ *     size_t headings = 0;
+ *     visitDocxStyles(path, [&](StyleInfo& style) {
+ *         if (style.properties.count("outlineLvl")) ++headings;
+ *     });
+ * @throws std::runtime_error for any file/parsing errors
  */
-std::unique_ptr<xmlDoc, xmlDoc_deleter> parseXml(const std::vector<char>& xmlData) noexcept(false);  // throws std::runtime_error
+StreamReport visitDocxStyles(const std::string& filePath, StyleVisitorRef visitor,
+                             const StreamOptions& options = {}) noexcept(false);  // throws std::runtime_error
 
 /**
- * @brief Finds all style nodes in an XML document
- * @param doc Parsed XML document
- * @return Vector of pointers to style nodes
+ * @brief visitStylesXml() for callers that keep the styles: each one is moved to onStyle
+ * @throws std::runtime_error for any file/parsing errors
  */
-std::vector<xmlNodePtr> findStyleNodes(xmlDocPtr doc);
+StreamReport streamStylesXml(zip_t* zip, const std::function<void(StyleInfo&&)>& onStyle,
+                             const StreamOptions& options = {}) noexcept(false);  // throws std::runtime_error
 
 /**
- * @brief Processes a single style node into StyleInfo
- * @param node XML node representing a style
- * @return StyleInfo containing extracted style data
+ * @brief Opens filePath and runs streamStylesXml() on it
+ * @throws std::runtime_error for any file/parsing errors
  */
-StyleInfo processStyleNode(xmlNodePtr node);
+StreamReport streamDocxStyles(const std::string& filePath, const std::function<void(StyleInfo&&)>& onStyle,
+                              const StreamOptions& options = {}) noexcept(false);  // throws std::runtime_error
 
 /**
- * @brief Extracts font properties from run properties node
- * @param rPrNode XML node containing run properties
- * @param[out] style StyleInfo to populate with font data
+ * @brief visitStylesXml() on a styles part already in memory
+ * @throws std::runtime_error if the part is malformed
  */
-void extractFontProperties(xmlNodePtr rPrNode, StyleInfo& style);
+StreamReport visitStylesPart(const char* data, size_t size, StyleVisitorRef visitor,
+                             const StreamOptions& options = {}) noexcept(false);  // throws std::runtime_error
 
 /**
- * @brief Extracts other style properties from a node
- * @param node XML node to process
- * @param[out] style StyleInfo to populate with properties
+ * @brief Calls visitor for each style of a flat XML document (flat OPC or Word 2003 XML)
+ *
+ * Parsing ends with the document's first styles element, so with a
+ * streaming backend the rest of the file is not read. Batch mode routes
+ * such inputs here (see sniffInput()).
+ * @throws std::runtime_error if the file is not well-formed or has no styles element
  */
-void extractOtherProperties(xmlNodePtr node, StyleInfo& style);
+StreamReport visitFlatXmlStyles(const std::string& filePath, StyleVisitorRef visitor,
+                                const StreamOptions& options = {}) noexcept(false);  // throws std::runtime_error
 
 /**
  * @brief Main interface - extracts all styles from a DOCX file
@@ -144,6 +290,25 @@ void extractOtherProperties(xmlNodePtr node, StyleInfo& style);
  */
 std::vector<StyleInfo> extractDocxStyles(const std::string& filePath);
 
+/**
+ * @brief Extracts every style definition, hidden and non-quick-format ones included
+ *
+ * extractDocxStyles() skips the base styles that quick-format styles are
+ * usually basedOn; anything resolving inheritance needs them.
+ * @throws std::runtime_error for any file/parsing errors
+ */
+std::vector<StyleInfo> extractAllDocxStyles(const std::string& filePath);
+
+/**
+ * @brief Like extractAllDocxStyles(), with the heading level table built in the same pass
+ *
+ * @details
+ * A level goes to the paragraph style that declares it; when several do,
+ * Word's built-in "heading N" wins, otherwise the first one.
+ * @throws std::runtime_error for any file/parsing errors
+ */
+StyleSheet extractDocxStyleSheet(const std::string& filePath);
+
 } // namespace DocxParser
 
 #endif // DOCX_STYLE_PARSER_H
@@ -0,0 +1,209 @@
+// Google Test framework header
+#include <gtest/gtest.h>
+// Standard C++ headers
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <future>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+// Headers under test
+#include "docx_style_parser.h"
+#include "extraction_service.h"
+// writeDocx for generated inputs
+#include "test_docx.h"
+
+using namespace DocxParser;
+namespace fs = std::filesystem;
+
+/*
+ * Concurrency stress tests
+ *
+ * These tests hammer the extraction code from many threads at once. On their
+ * own they check that every thread sees the same results as a single-threaded
+ * run; built with -DTYPSTYLE_TSAN=ON, ThreadSanitizer additionally reports
+ * any data race the schedule happens to expose.
+ */
+
+namespace {
+
+constexpr int kThreads = 8;
+constexpr int kIterations = 25;
+
+/**
+ * @brief Builds a styles.xml with the given number of quick-format styles
+ */
+std::string generateStylesXml(int styleCount) {
+    std::string xml =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+        "<w:styles xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\">\n";
+    for (int i = 0; i < styleCount; ++i) {
+        const std::string id = std::to_string(i);
+        xml += "<w:style w:type=\"paragraph\" w:styleId=\"S" + id + "\">"
+               "<w:name w:val=\"Style " + id + "\"/><w:qFormat/>"
+               "<w:pPr><w:outlineLvl w:val=\"" + std::to_string(i % 9) + "\"/></w:pPr>"
+               "<w:rPr><w:rFonts w:ascii=\"Font" + std::to_string(i % 7) + "\"/>"
+               "<w:sz w:val=\"" + std::to_string(20 + i % 10) + "\"/></w:rPr></w:style>\n";
+    }
+    return xml + "</w:styles>\n";
+}
+
+/**
+ * @brief Order-sensitive fingerprint of an extraction result
+ */
+std::string fingerprint(const std::vector<StyleInfo>& styles) {
+    std::string out;
+    for (const auto& style : styles) {
+        out += style.name + "|" + style.type + "|" + style.fontName + "|" + style.fontSize;
+        for (const auto& prop : style.properties) out += "|" + prop.first + "=" + prop.second;
+        out += "\n";
+    }
+    return out;
+}
+
+class StressTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Unique per run, so concurrent runs (ctest -j, CI jobs on one host) never share inputs
+        std::random_device random;
+        do {
+            directory_ = fs::temp_directory_path() / ("typstyle_stress_test_" + std::to_string(random()));
+        } while (!fs::create_directory(directory_));
+        inputs_ = {"sample.docx"};
+        for (int count : {1, 50, 400}) {
+            auto path = (directory_ / ("generated_" + std::to_string(count) + ".docx")).string();
+            writeDocx(path, generateStylesXml(count));
+            inputs_.push_back(path);
+        }
+        for (const auto& input : inputs_) {
+            expected_.push_back(fingerprint(extractDocxStyles(input)));
+        }
+    }
+
+    void TearDown() override {
+        fs::remove_all(directory_);
+    }
+
+    fs::path directory_;
+    std::vector<std::string> inputs_;
+    std::vector<std::string> expected_;
+};
+
+} // namespace
+
+/**
+ * @brief Racing first calls must initialize libxml2 exactly once
+ */
+TEST(ParserInitTest, ConcurrentInitializeIsSafe) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([] {
+            initializeParser();
+            initializeParser();
+        });
+    }
+    for (auto& thread : threads) thread.join();
+}
+
+/**
+ * @brief Concurrent extractDocxStyles calls match the single-threaded results
+ */
+TEST_F(StressTest, ConcurrentExtraction) {
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(kThreads, 0);
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kIterations; ++i) {
+                // Threads start at different inputs so different parts overlap
+                const size_t input = (t + i) % inputs_.size();
+                if (fingerprint(extractDocxStyles(inputs_[input])) != expected_[input]) {
+                    ++mismatches[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (int count : mismatches) EXPECT_EQ(count, 0);
+}
+
+/**
+ * @brief A shared service under a tiny cache budget: coalescing plus cache churn
+ */
+TEST_F(StressTest, ConcurrentServiceWithEvictions) {
+    ServiceOptions options;
+    options.cache.hotBytes = 64 << 10;
+    options.cache.hotShards = 2;
+    ExtractionService service(options);
+
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(kThreads, 0);
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kIterations; ++i) {
+                const size_t input = (t * 7 + i) % inputs_.size();
+                if (fingerprint(*service.extract(inputs_[input])) != expected_[input]) {
+                    ++mismatches[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (int count : mismatches) EXPECT_EQ(count, 0);
+
+    auto stats = service.stats();
+    EXPECT_EQ(stats.requests, uint64_t(kThreads) * kIterations);
+    // The 400-style set never fits the budget, so each of its requests
+    // either extracts again or waits on a concurrent extraction
+    EXPECT_GE(stats.extractions + stats.coalesced, uint64_t(kThreads) * kIterations / inputs_.size());
+}
+
+/**
+ * @brief Interactive submissions racing bulk jobs on the lane scheduler
+ */
+TEST_F(StressTest, ConcurrentPriorityLanes) {
+    ServiceOptions options;
+    options.workers = 4;
+    options.cache.hotBytes = 0;  // Every request reaches the parser
+    ExtractionService service(options);
+
+    std::vector<std::string> bulkInputs;
+    for (int i = 0; i < kIterations; ++i) bulkInputs.push_back(inputs_[i % inputs_.size()]);
+    std::atomic<int> bulkMismatches{0};
+    std::vector<std::future<void>> jobs;
+    for (int j = 0; j < 2; ++j) {
+        jobs.push_back(service.submitBulk(bulkInputs,
+            [&](const std::string& path, StyleSetPtr styles, std::exception_ptr error) {
+                const size_t input = std::find(inputs_.begin(), inputs_.end(), path) - inputs_.begin();
+                if (error || fingerprint(*styles) != expected_[input]) ++bulkMismatches;
+            }));
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(kThreads, 0);
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kIterations / 5; ++i) {
+                const size_t input = (t + i) % inputs_.size();
+                if (fingerprint(*service.submit(inputs_[input]).get()) != expected_[input]) {
+                    ++mismatches[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (auto& job : jobs) job.get();
+    for (int count : mismatches) EXPECT_EQ(count, 0);
+    EXPECT_EQ(bulkMismatches.load(), 0);
+
+    auto stats = service.stats();
+    EXPECT_EQ(stats.interactive.completed, uint64_t(kThreads) * (kIterations / 5));
+    EXPECT_EQ(stats.bulk.completed, 2u * kIterations);
+    EXPECT_EQ(stats.interactive.failed + stats.bulk.failed, 0u);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,12 +1,54 @@
 // Google Test framework header - provides testing macros and infrastructure
 #include <gtest/gtest.h>
 // Standard C++ file operations
+#include <filesystem>
 #include <fstream>
 // Our header with the functions to test
 #include "docx_style_parser.h"
+// writeDocx for generated inputs
+#include "test_docx.h"
 
 // Use the DocxParser namespace where our functions are defined
 using namespace DocxParser;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string fingerprint(const StyleInfo& style) {
+    std::string out = style.name + "|" + style.type + "|" + style.fontName + "|" + style.fontSize;
+    for (const auto& prop : style.properties) out += "|" + prop.first + "=" + prop.second;
+    return out + "\n";
+}
+
+/**
+ * @brief Builds a styles.xml with the given number of quick-format styles
+ */
+std::string generateStylesXml(int styleCount) {
+    std::string xml =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+        "<w:styles xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\">\n";
+    for (int i = 0; i < styleCount; ++i) {
+        const std::string id = std::to_string(i);
+        xml += "<w:style w:type=\"paragraph\" w:styleId=\"S" + id + "\"><w:name w:val=\"Style " + id +
+               "\"/><w:qFormat/><w:rPr><w:rFonts w:ascii=\"Font" + std::to_string(i % 7) +
+               "\"/><w:sz w:val=\"24\"/></w:rPr></w:style>\n";
+    }
+    return xml + "</w:styles>\n";
+}
+
+/**
+ * @brief Reference result: whole part in memory, parsed into one libxml2 tree
+ */
+std::string bufferedFingerprint(const std::string& path, bool quickFormatOnly) {
+    StreamOptions options;
+    options.quickFormatOnly = quickFormatOnly;
+    options.backend = XmlBackend::LibxmlDom;
+    std::string out;
+    visitDocxStyles(path, [&](StyleInfo& style) { out += fingerprint(style); }, options);
+    return out;
+}
+
+} // namespace
 
 /**
  * @brief Test case for handling missing DOCX files
@@ -66,6 +108,100 @@ TEST(DocxParserTest, ExtractsStylesFromValidDocx) {
     EXPECT_TRUE(foundNormal);
 }
 
+/**
+ * @brief Every backend and any chunk size, down to one byte, gives the tree-based result
+ */
+TEST(DocxParserTest, StreamingMatchesBufferedParse) {
+    auto backends = availableXmlBackends();
+    backends.push_back(XmlBackend::Auto);
+    for (XmlBackend backend : backends) {
+        for (bool quickFormatOnly : {true, false}) {
+            for (size_t chunkBytes : {size_t(1), size_t(7), size_t(4096), size_t(1) << 20}) {
+                StreamOptions options;
+                options.chunkBytes = chunkBytes;
+                options.quickFormatOnly = quickFormatOnly;
+                options.backend = backend;
+                std::string streamed;
+                auto report = streamDocxStyles("sample.docx",
+                                               [&](StyleInfo&& style) { streamed += fingerprint(style); }, options);
+                EXPECT_EQ(streamed, bufferedFingerprint("sample.docx", quickFormatOnly))
+                    << xmlBackendName(backend) << " " << chunkBytes;
+                if (backend != XmlBackend::Auto) {
+                    EXPECT_EQ(report.buffered, !xmlBackendStreams(backend));
+                }
+                EXPECT_GT(report.styles, 0u);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Styles arrive while the part is still being inflated
+ */
+TEST(DocxParserTest, StreamsLargePartIncrementally) {
+    const std::string xml = generateStylesXml(20000);
+    const auto path = (fs::temp_directory_path() / "typstyle_stream_test.docx").string();
+    writeDocx(path, xml);
+
+    StreamOptions options;
+    options.chunkBytes = 16 * 1024;
+    std::string streamed;
+    auto report = streamDocxStyles(path, [&](StyleInfo&& style) { streamed += fingerprint(style); }, options);
+    EXPECT_EQ(report.styles, 20000u);
+    EXPECT_EQ(report.inflatedBytes, xml.size());
+    EXPECT_LE(report.bytesBeforeFirstStyle, 2 * options.chunkBytes);
+    EXPECT_EQ(streamed, bufferedFingerprint(path, true));
+    fs::remove(path);
+}
+
+TEST(DocxParserTest, StreamingRejectsTruncatedPart) {
+    const auto path = (fs::temp_directory_path() / "typstyle_truncated_test.docx").string();
+    writeDocx(path, "<?xml version=\"1.0\"?><w:styles xmlns:w=\"urn:w\"><w:style w:type=\"paragraph\">"
+                    "<w:name w:val=\"A\"/></w:style><w:style");
+    for (XmlBackend backend : availableXmlBackends()) {
+        StreamOptions options;
+        options.backend = backend;
+        EXPECT_THROW(streamDocxStyles(path, [](StyleInfo&&) {}, options), std::runtime_error) << xmlBackendName(backend);
+    }
+    fs::remove(path);
+}
+
+/**
+ * @brief Visitors see every style as a view and may stop before the part is read
+ */
+TEST(DocxParserTest, VisitorStopsEarly) {
+    const std::string xml = generateStylesXml(20000);
+    const auto path = (fs::temp_directory_path() / "typstyle_visit_test.docx").string();
+    writeDocx(path, xml);
+
+    // Functor object returning VisitAction
+    struct FirstFonts {
+        std::vector<std::string> fonts;
+        VisitAction operator()(const StyleInfo& style) {
+            fonts.push_back(style.fontName);
+            return fonts.size() == 3 ? VisitAction::Stop : VisitAction::Continue;
+        }
+    } firstFonts;
+    StreamOptions options;
+    options.chunkBytes = 4096;
+    auto report = visitDocxStyles(path, firstFonts, options);
+    EXPECT_TRUE(report.stopped);
+    EXPECT_EQ(report.styles, 3u);
+    EXPECT_EQ(firstFonts.fonts, (std::vector<std::string>{"Font0", "Font1", "Font2"}));
+    EXPECT_LT(report.inflatedBytes, xml.size() / 100);
+
+    // Lambda returning void visits everything; the view may be moved from
+    std::vector<StyleInfo> kept;
+    report = visitDocxStyles(path, [&](StyleInfo& style) {
+        if (style.name == "Style 19999") kept.push_back(std::move(style));
+    });
+    EXPECT_FALSE(report.stopped);
+    EXPECT_EQ(report.styles, 20000u);
+    ASSERT_EQ(kept.size(), 1u);
+    EXPECT_EQ(kept[0].properties.at("styleId"), "S19999");
+    fs::remove(path);
+}
+
 /**
  * @brief Main function for running tests
  *
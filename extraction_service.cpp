@@ -0,0 +1,325 @@
+// Standard C++ headers
+#include <algorithm>  // For max, min
+#include <stdexcept>  // For runtime_error
+
+// Third-party library headers
+#include <zip.h>      // For central directory lookups (libzip)
+
+// Project header
+#include "extraction_service.h"
+
+using namespace std;
+
+/*
+ * Extraction Service - Implementation Notes
+ *
+ * Request flow:
+ *   open archive -> key from central directory -> cache?
+ *     -> in-flight?  wait on the leader's future
+ *     -> otherwise   become the leader: extract, cache, publish, retire
+ *
+ * With a warm tier the leader extracts incrementally: the block snapshot
+ * stored under the document's path (by whichever key it had last) supplies
+ * the unchanged styles, and the new snapshot replaces it. Without one it
+ * streams the part as before.
+ *
+ * The leader stores its result in the cache *before* removing the in-flight
+ * entry, so a request arriving in between finds one or the other and never
+ * starts a duplicate extraction.
+ *
+ * Priority lanes:
+ *   submit()/submitBulk() -> lane queue (bounded) -> worker pool -> extract()
+ *
+ * - Shared workers pick between non-empty lanes by smooth weighted round
+ *   robin: each pick adds every non-empty lane's weight to its credit, takes
+ *   the lane with the most credit and charges it the sum of the weights.
+ *   With weights 4:1 and both lanes backlogged, the order is I I B I I I I B...
+ *   - bulk keeps making progress, but never in long runs.
+ * - Reserved workers only ever take interactive work, so a pool saturated
+ *   with slow bulk documents still has a thread free for previews.
+ * - A bulk job is a chain of one-document work items; each re-enters the
+ *   back of the bulk lane. That gap between documents is the preemption
+ *   point, and it keeps several bulk jobs interleaved instead of serialized.
+ *   Re-entries bypass the capacity check: the job was admitted once.
+ */
+
+namespace DocxParser {
+
+    StylesKey stylesKeyOf(zip_t* zip) {
+        zip_stat_t stats = {};
+        if (zip_stat(zip, "word/styles.xml", 0, &stats) != 0) {
+            throw runtime_error("styles.xml not found in DOCX archive");
+        }
+        if (!(stats.valid & ZIP_STAT_CRC) || !(stats.valid & ZIP_STAT_SIZE)) {
+            throw runtime_error("styles.xml has no CRC in the central directory");
+        }
+        StylesKey key;
+        key.crc = stats.crc;
+        key.size = stats.size;
+        return key;
+    }
+
+    struct ExtractionService::BulkJob {
+        vector<string> paths;
+        size_t next = 0;
+        BulkCallback callback;
+        promise<void> done;
+    };
+
+    namespace {
+
+        uint64_t microsSince(chrono::steady_clock::time_point start) {
+            return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+        }
+
+    } // namespace
+
+    ExtractionService::ExtractionService(ServiceOptions options)
+        : options_(move(options)), cache_(options_.cache) {
+        laneState(Lane::Interactive).options = options_.interactive;
+        laneState(Lane::Bulk).options = options_.bulk;
+    }
+
+    ExtractionService::~ExtractionService() {
+        {
+            lock_guard<mutex> guard(queueLock_);
+            stopping_ = true;
+        }
+        interactiveReady_.notify_all();
+        workReady_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    StyleSetPtr ExtractionService::extractOnce(zip_t* zip, const StylesKey& key, const string& filePath) {
+        auto styles = make_shared<StyleSet>();
+        if (cache_.keepsBlocks()) {
+            const vector<char> part = readStylesXml(zip);
+            IncrementalReport report;
+            const auto snapshot = extractStyleBlocks(part.data(), part.size(), cache_.getBlocks(filePath), &report);
+            *styles = selectStyles(snapshot);
+            cache_.putBlocks(filePath, snapshot);
+            reusedStyles_.fetch_add(report.reused, memory_order_relaxed);
+        } else {
+            streamStylesXml(zip, [&](StyleInfo&& style) { styles->push_back(move(style)); });
+        }
+        extractions_.fetch_add(1, memory_order_relaxed);
+        cache_.put(key, styles);
+        return styles;
+    }
+
+    StyleSetPtr ExtractionService::extract(const string& filePath) {
+        requests_.fetch_add(1, memory_order_relaxed);
+
+        auto zip = openDocxFile(filePath);
+        const StylesKey key = stylesKeyOf(zip.get());
+        if (auto cached = cache_.get(key)) {
+            return cached;
+        }
+
+        promise<StyleSetPtr> leader;
+        shared_future<StyleSetPtr> pending;
+        bool isLeader = false;
+        {
+            lock_guard<mutex> guard(inflightLock_);
+            auto it = inflight_.find(key);
+            if (it != inflight_.end()) {
+                pending = it->second;
+            } else {
+                pending = leader.get_future().share();
+                inflight_.emplace(key, pending);
+                isLeader = true;
+            }
+        }
+
+        if (!isLeader) {
+            coalesced_.fetch_add(1, memory_order_relaxed);
+            return pending.get();  // Rethrows the leader's exception, if any
+        }
+
+        StyleSetPtr result;
+        try {
+            // A previous leader may have finished between our cache miss and taking the lock
+            result = cache_.peek(key);
+            if (!result) result = extractOnce(zip.get(), key, filePath);
+            leader.set_value(result);
+        } catch (...) {
+            leader.set_exception(current_exception());
+            lock_guard<mutex> guard(inflightLock_);
+            inflight_.erase(key);
+            throw;
+        }
+
+        lock_guard<mutex> guard(inflightLock_);
+        inflight_.erase(key);
+        return result;
+    }
+
+    void ExtractionService::startWorkers() {
+        call_once(poolStarted_, [this] {
+            unsigned count = options_.workers;
+            if (count == 0) count = max(2u, thread::hardware_concurrency());
+            // At least one worker must be able to run bulk work
+            const unsigned reserved = min(options_.reservedInteractiveWorkers, count - 1);
+            for (unsigned i = 0; i < count; ++i) {
+                workers_.emplace_back(&ExtractionService::workerLoop, this, i < reserved);
+            }
+        });
+    }
+
+    void ExtractionService::enqueue(Lane lane, function<void(Clock::time_point)> run, bool admitted) {
+        LaneState& state = laneState(lane);
+        {
+            lock_guard<mutex> guard(queueLock_);
+            if (!admitted) {
+                if (state.queue.size() >= state.options.capacity) {
+                    state.rejected.fetch_add(1, memory_order_relaxed);
+                    throw runtime_error(string(lane == Lane::Interactive ? "Interactive" : "Bulk") +
+                                        " queue is full");
+                }
+                state.submitted.fetch_add(1, memory_order_relaxed);
+            }
+            state.queue.push_back(Task{move(run), Clock::now()});
+        }
+        if (lane == Lane::Interactive) interactiveReady_.notify_one();
+        workReady_.notify_one();
+    }
+
+    bool ExtractionService::popLocked(bool interactiveOnly, Task& task, Lane& lane) {
+        LaneState* chosen = nullptr;
+        if (interactiveOnly) {
+            if (!laneState(Lane::Interactive).queue.empty()) chosen = &laneState(Lane::Interactive);
+        } else {
+            int64_t totalWeight = 0;
+            for (auto& state : lanes_) {
+                if (state.queue.empty()) {
+                    state.credit = 0;  // Idle lanes do not bank credit
+                    continue;
+                }
+                const int64_t weight = max(1u, state.options.weight);
+                state.credit += weight;
+                totalWeight += weight;
+                if (!chosen || state.credit > chosen->credit) chosen = &state;
+            }
+            if (chosen) chosen->credit -= totalWeight;
+        }
+        if (!chosen) return false;
+
+        task = move(chosen->queue.front());
+        chosen->queue.pop_front();
+        lane = chosen == &laneState(Lane::Interactive) ? Lane::Interactive : Lane::Bulk;
+        return true;
+    }
+
+    void ExtractionService::workerLoop(bool interactiveOnly) {
+        condition_variable& ready = interactiveOnly ? interactiveReady_ : workReady_;
+        while (true) {
+            Task task;
+            Lane lane = Lane::Interactive;
+            {
+                unique_lock<mutex> lock(queueLock_);
+                ready.wait(lock, [&] { return stopping_ || popLocked(interactiveOnly, task, lane); });
+                if (stopping_) return;
+            }
+
+            laneState(lane).queueWait.record(microsSince(task.enqueued));
+            task.run(task.enqueued);
+        }
+    }
+
+    // Called by a task before it publishes its result, so a caller woken by
+    // the result already sees it counted
+    void ExtractionService::recordCompletion(Lane lane, Clock::time_point enqueued, bool ok) {
+        LaneState& state = laneState(lane);
+        state.latency.record(microsSince(enqueued));
+        state.completed.fetch_add(1, memory_order_relaxed);
+        if (!ok) state.failed.fetch_add(1, memory_order_relaxed);
+    }
+
+    future<StyleSetPtr> ExtractionService::submit(const string& filePath, Lane lane) {
+        startWorkers();
+        auto result = make_shared<promise<StyleSetPtr>>();
+        auto ready = result->get_future();
+        enqueue(lane, [this, lane, result, filePath](Clock::time_point enqueued) {
+            StyleSetPtr styles;
+            exception_ptr error;
+            try {
+                styles = extract(filePath);
+            } catch (...) {
+                error = current_exception();
+            }
+            recordCompletion(lane, enqueued, !error);
+            if (error) {
+                result->set_exception(error);
+            } else {
+                result->set_value(styles);
+            }
+        }, false);
+        return ready;
+    }
+
+    future<void> ExtractionService::submitBulk(vector<string> filePaths, BulkCallback onDocument) {
+        auto job = make_shared<BulkJob>();
+        job->paths = move(filePaths);
+        job->callback = move(onDocument);
+        auto done = job->done.get_future();
+        if (job->paths.empty()) {
+            job->done.set_value();
+            return done;
+        }
+        startWorkers();
+        enqueue(Lane::Bulk, [this, job](Clock::time_point enqueued) { runBulkStep(job, enqueued); }, false);
+        return done;
+    }
+
+    void ExtractionService::runBulkStep(const shared_ptr<BulkJob>& job, Clock::time_point enqueued) {
+        // Only one step of a job is ever queued or running, so no lock is needed
+        const string& path = job->paths[job->next++];
+        StyleSetPtr styles;
+        exception_ptr error;
+        try {
+            styles = extract(path);
+        } catch (...) {
+            error = current_exception();
+        }
+        recordCompletion(Lane::Bulk, enqueued, !error);
+
+        try {
+            job->callback(path, styles, error);
+        } catch (...) {
+            // A throwing callback ends the job and surfaces through its future
+            job->done.set_exception(current_exception());
+            return;
+        }
+
+        if (job->next < job->paths.size()) {
+            enqueue(Lane::Bulk, [this, job](Clock::time_point enqueued) { runBulkStep(job, enqueued); }, true);
+        } else {
+            job->done.set_value();
+        }
+    }
+
+    ServiceStats ExtractionService::stats() const {
+        ServiceStats stats;
+        stats.requests = requests_.load(memory_order_relaxed);
+        stats.extractions = extractions_.load(memory_order_relaxed);
+        stats.coalesced = coalesced_.load(memory_order_relaxed);
+        stats.reusedStyles = reusedStyles_.load(memory_order_relaxed);
+        stats.hot = cache_.hotStats();
+        stats.warm = cache_.warmStats();
+
+        LaneStats* out[] = {&stats.interactive, &stats.bulk};
+        lock_guard<mutex> guard(queueLock_);
+        for (size_t i = 0; i < lanes_.size(); ++i) {
+            const LaneState& state = lanes_[i];
+            out[i]->submitted = state.submitted.load(memory_order_relaxed);
+            out[i]->rejected = state.rejected.load(memory_order_relaxed);
+            out[i]->completed = state.completed.load(memory_order_relaxed);
+            out[i]->failed = state.failed.load(memory_order_relaxed);
+            out[i]->queued = state.queue.size();
+            out[i]->queueWait = state.queueWait;
+            out[i]->latency = state.latency;
+        }
+        return stats;
+    }
+
+} // namespace DocxParser
@@ -0,0 +1,198 @@
+#ifndef EXTRACTION_SERVICE_H
+#define EXTRACTION_SERVICE_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "docx_style_parser.h"
+#include "latency_histogram.h"
+#include "tiered_cache.h"
+
+/**
+ * @brief Thread-safe extraction front end for long-running processes
+ *
+ * Many requests for the same template (everyone opening the new letterhead)
+ * should cost one extraction. The service therefore:
+ * 1. Keys every request by the CRC-32 and size of word/styles.xml, both read
+ *    from the zip central directory without inflating anything.
+ * 2. Answers from the tiered cache (memory LRU, then disk snapshots) when it can.
+ *    With a warm tier, a miss on a document seen before (an edited template)
+ *    reparses only the styles that changed since its last extraction.
+ * 3. Otherwise coalesces concurrent misses (single-flight): the first
+ *    request extracts, identical requests arriving meanwhile wait on its
+ *    shared_future and receive the same result or the same exception.
+ *
+ * Besides the blocking extract(), work can be queued on a worker pool in one
+ * of two priority lanes: Interactive (editor previews that need an answer
+ * within tens of milliseconds) and Bulk (re-index jobs). See submit().
+ */
+namespace DocxParser {
+
+/**
+ * @brief Priority class of queued work
+ */
+enum class Lane {
+    Interactive,
+    Bulk
+};
+
+/**
+ * @brief Admission and share of one lane
+ */
+struct LaneOptions {
+    size_t capacity;  ///< Maximum queued requests; submitting beyond it throws
+    unsigned weight;  ///< Relative share of dequeues while both lanes have work
+};
+
+struct ServiceOptions {
+    TieredCacheOptions cache;  ///< Hot (memory) and warm (disk) result cache
+    unsigned workers = 0;      ///< Worker pool size (0 = hardware concurrency, at least 2)
+    unsigned reservedInteractiveWorkers = 1;  ///< Workers that never pick up bulk work
+    LaneOptions interactive{256, 4};
+    LaneOptions bulk{1024, 1};
+};
+
+/**
+ * @brief Counters and latency distributions of one lane
+ *
+ * queueWait is the time from enqueue to a worker starting the request;
+ * latency is enqueue to completion. Bulk jobs record one sample per document.
+ */
+struct LaneStats {
+    uint64_t submitted = 0;  ///< Accepted submit()/submitBulk() calls
+    uint64_t rejected = 0;   ///< Submissions refused because the lane was full
+    uint64_t completed = 0;  ///< Documents finished (successfully or not)
+    uint64_t failed = 0;
+    uint64_t queued = 0;     ///< Currently waiting for a worker
+    LatencyHistogram queueWait;
+    LatencyHistogram latency;
+};
+
+/**
+ * @brief Counters since construction
+ */
+struct ServiceStats {
+    uint64_t requests = 0;
+    uint64_t extractions = 0;  ///< Requests that parsed styles.xml
+    uint64_t coalesced = 0;    ///< Requests that waited on an in-flight extraction
+    uint64_t reusedStyles = 0; ///< Styles copied from a document's previous version instead of parsed
+    CacheTierStats hot;
+    CacheTierStats warm;
+    LaneStats interactive;
+    LaneStats bulk;
+};
+
+class ExtractionService {
+public:
+    /// Called once per document of a bulk job, from a worker thread
+    using BulkCallback = std::function<void(const std::string& path, StyleSetPtr styles, std::exception_ptr error)>;
+
+    explicit ExtractionService(ServiceOptions options = ServiceOptions());
+
+    /// Stops the worker pool; futures of still-queued work report broken_promise
+    ~ExtractionService();
+
+    ExtractionService(const ExtractionService&) = delete;
+    ExtractionService& operator=(const ExtractionService&) = delete;
+
+    /**
+     * @brief Extracts (or reuses) the styles of a DOCX file; safe to call concurrently
+     * @throws std::runtime_error for any file/parsing errors
+     */
+    StyleSetPtr extract(const std::string& filePath);
+
+    /**
+     * @brief Queues one extraction in the given lane
+     *
+     * The worker pool starts on the first submission.
+     * @return Future holding the styles or the extraction's exception
+     * @throws std::runtime_error if the lane already holds its capacity
+     */
+    std::future<StyleSetPtr> submit(const std::string& filePath, Lane lane = Lane::Interactive);
+
+    /**
+     * @brief Queues a bulk job that extracts the documents one at a time
+     *
+     * Each document is a separate work item: after finishing one, the job
+     * goes to the back of the bulk lane, so interactive work never waits
+     * for more than the document currently being processed. The job counts
+     * once against the bulk capacity.
+     * @return Future that becomes ready after the last callback
+     * @throws std::runtime_error if the bulk lane is full
+     */
+    std::future<void> submitBulk(std::vector<std::string> filePaths, BulkCallback onDocument);
+
+    ServiceStats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Task {
+        std::function<void(Clock::time_point enqueued)> run;
+        Clock::time_point enqueued;
+    };
+
+    struct LaneState {
+        LaneOptions options;
+        std::deque<Task> queue;
+        int64_t credit = 0;  ///< Smooth weighted round-robin state
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> rejected{0};
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> failed{0};
+        LatencyHistogram queueWait;
+        LatencyHistogram latency;
+    };
+
+    struct BulkJob;
+
+    StyleSetPtr extractOnce(zip_t* zip, const StylesKey& key, const std::string& filePath);
+    void startWorkers();
+    void enqueue(Lane lane, std::function<void(Clock::time_point)> run, bool admitted);
+    void recordCompletion(Lane lane, Clock::time_point enqueued, bool ok);
+    bool popLocked(bool interactiveOnly, Task& task, Lane& lane);
+    void workerLoop(bool interactiveOnly);
+    void runBulkStep(const std::shared_ptr<BulkJob>& job, Clock::time_point enqueued);
+    LaneState& laneState(Lane lane) { return lanes_[lane == Lane::Interactive ? 0 : 1]; }
+
+    ServiceOptions options_;
+    TieredStyleCache cache_;
+    std::mutex inflightLock_;
+    std::unordered_map<StylesKey, std::shared_future<StyleSetPtr>, StylesKeyHash> inflight_;
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> extractions_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> reusedStyles_{0};
+
+    // Worker pool and priority lanes
+    std::once_flag poolStarted_;
+    mutable std::mutex queueLock_;
+    std::condition_variable interactiveReady_;  ///< Wakes reserved workers
+    std::condition_variable workReady_;         ///< Wakes shared workers
+    std::array<LaneState, 2> lanes_;            ///< Interactive, Bulk
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+/**
+ * @brief Reads the cache key of an open archive from its central directory
+ * @throws std::runtime_error if styles.xml is missing or has no CRC
+ */
+StylesKey stylesKeyOf(zip_t* zip);
+
+} // namespace DocxParser
+
+#endif // EXTRACTION_SERVICE_H
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include "extraction_service.h"
+
+using namespace DocxParser;
+
+/**
+ * @brief The byte budget evicts least recently used entries first
+ */
+TEST(ShardedLruCacheTest, EvictsLeastRecentlyUsed) {
+    ShardedLruCache<int, int> cache(100, 1);
+    cache.put(1, std::make_shared<int>(1), 40);
+    cache.put(2, std::make_shared<int>(2), 40);
+    ASSERT_NE(cache.get(1), nullptr);  // 2 is now the coldest entry
+    cache.put(3, std::make_shared<int>(3), 40);
+
+    EXPECT_NE(cache.get(1), nullptr);
+    EXPECT_EQ(cache.get(2), nullptr);
+    EXPECT_NE(cache.get(3), nullptr);
+    EXPECT_EQ(cache.evictions(), 1u);
+    EXPECT_EQ(cache.bytes(), 80u);
+    EXPECT_FALSE(cache.put(4, std::make_shared<int>(4), 101));
+}
+
+/**
+ * @brief Concurrent requests for one template extract it exactly once
+ */
+TEST(ExtractionServiceTest, ExtractsSharedTemplateOnce) {
+    ExtractionService service;
+    std::vector<std::thread> clients;
+    std::vector<StyleSetPtr> results(16);
+    for (size_t i = 0; i < results.size(); ++i) {
+        clients.emplace_back([&, i] { results[i] = service.extract("sample.docx"); });
+    }
+    for (auto& client : clients) client.join();
+
+    for (const auto& result : results) {
+        ASSERT_NE(result, nullptr);
+        EXPECT_EQ(result.get(), results.front().get());  // Same shared result
+    }
+    auto stats = service.stats();
+    EXPECT_EQ(stats.requests, 16u);
+    EXPECT_EQ(stats.extractions, 1u);
+}
+
+/**
+ * @brief Without a cache, every request is either a leader or coalesced
+ */
+TEST(ExtractionServiceTest, CoalescesWithoutCache) {
+    ServiceOptions options;
+    options.cache.hotBytes = 0;
+    ExtractionService service(options);
+    std::vector<std::thread> clients;
+    for (int i = 0; i < 8; ++i) {
+        clients.emplace_back([&] { EXPECT_FALSE(service.extract("sample.docx")->empty()); });
+    }
+    for (auto& client : clients) client.join();
+
+    auto stats = service.stats();
+    EXPECT_EQ(stats.extractions + stats.coalesced, stats.requests);
+    EXPECT_THROW(service.extract("nonexistent.docx"), std::runtime_error);
+}
+
+/**
+ * @brief Percentiles stay within the histogram's relative bucket width
+ */
+TEST(LatencyHistogramTest, PercentilesWithinBucketError) {
+    LatencyHistogram histogram;
+    for (uint64_t micros = 1; micros <= 10000; ++micros) histogram.record(micros);
+
+    EXPECT_EQ(histogram.count(), 10000u);
+    EXPECT_EQ(histogram.max(), 10000u);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 5000.5);
+    EXPECT_NEAR(double(histogram.percentile(0.5)), 5000.0, 5000.0 / 32);
+    EXPECT_NEAR(double(histogram.percentile(0.99)), 9900.0, 9900.0 / 32);
+    EXPECT_EQ(histogram.percentile(1.0), 10000u);
+
+    LatencyHistogram other;
+    other.record(20000);
+    histogram.merge(other);
+    EXPECT_EQ(histogram.count(), 10001u);
+    EXPECT_EQ(histogram.max(), 20000u);
+}
+
+namespace {
+
+/**
+ * @brief Bulk callback that parks a worker until the test opens the gate
+ */
+struct WorkerGate {
+    std::promise<void> entered;
+    std::promise<void> release;
+    std::shared_future<void> opened = release.get_future().share();
+    std::atomic<int> calls{0};
+
+    ExtractionService::BulkCallback callback() {
+        return [this](const std::string&, StyleSetPtr, std::exception_ptr) {
+            if (calls++ == 0) entered.set_value();
+            opened.wait();
+        };
+    }
+};
+
+} // namespace
+
+/**
+ * @brief A full lane rejects new work instead of queueing without bound
+ */
+TEST(ExtractionServiceTest, RejectsWhenLaneIsFull) {
+    ServiceOptions options;
+    options.workers = 1;  // Leaves no reserved worker
+    options.interactive.capacity = 1;
+    ExtractionService service(options);
+
+    WorkerGate gate;
+    auto job = service.submitBulk({"sample.docx"}, gate.callback());
+    gate.entered.get_future().wait();  // The only worker is now busy
+
+    auto queued = service.submit("sample.docx");
+    EXPECT_THROW(service.submit("sample.docx"), std::runtime_error);
+    EXPECT_EQ(service.stats().interactive.rejected, 1u);
+    EXPECT_EQ(service.stats().interactive.queued, 1u);
+
+    gate.release.set_value();
+    EXPECT_FALSE(queued.get()->empty());
+    job.get();
+}
+
+/**
+ * @brief Interactive work is served between the documents of a bulk job
+ */
+TEST(ExtractionServiceTest, InteractivePreemptsBulkBetweenDocuments) {
+    ServiceOptions options;
+    options.workers = 1;
+    ExtractionService service(options);
+
+    WorkerGate gate;
+    std::future<StyleSetPtr> preview;
+    std::vector<bool> previewReadyAtDocument;
+    auto job = service.submitBulk({"sample.docx", "sample.docx", "sample.docx"},
+        [&](const std::string& path, StyleSetPtr styles, std::exception_ptr error) {
+            const bool first = previewReadyAtDocument.empty();
+            previewReadyAtDocument.push_back(
+                !first && preview.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+            if (first) gate.callback()(path, styles, error);
+        });
+    gate.entered.get_future().wait();
+    preview = service.submit("sample.docx");
+    gate.release.set_value();
+    job.get();
+
+    // The preview ran right after the first document, not after the whole job
+    EXPECT_EQ(previewReadyAtDocument, (std::vector<bool>{false, true, true}));
+    auto stats = service.stats();
+    EXPECT_EQ(stats.bulk.submitted, 1u);
+    EXPECT_EQ(stats.bulk.completed, 3u);
+    EXPECT_EQ(stats.bulk.latency.count(), 3u);
+    EXPECT_EQ(stats.interactive.completed, 1u);
+    EXPECT_EQ(stats.interactive.queueWait.count(), 1u);
+}
+
+/**
+ * @brief Reserved workers keep answering while bulk work occupies the rest
+ */
+TEST(ExtractionServiceTest, ReservedWorkerServesInteractive) {
+    ServiceOptions options;
+    options.workers = 2;
+    options.reservedInteractiveWorkers = 1;
+    ExtractionService service(options);
+
+    WorkerGate gate;
+    auto first = service.submitBulk({"sample.docx"}, gate.callback());
+    gate.entered.get_future().wait();
+    auto second = service.submitBulk({"sample.docx"}, [](const std::string&, StyleSetPtr, std::exception_ptr) {});
+
+    // Only the shared worker takes bulk work, so the second job waits...
+    auto preview = service.submit("sample.docx");
+    EXPECT_FALSE(preview.get()->empty());
+    EXPECT_EQ(service.stats().bulk.queued, 1u);
+
+    // ...while failures are delivered through the future
+    EXPECT_THROW(service.submit("nonexistent.docx").get(), std::runtime_error);
+
+    gate.release.set_value();
+    first.get();
+    second.get();
+    auto stats = service.stats();
+    EXPECT_EQ(stats.interactive.completed, 2u);
+    EXPECT_EQ(stats.interactive.failed, 1u);
+    EXPECT_EQ(stats.bulk.completed, 2u);
+}
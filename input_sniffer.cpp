@@ -0,0 +1,172 @@
+// Standard C++ headers
+#include <algorithm>   // For search
+#include <cstring>     // For memcmp
+#include <filesystem>  // For directory bundles
+#include <fstream>     // For head and tail reads
+
+// Project header
+#include "input_sniffer.h"
+
+using namespace std;
+
+/*
+ * Input Sniffer - Implementation Notes
+ *
+ * Signatures, in the order they are tested:
+ * - ZIP: local file header "PK\3\4" at offset 0 ("PK\5\6" for an empty
+ *   archive). A complete archive ends with the end-of-central-directory
+ *   record "PK\5\6", at most 22 + 65535 bytes from the end. Pages files
+ *   are ZIPs whose entries live under Index/ (Document.iwa); the first
+ *   local header and the central directory in the tail both show it.
+ * - CFB: D0 CF 11 E0 A1 B1 1A E1. Office stores encrypted and IRM
+ *   documents in CFB with an "EncryptedPackage" stream and a
+ *   "\x06DataSpaces" storage; the directory entry names are UTF-16LE and
+ *   sit in the first sectors of small files or near the end of large ones.
+ * - Flat XML: optional BOM, then '<'; the root is pkg:package (flat OPC,
+ *   what Word writes as "Word XML Document") or w:wordDocument (Word 2003).
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    bool contains(const char* data, size_t size, const string& needle) {
+        return size >= needle.size() && search(data, data + size, needle.begin(), needle.end()) != data + size;
+    }
+
+    string utf16le(const char* ascii) {
+        string out;
+        for (const char* c = ascii; *c; ++c) {
+            out += *c;
+            out += '\0';
+        }
+        return out;
+    }
+
+    bool hasEndOfCentralDirectory(const char* tail, size_t size) {
+        return contains(tail, size, string("PK\x05\x06", 4));
+    }
+
+    InputSniff classified(InputKind kind, string detail) {
+        InputSniff sniff;
+        sniff.kind = kind;
+        sniff.detail = move(detail);
+        return sniff;
+    }
+
+} // namespace
+
+    const char* inputKindName(InputKind kind) {
+        switch (kind) {
+            case InputKind::Zip: return "zip";
+            case InputKind::Cfb: return "cfb";
+            case InputKind::FlatXml: return "flat-xml";
+            case InputKind::PagesBundle: return "pages";
+            case InputKind::Unknown: break;
+        }
+        return "unknown";
+    }
+
+    InputSniff sniffBytes(const char* head, size_t headSize, const char* tail, size_t tailSize) {
+        static const string kCfbMagic("\xD0\xCF\x11\xE0\xA1\xB1\x1A\xE1", 8);
+        static const string kEncryptedPackage = utf16le("EncryptedPackage");
+        static const string kDataSpaces = utf16le("DataSpaces");
+
+        if (headSize >= 4 && (memcmp(head, "PK\x03\x04", 4) == 0 || memcmp(head, "PK\x05\x06", 4) == 0)) {
+            const bool pages = (headSize > 36 && memcmp(head + 30, "Index/", 6) == 0) ||
+                               (tail && contains(tail, tailSize, "Index/Document.iwa"));
+            if (pages) return classified(InputKind::PagesBundle, "Apple Pages document (Index/*.iwa)");
+            InputSniff sniff = classified(InputKind::Zip, "ZIP archive");
+            if (tail && !hasEndOfCentralDirectory(tail, tailSize)) {
+                sniff.truncated = true;
+                sniff.detail = "ZIP archive without end of central directory (truncated or still being written)";
+            }
+            return sniff;
+        }
+
+        if (headSize >= kCfbMagic.size() && memcmp(head, kCfbMagic.data(), kCfbMagic.size()) == 0) {
+            InputSniff sniff = classified(InputKind::Cfb, "OLE compound file, not a DOCX package (legacy .doc?)");
+            for (const string* name : {&kEncryptedPackage, &kDataSpaces}) {
+                if (contains(head, headSize, *name) || (tail && contains(tail, tailSize, *name))) {
+                    sniff.encrypted = true;
+                }
+            }
+            if (sniff.encrypted) sniff.detail = "password-protected or IRM-protected document (encrypted OLE package)";
+            return sniff;
+        }
+
+        // Flat XML: skip a UTF-8 BOM and leading whitespace
+        size_t start = headSize >= 3 && memcmp(head, "\xEF\xBB\xBF", 3) == 0 ? 3 : 0;
+        while (start < headSize && (head[start] == ' ' || head[start] == '\t' || head[start] == '\r' || head[start] == '\n')) {
+            ++start;
+        }
+        if (start < headSize && head[start] == '<') {
+            const char* text = head + start;
+            const size_t size = headSize - start;
+            if (contains(text, size, "schemas.microsoft.com/office/2006/xmlPackage") || contains(text, size, "<pkg:package")) {
+                return classified(InputKind::FlatXml, "flat OPC XML document");
+            }
+            if (contains(text, size, "wordDocument")) {
+                return classified(InputKind::FlatXml, "Word 2003 XML document");
+            }
+            return classified(InputKind::Unknown, "XML file that is not a Word document");
+        }
+        return classified(InputKind::Unknown, "not a DOCX package (unrecognized format)");
+    }
+
+    InputSniff sniffInput(const string& path) {
+        error_code error;
+        if (filesystem::is_directory(path, error)) {
+            // Pages '09 and exported packages are directories
+            if (filesystem::exists(filesystem::path(path) / "Index.zip", error) ||
+                filesystem::exists(filesystem::path(path) / "index.xml.gz", error) ||
+                filesystem::exists(filesystem::path(path) / "Index" / "Document.iwa", error)) {
+                return classified(InputKind::PagesBundle, "Apple Pages package directory");
+            }
+            return classified(InputKind::Unknown, "directory, not a document");
+        }
+
+        ifstream in(path, ios::binary);
+        if (!in) return classified(InputKind::Unknown, "cannot open file");
+        in.seekg(0, ios::end);
+        const uint64_t size = static_cast<uint64_t>(in.tellg());
+        in.seekg(0);
+
+        char head[kSniffWindow];
+        const size_t headSize = static_cast<size_t>(min<uint64_t>(size, sizeof(head)));
+        in.read(head, static_cast<streamsize>(headSize));
+
+        // The tail window grows to the largest possible ZIP comment only if needed
+        string tail;
+        auto readTail = [&](uint64_t bytes) {
+            bytes = min(bytes, size);
+            tail.resize(static_cast<size_t>(bytes));
+            in.clear();
+            in.seekg(static_cast<streamoff>(size - bytes));
+            in.read(&tail[0], static_cast<streamsize>(bytes));
+        };
+        readTail(kSniffWindow);
+        if (!in) return classified(InputKind::Unknown, "cannot read file");
+
+        InputSniff sniff = sniffBytes(head, headSize, tail.data(), tail.size());
+        if (sniff.kind == InputKind::Zip && sniff.truncated && size > kSniffWindow) {
+            readTail(22 + 0xFFFF);
+            if (in) sniff = sniffBytes(head, headSize, tail.data(), tail.size());
+        }
+        return sniff;
+    }
+
+    void InputKindCounts::add(const InputSniff& sniff) {
+        switch (sniff.kind) {
+            case InputKind::Zip: ++zip; break;
+            case InputKind::Cfb:
+                ++cfb;
+                if (sniff.encrypted) ++encrypted;
+                break;
+            case InputKind::FlatXml: ++flatXml; break;
+            case InputKind::PagesBundle: ++pagesBundle; break;
+            case InputKind::Unknown: ++unknown; break;
+        }
+    }
+
+} // namespace DocxParser
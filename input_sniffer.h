@@ -0,0 +1,83 @@
+#ifndef INPUT_SNIFFER_H
+#define INPUT_SNIFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Classification of inputs by their first and last bytes
+ *
+ * A file named .docx is not necessarily a DOCX package. Password-protected
+ * and IRM-protected Word documents are OLE compound files (CFB) whose
+ * streams hold the encrypted package; exports also contain flat XML
+ * documents, Pages files and plain junk. libzip only reports such inputs
+ * with an error code after opening them, so batch mode classifies every
+ * input from its head and tail first and rejects or routes it before any
+ * archive is opened.
+ */
+namespace DocxParser {
+
+enum class InputKind {
+    Zip,          ///< ZIP container: a DOCX package (or something zipped)
+    Cfb,          ///< OLE compound file: encrypted / IRM DOCX or legacy .doc
+    FlatXml,      ///< Flat OPC (pkg:package) or Word 2003 XML in one file
+    PagesBundle,  ///< Apple Pages document (zip with Index/*.iwa, or a directory)
+    Unknown,      ///< Anything else, including unreadable paths
+};
+
+/// "zip", "cfb", "flat-xml", "pages", "unknown"
+const char* inputKindName(InputKind kind);
+
+struct InputSniff {
+    InputKind kind = InputKind::Unknown;
+    bool encrypted = false;  ///< CFB holding an EncryptedPackage or IRM DataSpaces
+    bool truncated = false;  ///< ZIP without an end-of-central-directory record
+    std::string detail;      ///< Human-readable reason, for rejections and logs
+
+    /// True if the input can be extracted (a complete ZIP or flat XML)
+    bool extractable() const {
+        return (kind == InputKind::Zip && !truncated) || kind == InputKind::FlatXml;
+    }
+};
+
+/**
+ * @brief Bytes read from each end of a file
+ *
+ * Enough for every signature; the end-of-central-directory search reads
+ * up to 64 KiB more only when the archive has a long comment or is cut off.
+ */
+constexpr size_t kSniffWindow = 4096;
+
+/**
+ * @brief Classifies the file at path from its first and last kSniffWindow bytes
+ *
+ * Never throws: a missing or unreadable path is Unknown with a detail.
+ */
+InputSniff sniffInput(const std::string& path);
+
+/**
+ * @brief Classifies an in-memory input
+ * @param head First bytes of the input
+ * @param tail Last bytes of the input, or nullptr when only the head is
+ *        known (the ZIP trailer check is then skipped)
+ */
+InputSniff sniffBytes(const char* head, size_t headSize, const char* tail, size_t tailSize);
+
+/**
+ * @brief Per-kind input counts of a batch run
+ */
+struct InputKindCounts {
+    size_t zip = 0;
+    size_t cfb = 0;
+    size_t encrypted = 0;  ///< CFB inputs that are encrypted or IRM-protected (also counted in cfb)
+    size_t flatXml = 0;
+    size_t pagesBundle = 0;
+    size_t unknown = 0;
+
+    void add(const InputSniff& sniff);
+};
+
+} // namespace DocxParser
+
+#endif // INPUT_SNIFFER_H
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "batch_runner.h"
+#include "input_sniffer.h"
+
+using namespace DocxParser;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+std::string tempFile(const std::string& name, const std::string& content) {
+    const auto path = (fs::temp_directory_path() / name).string();
+    std::ofstream(path, std::ios::binary) << content;
+    return path;
+}
+
+std::string utf16le(const std::string& ascii) {
+    std::string out;
+    for (char c : ascii) {
+        out += c;
+        out += '\0';
+    }
+    return out;
+}
+
+/**
+ * @brief Minimal CFB: header sector plus one directory sector naming the given streams
+ */
+std::string compoundFile(const std::vector<std::string>& streams) {
+    std::string file("\xD0\xCF\x11\xE0\xA1\xB1\x1A\xE1", 8);
+    file.resize(512, '\0');
+    std::vector<std::string> entries = {"Root Entry"};
+    entries.insert(entries.end(), streams.begin(), streams.end());
+    for (const auto& name : entries) file += utf16le(name) + std::string(128 - 2 * name.size(), '\0');
+    file.resize(2048, '\0');
+    return file;
+}
+
+/**
+ * @brief Flat OPC document whose styles part is sample.docx's styles.xml
+ */
+std::string flatOpc() {
+    auto zip = openDocxFile("sample.docx");
+    const auto part = readStylesXml(zip.get());
+    std::string styles(part.begin(), part.end());
+    if (styles.compare(0, 5, "<?xml") == 0) styles.erase(0, styles.find("?>") + 2);
+    return "<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+           "<?mso-application progid=\"Word.Document\"?>\n"
+           "<pkg:package xmlns:pkg=\"http://schemas.microsoft.com/office/2006/xmlPackage\">"
+           "<pkg:part pkg:name=\"/_rels/.rels\" pkg:contentType=\"application/vnd.openxmlformats-package.relationships+xml\">"
+           "<pkg:xmlData><Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\"/></pkg:xmlData>"
+           "</pkg:part>"
+           "<pkg:part pkg:name=\"/word/styles.xml\" pkg:contentType=\"application/vnd.openxmlformats-officedocument.wordprocessingml.styles+xml\">"
+           "<pkg:xmlData>" + styles + "</pkg:xmlData></pkg:part></pkg:package>";
+}
+
+std::string fingerprint(const std::vector<StyleInfo>& styles) {
+    std::string out;
+    for (const auto& style : styles) {
+        out += style.name + "|" + style.fontName + "|" + style.fontSize;
+        for (const auto& prop : style.properties) out += "|" + prop.first + "=" + prop.second;
+        out += "\n";
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(InputSnifferTest, ClassifiesByHeadAndTail) {
+    const auto docx = sniffInput("sample.docx");
+    EXPECT_EQ(docx.kind, InputKind::Zip);
+    EXPECT_TRUE(docx.extractable());
+
+    EXPECT_EQ(sniffInput("smaple.pages").kind, InputKind::PagesBundle);
+
+    const std::string sample = readFile("sample.docx");
+    const auto cut = tempFile("typstyle_sniff_cut.docx", sample.substr(0, sample.size() / 2));
+    const auto truncated = sniffInput(cut);
+    EXPECT_EQ(truncated.kind, InputKind::Zip);
+    EXPECT_TRUE(truncated.truncated);
+    EXPECT_FALSE(truncated.extractable());
+
+    const auto encryptedPath = tempFile("typstyle_sniff_encrypted.docx",
+                                        compoundFile({"\x06" "DataSpaces", "EncryptedPackage", "EncryptionInfo"}));
+    const auto encrypted = sniffInput(encryptedPath);
+    EXPECT_EQ(encrypted.kind, InputKind::Cfb);
+    EXPECT_TRUE(encrypted.encrypted);
+
+    const auto legacyPath = tempFile("typstyle_sniff_legacy.doc", compoundFile({"WordDocument", "1Table"}));
+    const auto legacy = sniffInput(legacyPath);
+    EXPECT_EQ(legacy.kind, InputKind::Cfb);
+    EXPECT_FALSE(legacy.encrypted);
+
+    const auto flatPath = tempFile("typstyle_sniff_flat.xml", "\xEF\xBB\xBF" + flatOpc());
+    EXPECT_EQ(sniffInput(flatPath).kind, InputKind::FlatXml);
+
+    EXPECT_EQ(sniffInput("nonexistent.docx").kind, InputKind::Unknown);
+    const auto textPath = tempFile("typstyle_sniff_text.docx", "Dear custodian,\n");
+    EXPECT_EQ(sniffInput(textPath).kind, InputKind::Unknown);
+
+    for (const auto& path : {cut, encryptedPath, legacyPath, flatPath, textPath}) fs::remove(path);
+}
+
+/**
+ * @brief libzip's "not a zip archive" is replaced by what the file actually is
+ */
+TEST(InputSnifferTest, NamesInputInOpenErrors) {
+    const auto path = tempFile("typstyle_sniff_open.docx", compoundFile({"EncryptedPackage"}));
+    try {
+        openDocxFile(path);
+        FAIL() << "Expected openDocxFile to throw";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("password-protected"), std::string::npos) << e.what();
+    }
+    fs::remove(path);
+}
+
+/**
+ * @brief Batch mode extracts flat XML, rejects the rest before opening it, and counts every kind
+ */
+TEST(InputSnifferTest, BatchRunnerRoutesAndRejects) {
+    const std::string sample = readFile("sample.docx");
+    const auto flat = tempFile("typstyle_batch_flat.xml", flatOpc());
+    const auto encrypted = tempFile("typstyle_batch_encrypted.docx",
+                                    compoundFile({"\x06" "DataSpaces", "EncryptedPackage"}));
+    const auto cut = tempFile("typstyle_batch_cut.docx", sample.substr(0, sample.size() / 2));
+
+    BatchOptions options;
+    options.threads = 2;
+    BatchRunner runner(options);
+    auto items = runner.run({"sample.docx", flat, encrypted, "smaple.pages", cut});
+    ASSERT_EQ(items.size(), 5u);
+
+    EXPECT_TRUE(items[1].error.empty()) << items[1].error;
+    EXPECT_EQ(fingerprint(items[1].document.styles), fingerprint(items[0].document.styles));
+    for (size_t i = 2; i < items.size(); ++i) {
+        EXPECT_EQ(items[i].error.rfind("Rejected: ", 0), 0u) << items[i].error;
+    }
+    EXPECT_NE(items[2].error.find("password-protected"), std::string::npos);
+
+    const auto& counts = runner.report().inputs;
+    EXPECT_EQ(counts.zip, 2u);
+    EXPECT_EQ(counts.flatXml, 1u);
+    EXPECT_EQ(counts.cfb, 1u);
+    EXPECT_EQ(counts.encrypted, 1u);
+    EXPECT_EQ(counts.pagesBundle, 1u);
+    EXPECT_EQ(runner.report().failed, 3u);
+
+    for (const auto& path : {flat, encrypted, cut}) fs::remove(path);
+}
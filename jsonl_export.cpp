@@ -0,0 +1,370 @@
+// Standard C++ headers
+#include <algorithm>   // For min, max
+#include <cstdio>      // For snprintf
+#include <exception>   // For exception_ptr
+#include <filesystem>  // For index-relative shard paths
+#include <fstream>     // For shard and index files
+#include <memory>      // For unique_ptr
+#include <mutex>       // For streaming writers
+#include <stdexcept>   // For runtime_error
+#include <thread>      // For parallel shard writers
+
+// Third-party library headers
+#include <zstd.h>  // For frame compression
+
+// Project header
+#include "jsonl_export.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/*
+ * JSONL Export - Implementation Notes
+ *
+ * Frames as seek points:
+ * - A writer collects JSON lines in memory until it holds frameBytes, then
+ *   compresses the buffer as one frame with ZSTD_compress2 and appends it
+ *   to the current part. Index entries of the buffered documents get the
+ *   frame's offset and compressed size once it is written.
+ * - Bigger frames compress better, smaller frames make a lookup cheaper;
+ *   1 MiB of JSON keeps the ratio within a few percent of one solid stream.
+ *
+ * Every writer owns its ZSTD_CCtx, frame buffer and output file, so the
+ * threads share nothing but the read-only input. The context is reused for
+ * every frame, which keeps its match tables allocated.
+ *
+ * JsonlExporter has no threads of its own: each writer has a mutex, and
+ * add() takes the first free writer, starting from a rotating position so
+ * concurrent callers spread over them, and waits only if all are busy.
+ *
+ * The index is plain TSV so it can be grepped; tab, newline and backslash
+ * in paths are backslash-escaped.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    struct CCtxDeleter {
+        void operator()(ZSTD_CCtx* context) const { ZSTD_freeCCtx(context); }
+    };
+
+    void appendJsonString(const string& value, string& out) {
+        out += '"';
+        for (char c : value) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escaped[8];
+                        snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                        out += escaped;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    string escapeField(const string& value) {
+        string out;
+        for (char c : value) {
+            if (c == '\\') out += "\\\\";
+            else if (c == '\t') out += "\\t";
+            else if (c == '\n') out += "\\n";
+            else out += c;
+        }
+        return out;
+    }
+
+    string unescapeField(const string& value) {
+        string out;
+        for (size_t i = 0; i < value.size(); ++i) {
+            if (value[i] == '\\' && i + 1 < value.size()) {
+                const char next = value[++i];
+                out += next == 't' ? '\t' : next == 'n' ? '\n' : next;
+            } else {
+                out += value[i];
+            }
+        }
+        return out;
+    }
+
+    /**
+     * @brief Writes one contiguous range of documents as rotating parts
+     */
+    class ShardWriter {
+    public:
+        ShardWriter(string prefix, const JsonlExportOptions& options)
+            : prefix_(move(prefix)), options_(options), context_(ZSTD_createCCtx()) {
+            if (!context_) throw runtime_error("Failed to create zstd context");
+            ZSTD_CCtx_setParameter(context_.get(), ZSTD_c_compressionLevel, options_.level);
+            ZSTD_CCtx_setParameter(context_.get(), ZSTD_c_checksumFlag, 1);
+            frame_.reserve(options_.frameBytes + 4096);
+        }
+
+        void add(const DocumentStyles& document) {
+            JsonlIndexEntry entry;
+            entry.path = document.path;
+            entry.lineOffset = frame_.size();
+            appendDocumentJson(document, frame_);
+            entry.lineBytes = frame_.size() - entry.lineOffset;
+            frame_ += '\n';
+            pending_.push_back(move(entry));
+            if (frame_.size() >= options_.frameBytes) flushFrame();
+        }
+
+        void finish() {
+            flushFrame();
+            closePart();
+        }
+
+        vector<JsonlIndexEntry> entries;
+        vector<string> files;
+        uint64_t jsonBytes = 0;
+        uint64_t compressedBytes = 0;
+
+    private:
+        void flushFrame() {
+            if (frame_.empty()) return;
+            if (!file_.is_open()) openPart();
+
+            compressed_.resize(ZSTD_compressBound(frame_.size()));
+            const size_t written = ZSTD_compress2(context_.get(), &compressed_[0], compressed_.size(),
+                                                  frame_.data(), frame_.size());
+            if (ZSTD_isError(written)) {
+                throw runtime_error(string("zstd compression failed: ") + ZSTD_getErrorName(written));
+            }
+            file_.write(compressed_.data(), static_cast<streamsize>(written));
+            if (!file_) throw runtime_error("Failed to write " + files.back());
+
+            const string shardName = fs::path(files.back()).filename().string();
+            for (auto& entry : pending_) {
+                entry.shard = shardName;
+                entry.frameOffset = partBytes_;
+                entry.frameBytes = written;
+                entries.push_back(move(entry));
+            }
+            pending_.clear();
+            jsonBytes += frame_.size();
+            compressedBytes += written;
+            partBytes_ += written;
+            frame_.clear();
+
+            if (partBytes_ >= options_.shardBytes) closePart();  // The next frame opens a new part
+        }
+
+        void openPart() {
+            files.push_back(prefix_ + "." + to_string(part_++) + ".jsonl.zst");
+            file_.open(files.back(), ios::binary | ios::trunc);
+            if (!file_) throw runtime_error("Failed to create " + files.back());
+            partBytes_ = 0;
+        }
+
+        void closePart() {
+            if (!file_.is_open()) return;
+            file_.close();
+            if (!file_) throw runtime_error("Failed to write " + files.back());
+        }
+
+        string prefix_;
+        const JsonlExportOptions& options_;
+        unique_ptr<ZSTD_CCtx, CCtxDeleter> context_;
+        string frame_;
+        string compressed_;
+        vector<JsonlIndexEntry> pending_;  ///< Documents of the frame being filled
+        ofstream file_;
+        size_t part_ = 0;
+        uint64_t partBytes_ = 0;
+    };
+
+    JsonlExportReport writeIndex(const string& prefix, const vector<const ShardWriter*>& writers) {
+        JsonlExportReport report;
+        report.indexFile = prefix + ".index.tsv";
+        ofstream index(report.indexFile, ios::trunc);
+        index << "path\tshard\tframe_offset\tframe_bytes\tline_offset\tline_bytes\n";
+        for (const auto* writer : writers) {
+            for (const auto& entry : writer->entries) {
+                index << escapeField(entry.path) << '\t' << entry.shard << '\t' << entry.frameOffset << '\t'
+                      << entry.frameBytes << '\t' << entry.lineOffset << '\t' << entry.lineBytes << '\n';
+            }
+            report.shardFiles.insert(report.shardFiles.end(), writer->files.begin(), writer->files.end());
+            report.jsonBytes += writer->jsonBytes;
+            report.compressedBytes += writer->compressedBytes;
+        }
+        index.close();
+        if (!index) throw runtime_error("Failed to write " + report.indexFile);
+        return report;
+    }
+
+} // namespace
+
+    void appendDocumentJson(const DocumentStyles& document, string& out) {
+        out += "{\"path\":";
+        appendJsonString(document.path, out);
+        out += ",\"styles\":[";
+        for (size_t i = 0; i < document.styles.size(); ++i) {
+            const auto& style = document.styles[i];
+            if (i > 0) out += ',';
+            out += "{\"name\":";
+            appendJsonString(style.name, out);
+            out += ",\"type\":";
+            appendJsonString(style.type, out);
+            out += ",\"font\":";
+            appendJsonString(style.fontName, out);
+            out += ",\"fontSize\":";
+            appendJsonString(style.fontSize, out);
+            out += ",\"properties\":{";
+            bool first = true;
+            for (const auto& property : style.properties) {
+                if (!first) out += ',';
+                first = false;
+                appendJsonString(property.first, out);
+                out += ':';
+                appendJsonString(property.second, out);
+            }
+            out += "}}";
+        }
+        out += "]}";
+    }
+
+    JsonlExportReport exportJsonlShards(const vector<DocumentStyles>& documents, const string& prefix,
+                                        const JsonlExportOptions& options) {
+        size_t writerCount = options.writers ? options.writers : max(1u, thread::hardware_concurrency());
+        writerCount = max<size_t>(1, min(writerCount, documents.size()));
+
+        vector<unique_ptr<ShardWriter>> writers;
+        for (size_t w = 0; w < writerCount; ++w) {
+            writers.push_back(make_unique<ShardWriter>(prefix + "-" + to_string(w), options));
+        }
+
+        vector<exception_ptr> errors(writerCount);
+        vector<thread> threads;
+        threads.reserve(writerCount);
+        for (size_t w = 0; w < writerCount; ++w) {
+            threads.emplace_back([&, w] {
+                try {
+                    const size_t begin = documents.size() * w / writerCount;
+                    const size_t end = documents.size() * (w + 1) / writerCount;
+                    for (size_t i = begin; i < end; ++i) writers[w]->add(documents[i]);
+                    writers[w]->finish();
+                } catch (...) {
+                    errors[w] = current_exception();
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        for (const auto& error : errors) {
+            if (error) rethrow_exception(error);
+        }
+
+        vector<const ShardWriter*> finished;
+        for (const auto& writer : writers) finished.push_back(writer.get());
+        return writeIndex(prefix, finished);
+    }
+
+    struct JsonlExporter::Writer {
+        Writer(string prefix, const JsonlExportOptions& options) : shard(move(prefix), options) {}
+
+        mutex lock;
+        ShardWriter shard;
+    };
+
+    JsonlExporter::JsonlExporter(string prefix, JsonlExportOptions options)
+        : prefix_(move(prefix)), options_(move(options)) {
+        const size_t count = options_.writers ? options_.writers : max(1u, thread::hardware_concurrency());
+        for (size_t w = 0; w < count; ++w) {
+            writers_.push_back(make_unique<Writer>(prefix_ + "-" + to_string(w), options_));
+        }
+    }
+
+    JsonlExporter::~JsonlExporter() = default;
+
+    void JsonlExporter::add(const DocumentStyles& document) {
+        const size_t start = next_.fetch_add(1, memory_order_relaxed);
+        for (size_t i = 0; i < writers_.size(); ++i) {
+            Writer& writer = *writers_[(start + i) % writers_.size()];
+            unique_lock<mutex> guard(writer.lock, try_to_lock);
+            if (guard.owns_lock()) {
+                writer.shard.add(document);
+                return;
+            }
+        }
+        Writer& writer = *writers_[start % writers_.size()];
+        lock_guard<mutex> guard(writer.lock);
+        writer.shard.add(document);
+    }
+
+    JsonlExportReport JsonlExporter::finish() {
+        vector<const ShardWriter*> finished;
+        for (auto& writer : writers_) {
+            lock_guard<mutex> guard(writer->lock);
+            writer->shard.finish();
+            finished.push_back(&writer->shard);
+        }
+        return writeIndex(prefix_, finished);
+    }
+
+    JsonlShardIndex::JsonlShardIndex(const string& indexPath)
+        : directory_(fs::path(indexPath).parent_path().string()) {
+        ifstream in(indexPath);
+        if (!in) throw runtime_error("Cannot read JSONL index " + indexPath);
+
+        string line;
+        getline(in, line);  // Header
+        while (getline(in, line)) {
+            if (line.empty()) continue;
+            vector<string> fields;
+            size_t start = 0;
+            for (size_t tab; (tab = line.find('\t', start)) != string::npos; start = tab + 1) {
+                fields.push_back(line.substr(start, tab - start));
+            }
+            fields.push_back(line.substr(start));
+            if (fields.size() != 6) throw runtime_error("Malformed JSONL index line: " + line);
+
+            JsonlIndexEntry entry;
+            entry.path = unescapeField(fields[0]);
+            entry.shard = fields[1];
+            entry.frameOffset = stoull(fields[2]);
+            entry.frameBytes = stoull(fields[3]);
+            entry.lineOffset = stoull(fields[4]);
+            entry.lineBytes = stoull(fields[5]);
+            byPath_[entry.path] = entries_.size();
+            entries_.push_back(move(entry));
+        }
+    }
+
+    const JsonlIndexEntry* JsonlShardIndex::find(const string& documentPath) const {
+        auto it = byPath_.find(documentPath);
+        return it == byPath_.end() ? nullptr : &entries_[it->second];
+    }
+
+    string JsonlShardIndex::read(const JsonlIndexEntry& entry) const {
+        const string shardPath = (fs::path(directory_) / entry.shard).string();
+        ifstream in(shardPath, ios::binary);
+        if (!in) throw runtime_error("Cannot open shard " + shardPath);
+
+        string compressed(entry.frameBytes, '\0');
+        in.seekg(static_cast<streamoff>(entry.frameOffset));
+        in.read(&compressed[0], static_cast<streamsize>(compressed.size()));
+        if (!in) throw runtime_error("Truncated shard " + shardPath);
+
+        const unsigned long long frameSize = ZSTD_getFrameContentSize(compressed.data(), compressed.size());
+        if (frameSize == ZSTD_CONTENTSIZE_ERROR || frameSize == ZSTD_CONTENTSIZE_UNKNOWN ||
+            entry.lineOffset + entry.lineBytes > frameSize) {
+            throw runtime_error("Corrupt frame in " + shardPath);
+        }
+        string frame(frameSize, '\0');
+        const size_t size = ZSTD_decompress(&frame[0], frame.size(), compressed.data(), compressed.size());
+        if (ZSTD_isError(size) || size != frameSize) {
+            throw runtime_error("Corrupt frame in " + shardPath);
+        }
+        return frame.substr(entry.lineOffset, entry.lineBytes);
+    }
+
+} // namespace DocxParser
@@ -0,0 +1,138 @@
+#ifndef JSONL_EXPORT_H
+#define JSONL_EXPORT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "docx_style_parser.h"
+
+/**
+ * @brief zstd-compressed JSON Lines export with a per-document seek index
+ *
+ * Documents are written one JSON object per line into shard files
+ * <prefix>-<writer>.<part>.jsonl.zst. Several writers run in parallel, each
+ * on its own thread with its own zstd compression context, so compression
+ * scales with the cores instead of bottlenecking on one external gzip pipe.
+ * A writer starts a new part once the current one reaches shardBytes.
+ *
+ * Each shard is a sequence of independent zstd frames of about frameBytes
+ * of JSON. Concatenated frames are a valid zstd stream (`zstd -dc` reads the
+ * whole shard), and <prefix>.index.tsv records for every document its shard,
+ * the frame holding it and its place in that frame, so one result is read
+ * by decompressing a single frame.
+ */
+namespace DocxParser {
+
+struct JsonlExportOptions {
+    size_t writers = 0;                   ///< Parallel shard writers (0 = hardware concurrency)
+    uint64_t shardBytes = 256ull << 20;   ///< Start a new part after this many compressed bytes
+    size_t frameBytes = 1 << 20;          ///< JSON per zstd frame; the unit of random access
+    int level = 3;                        ///< zstd compression level
+};
+
+/**
+ * @brief Location of one document's record
+ */
+struct JsonlIndexEntry {
+    std::string path;          ///< Source document path
+    std::string shard;         ///< Shard file name, relative to the index file
+    uint64_t frameOffset = 0;  ///< Byte offset of the zstd frame in the shard
+    uint64_t frameBytes = 0;   ///< Compressed size of the frame
+    uint64_t lineOffset = 0;   ///< Offset of the record in the decompressed frame
+    uint64_t lineBytes = 0;    ///< Length of the record, without the newline
+};
+
+struct JsonlExportReport {
+    std::vector<std::string> shardFiles;  ///< In writer, then part order
+    std::string indexFile;
+    uint64_t jsonBytes = 0;        ///< Uncompressed JSON written
+    uint64_t compressedBytes = 0;  ///< Sum of the shard sizes
+};
+
+/**
+ * @brief Appends one document as a single-line JSON object
+ *
+ * {"path": ..., "styles": [{"name", "type", "font", "fontSize", "properties": {...}}]}
+ */
+void appendDocumentJson(const DocumentStyles& document, std::string& out);
+
+/**
+ * @brief Writes documents as compressed JSONL shards plus their index
+ * @param documents Documents in export order; each writer takes a contiguous range
+ * @param prefix Output path prefix
+ * @throws std::runtime_error if a file cannot be written or zstd fails
+ */
+JsonlExportReport exportJsonlShards(const std::vector<DocumentStyles>& documents,
+                                    const std::string& prefix,
+                                    const JsonlExportOptions& options = {});
+
+/**
+ * @brief Streaming export: documents are written as they arrive
+ *
+ * add() serializes and compresses on the calling thread, into whichever of
+ * the shard writers is free, so the threads that add documents (batch
+ * workers, through BatchOptions::onItem) do the compression and no more
+ * than one frame per writer is held in memory. Records are in arrival
+ * order; the index finds them whatever the order.
+ */
+class JsonlExporter {
+public:
+    explicit JsonlExporter(std::string prefix, JsonlExportOptions options = {});
+    ~JsonlExporter();
+
+    JsonlExporter(const JsonlExporter&) = delete;
+    JsonlExporter& operator=(const JsonlExporter&) = delete;
+
+    /**
+     * @brief Writes one document; thread-safe
+     * @throws std::runtime_error if a shard cannot be written or zstd fails
+     */
+    void add(const DocumentStyles& document);
+
+    /**
+     * @brief Writes the last frames and the index; call once, after the last add()
+     * @throws std::runtime_error if a file cannot be written or zstd fails
+     */
+    JsonlExportReport finish();
+
+private:
+    struct Writer;
+
+    std::string prefix_;
+    JsonlExportOptions options_;
+    std::vector<std::unique_ptr<Writer>> writers_;
+    std::atomic<size_t> next_{0};
+};
+
+/**
+ * @brief Random access to exported records through the index
+ */
+class JsonlShardIndex {
+public:
+    /// @throws std::runtime_error if the index cannot be read
+    explicit JsonlShardIndex(const std::string& indexPath);
+
+    /// nullptr if the document is not in the export
+    const JsonlIndexEntry* find(const std::string& documentPath) const;
+
+    /**
+     * @brief Reads one record by decompressing only its frame
+     * @throws std::runtime_error if the shard is missing or corrupt
+     */
+    std::string read(const JsonlIndexEntry& entry) const;
+
+    const std::vector<JsonlIndexEntry>& entries() const { return entries_; }
+
+private:
+    std::string directory_;
+    std::vector<JsonlIndexEntry> entries_;
+    std::unordered_map<std::string, size_t> byPath_;
+};
+
+} // namespace DocxParser
+
+#endif // JSONL_EXPORT_H
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <zstd.h>
+#include "jsonl_export.h"
+
+using namespace DocxParser;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::vector<DocumentStyles> makeDocuments(size_t count) {
+    std::vector<DocumentStyles> documents(count);
+    for (size_t d = 0; d < count; ++d) {
+        documents[d].path = "/corpus/doc" + std::to_string(d) + ".docx";
+        for (size_t s = 0; s < 12; ++s) {
+            StyleInfo style;
+            style.name = "Heading " + std::to_string(s);
+            style.type = "paragraph";
+            style.fontName = "Calibri";
+            style.fontSize = std::to_string(20 + d % 7);
+            style.properties["outlineLvl"] = std::to_string(s % 9);
+            documents[d].styles.push_back(std::move(style));
+        }
+    }
+    return documents;
+}
+
+fs::path freshDirectory(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() / name;
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+/**
+ * @brief Strings are escaped and properties become an object
+ */
+TEST(JsonlExportTest, WritesEscapedJson) {
+    DocumentStyles document;
+    document.path = "C:\\docs\\\"quoted\".docx";
+    StyleInfo style;
+    style.name = "Tab\there";
+    style.type = "paragraph";
+    style.properties["qFormat"] = "";
+    style.properties["ctl"] = std::string(1, '\x01');
+    document.styles.push_back(std::move(style));
+
+    std::string json;
+    appendDocumentJson(document, json);
+    EXPECT_EQ(json,
+              "{\"path\":\"C:\\\\docs\\\\\\\"quoted\\\".docx\",\"styles\":[{\"name\":\"Tab\\there\","
+              "\"type\":\"paragraph\",\"font\":\"\",\"fontSize\":\"\","
+              "\"properties\":{\"ctl\":\"\\u0001\",\"qFormat\":\"\"}}]}");
+}
+
+/**
+ * @brief Parts rotate by size, shards decompress as plain JSONL and the index reads single records
+ */
+TEST(JsonlExportTest, RotatesShardsAndSeeksThroughIndex) {
+    const auto dir = freshDirectory("typstyle_jsonl_test");
+    const auto documents = makeDocuments(300);
+
+    JsonlExportOptions options;
+    options.writers = 3;
+    options.frameBytes = 8 << 10;
+    options.shardBytes = 4 << 10;
+    const auto report = exportJsonlShards(documents, (dir / "out").string(), options);
+
+    EXPECT_GT(report.shardFiles.size(), 3u);  // Every writer rotated at least once
+    EXPECT_LT(report.compressedBytes, report.jsonBytes);
+
+    // Concatenating every shard in order gives the documents in input order
+    std::string all;
+    for (const auto& file : report.shardFiles) {
+        const std::string compressed = readFile(file);
+        std::unique_ptr<ZSTD_DStream, size_t (*)(ZSTD_DStream*)> stream(ZSTD_createDStream(), &ZSTD_freeDStream);
+        ZSTD_inBuffer in = {compressed.data(), compressed.size(), 0};
+        char chunk[4096];
+        ZSTD_outBuffer out;
+        do {
+            out = {chunk, sizeof(chunk), 0};
+            ASSERT_FALSE(ZSTD_isError(ZSTD_decompressStream(stream.get(), &out, &in))) << file;
+            all.append(chunk, out.pos);
+        } while (in.pos < in.size || out.pos == out.size);
+    }
+    std::string expected;
+    for (const auto& document : documents) {
+        appendDocumentJson(document, expected);
+        expected += '\n';
+    }
+    EXPECT_EQ(all, expected);
+    EXPECT_EQ(report.jsonBytes, expected.size());
+
+    JsonlShardIndex index(report.indexFile);
+    ASSERT_EQ(index.entries().size(), documents.size());
+    for (size_t d : {0, 99, 100, 217, 299}) {
+        const auto* entry = index.find(documents[d].path);
+        ASSERT_NE(entry, nullptr);
+        std::string json;
+        appendDocumentJson(documents[d], json);
+        EXPECT_EQ(index.read(*entry), json);
+    }
+    EXPECT_EQ(index.find("/corpus/missing.docx"), nullptr);
+}
+
+/**
+ * @brief Documents added from several threads all land in the shards and the index
+ */
+TEST(JsonlExportTest, StreamsFromConcurrentThreads) {
+    const auto dir = freshDirectory("typstyle_jsonl_stream_test");
+    const auto documents = makeDocuments(200);
+
+    JsonlExportOptions options;
+    options.writers = 2;
+    options.frameBytes = 4 << 10;
+    JsonlExporter exporter((dir / "out").string(), options);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t d = t; d < documents.size(); d += 4) exporter.add(documents[d]);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    const auto report = exporter.finish();
+    EXPECT_EQ(report.shardFiles.size(), 2u);
+
+    JsonlShardIndex index(report.indexFile);
+    ASSERT_EQ(index.entries().size(), documents.size());
+    for (const auto& document : documents) {
+        const auto* entry = index.find(document.path);
+        ASSERT_NE(entry, nullptr) << document.path;
+        std::string json;
+        appendDocumentJson(document, json);
+        EXPECT_EQ(index.read(*entry), json);
+    }
+    fs::remove_all(dir);
+}
@@ -0,0 +1,123 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace DocxParser {
+
+/**
+ * @brief Lock-free latency histogram with bounded relative error
+ *
+ * @details
+ * Values (microseconds) are bucketed HDR-style: values below kSubBuckets
+ * are counted exactly; above that, the power of two of the value selects an
+ * octave, which is split into kSubBuckets linear sub-buckets. Every bucket
+ * is therefore at most 1/kSubBuckets (~3%) wide relative to its values,
+ * whatever the magnitude, and values up to 2^45 us fit in a fixed array.
+ *
+ * record() is a couple of relaxed atomic increments, so many threads can
+ * record into one histogram without a lock.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr uint64_t kSubBuckets = uint64_t(1) << kSubBucketBits;
+    static constexpr int kMajorBuckets = 40;
+    static constexpr size_t kBucketCount = size_t(kMajorBuckets + 1) * kSubBuckets;  ///< Linear range + octaves
+
+    LatencyHistogram() {
+        for (auto& bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram(const LatencyHistogram& other) { *this = other; }
+
+    LatencyHistogram& operator=(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            buckets_[i].store(other.buckets_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        count_.store(other.count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        sum_.store(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        max_.store(other.max_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    void record(uint64_t micros) {
+        buckets_[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(micros, std::memory_order_relaxed);
+        uint64_t seen = max_.load(std::memory_order_relaxed);
+        while (micros > seen && !max_.compare_exchange_weak(seen, micros, std::memory_order_relaxed)) {
+        }
+    }
+
+    /// Adds every sample of other into this histogram
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            buckets_[i].fetch_add(other.buckets_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        count_.fetch_add(other.count(), std::memory_order_relaxed);
+        sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        uint64_t theirs = other.max();
+        uint64_t seen = max_.load(std::memory_order_relaxed);
+        while (theirs > seen && !max_.compare_exchange_weak(seen, theirs, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Value at quantile q (0..1), reported as the upper edge of its bucket
+     */
+    uint64_t percentile(double q) const {
+        const uint64_t total = count();
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(q * total + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > total) rank = total;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                const uint64_t upper = upperEdge(i);
+                return upper < max() ? upper : max();
+            }
+        }
+        return max();
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    double mean() const {
+        const uint64_t n = count();
+        return n ? double(sum_.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+
+private:
+    static size_t bucketOf(uint64_t value) {
+        if (value < kSubBuckets) return static_cast<size_t>(value);
+        // Octave [2^b, 2^(b+1)) is split into kSubBuckets equal steps of 2^(b - kSubBucketBits)
+        int b = kSubBucketBits;
+        while (b < 63 && (value >> (b + 1)) != 0) ++b;
+        const int shift = b - kSubBucketBits;
+        if (shift >= kMajorBuckets) return kBucketCount - 1;
+        const uint64_t sub = (value >> shift) - kSubBuckets;
+        return static_cast<size_t>(kSubBuckets + uint64_t(shift) * kSubBuckets + sub);
+    }
+
+    static uint64_t upperEdge(size_t index) {
+        if (index < kSubBuckets) return index;
+        const uint64_t shift = (index - kSubBuckets) / kSubBuckets;
+        const uint64_t sub = (index - kSubBuckets) % kSubBuckets;
+        return ((kSubBuckets + sub + 1) << shift) - 1;
+    }
+
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_;
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+} // namespace DocxParser
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,314 @@
+// Standard C++ headers
+#include <algorithm>           // For sort, max
+#include <chrono>              // For steady_clock
+#include <condition_variable>  // For the RSS sampler
+#include <cstdio>              // For fopen, fscanf
+#include <fstream>             // For ifstream
+#include <mutex>               // For mutex, lock_guard
+#include <sstream>             // For istringstream
+#include <stdexcept>           // For runtime_error
+#include <thread>              // For thread, sleep_until
+
+#ifdef __linux__
+#include <unistd.h>            // For sysconf(_SC_PAGESIZE)
+#endif
+
+// Project header
+#include "load_generator.h"
+
+using namespace std;
+
+/*
+ * Load Generator - Implementation Notes
+ *
+ * Clients share one atomic request counter. A client takes index i, waits
+ * until i is due, submits requests[i % n] to the service and blocks on the
+ * future; so at most `concurrency` requests are in flight and requests
+ * leave in index order.
+ *
+ * Due times (microseconds from the start):
+ *   rate > 0          i * 1e6 / rate
+ *   recorded log      (pass * period + offset[i % n]) / speed, where the
+ *                     period is the log's span plus one mean gap, so a
+ *                     repeated log keeps its average rate
+ *   otherwise         none: closed loop, latency starts at the submit
+ *
+ * Latency runs from the due time, not from the moment a client got round
+ * to sending: if every client is stuck behind a slow request, the requests
+ * that should have gone out meanwhile are charged the wait. `late` counts
+ * how often that happened; a high count means the generator, not just the
+ * service, was saturated and the concurrency should be raised.
+ *
+ * A separate thread samples RSS from /proc/self/statm. The service runs in
+ * this process, so that is the service's footprint plus the generator's,
+ * which is small and constant (histograms, the request list).
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    using Clock = chrono::steady_clock;
+
+    constexpr size_t kMaxDistinctErrors = 32;
+
+    Lane laneFromName(const string& name) {
+        if (name == "interactive") return Lane::Interactive;
+        if (name == "bulk") return Lane::Bulk;
+        throw runtime_error("Unknown lane '" + name + "' (interactive or bulk)");
+    }
+
+    uint64_t microsSince(Clock::time_point from, Clock::time_point to) {
+        return to > from ? static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(to - from).count()) : 0;
+    }
+
+    /**
+     * @brief When each request is due, relative to the start of the run
+     */
+    class Schedule {
+    public:
+        Schedule(const vector<LoadRequest>& requests, const LoadOptions& options) : n_(requests.size()) {
+            if (options.rate > 0) {
+                kind_ = Kind::Paced;
+                interval_ = 1e6 / options.rate;
+            } else if (requests.back().offsetMicros > 0) {
+                kind_ = Kind::Recorded;
+                const double span = double(requests.back().offsetMicros);
+                period_ = n_ > 1 ? span + span / double(n_ - 1) : span;
+                speed_ = options.speed;
+                offsets_.reserve(n_);
+                for (const auto& request : requests) offsets_.push_back(double(request.offsetMicros));
+            }
+        }
+
+        bool paced() const { return kind_ != Kind::Closed; }
+
+        /// Microseconds from the start at which request i is due
+        double due(uint64_t i) const {
+            if (kind_ == Kind::Paced) return double(i) * interval_;
+            return (double(i / n_) * period_ + offsets_[i % n_]) / speed_;
+        }
+
+    private:
+        enum class Kind { Closed, Paced, Recorded };
+
+        size_t n_;
+        Kind kind_ = Kind::Closed;
+        double interval_ = 0;
+        double period_ = 0;
+        double speed_ = 1.0;
+        vector<double> offsets_;
+    };
+
+    /**
+     * @brief Samples RSS on its own thread until stopped
+     */
+    class RssSampler {
+    public:
+        RssSampler(Clock::time_point start, unsigned intervalMs) : start_(start), interval_(intervalMs) {
+            if (currentRssBytes() == 0) return;  // Unknown on this platform
+            thread_ = thread([this] { run(); });
+        }
+
+        ~RssSampler() { stop(); }
+
+        vector<RssSample> stop() {
+            if (thread_.joinable()) {
+                {
+                    lock_guard<mutex> lock(lock_);
+                    stopping_ = true;
+                }
+                wake_.notify_one();
+                thread_.join();
+                sample();  // The state after the last request
+            }
+            return move(samples_);
+        }
+
+    private:
+        void run() {
+            unique_lock<mutex> lock(lock_);
+            do {
+                sample();
+            } while (!wake_.wait_for(lock, interval_, [this] { return stopping_; }));
+        }
+
+        void sample() {
+            const double seconds = chrono::duration<double>(Clock::now() - start_).count();
+            samples_.push_back({seconds, currentRssBytes()});
+        }
+
+        Clock::time_point start_;
+        chrono::milliseconds interval_;
+        mutex lock_;
+        condition_variable wake_;
+        bool stopping_ = false;
+        vector<RssSample> samples_;
+        thread thread_;
+    };
+
+} // namespace
+
+    vector<LoadRequest> parseRequestLog(istream& in) {
+        vector<LoadRequest> requests;
+        size_t lineNumber = 0;
+        for (string line; getline(in, line);) {
+            ++lineNumber;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            const size_t begin = line.find_first_not_of(" \t");
+            if (begin == string::npos || line[begin] == '#') continue;
+
+            istringstream fields(line);
+            double offsetMs = -1;
+            string lane;
+            LoadRequest request;
+            fields >> offsetMs >> lane;
+            getline(fields >> ws, request.path);
+            if (offsetMs < 0 || lane.empty() || request.path.empty()) {
+                throw runtime_error("Malformed request log line " + to_string(lineNumber) +
+                                    " (expected '<offset-ms> <lane> <path>'): " + line);
+            }
+            request.lane = laneFromName(lane);
+            request.offsetMicros = static_cast<uint64_t>(offsetMs * 1000.0 + 0.5);
+            requests.push_back(move(request));
+        }
+        stable_sort(requests.begin(), requests.end(), [](const LoadRequest& a, const LoadRequest& b) {
+            return a.offsetMicros < b.offsetMicros;
+        });
+        return requests;
+    }
+
+    vector<LoadRequest> readRequestLog(const string& path) {
+        ifstream in(path);
+        if (!in) {
+            throw runtime_error("Cannot read request log " + path);
+        }
+        return parseRequestLog(in);
+    }
+
+    uint64_t currentRssBytes() {
+#ifdef __linux__
+        FILE* statm = fopen("/proc/self/statm", "r");
+        if (!statm) return 0;
+        unsigned long long pages = 0, resident = 0;
+        const int fields = fscanf(statm, "%llu %llu", &pages, &resident);
+        fclose(statm);
+        return fields == 2 ? resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+        return 0;
+#endif
+    }
+
+    double LoadReport::throughput() const {
+        return elapsedSeconds > 0 ? double(completed) / elapsedSeconds : 0.0;
+    }
+
+    double LoadReport::errorRate() const {
+        return sent ? double(failed + rejected) / double(sent) : 0.0;
+    }
+
+    double LoadReport::rssDriftPerMinute() const {
+        if (rss.size() < 2) return 0.0;
+        const double warmup = rss.back().seconds / 5;
+        double n = 0, sumT = 0, sumB = 0, sumTT = 0, sumTB = 0;
+        for (const auto& sample : rss) {
+            if (sample.seconds < warmup) continue;
+            const double bytes = double(sample.bytes);
+            n += 1;
+            sumT += sample.seconds;
+            sumB += bytes;
+            sumTT += sample.seconds * sample.seconds;
+            sumTB += sample.seconds * bytes;
+        }
+        const double denominator = n * sumTT - sumT * sumT;
+        if (n < 2 || denominator <= 0) return 0.0;
+        return (n * sumTB - sumT * sumB) / denominator * 60.0;
+    }
+
+    LoadReport runLoad(ExtractionService& service, const vector<LoadRequest>& requests,
+                       const LoadOptions& options) {
+        if (requests.empty()) {
+            throw runtime_error("No requests to replay");
+        }
+        if (options.concurrency == 0 || options.rate < 0 || options.speed <= 0 || options.durationSeconds < 0) {
+            throw runtime_error("Load options out of range (concurrency >= 1, rate >= 0, speed > 0, duration >= 0)");
+        }
+
+        const Schedule schedule(requests, options);
+        const uint64_t limit = options.requests ? options.requests
+                             : options.durationSeconds > 0 ? UINT64_MAX
+                             : requests.size();
+        const double durationMicros = options.durationSeconds * 1e6;
+
+        LoadReport report;
+        atomic<uint64_t> next{0};
+        atomic<uint64_t> sent{0}, completed{0}, failed{0}, rejected{0}, late{0};
+        mutex errorsLock;
+
+        const auto noteError = [&](const string& message) {
+            lock_guard<mutex> lock(errorsLock);
+            auto it = report.errors.find(message);
+            if (it == report.errors.end() && report.errors.size() >= kMaxDistinctErrors) {
+                it = report.errors.emplace("(other errors)", 0).first;
+            } else if (it == report.errors.end()) {
+                it = report.errors.emplace(message, 0).first;
+            }
+            ++it->second;
+        };
+
+        const Clock::time_point start = Clock::now();
+        RssSampler sampler(start, max(1u, options.rssIntervalMs));
+
+        const auto client = [&] {
+            for (uint64_t i = next++; i < limit; i = next++) {
+                Clock::time_point due = Clock::now();
+                if (schedule.paced()) {
+                    const double dueMicros = schedule.due(i);
+                    if (durationMicros > 0 && dueMicros >= durationMicros) break;
+                    due = start + chrono::microseconds(static_cast<int64_t>(dueMicros));
+                    this_thread::sleep_until(due);
+                } else if (durationMicros > 0 && double(microsSince(start, due)) >= durationMicros) {
+                    break;
+                }
+
+                const LoadRequest& request = requests[i % requests.size()];
+                const Clock::time_point submitted = Clock::now();
+                if (schedule.paced() && microsSince(due, submitted) > 1000) ++late;
+                ++sent;
+                future<StyleSetPtr> result;
+                try {
+                    result = service.submit(request.path, request.lane);
+                } catch (const exception& e) {
+                    ++rejected;
+                    noteError(e.what());
+                    continue;
+                }
+                try {
+                    result.get();
+                    ++completed;
+                } catch (const exception& e) {
+                    ++failed;
+                    noteError(e.what());
+                }
+                const Clock::time_point finished = Clock::now();
+                report.latency.record(microsSince(due, finished));
+                report.serviceTime.record(microsSince(submitted, finished));
+            }
+        };
+
+        vector<thread> clients;
+        for (unsigned c = 0; c < options.concurrency; ++c) clients.emplace_back(client);
+        for (auto& thread : clients) thread.join();
+
+        report.elapsedSeconds = chrono::duration<double>(Clock::now() - start).count();
+        report.rss = sampler.stop();
+        report.sent = sent;
+        report.completed = completed;
+        report.failed = failed;
+        report.rejected = rejected;
+        report.late = late;
+        report.service = service.stats();
+        return report;
+    }
+
+} // namespace DocxParser
@@ -0,0 +1,115 @@
+#ifndef LOAD_GENERATOR_H
+#define LOAD_GENERATOR_H
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "extraction_service.h"
+#include "latency_histogram.h"
+
+/**
+ * @brief Load generator and soak harness for the extraction service
+ *
+ * @details
+ * Replays a corpus (every path in turn) or a recorded request log (paths,
+ * lanes and send times) against an in-process ExtractionService from a
+ * fixed number of client threads, optionally at a fixed request rate, for a
+ * number of requests or a wall-clock duration. The report has latency
+ * percentiles, error counts, throughput and the process RSS sampled over
+ * the run, from which a drift (growth per minute) is fitted.
+ *
+ * Paced runs are open loop: request i is due at a fixed time whether or not
+ * earlier requests have finished, and its latency is measured from that due
+ * time. A stalled service therefore shows up as high latency for every
+ * request that had to wait for a free client, instead of as fewer requests
+ * (coordinated omission). serviceTime is measured from the actual submit.
+ */
+namespace DocxParser {
+
+/**
+ * @brief One request to replay
+ */
+struct LoadRequest {
+    std::string path;
+    Lane lane = Lane::Interactive;
+    uint64_t offsetMicros = 0;  ///< Send time from the start of the recording (logs only)
+};
+
+/**
+ * @brief Reads a request log
+ *
+ * One request per line, `<offset-ms> <lane> <path>` separated by tabs or
+ * spaces (the path may contain spaces), lane `interactive` or `bulk`.
+ * Blank lines and lines starting with '#' are skipped. Requests are sorted
+ * by offset.
+ * @throws std::runtime_error on a malformed line
+ */
+std::vector<LoadRequest> parseRequestLog(std::istream& in);
+
+/// @throws std::runtime_error if the file cannot be read or is malformed
+std::vector<LoadRequest> readRequestLog(const std::string& path);
+
+struct LoadOptions {
+    /// Requests per second, paced open loop. 0: a log with offsets is
+    /// replayed at its recorded times (scaled by speed), anything else runs
+    /// closed loop (each client sends as soon as its last request finished)
+    double rate = 0;
+    double speed = 1.0;            ///< Time scale of a recorded log (2 = twice as fast)
+    unsigned concurrency = 4;      ///< Client threads, i.e. maximum requests in flight
+    uint64_t requests = 0;         ///< Stop after this many requests (0 = no limit)
+    double durationSeconds = 0;    ///< Stop sending after this long (0 = no limit)
+    unsigned rssIntervalMs = 250;  ///< RSS sampling period
+};
+
+struct RssSample {
+    double seconds;  ///< Since the start of the run
+    uint64_t bytes;
+};
+
+struct LoadReport {
+    uint64_t sent = 0;       ///< Requests submitted, including rejected ones
+    uint64_t completed = 0;  ///< Requests that returned styles
+    uint64_t failed = 0;     ///< Requests whose extraction threw
+    uint64_t rejected = 0;   ///< Submissions refused because the lane was full
+    uint64_t late = 0;       ///< Paced requests sent more than 1 ms after their due time
+    double elapsedSeconds = 0;
+    LatencyHistogram latency;      ///< Due time (or send time, closed loop) to completion, microseconds
+    LatencyHistogram serviceTime;  ///< Submit to completion, microseconds
+    std::map<std::string, uint64_t> errors;  ///< Distinct error messages (at most 32) and their counts
+    std::vector<RssSample> rss;              ///< Empty where RSS is unknown
+    ServiceStats service;                    ///< Service counters at the end of the run
+
+    /// Completed requests per second
+    double throughput() const;
+    /// (failed + rejected) / sent
+    double errorRate() const;
+    /**
+     * @brief RSS growth in bytes per minute, least squares over the samples
+     *
+     * The first fifth of the run is left out as warm-up (caches, allocator
+     * pools and thread stacks filling). 0 with fewer than two samples.
+     */
+    double rssDriftPerMinute() const;
+};
+
+/**
+ * @brief Resident set size of this process in bytes; 0 where unknown
+ */
+uint64_t currentRssBytes();
+
+/**
+ * @brief Replays requests against the service until the request or duration limit
+ *
+ * Requests are reused round-robin; without either limit each is sent once.
+ * A recorded log repeats with its own period.
+ * @throws std::runtime_error if requests is empty or an option is out of range
+ */
+LoadReport runLoad(ExtractionService& service, const std::vector<LoadRequest>& requests,
+                   const LoadOptions& options);
+
+} // namespace DocxParser
+
+#endif // LOAD_GENERATOR_H
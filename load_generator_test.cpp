@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include "load_generator.h"
+
+using namespace DocxParser;
+
+TEST(LoadGeneratorTest, ParsesRequestLog) {
+    std::istringstream log(
+        "# offset-ms lane path\n"
+        "20\tbulk\tshared/Quarterly report.docx\r\n"
+        "\n"
+        "0 interactive sample.docx\n"
+        "  7.5   interactive   b.docx\n");
+    const auto requests = parseRequestLog(log);
+    ASSERT_EQ(requests.size(), 3u);
+    EXPECT_EQ(requests[0].path, "sample.docx");
+    EXPECT_EQ(requests[0].offsetMicros, 0u);
+    EXPECT_EQ(requests[1].offsetMicros, 7500u);
+    EXPECT_EQ(requests[2].path, "shared/Quarterly report.docx");
+    EXPECT_EQ(requests[2].lane, Lane::Bulk);
+
+    for (const char* bad : {"x interactive a.docx\n", "5 urgent a.docx\n", "5 bulk\n", "-1 bulk a.docx\n"}) {
+        std::istringstream in(bad);
+        EXPECT_THROW(parseRequestLog(in), std::runtime_error) << bad;
+    }
+}
+
+/**
+ * @brief A closed-loop run sends every request once and counts failures apart from latencies
+ */
+TEST(LoadGeneratorTest, ClosedLoopCountsRequestsAndErrors) {
+    ExtractionService service;
+    std::vector<LoadRequest> requests(3);
+    requests[0].path = "sample.docx";
+    requests[1].path = "sample.docx";
+    requests[2].path = "nonexistent.docx";
+    LoadOptions options;
+    options.concurrency = 2;
+    options.requests = 30;
+    const auto report = runLoad(service, requests, options);
+
+    EXPECT_EQ(report.sent, 30u);
+    EXPECT_EQ(report.completed, 20u);
+    EXPECT_EQ(report.failed, 10u);
+    EXPECT_EQ(report.rejected, 0u);
+    EXPECT_EQ(report.latency.count(), 30u);
+    EXPECT_EQ(report.errors.size(), 1u);
+    EXPECT_NEAR(report.errorRate(), 1.0 / 3, 1e-9);
+    EXPECT_GT(report.throughput(), 0.0);
+    EXPECT_EQ(report.service.interactive.submitted, 30u);
+    EXPECT_EQ(report.service.extractions, 1u);  // Everything else came from the cache
+    if (currentRssBytes() > 0) {
+        EXPECT_GE(report.rss.size(), 2u);
+    }
+}
+
+/**
+ * @brief A paced run sends on schedule until the duration and measures from due times
+ */
+TEST(LoadGeneratorTest, PacedRunStopsAtDuration) {
+    ExtractionService service;
+    std::vector<LoadRequest> requests(1);
+    requests[0].path = "sample.docx";
+    LoadOptions options;
+    options.rate = 200;
+    options.durationSeconds = 0.25;
+    const auto report = runLoad(service, requests, options);
+
+    EXPECT_EQ(report.sent, 50u);  // Due at 0, 5, ..., 245 ms
+    EXPECT_EQ(report.completed, 50u);
+    EXPECT_GE(report.elapsedSeconds, 0.245);
+    EXPECT_GE(report.latency.max(), report.serviceTime.percentile(0.5));
+}
+
+TEST(LoadGeneratorTest, RssDriftFitsLaterSamples) {
+    LoadReport report;
+    report.rss = {{0.0, 1000000}, {15.0, 1000}, {30.0, 2000}, {45.0, 3000}, {60.0, 4000}};
+    // The first sample falls in the warm-up fifth; the rest grow 1000 bytes per 15 s
+    EXPECT_NEAR(report.rssDriftPerMinute(), 4000.0, 1e-6);
+}
+
+TEST(LoadGeneratorTest, RejectsEmptyRunsAndBadOptions) {
+    ExtractionService service;
+    EXPECT_THROW(runLoad(service, {}, LoadOptions()), std::runtime_error);
+    LoadOptions options;
+    options.concurrency = 0;
+    EXPECT_THROW(runLoad(service, {LoadRequest{"sample.docx"}}, options), std::runtime_error);
+}
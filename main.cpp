@@ -1,13 +1,762 @@
-#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <thread>
 #include "docx_style_parser.h"
+#include "style_index.h"
+#include "typst_generator.h"
+#include "batch_runner.h"
+#include "batch_cluster.h"
+#include "jsonl_export.h"
+#include "sqlite_export.h"
+#include "extraction_service.h"
+#include "load_generator.h"
+#include "style_merge.h"
+#include "style_provenance.h"
+#ifdef TYPSTYLE_WITH_ARROW
+#include "arrow_export.h"
+#endif
 #include "spdlog/spdlog.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
 
-int main() {
+// TIP
+// Expands command line inputs into document paths.
+// An argument starting with '@' names a text file with one path per line,
+// which keeps very large corpora off the command line. .zip and .tar
+// bundles are passed through; BatchRunner expands them into their members.
+static std::vector<std::string> collectInputs(int argc, char* argv[], int first) {
+    std::vector<std::string> inputs;
+    for (int i = first; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (!arg.empty() && arg[0] == '@') {
+            std::ifstream list(arg.substr(1));
+            if (!list) {
+                throw std::runtime_error("Cannot read input list " + arg.substr(1));
+            }
+            for (std::string line; std::getline(list, line);) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (!line.empty()) inputs.push_back(line);
+            }
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    return inputs;
+}
+
+// TIP
+// Formats styles in the same layout as the default single-file mode.
+// Builds a string instead of writing to a stream so the one-shot fast path
+// can print it with a single fwrite.
+static void formatStyle(std::string& out, const StyleInfo& style) {
+    out += "\nStyle: " + style.name + " (Type: " + style.type + ")\n";
+    out += "Properties:\n";
+    if (!style.fontName.empty()) {
+        out += "  Font: " + style.fontName + "\n";
+    }
+    if (!style.fontSize.empty()) {
+        out += "  Font Size: " + style.fontSize + "\n";
+    }
+    for (const auto& prop : style.properties) {
+        out += "  " + prop.first + ": " + (prop.second.empty() ? "[no value]" : prop.second) + "\n";
+    }
+}
+
+static void formatStyles(std::string& out, const std::vector<StyleInfo>& styles) {
+    for (const auto& style : styles) formatStyle(out, style);
+}
+
+static void printStyles(std::FILE* out, const std::vector<StyleInfo>& styles) {
+    std::string text;
+    formatStyles(text, styles);
+    std::fwrite(text.data(), 1, text.size(), out);
+}
+
+// TypStyle styles <docx>
+// One-shot fast path for editor integrations that start a process per file:
+// it runs before the logger is configured and prints with stdio, so the
+// process only pays for the zip and XML work. TypStyle's sources do not
+// include <iostream> (all output goes through stdio and fmt), so no stream
+// initializer runs at start-up either.
+static int runStyles(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::fputs("Usage: TypStyle styles <docx>\n", stderr);
+        return 1;
+    }
+    // Styles are formatted as they are parsed; none are kept
+    std::string body;
+    const auto report = DocxParser::visitDocxStyles(argv[2], [&](StyleInfo& style) { formatStyle(body, style); });
+    const std::string header = "Found " + std::to_string(report.styles) + " styles:\n";
+    std::fwrite(header.data(), 1, header.size(), stdout);
+    std::fwrite(body.data(), 1, body.size(), stdout);
+    return 0;
+}
+
+// TIP
+// Options shared by every multi-document command:
+//   --threads N, --schedule fifo|size, --calibration FILE,
+//   --readahead N (prefetch window), --readahead-mode ranges|whole,
+//   --perf-counters (hardware counters per stage, no value)
+// Returns the index of the first input argument.
+static int parseBatchOptions(int argc, char* argv[], int first, DocxParser::BatchOptions& options,
+                             std::string& calibrationPath) {
+    while (first + 1 < argc && std::string(argv[first]).rfind("--", 0) == 0) {
+        const std::string flag = argv[first];
+        if (flag == "--perf-counters") {
+            options.perfCounters = true;
+            ++first;
+            continue;
+        }
+        const std::string value = argv[first + 1];
+        if (flag == "--threads") {
+            options.threads = std::stoul(value);
+        } else if (flag == "--schedule") {
+            if (value != "fifo" && value != "size") throw std::invalid_argument("--schedule takes fifo or size: " + value);
+            options.policy = value == "fifo" ? DocxParser::SchedulePolicy::Fifo
+                                             : DocxParser::SchedulePolicy::LargestFirst;
+        } else if (flag == "--calibration") {
+            calibrationPath = value;
+            options.costModel = DocxParser::CostModel::load(value);
+        } else if (flag == "--readahead") {
+            options.readahead.maxWindow = std::stoul(value);
+        } else if (flag == "--readahead-mode") {
+            if (value != "ranges" && value != "whole") {
+                throw std::invalid_argument("--readahead-mode takes ranges or whole: " + value);
+            }
+            options.readahead.rangesOnly = value == "ranges";
+        } else {
+            break;
+        }
+        first += 2;
+    }
+    return first;
+}
+
+// TIP
+// One line per document class and stage: per-document means of the counted
+// events, plus IPC. Missing counters are reported once and skipped.
+static void logPerfReport(const DocxParser::PerfReport& perf) {
+    if (!perf.enabled) return;
+    if (!perf.available) {
+        spdlog::warn("Performance counters unavailable ({}); timings only", perf.status);
+        return;
+    }
+    if (!perf.status.empty()) spdlog::warn("Some performance counters missing: {}", perf.status);
+    for (const auto& counters : perf.classes) {
+        for (size_t s = 0; s < DocxParser::kBatchStages; ++s) {
+            const auto& sample = counters.stages[s];
+            if (sample[DocxParser::PerfEvent::Cycles] + sample[DocxParser::PerfEvent::Instructions] == 0) continue;
+            std::string line;
+            for (size_t e = 0; e < DocxParser::kPerfEvents; ++e) {
+                if (!perf.counted[e]) continue;
+                const auto event = static_cast<DocxParser::PerfEvent>(e);
+                line += fmt::format(" {} {:.0f},", DocxParser::perfEventName(event),
+                                    double(sample[event]) / counters.documents);
+            }
+            if (perf.counted[size_t(DocxParser::PerfEvent::Cycles)] &&
+                perf.counted[size_t(DocxParser::PerfEvent::Instructions)]) {
+                line += fmt::format(" IPC {:.2f}", sample.ipc());
+            } else if (!line.empty()) {
+                line.pop_back();
+            }
+            spdlog::info("Perf [{}, {} docs] {}:{}", counters.name, counters.documents,
+                         DocxParser::batchStageName(static_cast<DocxParser::BatchStage>(s)), line);
+        }
+    }
+}
+
+// TIP
+// Runs a batch over the remaining arguments, logs failures and the
+// scheduling report, and stores the refitted cost model if requested.
+// onItem, if set, sees every item on its worker thread as soon as it is done.
+// Without retainStyles the returned items keep no styles: onItem is the only
+// place to take them (it may move them out).
+static std::vector<DocxParser::BatchItem> runBatch(int argc, char* argv[], int first,
+                                                   std::function<void(DocxParser::BatchItem&)> onItem = {},
+                                                   const StreamOptions& stream = {}, bool retainStyles = true) {
+    DocxParser::BatchOptions options;
+    options.onItem = std::move(onItem);
+    options.stream = stream;
+    options.retainStyles = retainStyles;
+    std::string calibrationPath;
+    first = parseBatchOptions(argc, argv, first, options, calibrationPath);
+
+    DocxParser::BatchRunner runner(options);
+    auto items = runner.run(collectInputs(argc, argv, first));
+    for (const auto& item : items) {
+        if (!item.error.empty()) {
+            // One broken document should not abort a corpus-wide run
+            spdlog::warn("Skipping {}: {}", item.document.path, item.error);
+        }
+    }
+
+    const auto& report = runner.report();
+    spdlog::info("{} documents ({} failed) on {} threads: makespan {:.1f} ms, work {:.1f} ms; "
+                 "replayed FIFO {:.1f} ms vs largest-first {:.1f} ms",
+                 items.size(), report.failed, report.threads, report.makespanMs, report.totalWorkMs,
+                 report.fifoMakespanMs, report.largestFirstMakespanMs);
+    const auto& inputs = report.inputs;
+    if (inputs.zip != items.size()) {
+        spdlog::info("Inputs: {} zip, {} flat XML, {} CFB ({} encrypted/IRM), {} Pages, {} unknown",
+                     inputs.zip, inputs.flatXml, inputs.cfb, inputs.encrypted, inputs.pagesBundle, inputs.unknown);
+    }
+    if (report.readahead.prefetched + report.readahead.unreadable > 0) {
+        spdlog::info("Readahead: {} files advised, window up to {}, {:.0f} us mean prefetch I/O",
+                     report.readahead.prefetched, report.readahead.largestWindow, report.readahead.meanIoMicros);
+    }
+    logPerfReport(report.perf);
+    if (!calibrationPath.empty()) {
+        report.calibrated.save(calibrationPath);
+    }
+    return items;
+}
+
+// TypStyle batch [options] <docx|@list>...
+static int runBatchDump(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::fputs("Usage: TypStyle batch [--threads N] [--schedule fifo|size] "
+                   "[--calibration FILE] [--readahead N] [--readahead-mode ranges|whole] [--perf-counters] "
+                   "<docx|@list>...\n", stderr);
+        return 1;
+    }
+    for (const auto& item : runBatch(argc, argv, 2)) {
+        if (!item.error.empty()) continue;
+        fmt::print("\n== {}\n", item.document.path);
+        printStyles(stdout, item.document.styles);
+    }
+    return 0;
+}
+
+// TypStyle typst <docx> [--flatten] [--explain STYLE]
+// Writes a Typst module with one function per style; every function wraps
+// its basedOn parent unless --flatten asks for fully resolved styles. Heading
+// styles with an outline level also get a show rule per heading level.
+// --explain prints instead where each effective property of one style (by
+// name or styleId) comes from: the style, a basedOn ancestor, docDefaults
+// or the theme.
+static int runTypst(int argc, char* argv[]) {
+    DocxParser::TypstOptions options;
+    const char* input = nullptr;
+    const char* explain = nullptr;
+    for (int i = 2; i < argc; ++i) {
+        if (std::string(argv[i]) == "--flatten") {
+            options.flatten = true;
+        } else if (std::string(argv[i]) == "--explain" && i + 1 < argc) {
+            explain = argv[++i];
+        } else {
+            input = argv[i];
+        }
+    }
+    if (!input) {
+        std::fputs("Usage: TypStyle typst <docx> [--flatten] [--explain STYLE]\n", stderr);
+        return 1;
+    }
+    // All styles: quick-format styles are usually basedOn hidden ones
+    const auto sheet = DocxParser::extractDocxStyleSheet(input);
+    if (explain) {
+        const DocxParser::ResolvedStyleSheet resolved(sheet, DocxParser::readDocxThemeFonts(input));
+        std::fputs(DocxParser::explainStyle(resolved, explain).c_str(), stdout);
+        return 0;
+    }
+    const std::string module = DocxParser::generateTypst(sheet, options);
+    std::fwrite(module.data(), 1, module.size(), stdout);
+    return 0;
+}
+
+// TypStyle merge <out.typ> [--group-by name|styleId] [--choose NAME=N]... [--prefer DOCX]
+//                [batch options] <docx|@list>...
+// Merges many templates into one style library. Styles are grouped across
+// documents, each group's variants (distinct resolved definitions) are
+// counted, and the library takes the majority variant unless --choose
+// (1-based, as numbered in the report) or --prefer says otherwise. The
+// report of groups with more than one variant goes to stdout.
+static int runMerge(int argc, char* argv[]) {
+    DocxParser::MergeKey key = DocxParser::MergeKey::Name;
+    DocxParser::MergeChoice choice;
+    int first = 3;
+    while (first + 1 < argc && std::string(argv[first]).rfind("--", 0) == 0) {
+        const std::string flag = argv[first];
+        const std::string value = argv[first + 1];
+        if (flag == "--group-by") {
+            if (value != "name" && value != "styleId") throw std::runtime_error("--group-by takes name or styleId");
+            key = value == "name" ? DocxParser::MergeKey::Name : DocxParser::MergeKey::StyleId;
+        } else if (flag == "--choose") {
+            const size_t equals = value.rfind('=');
+            const unsigned long variant = equals == std::string::npos ? 0 : std::stoul(value.substr(equals + 1));
+            if (variant == 0) throw std::runtime_error("--choose takes NAME=N with N counted from 1: " + value);
+            choice.chosen[value.substr(0, equals)] = variant - 1;
+        } else if (flag == "--prefer") {
+            choice.preferDocument = value;
+        } else {
+            break;  // Batch options follow
+        }
+        first += 2;
+    }
+    if (argc <= first) {
+        std::fputs("Usage: TypStyle merge <out.typ> [--group-by name|styleId] [--choose NAME=N]... "
+                   "[--prefer DOCX] [batch options] <docx|@list>...\n", stderr);
+        return 1;
+    }
+
+    // Every style, not just quick-format ones: variants are compared after basedOn resolution
+    StreamOptions stream;
+    stream.quickFormatOnly = false;
+    DocxParser::StyleMerger merger(key);
+    // The merger keeps what it needs per variant; the batch drops each document's styles after this
+    runBatch(argc, argv, first, [&](const DocxParser::BatchItem& item) {
+        if (item.error.empty()) merger.addDocument(item.index, item.document.path, item.document.styles);
+    }, stream, false);
+
+    const auto groups = merger.groups();
+    const auto library = merger.library(groups, choice);
+    size_t conflicts = 0, styles = 0;
+    for (size_t g = 0; g < groups.size(); ++g) {
+        const auto& group = groups[g];
+        for (const auto& variant : group.variants) styles += variant.count();
+        if (group.variants.size() < 2) continue;
+        ++conflicts;
+        const auto& chosen = group.variants[library.variant[g]];
+        fmt::print("{} ({}): {} variants\n", group.name, group.type, group.variants.size());
+        for (size_t v = 0; v < group.variants.size(); ++v) {
+            const auto& variant = group.variants[v];
+            fmt::print("{}{}: {} {}, first {}", v == library.variant[g] ? "  * " : "    ", v + 1, variant.count(),
+                       variant.count() == 1 ? "document" : "documents", merger.documentPath(variant.documents.front()));
+            std::string separator = "; ";
+            for (const auto& difference : DocxParser::describeDifferences(variant.properties, chosen.properties)) {
+                fmt::print("{}{}", separator, difference);
+                separator = ", ";
+            }
+            std::fputs("\n", stdout);
+        }
+    }
+
+    std::ofstream out(argv[2], std::ios::binary);
+    const std::string module = DocxParser::generateTypst(library.sheet);
+    if (!out.write(module.data(), module.size())) {
+        throw std::runtime_error(std::string("Cannot write ") + argv[2]);
+    }
+    spdlog::info("Merged {} styles from {} documents into {} library styles; {} with more than one variant",
+                 styles, merger.documents(), groups.size(), conflicts);
+    return 0;
+}
+
+// TypStyle cache-warm <cache-dir> [--budget-mb N] [--threads N] <docx|@manifest>...
+// Pre-populates the disk cache before peak hours. Re-warming after templates
+// were edited only reparses the styles that changed.
+static int runCacheWarm(int argc, char* argv[]) {
+    DocxParser::ServiceOptions options;
+    size_t threads = std::thread::hardware_concurrency();
+    int first = 3;
+    while (first + 1 < argc && std::string(argv[first]).rfind("--", 0) == 0) {
+        const std::string flag = argv[first];
+        if (flag == "--budget-mb") {
+            options.cache.warmBytes = std::stoull(argv[first + 1]) << 20;
+        } else if (flag == "--threads") {
+            threads = std::stoul(argv[first + 1]);
+        } else {
+            break;
+        }
+        first += 2;
+    }
+    if (argc <= first) {
+        std::fputs("Usage: TypStyle cache-warm <cache-dir> [--budget-mb N] [--threads N] <docx|@manifest>...\n", stderr);
+        return 1;
+    }
+    options.cache.warmDirectory = argv[2];
+    options.cache.hotBytes = 0;  // Nothing is served from this process
+
+    DocxParser::ExtractionService service(options);
+    const auto inputs = collectInputs(argc, argv, first);
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < std::max<size_t>(1, threads); ++w) {
+        workers.emplace_back([&] {
+            for (size_t i = next++; i < inputs.size(); i = next++) {
+                try {
+                    service.extract(inputs[i]);
+                } catch (const std::exception& e) {
+                    spdlog::warn("Skipping {}: {}", inputs[i], e.what());
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    const auto stats = service.stats();
+    fmt::print("Warmed {}: {} requests, {} extracted ({} styles reused from earlier versions), {} already cached, "
+               "{} evicted, {} bytes on disk\n",
+               argv[2], stats.requests, stats.extractions, stats.reusedStyles, stats.warm.hits,
+               stats.warm.evictions, stats.warm.bytes);
+    return 0;
+}
+
+// TypStyle loadgen [load options] <docx|@list>...
+// Replays a corpus (or --log <request-log>) against an in-process service and
+// reports latency percentiles, errors, throughput and RSS drift. Exits with 1
+// when a --max-* limit is exceeded, so it can gate a rollout or run in ctest.
+static int runLoadgen(int argc, char* argv[]) {
+    DocxParser::LoadOptions load;
+    DocxParser::ServiceOptions options;
+    DocxParser::Lane lane = DocxParser::Lane::Interactive;
+    std::string logPath, rssLogPath;
+    double maxErrorRate = -1, maxP99Ms = -1, maxRssDriftMb = -1;
+    int first = 2;
+    while (first + 1 < argc && std::string(argv[first]).rfind("--", 0) == 0) {
+        const std::string flag = argv[first];
+        const std::string value = argv[first + 1];
+        if (flag == "--rate") {
+            load.rate = std::stod(value);
+        } else if (flag == "--concurrency") {
+            load.concurrency = std::stoul(value);
+        } else if (flag == "--requests") {
+            load.requests = std::stoull(value);
+        } else if (flag == "--duration") {
+            load.durationSeconds = std::stod(value);
+        } else if (flag == "--speed") {
+            load.speed = std::stod(value);
+        } else if (flag == "--rss-interval-ms") {
+            load.rssIntervalMs = std::stoul(value);
+        } else if (flag == "--workers") {
+            options.workers = std::stoul(value);
+        } else if (flag == "--cache-mb") {
+            options.cache.hotBytes = std::stoull(value) << 20;
+        } else if (flag == "--lane") {
+            if (value != "interactive" && value != "bulk") throw std::runtime_error("Unknown lane " + value);
+            lane = value == "bulk" ? DocxParser::Lane::Bulk : DocxParser::Lane::Interactive;
+        } else if (flag == "--log") {
+            logPath = value;
+        } else if (flag == "--rss-log") {
+            rssLogPath = value;
+        } else if (flag == "--max-error-rate") {
+            maxErrorRate = std::stod(value);
+        } else if (flag == "--max-p99-ms") {
+            maxP99Ms = std::stod(value);
+        } else if (flag == "--max-rss-drift-mb") {
+            maxRssDriftMb = std::stod(value);
+        } else {
+            break;
+        }
+        first += 2;
+    }
+    std::vector<DocxParser::LoadRequest> requests;
+    if (!logPath.empty()) {
+        requests = DocxParser::readRequestLog(logPath);
+    } else {
+        for (const auto& path : collectInputs(argc, argv, first)) {
+            requests.push_back({path, lane, 0});
+        }
+    }
+    if (requests.empty()) {
+        std::fputs("Usage: TypStyle loadgen [--rate N] [--concurrency N] [--requests N] [--duration S]\n"
+                   "    [--lane interactive|bulk] [--workers N] [--cache-mb N] [--rss-interval-ms N] [--rss-log FILE]\n"
+                   "    [--max-error-rate X] [--max-p99-ms X] [--max-rss-drift-mb X]\n"
+                   "    (<docx|@list>... | --log <request-log> [--speed X])\n", stderr);
+        return 1;
+    }
+
+    DocxParser::ExtractionService service(options);
+    const auto report = DocxParser::runLoad(service, requests, load);
+
+    const auto ms = [](uint64_t micros) { return micros / 1000.0; };
+    const auto mib = [](double bytes) { return bytes / (1 << 20); };
+    fmt::print("Load: {} sent, {} ok, {} failed, {} rejected in {:.2f} s ({:.1f} req/s, error rate {:.4f})\n",
+               report.sent, report.completed, report.failed, report.rejected,
+               report.elapsedSeconds, report.throughput(), report.errorRate());
+    for (const auto* histogram : {&report.latency, &report.serviceTime}) {
+        fmt::print("{} ms: p50 {:.3f}  p90 {:.3f}  p99 {:.3f}  p999 {:.3f}  max {:.3f}  mean {:.3f}\n",
+                   histogram == &report.latency ? "Latency" : "Service time",
+                   ms(histogram->percentile(0.5)), ms(histogram->percentile(0.9)),
+                   ms(histogram->percentile(0.99)), ms(histogram->percentile(0.999)),
+                                 ms(histogram->max()), histogram->mean() / 1000.0);
+    }
+    if (report.late) {
+        spdlog::warn("{} requests left more than 1 ms after their due time (clients busy or "
+                     "scheduler delay); their latency includes the wait", report.late);
+    }
+    if (!report.rss.empty()) {
+        uint64_t peak = 0;
+        for (const auto& sample : report.rss) peak = std::max(peak, sample.bytes);
+        fmt::print("RSS MiB: start {:.1f}  end {:.1f}  peak {:.1f}  drift {:+.2f}/min ({} samples)\n",
+                   mib(report.rss.front().bytes), mib(report.rss.back().bytes), mib(peak),
+                   mib(report.rssDriftPerMinute()), report.rss.size());
+    }
+    fmt::print("Service: {} extractions, {} coalesced, {} hot hits, {} hot misses\n",
+               report.service.extractions, report.service.coalesced,
+               report.service.hot.hits, report.service.hot.misses);
+    for (const auto& [message, count] : report.errors) {
+        fmt::print("Error x{}: {}\n", count, message);
+    }
+    if (!rssLogPath.empty()) {
+        std::ofstream rssLog(rssLogPath);
+        rssLog << "seconds\trss_bytes\n";
+        for (const auto& sample : report.rss) rssLog << sample.seconds << "\t" << sample.bytes << "\n";
+    }
+
+    bool failed = false;
+    if (maxErrorRate >= 0 && report.errorRate() > maxErrorRate) {
+        spdlog::warn("Error rate {:.4f} exceeds {}", report.errorRate(), maxErrorRate);
+        failed = true;
+    }
+    if (maxP99Ms >= 0 && ms(report.latency.percentile(0.99)) > maxP99Ms) {
+        spdlog::warn("p99 latency {:.3f} ms exceeds {} ms", ms(report.latency.percentile(0.99)), maxP99Ms);
+        failed = true;
+    }
+    if (maxRssDriftMb >= 0 && mib(report.rssDriftPerMinute()) > maxRssDriftMb) {
+        spdlog::warn("RSS drift {:.2f} MiB/min exceeds {} MiB/min", mib(report.rssDriftPerMinute()), maxRssDriftMb);
+        failed = true;
+    }
+    return failed ? 1 : 0;
+}
+
+// TypStyle index <index-file> <docx|@list>...
+static int runIndex(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::fputs("Usage: TypStyle index <index-file> [batch options] <docx|@list>...\n", stderr);
+        return 1;
+    }
+    DocxParser::StyleIndexBuilder builder;
+    for (const auto& item : runBatch(argc, argv, 3)) {
+        if (item.error.empty()) builder.addDocument(item.document.path, item.document.styles);
+    }
+    builder.write(argv[2]);
+    fmt::print("Indexed {} styles from {} documents\n", builder.styleCount(), builder.documentCount());
+    return 0;
+}
+
+// TypStyle query <index-file> <key=value>...
+static int runQuery(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::fputs("Usage: TypStyle query <index-file> <key=value>...\n"
+                   "Keys: font, size, name, type or any style property (e.g. outlineLvl)\n", stderr);
+        return 1;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    DocxParser::StyleIndexReader reader(argv[2]);
+    std::vector<std::string> terms(argv + 3, argv + argc);
+    auto hits = reader.query(terms);
+    const auto elapsed = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    for (uint32_t ordinal : hits) {
+        auto hit = reader.describe(ordinal);
+        fmt::print("{}\t{}\n", hit.documentPath, hit.styleName);
+    }
+    fmt::print(stderr, "{} matching styles across {} documents in {:g} ms\n", hits.size(), reader.documentCount(),
+               elapsed);
+    return 0;
+}
+
+// TypStyle coordinator <out-dir> [--port N] [--lease-size N] [--lease-seconds N] <docx|@manifest>...
+// Hands out ranges of the manifest to agents and collects their result shards.
+static int runCoordinator(int argc, char* argv[]) {
+    DocxParser::CoordinatorOptions options;
+    int first = 3;
+    while (first + 1 < argc && std::string(argv[first]).rfind("--", 0) == 0) {
+        const std::string flag = argv[first];
+        if (flag == "--port") {
+            options.port = static_cast<uint16_t>(std::stoul(argv[first + 1]));
+        } else if (flag == "--lease-size") {
+            options.leaseSize = std::stoul(argv[first + 1]);
+        } else if (flag == "--lease-seconds") {
+            options.leaseTimeout = std::chrono::seconds(std::stoul(argv[first + 1]));
+        } else {
+            break;
+        }
+        first += 2;
+    }
+    if (argc <= first) {
+        std::fputs("Usage: TypStyle coordinator <out-dir> [--port N] [--lease-size N] "
+                   "[--lease-seconds N] <docx|@manifest>...\n", stderr);
+        return 1;
+    }
+    options.outputDirectory = argv[2];
+
+    DocxParser::BatchCoordinator coordinator(collectInputs(argc, argv, first), options);
+    spdlog::info("Coordinator listening on port {}", coordinator.port());
+    const auto report = coordinator.run();
+    spdlog::info("{} documents ({} failed) in {} ranges: {} leases granted, {} expired, {} stale results",
+                 report.documents, report.failedDocuments, report.ranges, report.leasesGranted,
+                 report.leasesExpired, report.staleResults);
+    for (const auto& file : report.shardFiles) fmt::print("{}\n", file);
+    return 0;
+}
+
+// TypStyle agent <host> <port> [--name NAME] [batch options]
+// Works coordinator leases with the local parallel engine until the batch is done.
+static int runAgent(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::fputs("Usage: TypStyle agent <host> <port> [--name NAME] [--threads N] "
+                   "[--schedule fifo|size] [--calibration FILE]\n", stderr);
+        return 1;
+    }
+    DocxParser::AgentOptions options;
+    options.host = argv[2];
+    options.port = static_cast<uint16_t>(std::stoul(argv[3]));
+    int first = 4;
+    if (first + 1 < argc && std::string(argv[first]) == "--name") {
+        options.name = argv[first + 1];
+        first += 2;
+    }
+    std::string calibrationPath;
+    parseBatchOptions(argc, argv, first, options.batch, calibrationPath);
+
+    const size_t ranges = DocxParser::runBatchAgent(options);
+    spdlog::info("Agent {} completed {} ranges", options.name, ranges);
+    return 0;
+}
+
+// TypStyle export-jsonl <prefix> [--writers N] [--shard-mb N] [--level N] [batch options] <docx|@list>...
+// Documents are compressed by the batch workers as they finish, while the rest are
+// still extracting, and dropped right after; the corpus is never held in memory.
+static int runExportJsonl(int argc, char* argv[]) {
+    DocxParser::JsonlExportOptions options;
+    int first = 3;
+    while (first + 1 < argc && std::string(argv[first]).rfind("--", 0) == 0) {
+        const std::string flag = argv[first];
+        if (flag == "--writers") {
+            options.writers = std::stoul(argv[first + 1]);
+        } else if (flag == "--shard-mb") {
+            options.shardBytes = std::stoull(argv[first + 1]) << 20;
+        } else if (flag == "--level") {
+            options.level = std::stoi(argv[first + 1]);
+        } else {
+            break;  // Batch options follow
+        }
+        first += 2;
+    }
+    if (argc <= first) {
+        std::fputs("Usage: TypStyle export-jsonl <prefix> [--writers N] [--shard-mb N] [--level N] "
+                   "[batch options] <docx|@list>...\n", stderr);
+        return 1;
+    }
+    DocxParser::JsonlExporter exporter(argv[2], options);
+    std::atomic<size_t> exported{0};
+    runBatch(argc, argv, first, [&](const DocxParser::BatchItem& item) {
+        if (!item.error.empty()) return;
+        exporter.add(item.document);
+        ++exported;
+    }, {}, false);
+    const auto report = exporter.finish();
+    spdlog::info("{} documents: {} JSON bytes compressed to {} in {} shards",
+                 exported.load(), report.jsonBytes, report.compressedBytes, report.shardFiles.size());
+    for (const auto& file : report.shardFiles) fmt::print("{}\n", file);
+    fmt::print("{}\n", report.indexFile);
+    return 0;
+}
+
+// TypStyle export-sqlite <database> [--transaction-rows N] [batch options] <docx|@list>...
+// Rows are inserted by a writer thread while the batch is still extracting;
+// each document is moved into its queue, not copied, and not kept by the batch.
+static int runExportSqlite(int argc, char* argv[]) {
+    DocxParser::SqliteExportOptions options;
+    int first = 3;
+    if (argc > 4 && std::string(argv[3]) == "--transaction-rows") {
+        options.rowsPerTransaction = std::stoul(argv[4]);
+        first = 5;
+    }
+    if (argc <= first) {
+        std::fputs("Usage: TypStyle export-sqlite <database> [--transaction-rows N] "
+                   "[batch options] <docx|@list>...\n", stderr);
+        return 1;
+    }
+    DocxParser::SqliteExporter exporter(argv[2], options);
+    runBatch(argc, argv, first, [&](DocxParser::BatchItem& item) {
+        if (item.error.empty()) exporter.add(DocumentStyles{item.document.path, std::move(item.document.styles)});
+    }, {}, false);
+    const auto report = exporter.finish();
+    spdlog::info("SQLite: {} templates, {} styles, {} properties in {} transactions; "
+                 "inserts {:.1f} ms, indexes {:.1f} ms",
+                 report.templates, report.styles, report.properties, report.transactions,
+                 report.insertMs, report.indexMs);
+    return 0;
+}
+
+// TypStyle jsonl-get <index-file> <docx>...
+// Prints the exported records of single documents without decompressing whole shards.
+static int runJsonlGet(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::fputs("Usage: TypStyle jsonl-get <index-file> <docx>...\n", stderr);
+        return 1;
+    }
+    DocxParser::JsonlShardIndex index(argv[2]);
+    int missing = 0;
+    for (int i = 3; i < argc; ++i) {
+        const auto* entry = index.find(argv[i]);
+        if (!entry) {
+            spdlog::warn("{} is not in the export", argv[i]);
+            ++missing;
+            continue;
+        }
+        fmt::print("{}\n", index.read(*entry));
+    }
+    return missing ? 1 : 0;
+}
+
+#ifdef TYPSTYLE_WITH_ARROW
+// TypStyle export-arrow <prefix> [--shards N] [batch options] <docx|@list>...
+static int runExportArrow(int argc, char* argv[]) {
+    int first = 3;
+    size_t shards = std::thread::hardware_concurrency();
+    if (argc > 4 && std::string(argv[3]) == "--shards") {
+        shards = std::stoul(argv[4]);
+        first = 5;
+    }
+    if (argc <= first) {
+        std::fputs("Usage: TypStyle export-arrow <prefix> [--shards N] [batch options] <docx|@list>...\n", stderr);
+        return 1;
+    }
+    // Rows go into the shard builders as documents finish; nothing is kept per item
+    DocxParser::ArrowExporter exporter(argv[2], {shards});
+    runBatch(argc, argv, first, [&](DocxParser::BatchItem& item) {
+        if (item.error.empty()) exporter.add(item.document);
+    }, {}, false);
+    for (const auto& file : exporter.finish()) fmt::print("{}\n", file);
+    return 0;
+}
+#endif
+
+int main(int argc, char* argv[]) {
     try {
+        if (argc > 1) {
+            const std::string command = argv[1];
+            // Before anything else is set up; see runStyles()
+            if (command == "styles") return runStyles(argc, argv);
+
+            // Subcommands write results to stdout; keep log lines out of it
+            spdlog::set_default_logger(spdlog::stderr_color_mt("stderr"));
+            if (command == "batch") return runBatchDump(argc, argv);
+            if (command == "typst") return runTypst(argc, argv);
+            if (command == "index") return runIndex(argc, argv);
+            if (command == "merge") return runMerge(argc, argv);
+            if (command == "cache-warm") return runCacheWarm(argc, argv);
+            if (command == "loadgen") return runLoadgen(argc, argv);
+            if (command == "query") return runQuery(argc, argv);
+            if (command == "coordinator") return runCoordinator(argc, argv);
+            if (command == "agent") return runAgent(argc, argv);
+            if (command == "export-jsonl") return runExportJsonl(argc, argv);
+            if (command == "jsonl-get") return runJsonlGet(argc, argv);
+            if (command == "export-sqlite") return runExportSqlite(argc, argv);
+#ifdef TYPSTYLE_WITH_ARROW
+            if (command == "export-arrow") return runExportArrow(argc, argv);
+#else
+            if (command == "export-arrow") {
+                std::fputs("export-arrow is not in this build; configure with -DTYPSTYLE_WITH_ARROW=ON\n", stderr);
+                return 1;
+            }
+#endif
+            fmt::print(stderr, "Unknown command: {}\n"
+                       "Usage: TypStyle [styles|typst|batch|index|merge|query|cache-warm|loadgen|coordinator|agent|"
+                       "export-jsonl|jsonl-get|export-sqlite|export-arrow] ...\n", command);
+            return 1;
+        }
+
         // TIP
         // Extract and display DOCX styles
         const std::string docxPath = "sample.docx";
-        std::cout << "\nExtracting styles from " << docxPath << "...\n";
+        fmt::print("\nExtracting styles from {}...\n", docxPath);
 
         // TIP
         // Check if file exists first
@@ -21,35 +770,21 @@ int main() {
             auto styles = DocxParser::extractDocxStyles(docxPath);
 
             if (styles.empty()) {
-                std::cout << "No styles found in the document.\n";
+                std::fputs("No styles found in the document.\n", stdout);
             } else {
-                std::cout << "Found " << styles.size() << " styles:\n";
-                for (const auto& style : styles) {
-                    std::cout << "\nStyle: " << style.name
-                              << " (Type: " << style.type << ")\n";
-                    std::cout << "Properties:\n";
-                    if (!style.fontName.empty()) {
-                        std::cout << "  Font: " << style.fontName << "\n";
-                    }
-                    if (!style.fontSize.empty()) {
-                        std::cout << "  Font Size: " << style.fontSize << "\n";
-                    }
-                    for (const auto& prop : style.properties) {
-                        std::cout << "  " << prop.first << ": "
-                             << (prop.second.empty() ? "[no value]" : prop.second) << "\n";
-                    }
-                }
+                fmt::print("Found {} styles:\n", styles.size());
+                printStyles(stdout, styles);
             }
         } else {
-            std::cerr << "Error: File not found - " << docxPath << "\n";
-            std::cerr << "Please ensure the file exists in the same directory as the executable.\n";
+            fmt::print(stderr, "Error: File not found - {}\n", docxPath);
+            std::fputs("Please ensure the file exists in the same directory as the executable.\n", stderr);
             return 1;
         }
     } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
+        fmt::print(stderr, "Error: {}\n", e.what());
         return 1;
     } catch (...) {
-        std::cerr << "Unknown error occurred" << std::endl;
+        std::fputs("Unknown error occurred\n", stderr);
         return 1;
     }
 
@@ -0,0 +1,112 @@
+// Standard C++ headers
+#include <stdexcept>  // For runtime_error
+#include <utility>    // For exchange
+
+// Platform headers for memory mapping
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>     // For open
+#include <sys/mman.h>  // For mmap, munmap
+#include <sys/stat.h>  // For fstat
+#include <unistd.h>    // For close
+#endif
+
+// Project header
+#include "mapped_file.h"
+
+using namespace std;
+
+namespace DocxParser {
+
+#ifdef _WIN32
+    MappedFile::MappedFile(const string& path) {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw runtime_error("Failed to open file for mapping: " + path);
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            CloseHandle(file);
+            throw runtime_error("Failed to read file size: " + path);
+        }
+        size_ = static_cast<size_t>(size.QuadPart);
+        if (size_ > 0) {
+            mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_) {
+                data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+            }
+        }
+        // The mapping keeps the file alive; the handle is no longer needed
+        CloseHandle(file);
+        if (size_ > 0 && !data_) {
+            release();
+            throw runtime_error("Failed to map file: " + path);
+        }
+    }
+
+    void MappedFile::release() noexcept {
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        data_ = nullptr;
+        mapping_ = nullptr;
+        size_ = 0;
+    }
+#else
+    MappedFile::MappedFile(const string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw runtime_error("Failed to open file for mapping: " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw runtime_error("Failed to read file size: " + path);
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ > 0) {
+            void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                throw runtime_error("Failed to map file: " + path);
+            }
+            data_ = static_cast<const char*>(mapped);
+        }
+        // The mapping keeps the file alive; the descriptor is no longer needed
+        ::close(fd);
+    }
+
+    void MappedFile::release() noexcept {
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+#endif
+
+    MappedFile::~MappedFile() {
+        release();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : data_(exchange(other.data_, nullptr)), size_(exchange(other.size_, 0)) {
+#ifdef _WIN32
+        mapping_ = exchange(other.mapping_, nullptr);
+#endif
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = exchange(other.data_, nullptr);
+            size_ = exchange(other.size_, 0);
+#ifdef _WIN32
+            mapping_ = exchange(other.mapping_, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+} // namespace DocxParser
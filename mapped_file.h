@@ -0,0 +1,46 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace DocxParser {
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * @details
+ * The operating system pages the file in on demand and shares the pages
+ * with its file cache, so reading a snapshot or a large bundle costs no
+ * copy into a heap buffer. Uses mmap on POSIX and MapViewOfFile on Windows.
+ * Empty files are valid and map to a null pointer with size 0.
+ */
+class MappedFile {
+public:
+    /**
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    void release() noexcept;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* mapping_ = nullptr;  ///< HANDLE of the file mapping object
+#endif
+};
+
+} // namespace DocxParser
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,183 @@
+// Standard C++ headers
+#include <cerrno>   // For errno
+#include <cstring>  // For memset, strerror
+
+// Platform headers for the perf_event_open syscall
+#ifdef __linux__
+#include <linux/perf_event.h>  // For perf_event_attr
+#include <sys/ioctl.h>         // For PERF_EVENT_IOC_ENABLE
+#include <sys/syscall.h>       // For SYS_perf_event_open (there is no libc wrapper)
+#include <unistd.h>            // For syscall, read, close
+#endif
+
+// Project header
+#include "perf_counters.h"
+
+using namespace std;
+
+/*
+ * Performance Counters - Implementation Notes
+ *
+ * All events form one group, so they are scheduled onto the PMU together
+ * and one read() returns them all:
+ *
+ *   { nr, time_enabled, time_running, value[nr] }
+ *
+ * The first event that opens leads the group. The group is enabled once and
+ * left running; start() and stop() read it, and a sample is the difference.
+ * If the kernel multiplexed the group (more events than hardware counters,
+ * or another perf user), time_running < time_enabled and the deltas are
+ * scaled by enabled / running, like `perf stat` does.
+ *
+ * exclude_kernel and exclude_hv keep the counters usable at
+ * perf_event_paranoid 2, the usual default; kernel time spent in read() or
+ * page faults of a stage is therefore not counted.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    const char* const kEventNames[kPerfEvents] = {
+        "cycles", "instructions", "L1d-misses", "LLC-misses", "branch-misses",
+    };
+
+#ifdef __linux__
+    void describe(perf_event_attr& attr, PerfEvent event) {
+        switch (event) {
+            case PerfEvent::Cycles:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case PerfEvent::Instructions:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case PerfEvent::L1dMisses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                              PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+                break;
+            case PerfEvent::LlcMisses:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            case PerfEvent::BranchMisses:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+        }
+    }
+#endif
+
+} // namespace
+
+    const char* perfEventName(PerfEvent event) {
+        return kEventNames[static_cast<size_t>(event)];
+    }
+
+    PerfSample& PerfSample::operator+=(const PerfSample& other) {
+        for (size_t i = 0; i < kPerfEvents; ++i) values[i] += other.values[i];
+        return *this;
+    }
+
+    double PerfSample::ipc() const {
+        const uint64_t cycles = (*this)[PerfEvent::Cycles];
+        return cycles ? double((*this)[PerfEvent::Instructions]) / double(cycles) : 0.0;
+    }
+
+    PerfCounters::PerfCounters() {
+        fds_.fill(-1);
+        slot_.fill(0);
+#ifdef __linux__
+        string failures;
+        int firstError = 0;
+        bool sameError = true;
+        for (size_t i = 0; i < kPerfEvents; ++i) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            describe(attr, static_cast<PerfEvent>(i));
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            attr.disabled = leader_ < 0;  // The leader starts the whole group
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0));
+            if (fd < 0) {
+                const int error = errno;
+                if (!failures.empty()) failures += ", ";
+                failures += string(kEventNames[i]) + ": " + strerror(error);
+                if (firstError == 0) firstError = error;
+                sameError = sameError && error == firstError;
+                continue;
+            }
+            if (leader_ < 0) leader_ = fd;
+            fds_[i] = fd;
+            slot_[i] = opened_++;
+        }
+        if (leader_ >= 0 && ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) != 0) {
+            failures = string("enable: ") + strerror(errno);
+            for (int& fd : fds_) {
+                if (fd >= 0) close(fd);
+                fd = -1;
+            }
+            leader_ = -1;
+            opened_ = 0;
+        }
+        if (opened_ == 0 && sameError && firstError != 0) {
+            // Nothing opened, for one reason: say that reason once
+            failures = strerror(firstError);
+            if (firstError == ENOENT || firstError == EOPNOTSUPP) {
+                failures += " (no hardware PMU, e.g. a virtual machine)";
+            } else if (firstError == EACCES || firstError == EPERM) {
+                failures += " (kernel.perf_event_paranoid > 2 or a seccomp profile blocks it)";
+            } else if (firstError == ENOSYS) {
+                failures += " (kernel without perf events)";
+            }
+        }
+        if (!failures.empty()) status_ = "perf_event_open: " + failures;
+#else
+        status_ = "hardware counters need Linux perf_event_open";
+#endif
+    }
+
+    PerfCounters::~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    PerfCounters::Reading PerfCounters::read() const {
+        Reading reading;
+#ifdef __linux__
+        if (leader_ < 0) return reading;
+        uint64_t buffer[3 + kPerfEvents] = {};
+        if (::read(leader_, buffer, sizeof(buffer)) < static_cast<ssize_t>(3 * sizeof(uint64_t))) return reading;
+        reading.enabled = buffer[1];
+        reading.running = buffer[2];
+        for (size_t i = 0; i < kPerfEvents; ++i) {
+            if (fds_[i] >= 0 && slot_[i] < buffer[0]) reading.values[i] = buffer[3 + slot_[i]];
+        }
+#endif
+        return reading;
+    }
+
+    void PerfCounters::start() {
+        begin_ = read();
+    }
+
+    PerfSample PerfCounters::stop() {
+        const Reading end = read();
+        PerfSample sample;
+        const uint64_t enabled = end.enabled - begin_.enabled;
+        const uint64_t running = end.running - begin_.running;
+        const double scale = running > 0 && running < enabled ? double(enabled) / double(running) : 1.0;
+        for (size_t i = 0; i < kPerfEvents; ++i) {
+            sample.values[i] = static_cast<uint64_t>(double(end.values[i] - begin_.values[i]) * scale);
+        }
+        return sample;
+    }
+
+} // namespace DocxParser
@@ -0,0 +1,92 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Hardware performance counters of the calling thread (Linux perf_event_open)
+ *
+ * Wall time says how long a stage took, not why. The counters split it into
+ * instructions retired, cycles (so IPC), L1 data and last-level cache misses
+ * and branch mispredictions, which tell a memory-bound stage from a branchy
+ * or simply long one.
+ *
+ * Counters are opened per thread, user space only, so they work with the
+ * default perf_event_paranoid setting of 2. Where they cannot be opened at
+ * all (other platforms, containers whose seccomp profile blocks the
+ * syscall, paranoid 3) a PerfCounters object is simply unavailable and its
+ * samples are empty; a counter the CPU or hypervisor lacks is left out on
+ * its own.
+ */
+namespace DocxParser {
+
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    L1dMisses,     ///< L1 data cache read misses
+    LlcMisses,     ///< Last-level cache misses
+    BranchMisses,
+};
+
+constexpr size_t kPerfEvents = 5;
+
+/// "cycles", "instructions", "L1d-misses", "LLC-misses", "branch-misses"
+const char* perfEventName(PerfEvent event);
+
+/**
+ * @brief Counter deltas over one measured interval
+ *
+ * Values are scaled up when the kernel had to multiplex the counters.
+ */
+struct PerfSample {
+    std::array<uint64_t, kPerfEvents> values{};
+
+    uint64_t operator[](PerfEvent event) const { return values[static_cast<size_t>(event)]; }
+    PerfSample& operator+=(const PerfSample& other);
+    /// Instructions per cycle, 0 without cycles
+    double ipc() const;
+};
+
+class PerfCounters {
+public:
+    /// Opens the counters for the calling thread; never throws
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /// At least one counter is open
+    bool available() const { return opened_ > 0; }
+    bool has(PerfEvent event) const { return fds_[static_cast<size_t>(event)] >= 0; }
+    /// Why counters are missing, e.g. "perf_event_open: Permission denied"; empty if all opened
+    const std::string& status() const { return status_; }
+
+    /// Starts an interval; must be called on the thread that constructed the object
+    void start();
+    /// Ends the interval started last
+    PerfSample stop();
+
+private:
+    struct Reading {
+        std::array<uint64_t, kPerfEvents> values{};
+        uint64_t enabled = 0;
+        uint64_t running = 0;
+    };
+
+    Reading read() const;
+
+    std::array<int, kPerfEvents> fds_;
+    std::array<size_t, kPerfEvents> slot_;  ///< Position of each event in the group read
+    int leader_ = -1;
+    size_t opened_ = 0;
+    std::string status_;
+    Reading begin_;
+};
+
+} // namespace DocxParser
+
+#endif // PERF_COUNTERS_H
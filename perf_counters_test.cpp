@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include "batch_runner.h"
+#include "perf_counters.h"
+
+using namespace DocxParser;
+
+/**
+ * @brief Counters either count or say why not; neither case throws
+ */
+TEST(PerfCountersTest, CountsOrExplains) {
+    PerfCounters counters;
+    if (!counters.available()) {
+        EXPECT_FALSE(counters.status().empty());
+        counters.start();
+        const auto sample = counters.stop();
+        EXPECT_EQ(sample[PerfEvent::Instructions], 0u);
+        GTEST_SKIP() << counters.status();
+    }
+
+    counters.start();
+    volatile uint64_t sum = 0;
+    for (uint64_t i = 0; i < 1000000; ++i) sum = sum + i;
+    const auto sample = counters.stop();
+    if (counters.has(PerfEvent::Instructions)) {
+        EXPECT_GT(sample[PerfEvent::Instructions], 1000000u);
+    }
+    if (counters.has(PerfEvent::Cycles)) {
+        EXPECT_GT(sample.ipc(), 0.0);
+    }
+}
+
+/**
+ * @brief Batch runs sum counters per document class and stage, or report them unavailable
+ */
+TEST(PerfCountersTest, BatchReportsPerClassAndStage) {
+    BatchOptions options;
+    options.threads = 2;
+    options.perfCounters = true;
+    BatchRunner runner(options);
+    const auto items = runner.run({"sample.docx", "sample.docx", "nonexistent.docx"});
+    const auto& perf = runner.report().perf;
+    EXPECT_TRUE(perf.enabled);
+    if (!perf.available) {
+        EXPECT_FALSE(perf.status.empty());
+        EXPECT_TRUE(perf.classes.empty());
+        GTEST_SKIP() << perf.status;
+    }
+
+    ASSERT_EQ(perf.classes.size(), 2u);
+    EXPECT_EQ(perf.classes[0].name, "docx <64K");
+    EXPECT_EQ(perf.classes[0].documents, 2u);
+    EXPECT_EQ(perf.classes[1].name, "failed");
+    const size_t parse = static_cast<size_t>(BatchStage::Parse);
+    const size_t counted = perf.counted[0] ? 0 : perf.counted[1] ? 1 : 2;
+    EXPECT_GT(perf.classes[0].stages[parse].values[counted], 0u);
+    EXPECT_GT(items[0].perf[parse].values[counted], 0u);
+}
@@ -0,0 +1,265 @@
+// Standard C++ headers
+#include <algorithm>  // For min, max
+#include <cmath>      // For ceil
+#include <cstdint>    // For fixed-width integers
+#include <cstring>    // For memcmp
+
+// Platform headers for positional reads and access advice
+#ifdef _WIN32
+#include <fstream>     // Portable fallback: read the ranges instead of advising
+#else
+#include <fcntl.h>     // For open, posix_fadvise
+#include <sys/stat.h>  // For fstat
+#include <unistd.h>    // For pread, close
+#endif
+
+// Project header
+#include "readahead.h"
+
+using namespace std;
+
+/*
+ * Readahead - Implementation Notes
+ *
+ * Zip layout, as far as prefetching is concerned:
+ *
+ *   [local header + data]... [central directory] [end of central directory]
+ *
+ * The end record (EOCD, signature PK\5\6) sits in the last 22 bytes plus an
+ * optional comment of up to 64 KiB; it holds the offset and size of the
+ * central directory. Each central directory entry (PK\1\2) holds the offset
+ * of the entry's local header and its compressed size. Reading the tail is
+ * therefore one blocking read that also leaves the central directory in the
+ * page cache for libzip; the styles entry is then advised asynchronously.
+ *
+ * Where posix_fadvise is unavailable the ranges are simply read, which warms
+ * the cache just the same but blocks the prefetch thread (never a worker).
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    constexpr size_t kEocdSize = 22;
+    constexpr size_t kMaxTail = kEocdSize + 0xFFFF;
+    constexpr size_t kCentralEntrySize = 46;
+    constexpr size_t kLocalHeaderSize = 30;
+    constexpr uint64_t kLocalExtraSlack = 1024;  ///< Local extra fields are not in the central directory
+    constexpr double kSmoothing = 0.2;
+    const char kStylesPart[] = "word/styles.xml";
+
+    uint16_t le16(const char* p) {
+        const auto* u = reinterpret_cast<const unsigned char*>(p);
+        return uint16_t(u[0] | u[1] << 8);
+    }
+
+    uint32_t le32(const char* p) {
+        const auto* u = reinterpret_cast<const unsigned char*>(p);
+        return uint32_t(u[0]) | uint32_t(u[1]) << 8 | uint32_t(u[2]) << 16 | uint32_t(u[3]) << 24;
+    }
+
+    /**
+     * @brief Read-only file with positional reads and readahead advice
+     */
+    class ArchiveFile {
+    public:
+        explicit ArchiveFile(const string& path) {
+#ifdef _WIN32
+            in_.open(path, ios::binary);
+            if (in_) {
+                in_.seekg(0, ios::end);
+                size_ = static_cast<uint64_t>(in_.tellg());
+                open_ = true;
+            }
+#else
+            fd_ = ::open(path.c_str(), O_RDONLY);
+            struct stat info;
+            if (fd_ >= 0 && fstat(fd_, &info) == 0) {
+                size_ = static_cast<uint64_t>(info.st_size);
+                open_ = true;
+            }
+#endif
+        }
+
+        ~ArchiveFile() {
+#ifndef _WIN32
+            if (fd_ >= 0) ::close(fd_);
+#endif
+        }
+
+        bool isOpen() const { return open_; }
+        uint64_t size() const { return size_; }
+
+        bool read(uint64_t offset, size_t length, string& out) {
+            out.resize(length);
+#ifdef _WIN32
+            in_.clear();
+            in_.seekg(static_cast<streamoff>(offset));
+            return static_cast<bool>(in_.read(&out[0], static_cast<streamsize>(length)));
+#else
+            size_t done = 0;
+            while (done < length) {
+                const ssize_t n = pread(fd_, &out[done], length - done, static_cast<off_t>(offset + done));
+                if (n <= 0) return false;
+                done += static_cast<size_t>(n);
+            }
+            return true;
+#endif
+        }
+
+        /// Starts reading [offset, offset + length) into the page cache (length 0 = to the end)
+        void adviseWillNeed(uint64_t offset, uint64_t length) {
+#if !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+            posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+#else
+            if (length == 0 || offset + length > size_) length = size_ - offset;
+            string scratch;
+            read(offset, static_cast<size_t>(length), scratch);
+#endif
+        }
+
+    private:
+#ifdef _WIN32
+        ifstream in_;
+#else
+        int fd_ = -1;
+#endif
+        uint64_t size_ = 0;
+        bool open_ = false;
+    };
+
+} // namespace
+
+    bool prefetchArchive(const string& path, bool rangesOnly) {
+        ArchiveFile file(path);
+        if (!file.isOpen()) return false;
+        if (!rangesOnly) {
+            file.adviseWillNeed(0, 0);
+            return true;
+        }
+
+        // The tail read blocks on a cold cache; that is the latency the window adapts to
+        const size_t tailSize = static_cast<size_t>(min<uint64_t>(file.size(), kMaxTail));
+        const uint64_t tailOffset = file.size() - tailSize;
+        string tail;
+        if (tailSize < kEocdSize || !file.read(tailOffset, tailSize, tail)) return false;
+
+        size_t eocd = string::npos;
+        for (size_t i = tailSize - kEocdSize + 1; i-- > 0;) {
+            if (memcmp(&tail[i], "PK\x05\x06", 4) == 0) {
+                eocd = i;
+                break;
+            }
+        }
+        if (eocd == string::npos) return false;
+
+        const uint64_t directorySize = le32(&tail[eocd + 12]);
+        const uint64_t directoryOffset = le32(&tail[eocd + 16]);
+        if (directoryOffset == 0xFFFFFFFFu || directoryOffset + directorySize > file.size()) {
+            // Zip64 or damaged: fall back to the whole file
+            file.adviseWillNeed(0, 0);
+            return true;
+        }
+
+        string directory;
+        if (directoryOffset >= tailOffset) {
+            directory = tail.substr(static_cast<size_t>(directoryOffset - tailOffset),
+                                    static_cast<size_t>(directorySize));
+        } else if (!file.read(directoryOffset, static_cast<size_t>(directorySize), directory)) {
+            return false;
+        }
+
+        const size_t partLength = sizeof(kStylesPart) - 1;
+        for (size_t p = 0; p + kCentralEntrySize <= directory.size();) {
+            const char* entry = &directory[p];
+            if (memcmp(entry, "PK\x01\x02", 4) != 0) break;
+            const uint64_t compressedSize = le32(entry + 20);
+            const size_t nameLength = le16(entry + 28);
+            const size_t extraLength = le16(entry + 30);
+            const size_t commentLength = le16(entry + 32);
+            const uint64_t localOffset = le32(entry + 42);
+            if (p + kCentralEntrySize + nameLength > directory.size()) break;
+            if (nameLength == partLength && memcmp(entry + kCentralEntrySize, kStylesPart, partLength) == 0) {
+                file.adviseWillNeed(localOffset, kLocalHeaderSize + nameLength + kLocalExtraSlack + compressedSize);
+                break;
+            }
+            p += kCentralEntrySize + nameLength + extraLength + commentLength;
+        }
+        return true;
+    }
+
+    ReadaheadPipeline::ReadaheadPipeline(vector<string> paths, ReadaheadOptions options)
+        : paths_(move(paths)), options_(options), enabled_(options.maxWindow > 0 && !paths_.empty()) {
+        window_ = min<size_t>(2, options_.maxWindow);
+        lastConsumed_ = Clock::now();
+        if (enabled_) {
+            thread_ = thread(&ReadaheadPipeline::prefetchLoop, this);
+        }
+    }
+
+    ReadaheadPipeline::~ReadaheadPipeline() {
+        finish();
+    }
+
+    void ReadaheadPipeline::consumed() {
+        if (!enabled_) return;
+        const auto now = Clock::now();
+        {
+            lock_guard<mutex> guard(lock_);
+            ++consumed_;
+            const double interval = chrono::duration<double, micro>(now - lastConsumed_).count();
+            lastConsumed_ = now;
+            intervalMicros_ = consumed_ == 1 ? interval : intervalMicros_ + kSmoothing * (interval - intervalMicros_);
+        }
+        wake_.notify_one();
+    }
+
+    void ReadaheadPipeline::prefetchLoop() {
+        unique_lock<mutex> lock(lock_);
+        while (true) {
+            wake_.wait(lock, [&] {
+                return stopping_ || next_ >= paths_.size() || next_ < consumed_ + window_;
+            });
+            if (stopping_ || next_ >= paths_.size()) return;
+            // Files the workers already opened gain nothing from advice
+            next_ = max(next_, consumed_);
+            if (next_ >= paths_.size()) return;
+            const string& path = paths_[next_++];
+
+            lock.unlock();
+            const auto start = Clock::now();
+            const bool ok = prefetchArchive(path, options_.rangesOnly);
+            const double io = chrono::duration<double, micro>(Clock::now() - start).count();
+            lock.lock();
+
+            if (ok) {
+                ++stats_.prefetched;
+            } else {
+                ++stats_.unreadable;
+            }
+            totalIoMicros_ += io;
+            ioMicros_ = stats_.prefetched + stats_.unreadable == 1 ? io : ioMicros_ + kSmoothing * (io - ioMicros_);
+            if (intervalMicros_ > 0) {
+                const double needed = ceil(ioMicros_ / intervalMicros_) + 1;
+                window_ = static_cast<size_t>(min<double>(needed, double(options_.maxWindow)));
+            }
+            stats_.largestWindow = max(stats_.largestWindow, window_);
+        }
+    }
+
+    ReadaheadStats ReadaheadPipeline::finish() {
+        {
+            lock_guard<mutex> guard(lock_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (thread_.joinable()) thread_.join();
+
+        lock_guard<mutex> guard(lock_);
+        ReadaheadStats stats = stats_;
+        const size_t steps = stats.prefetched + stats.unreadable;
+        stats.meanIoMicros = steps ? totalIoMicros_ / steps : 0;
+        return stats;
+    }
+
+} // namespace DocxParser
@@ -0,0 +1,98 @@
+#ifndef READAHEAD_H
+#define READAHEAD_H
+
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Look-ahead prefetching of batch inputs
+ *
+ * On spinning disks and network volumes every archive open stalls a worker
+ * for a full I/O round trip. A ReadaheadPipeline walks the input list ahead
+ * of the workers on its own thread and asks the kernel to start reading the
+ * next files (posix_fadvise WILLNEED), so their pages are in the page cache
+ * by the time a worker opens them.
+ *
+ * In ranges mode only the bytes extraction touches are requested: the
+ * central directory at the end of the archive and the word/styles.xml
+ * entry, whose offset the central directory reveals. Images and the
+ * document body are never pulled in.
+ */
+namespace DocxParser {
+
+struct ReadaheadOptions {
+    size_t maxWindow = 0;    ///< Most files prefetched ahead of the workers (0 = off)
+    bool rangesOnly = true;  ///< Central directory + styles entry instead of whole files
+};
+
+struct ReadaheadStats {
+    size_t prefetched = 0;     ///< Files advised
+    size_t unreadable = 0;     ///< Files that could not be opened or were not zips
+    size_t largestWindow = 0;  ///< Largest window the adaptation chose
+    double meanIoMicros = 0;   ///< Mean blocking time of a prefetch step
+};
+
+/**
+ * @brief Issues readahead for one archive
+ * @return false if the file cannot be opened or is not a zip archive
+ */
+bool prefetchArchive(const std::string& path, bool rangesOnly);
+
+/**
+ * @brief Background prefetcher that stays a few files ahead of the workers
+ *
+ * @details
+ * Window adaptation (Little's law): to hide an I/O latency L while workers
+ * start a new file every T, about L / T files must be in flight. Both are
+ * measured as moving averages - L is the time one prefetch step blocks
+ * (reading the archive tail is a real read), T the interval between
+ * consumed() calls - and the window is ceil(L / T) + 1, capped at maxWindow.
+ * A warm cache gives a window of 1-2; a slow volume grows it.
+ */
+class ReadaheadPipeline {
+public:
+    /**
+     * @param paths Inputs in the order workers will open them
+     */
+    ReadaheadPipeline(std::vector<std::string> paths, ReadaheadOptions options);
+    ~ReadaheadPipeline();
+
+    ReadaheadPipeline(const ReadaheadPipeline&) = delete;
+    ReadaheadPipeline& operator=(const ReadaheadPipeline&) = delete;
+
+    /// A worker is about to open the next file; thread-safe
+    void consumed();
+
+    /// Stops prefetching and returns the counters
+    ReadaheadStats finish();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void prefetchLoop();
+
+    std::vector<std::string> paths_;
+    ReadaheadOptions options_;
+    const bool enabled_;
+    std::mutex lock_;
+    std::condition_variable wake_;
+    size_t next_ = 0;      ///< Next path to prefetch
+    size_t consumed_ = 0;  ///< Paths opened by workers
+    size_t window_ = 1;
+    bool stopping_ = false;
+    double ioMicros_ = 0;        ///< Moving average of L
+    double intervalMicros_ = 0;  ///< Moving average of T
+    Clock::time_point lastConsumed_;
+    double totalIoMicros_ = 0;
+    ReadaheadStats stats_;
+    std::thread thread_;
+};
+
+} // namespace DocxParser
+
+#endif // READAHEAD_H
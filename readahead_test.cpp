@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+#include "batch_runner.h"
+#include "readahead.h"
+
+using namespace DocxParser;
+
+/**
+ * @brief Archives are prefetched in both modes; other files are reported unreadable
+ */
+TEST(ReadaheadTest, PrefetchesArchives) {
+    EXPECT_TRUE(prefetchArchive("sample.docx", true));
+    EXPECT_TRUE(prefetchArchive("sample.docx", false));
+    EXPECT_FALSE(prefetchArchive("CMakeLists.txt", true));
+    EXPECT_FALSE(prefetchArchive("nonexistent.docx", true));
+}
+
+/**
+ * @brief Batch results are unchanged with readahead, and every input is advised
+ */
+TEST(ReadaheadTest, BatchRunnerPrefetchesInputs) {
+    std::vector<std::string> paths(12, "sample.docx");
+    paths[3] = "nonexistent.docx";
+    for (auto policy : {SchedulePolicy::Fifo, SchedulePolicy::LargestFirst}) {
+        BatchOptions options;
+        options.threads = 2;
+        options.policy = policy;
+        options.readahead.maxWindow = 4;
+        BatchRunner runner(options);
+        auto items = runner.run(paths);
+
+        ASSERT_EQ(items.size(), paths.size());
+        EXPECT_FALSE(items[3].error.empty());
+        EXPECT_FALSE(items[0].document.styles.empty());
+        const auto& stats = runner.report().readahead;
+        // Workers may overtake the prefetcher, which then skips ahead
+        EXPECT_LE(stats.prefetched + stats.unreadable, paths.size());
+        EXPECT_GE(stats.largestWindow, 1u);
+        EXPECT_LE(stats.largestWindow, 4u);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef SCRATCH_BUFFER_H
+#define SCRATCH_BUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+namespace DocxParser {
+
+/**
+ * @brief Borrows this thread's pooled buffer, or a private one if it is already borrowed
+ *
+ * @details
+ * Whole-part buffers are reused across documents on a thread, but a
+ * visitor may start another extraction on the same thread while the
+ * buffer is still in use; the nested borrow then gets a buffer of its own
+ * instead of clobbering the outer one. Each Tag has its own pool, so
+ * buffers that are alive at the same time (an inflated member and the
+ * parser's copy of its styles part) never share one.
+ *
+ * A pooled buffer that grew beyond maxPooled is released when returned, so
+ * one huge part does not pin its memory for the life of the thread.
+ */
+template <typename Tag, typename Buffer = std::vector<char>>
+class ScratchBuffer {
+public:
+    explicit ScratchBuffer(size_t maxPooled) : maxPooled_(maxPooled), owner_(!inUse()), buffer_(owner_ ? pooled() : local_) {
+        if (owner_) inUse() = true;
+    }
+    ~ScratchBuffer() {
+        if (!owner_) return;
+        if (buffer_.capacity() > maxPooled_) Buffer().swap(buffer_);
+        inUse() = false;
+    }
+    ScratchBuffer(const ScratchBuffer&) = delete;
+    ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+    Buffer& get() { return buffer_; }
+
+private:
+    static Buffer& pooled() {
+        thread_local Buffer buffer;
+        return buffer;
+    }
+    static bool& inUse() {
+        thread_local bool flag = false;
+        return flag;
+    }
+
+    size_t maxPooled_;
+    bool owner_;
+    Buffer local_;
+    Buffer& buffer_;
+};
+
+} // namespace DocxParser
+
+#endif // SCRATCH_BUFFER_H
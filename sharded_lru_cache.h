@@ -0,0 +1,156 @@
+#ifndef SHARDED_LRU_CACHE_H
+#define SHARDED_LRU_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace DocxParser {
+
+/**
+ * @brief Thread-safe LRU cache with a byte budget, split into lock-striped shards
+ *
+ * @details
+ * A single mutex around one LRU list becomes the bottleneck once many
+ * threads hit the cache. Here the key hash selects one of N shards and each
+ * shard has its own mutex, list and map, so threads only contend when they
+ * touch the same shard. Each shard gets an equal slice of the byte budget
+ * and evicts from its own cold end.
+ *
+ * Values are held as shared_ptr<const V>, so an entry evicted while a
+ * caller still uses it stays alive until that caller lets go.
+ *
+ * @tparam Key Hashable key type
+ * @tparam Value Cached value type
+ * @tparam Hash Hash functor for Key
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedLruCache {
+public:
+    using ValuePtr = std::shared_ptr<const Value>;
+
+    /**
+     * @param byteBudget Total bytes across all shards (0 disables caching)
+     * @param shardCount Number of lock stripes
+     */
+    explicit ShardedLruCache(size_t byteBudget, size_t shardCount = 16)
+        : shards_(shardCount ? shardCount : 1), shardBudget_(byteBudget / (shardCount ? shardCount : 1)) {}
+
+    /// Returns the cached value and marks it most recently used, or nullptr
+    ValuePtr get(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return it->second->value;
+    }
+
+    /// Like get(), but leaves recency and hit/miss counters untouched
+    ValuePtr peek(const Key& key) const {
+        const Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto it = shard.map.find(key);
+        return it == shard.map.end() ? nullptr : it->second->value;
+    }
+
+    /**
+     * @brief Inserts or replaces a value
+     * @param bytes Approximate memory held by the value
+     * @return false if the value alone exceeds the shard budget (not cached)
+     */
+    bool put(const Key& key, ValuePtr value, size_t bytes) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        if (bytes > shardBudget_) return false;
+
+        auto it = shard.map.find(key);
+        if (it != shard.map.end()) {
+            shard.bytes -= it->second->bytes;
+            shard.lru.erase(it->second);
+            shard.map.erase(it);
+        }
+        shard.lru.push_front(Entry{key, std::move(value), bytes});
+        shard.map.emplace(key, shard.lru.begin());
+        shard.bytes += bytes;
+
+        while (shard.bytes > shardBudget_) {
+            Entry& victim = shard.lru.back();
+            shard.bytes -= victim.bytes;
+            shard.map.erase(victim.key);
+            shard.lru.pop_back();
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /// Removes all entries; counters are kept
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            shard.map.clear();
+            shard.lru.clear();
+            shard.bytes = 0;
+        }
+    }
+
+    size_t bytes() const {
+        size_t total = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            total += shard.bytes;
+        }
+        return total;
+    }
+
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+    uint64_t evictions() const { return evictions_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        Key key;
+        ValuePtr value;
+        size_t bytes;
+    };
+
+    struct Shard {
+        mutable std::mutex lock;
+        std::list<Entry> lru;  ///< Front = most recently used
+        std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> map;
+        size_t bytes = 0;
+    };
+
+    Shard& shardFor(const Key& key) {
+        return const_cast<Shard&>(static_cast<const ShardedLruCache*>(this)->shardFor(key));
+    }
+
+    const Shard& shardFor(const Key& key) const {
+        // Mix the hash so keys with similar low bits still spread over shards
+        uint64_t h = static_cast<uint64_t>(Hash{}(key));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return shards_[h % shards_.size()];
+    }
+
+    std::vector<Shard> shards_;
+    size_t shardBudget_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+};
+
+} // namespace DocxParser
+
+#endif // SHARDED_LRU_CACHE_H
@@ -0,0 +1,294 @@
+// Standard C++ headers
+#include <chrono>     // For insert and index timing
+#include <stdexcept>  // For runtime_error
+
+// Third-party library headers
+#include <sqlite3.h>
+
+// Project header
+#include "sqlite_export.h"
+
+using namespace std;
+
+/*
+ * SQLite Export - Implementation Notes
+ *
+ * Where bulk-load time goes in SQLite, and what this file does about it:
+ * - Commits: every transaction ends in a journal sync. Rows are grouped
+ *   into transactions of rowsPerTransaction rows (templates, styles and
+ *   properties all count), so a corpus needs a handful of syncs.
+ * - SQL compilation: the three INSERTs are prepared once and re-bound for
+ *   every row (sqlite3_reset + bind); strings are bound SQLITE_STATIC since
+ *   the queued document outlives the step.
+ * - Journaling: WAL with synchronous=NORMAL appends pages sequentially and
+ *   only syncs at checkpoints.
+ * - Indexes: maintaining B-tree indexes row by row costs random page
+ *   writes. They are created once in finish(), which sorts each column in
+ *   one pass. Ids are assigned here rather than read back with
+ *   sqlite3_last_insert_rowid(), so no lookups are needed during the load.
+ *
+ * The queue is bounded: if extraction outpaces the writer, add() blocks
+ * the workers instead of buffering the corpus in memory. The writer swaps
+ * the whole queue out under the lock and inserts without holding it.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    using Clock = chrono::steady_clock;
+
+    double elapsedMs(Clock::time_point start) {
+        return chrono::duration<double, milli>(Clock::now() - start).count();
+    }
+
+    const char* const kSchema =
+        "CREATE TABLE IF NOT EXISTS templates ("
+        "  id INTEGER PRIMARY KEY, path TEXT NOT NULL, style_count INTEGER NOT NULL);"
+        "CREATE TABLE IF NOT EXISTS styles ("
+        "  id INTEGER PRIMARY KEY, template_id INTEGER NOT NULL REFERENCES templates(id),"
+        "  name TEXT NOT NULL, type TEXT NOT NULL, font TEXT NOT NULL, font_size TEXT NOT NULL);"
+        "CREATE TABLE IF NOT EXISTS properties ("
+        "  style_id INTEGER NOT NULL REFERENCES styles(id), key TEXT NOT NULL, value TEXT NOT NULL);";
+
+    const char* const kIndexes =
+        "CREATE INDEX IF NOT EXISTS templates_path ON templates(path);"
+        "CREATE INDEX IF NOT EXISTS styles_template ON styles(template_id);"
+        "CREATE INDEX IF NOT EXISTS styles_name ON styles(name);"
+        "CREATE INDEX IF NOT EXISTS styles_font ON styles(font, font_size);"
+        "CREATE INDEX IF NOT EXISTS properties_style ON properties(style_id);"
+        "CREATE INDEX IF NOT EXISTS properties_key ON properties(key, value);";
+
+    DocumentStyles copyDocument(const DocumentStyles& document) {
+        DocumentStyles copy;
+        copy.path = document.path;
+        copy.styles.reserve(document.styles.size());
+        for (const auto& style : document.styles) {
+            StyleInfo styleCopy;
+            styleCopy.name = style.name;
+            styleCopy.type = style.type;
+            styleCopy.fontName = style.fontName;
+            styleCopy.fontSize = style.fontSize;
+            styleCopy.properties = style.properties;
+            copy.styles.push_back(move(styleCopy));
+        }
+        return copy;
+    }
+
+    void bindText(sqlite3_stmt* statement, int column, const string& value) {
+        sqlite3_bind_text(statement, column, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
+    }
+
+} // namespace
+
+    struct SqliteExporter::Statements {
+        sqlite3_stmt* insertTemplate = nullptr;
+        sqlite3_stmt* insertStyle = nullptr;
+        sqlite3_stmt* insertProperty = nullptr;
+
+        ~Statements() {
+            sqlite3_finalize(insertTemplate);
+            sqlite3_finalize(insertStyle);
+            sqlite3_finalize(insertProperty);
+        }
+    };
+
+    SqliteExporter::SqliteExporter(const string& databasePath, SqliteExportOptions options)
+        : options_(options) {
+        const int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX;
+        if (sqlite3_open_v2(databasePath.c_str(), &db_, flags, nullptr) != SQLITE_OK) {
+            const string message = db_ ? sqlite3_errmsg(db_) : "out of memory";
+            closeDatabase();
+            throw runtime_error("Cannot open SQLite database " + databasePath + ": " + message);
+        }
+        try {
+            execute("PRAGMA journal_mode=WAL;"
+                    "PRAGMA synchronous=NORMAL;"
+                    "PRAGMA temp_store=MEMORY;"
+                    "PRAGMA cache_size=-65536;");  // 64 MiB
+            execute(kSchema);
+
+            // Appending: continue after the ids already in the database
+            sqlite3_stmt* maxIds = nullptr;
+            if (sqlite3_prepare_v2(db_, "SELECT (SELECT COALESCE(MAX(id), 0) FROM templates),"
+                                        "       (SELECT COALESCE(MAX(id), 0) FROM styles)",
+                                   -1, &maxIds, nullptr) != SQLITE_OK ||
+                sqlite3_step(maxIds) != SQLITE_ROW) {
+                sqlite3_finalize(maxIds);
+                throw runtime_error(string("SQLite error: ") + sqlite3_errmsg(db_));
+            }
+            nextTemplateId_ = sqlite3_column_int64(maxIds, 0) + 1;
+            nextStyleId_ = sqlite3_column_int64(maxIds, 1) + 1;
+            sqlite3_finalize(maxIds);
+
+            statements_ = make_unique<Statements>();
+            auto prepare = [&](const char* sql, sqlite3_stmt** statement) {
+                if (sqlite3_prepare_v3(db_, sql, -1, SQLITE_PREPARE_PERSISTENT, statement, nullptr) != SQLITE_OK) {
+                    throw runtime_error(string("SQLite error: ") + sqlite3_errmsg(db_));
+                }
+            };
+            prepare("INSERT INTO templates (id, path, style_count) VALUES (?1, ?2, ?3)",
+                    &statements_->insertTemplate);
+            prepare("INSERT INTO styles (id, template_id, name, type, font, font_size) "
+                    "VALUES (?1, ?2, ?3, ?4, ?5, ?6)",
+                    &statements_->insertStyle);
+            prepare("INSERT INTO properties (style_id, key, value) VALUES (?1, ?2, ?3)",
+                    &statements_->insertProperty);
+        } catch (...) {
+            closeDatabase();
+            throw;
+        }
+        writer_ = thread(&SqliteExporter::writerLoop, this);
+    }
+
+    SqliteExporter::~SqliteExporter() {
+        if (!finished_) {
+            try {
+                finish();
+            } catch (...) {
+                // Destructors must not throw; call finish() to see errors
+            }
+        }
+    }
+
+    void SqliteExporter::add(const DocumentStyles& document) {
+        add(copyDocument(document));  // Copied outside the lock
+    }
+
+    void SqliteExporter::add(DocumentStyles&& document) {
+        unique_lock<mutex> guard(lock_);
+        notFull_.wait(guard, [&] { return queue_.size() < options_.queueDocuments || error_ || closing_; });
+        if (error_) rethrow_exception(error_);
+        if (closing_) throw runtime_error("SqliteExporter::add() after finish()");
+        queue_.push_back(move(document));
+        notEmpty_.notify_one();
+    }
+
+    SqliteExportReport SqliteExporter::finish() {
+        if (finished_) return report_;
+        {
+            lock_guard<mutex> guard(lock_);
+            closing_ = true;
+        }
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+        writer_.join();
+        finished_ = true;
+
+        if (error_) {
+            closeDatabase();
+            rethrow_exception(error_);
+        }
+        try {
+            if (options_.createIndexes) {
+                const auto start = Clock::now();
+                execute(kIndexes);
+                report_.indexMs = elapsedMs(start);
+            }
+        } catch (...) {
+            closeDatabase();
+            throw;
+        }
+        closeDatabase();
+        return report_;
+    }
+
+    void SqliteExporter::writerLoop() {
+        try {
+            for (;;) {
+                deque<DocumentStyles> batch;
+                {
+                    unique_lock<mutex> guard(lock_);
+                    notEmpty_.wait(guard, [&] { return !queue_.empty() || closing_; });
+                    if (queue_.empty()) break;  // Closing and drained
+                    batch.swap(queue_);
+                }
+                notFull_.notify_all();
+
+                const auto start = Clock::now();
+                for (const auto& document : batch) insert(document);
+                report_.insertMs += elapsedMs(start);
+            }
+            if (inTransaction_) {
+                const auto start = Clock::now();
+                execute("COMMIT");
+                ++report_.transactions;
+                report_.insertMs += elapsedMs(start);
+            }
+        } catch (...) {
+            lock_guard<mutex> guard(lock_);
+            error_ = current_exception();
+            queue_.clear();
+            notFull_.notify_all();
+        }
+    }
+
+    void SqliteExporter::insert(const DocumentStyles& document) {
+        if (!inTransaction_) {
+            execute("BEGIN");
+            inTransaction_ = true;
+            rowsInTransaction_ = 0;
+        }
+        auto step = [&](sqlite3_stmt* statement) {
+            if (sqlite3_step(statement) != SQLITE_DONE) {
+                throw runtime_error("SQLite insert failed for " + document.path + ": " + sqlite3_errmsg(db_));
+            }
+            sqlite3_reset(statement);
+        };
+
+        const int64_t templateId = nextTemplateId_++;
+        sqlite3_stmt* insertTemplate = statements_->insertTemplate;
+        sqlite3_bind_int64(insertTemplate, 1, templateId);
+        bindText(insertTemplate, 2, document.path);
+        sqlite3_bind_int64(insertTemplate, 3, static_cast<int64_t>(document.styles.size()));
+        step(insertTemplate);
+        ++report_.templates;
+        ++rowsInTransaction_;
+
+        for (const auto& style : document.styles) {
+            const int64_t styleId = nextStyleId_++;
+            sqlite3_stmt* insertStyle = statements_->insertStyle;
+            sqlite3_bind_int64(insertStyle, 1, styleId);
+            sqlite3_bind_int64(insertStyle, 2, templateId);
+            bindText(insertStyle, 3, style.name);
+            bindText(insertStyle, 4, style.type);
+            bindText(insertStyle, 5, style.fontName);
+            bindText(insertStyle, 6, style.fontSize);
+            step(insertStyle);
+            ++report_.styles;
+            ++rowsInTransaction_;
+
+            sqlite3_stmt* insertProperty = statements_->insertProperty;
+            for (const auto& property : style.properties) {
+                sqlite3_bind_int64(insertProperty, 1, styleId);
+                bindText(insertProperty, 2, property.first);
+                bindText(insertProperty, 3, property.second);
+                step(insertProperty);
+                ++report_.properties;
+                ++rowsInTransaction_;
+            }
+        }
+
+        if (rowsInTransaction_ >= options_.rowsPerTransaction) {
+            execute("COMMIT");
+            inTransaction_ = false;
+            ++report_.transactions;
+        }
+    }
+
+    void SqliteExporter::execute(const char* sql) {
+        char* message = nullptr;
+        if (sqlite3_exec(db_, sql, nullptr, nullptr, &message) != SQLITE_OK) {
+            const string error = message ? message : sqlite3_errmsg(db_);
+            sqlite3_free(message);
+            throw runtime_error("SQLite error: " + error);
+        }
+    }
+
+    void SqliteExporter::closeDatabase() {
+        statements_.reset();  // Statements must be finalized before the connection closes
+        sqlite3_close(db_);
+        db_ = nullptr;
+    }
+
+} // namespace DocxParser
@@ -0,0 +1,108 @@
+#ifndef SQLITE_EXPORT_H
+#define SQLITE_EXPORT_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "docx_style_parser.h"
+
+struct sqlite3;
+
+/**
+ * @brief Export of extracted styles into a normalized SQLite database
+ *
+ * Schema:
+ * - templates(id, path, style_count)
+ * - styles(id, template_id, name, type, font, font_size)
+ * - properties(style_id, key, value)
+ *
+ * Documents are handed to add() from any thread (typically the batch
+ * workers, through BatchOptions::onItem) and inserted by one dedicated
+ * writer thread, since SQLite serializes writers anyway. An existing
+ * database is appended to; ids continue after the largest existing ones.
+ */
+namespace DocxParser {
+
+struct SqliteExportOptions {
+    size_t rowsPerTransaction = 200000;  ///< Rows inserted between commits
+    size_t queueDocuments = 4096;        ///< add() blocks while this many documents wait
+    bool createIndexes = true;           ///< Build the lookup indexes after the load
+};
+
+struct SqliteExportReport {
+    uint64_t templates = 0;
+    uint64_t styles = 0;
+    uint64_t properties = 0;
+    uint64_t transactions = 0;
+    double insertMs = 0;  ///< Writer thread time spent inserting and committing
+    double indexMs = 0;   ///< Time spent creating indexes in finish()
+};
+
+class SqliteExporter {
+public:
+    /**
+     * @brief Opens (or creates) the database and starts the writer thread
+     * @throws std::runtime_error if the database cannot be opened or prepared
+     */
+    SqliteExporter(const std::string& databasePath, SqliteExportOptions options = {});
+
+    /// Finishes the export if finish() was not called; errors are dropped
+    ~SqliteExporter();
+
+    SqliteExporter(const SqliteExporter&) = delete;
+    SqliteExporter& operator=(const SqliteExporter&) = delete;
+
+    /**
+     * @brief Queues a copy of one document; thread-safe
+     * @throws std::runtime_error if the writer thread has failed
+     */
+    void add(const DocumentStyles& document);
+
+    /**
+     * @brief Queues one document without copying it; thread-safe
+     * @throws std::runtime_error if the writer thread has failed
+     */
+    void add(DocumentStyles&& document);
+
+    /**
+     * @brief Drains the queue, commits, creates the indexes and closes the database
+     * @throws std::runtime_error with the writer thread's error, if any
+     */
+    SqliteExportReport finish();
+
+private:
+    void writerLoop();
+    void insert(const DocumentStyles& document);
+    void execute(const char* sql);
+    void closeDatabase();
+
+    SqliteExportOptions options_;
+    sqlite3* db_ = nullptr;
+    struct Statements;
+    std::unique_ptr<Statements> statements_;
+
+    std::mutex lock_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::deque<DocumentStyles> queue_;
+    bool closing_ = false;
+    bool finished_ = false;
+    std::exception_ptr error_;
+
+    int64_t nextTemplateId_ = 1;
+    int64_t nextStyleId_ = 1;
+    size_t rowsInTransaction_ = 0;
+    bool inTransaction_ = false;
+    SqliteExportReport report_;
+    std::thread writer_;
+};
+
+} // namespace DocxParser
+
+#endif // SQLITE_EXPORT_H
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <thread>
+#include <sqlite3.h>
+#include "sqlite_export.h"
+
+using namespace DocxParser;
+namespace fs = std::filesystem;
+
+namespace {
+
+DocumentStyles makeDocument(size_t id) {
+    DocumentStyles document;
+    document.path = "/corpus/doc" + std::to_string(id) + ".docx";
+    for (size_t s = 0; s < 5; ++s) {
+        StyleInfo style;
+        style.name = "Heading " + std::to_string(s);
+        style.type = "paragraph";
+        style.fontName = s % 2 ? "Calibri" : "Cambria";
+        style.fontSize = "24";
+        style.properties["outlineLvl"] = std::to_string(s);
+        style.properties["qFormat"] = "";
+        document.styles.push_back(std::move(style));
+    }
+    return document;
+}
+
+fs::path freshDatabase(const std::string& name) {
+    fs::path path = fs::temp_directory_path() / name;
+    for (const char* suffix : {"", "-wal", "-shm"}) fs::remove(path.string() + suffix);
+    return path;
+}
+
+int64_t queryInt(sqlite3* db, const char* sql) {
+    sqlite3_stmt* statement = nullptr;
+    EXPECT_EQ(sqlite3_prepare_v2(db, sql, -1, &statement, nullptr), SQLITE_OK) << sql;
+    EXPECT_EQ(sqlite3_step(statement), SQLITE_ROW) << sql;
+    const int64_t value = sqlite3_column_int64(statement, 0);
+    sqlite3_finalize(statement);
+    return value;
+}
+
+} // namespace
+
+/**
+ * @brief Concurrent producers, small transactions and appending keep every row and its links
+ */
+TEST(SqliteExportTest, WritesNormalizedSchema) {
+    const auto path = freshDatabase("typstyle_sqlite_test.db");
+
+    SqliteExportOptions options;
+    options.rowsPerTransaction = 100;
+    options.queueDocuments = 8;  // Producers block on the writer
+    {
+        SqliteExporter exporter(path.string(), options);
+        std::vector<std::thread> producers;
+        for (size_t p = 0; p < 4; ++p) {
+            producers.emplace_back([&, p] {
+                for (size_t i = 0; i < 50; ++i) {
+                    if (p == 0) {
+                        const DocumentStyles document = makeDocument(i);  // Copying overload
+                        exporter.add(document);
+                    } else {
+                        exporter.add(makeDocument(p * 50 + i));
+                    }
+                }
+            });
+        }
+        for (auto& producer : producers) producer.join();
+        auto report = exporter.finish();
+        EXPECT_EQ(report.templates, 200u);
+        EXPECT_EQ(report.styles, 1000u);
+        EXPECT_EQ(report.properties, 2000u);
+        EXPECT_GT(report.transactions, 10u);
+    }
+    {
+        SqliteExporter exporter(path.string(), options);  // Appends
+        exporter.add(makeDocument(1000));
+        exporter.finish();
+    }
+
+    sqlite3* db = nullptr;
+    ASSERT_EQ(sqlite3_open(path.string().c_str(), &db), SQLITE_OK);
+    EXPECT_EQ(queryInt(db, "SELECT COUNT(*) FROM templates"), 201);
+    EXPECT_EQ(queryInt(db, "SELECT COUNT(DISTINCT id) FROM styles"), 1005);
+    EXPECT_EQ(queryInt(db, "SELECT COUNT(*) FROM properties p JOIN styles s ON s.id = p.style_id "
+                           "JOIN templates t ON t.id = s.template_id "
+                           "WHERE t.path = '/corpus/doc1000.docx' AND p.key = 'outlineLvl'"), 5);
+    EXPECT_EQ(queryInt(db, "SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND name NOT LIKE 'sqlite_%'"),
+              6);
+    EXPECT_EQ(queryInt(db, "SELECT COUNT(*) FROM styles WHERE font = 'Calibri'"), 402);
+    sqlite3_close(db);
+}
@@ -0,0 +1,368 @@
+// Standard C++ headers
+#include <algorithm>      // For min
+#include <cstring>        // For memchr, memcmp, memcpy
+#include <stdexcept>      // For runtime_error
+#include <string_view>    // For string_view
+#include <unordered_map>  // For the hash -> previous block lookup
+#include <utility>        // For pair, move
+
+// Project headers
+#include "style_blocks.h"
+#include "text_encoding.h"  // For detectXmlEncoding
+
+using namespace std;
+
+/*
+ * Style Blocks - Implementation Notes
+ *
+ * The scanner walks the part from '<' to '<' (memchr) and only tells
+ * markup apart: comments, CDATA sections and processing instructions are
+ * skipped whole, start tags are read to their '>' with quoted attribute
+ * values stepped over, and a stack of open element names checks that end
+ * tags match. Character data is never looked at. A style block is a child
+ * of the root whose local name is "style", from its '<' to the '>' that
+ * closes it.
+ *
+ * That is the same selection StyleEventBuilder makes (style children of
+ * the root container, names without prefixes), so a full extraction with
+ * quickFormatOnly = false yields exactly one style per block, in order. A
+ * full run checks this and drops the block list if it does not hold.
+ *
+ * Changed blocks are parsed as one synthetic part: the original bytes up to
+ * the end of the root start tag (declaration, namespace declarations), the
+ * changed blocks back to back, and the root end tag. Since the prefix is
+ * part of the context hash, every namespace prefix is bound exactly as in
+ * the real part.
+ *
+ * An incremental run only parses the changed blocks; the bytes between
+ * blocks (docDefaults, latentStyles, whitespace) are checked for balanced
+ * tags by the scanner but not parsed. Unchanged blocks were parsed when the
+ * snapshot was made.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    const char kBlocksMagic[4] = {'T', 'S', 'B', 'K'};
+    // Also bumped when extraction output changes: reused styles come from the snapshot.
+    // 2: fontTheme and docDefaults properties
+    constexpr uint32_t kBlocksVersion = 2;
+    constexpr size_t kBlocksHeaderSize = 24;  // Magic, version, length, context hash, block count
+    constexpr size_t kSniffBytes = 512;
+
+    /*
+     * Multiply-xorshift over 8-byte words, length mixed in first. Words are
+     * read in native byte order: a snapshot moved to a machine of the other
+     * endianness only matches nothing and is re-extracted in full.
+     */
+    uint64_t hashBytes(const char* data, size_t size) {
+        constexpr uint64_t kMultiplier = 0x9E3779B97F4A7C15ull;
+        uint64_t hash = (uint64_t(size) + 1) * kMultiplier;
+        auto mix = [&](uint64_t word) {
+            hash ^= word;
+            hash *= kMultiplier;
+            hash ^= hash >> 32;
+        };
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            memcpy(&word, data + i, 8);
+            mix(word);
+        }
+        if (i < size) {
+            uint64_t word = 0;
+            memcpy(&word, data + i, size - i);
+            mix(word);
+        }
+        hash ^= hash >> 29;
+        hash *= 0xBF58476D1CE4E5B9ull;
+        return hash ^ (hash >> 32);
+    }
+
+    StyleInfo copyStyle(const StyleInfo& style) {
+        StyleInfo copy;
+        copy.name = style.name;
+        copy.type = style.type;
+        copy.fontName = style.fontName;
+        copy.fontSize = style.fontSize;
+        copy.properties = style.properties;
+        return copy;
+    }
+
+    /**
+     * @brief Where the root start tag and the style blocks of a part are
+     */
+    struct BlockScan {
+        size_t contextEnd = 0;  ///< Just past the root start tag
+        string_view rootName;
+        vector<pair<size_t, size_t>> blocks;  ///< [begin, end) of each style element
+    };
+
+    const char* search(const char* from, const char* end, const char* pattern, size_t length) {
+        for (const char* p = from; end - p >= static_cast<ptrdiff_t>(length); ++p) {
+            p = static_cast<const char*>(memchr(p, pattern[0], end - p));
+            if (!p || end - p < static_cast<ptrdiff_t>(length)) return nullptr;
+            if (memcmp(p, pattern, length) == 0) return p;
+        }
+        return nullptr;
+    }
+
+    bool startsWith(const char* p, const char* end, const char* prefix, size_t length) {
+        return end - p >= static_cast<ptrdiff_t>(length) && memcmp(p, prefix, length) == 0;
+    }
+
+    string_view localName(string_view name) {
+        const size_t colon = name.rfind(':');
+        return colon == string_view::npos ? name : name.substr(colon + 1);
+    }
+
+    bool isNameEnd(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '/' || c == '>';
+    }
+
+    /**
+     * @brief Finds the style blocks; false for anything it cannot vouch for
+     */
+    bool scanStyleBlocks(const char* data, size_t size, BlockScan& scan) {
+        const char* const end = data + size;
+        vector<string_view> open;
+        size_t blockBegin = 0;
+        bool inBlock = false;
+        for (const char* p = data;;) {
+            p = static_cast<const char*>(memchr(p, '<', end - p));
+            if (!p || end - p < 2) return false;  // Root never closed
+
+            if (p[1] == '!') {
+                const char* close = nullptr;
+                if (startsWith(p, end, "<!--", 4)) {
+                    close = search(p + 4, end, "-->", 3);
+                } else if (startsWith(p, end, "<![CDATA[", 9)) {
+                    close = search(p + 9, end, "]]>", 3);
+                }
+                if (!close) return false;  // Unterminated, or a DOCTYPE (entities could change meaning)
+                p = close + 3;
+                continue;
+            }
+            if (p[1] == '?') {
+                const char* close = search(p + 2, end, "?>", 2);
+                if (!close) return false;
+                p = close + 2;
+                continue;
+            }
+
+            const bool endTag = p[1] == '/';
+            const char* nameBegin = p + (endTag ? 2 : 1);
+            const char* nameEnd = nameBegin;
+            while (nameEnd < end && !isNameEnd(*nameEnd)) ++nameEnd;
+            const string_view name(nameBegin, static_cast<size_t>(nameEnd - nameBegin));
+            if (name.empty()) return false;
+
+            // To the closing '>', stepping over quoted attribute values
+            const char* close = nameEnd;
+            for (char quote = 0; close < end; ++close) {
+                if (quote) {
+                    if (*close == quote) quote = 0;
+                } else if (*close == '"' || *close == '\'') {
+                    quote = *close;
+                } else if (*close == '>') {
+                    break;
+                }
+            }
+            if (close == end) return false;
+            const size_t tagBegin = static_cast<size_t>(p - data);
+            p = close + 1;
+            const size_t tagEnd = static_cast<size_t>(p - data);
+
+            if (endTag) {
+                if (open.empty() || open.back() != name) return false;
+                open.pop_back();
+                if (open.size() == 1 && inBlock) {
+                    scan.blocks.emplace_back(blockBegin, tagEnd);
+                    inBlock = false;
+                }
+                if (open.empty()) return true;
+                continue;
+            }
+
+            const bool empty = close[-1] == '/';
+            if (open.empty()) {
+                scan.rootName = name;
+                scan.contextEnd = tagEnd;
+                if (empty) return true;
+            } else if (open.size() == 1 && localName(name) == "style") {
+                if (empty) {
+                    scan.blocks.emplace_back(tagBegin, tagEnd);
+                } else {
+                    inBlock = true;
+                    blockBegin = tagBegin;
+                }
+            }
+            if (!empty) open.push_back(name);
+        }
+    }
+
+    /// Extracts every style of a part; each one is appended to styles
+    void parseAll(const char* data, size_t size, StyleSet& styles) {
+        StreamOptions options;
+        options.quickFormatOnly = false;
+        visitStylesPart(data, size, [&](StyleInfo& style) { styles.push_back(move(style)); }, options);
+    }
+
+    void putU32(string& out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    void putU64(string& out, uint64_t v) {
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    uint64_t getLittleEndian(const char* p, int bytes) {
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i) v |= uint64_t(static_cast<unsigned char>(p[i])) << (8 * i);
+        return v;
+    }
+
+} // namespace
+
+    StyleBlockSnapshot extractStyleBlocks(const char* data, size_t size, StyleBlockSnapshot previous,
+                                          IncrementalReport* report) {
+        IncrementalReport local;
+        IncrementalReport& counts = report ? *report : local;
+        counts = IncrementalReport();
+        StyleBlockSnapshot result;
+
+        BlockScan scan;
+        const bool scanned = detectXmlEncoding(data, min(size, kSniffBytes)).encoding == TextEncoding::Utf8 &&
+                             scanStyleBlocks(data, size, scan);
+        if (scanned) {
+            result.contextHash = hashBytes(data, scan.contextEnd);
+            result.blocks.reserve(scan.blocks.size());
+            for (const auto& block : scan.blocks) {
+                const size_t length = block.second - block.first;
+                result.blocks.push_back({hashBytes(data + block.first, length), static_cast<uint32_t>(length)});
+            }
+        }
+
+        const bool reusable = scanned && !previous.blocks.empty() &&
+                              previous.blocks.size() == previous.styles.size() &&
+                              previous.contextHash == result.contextHash;
+        if (reusable) {
+            // Previous index -> index in result it was moved to, or -1 while unused
+            unordered_map<uint64_t, pair<size_t, ptrdiff_t>> earlier;
+            earlier.reserve(previous.blocks.size());
+            for (size_t i = 0; i < previous.blocks.size(); ++i) {
+                earlier.emplace(previous.blocks[i].hash, make_pair(i, ptrdiff_t(-1)));
+            }
+
+            result.styles.resize(result.blocks.size());
+            vector<size_t> changed;
+            string part(data, scan.contextEnd);
+            for (size_t i = 0; i < result.blocks.size(); ++i) {
+                const auto found = earlier.find(result.blocks[i].hash);
+                if (found != earlier.end() && previous.blocks[found->second.first].length == result.blocks[i].length) {
+                    auto& [index, movedTo] = found->second;
+                    if (movedTo < 0) {
+                        result.styles[i] = move(previous.styles[index]);
+                        movedTo = static_cast<ptrdiff_t>(i);
+                    } else {
+                        result.styles[i] = copyStyle(result.styles[static_cast<size_t>(movedTo)]);  // Duplicate block
+                    }
+                } else {
+                    changed.push_back(i);
+                    part.append(data + scan.blocks[i].first, scan.blocks[i].second - scan.blocks[i].first);
+                }
+            }
+
+            StyleSet parsed;
+            if (!changed.empty()) {
+                part += "</";
+                part += scan.rootName;
+                part += '>';
+                parseAll(part.data(), part.size(), parsed);
+            }
+            if (parsed.size() == changed.size()) {
+                for (size_t i = 0; i < changed.size(); ++i) result.styles[changed[i]] = move(parsed[i]);
+                counts.blocks = result.blocks.size();
+                counts.parsed = changed.size();
+                counts.reused = counts.blocks - counts.parsed;
+                return result;
+            }
+            result.styles.clear();  // The scan and the parser disagree; start over
+        }
+
+        counts.fullRun = true;
+        parseAll(data, size, result.styles);
+        if (result.blocks.size() != result.styles.size()) result.blocks.clear();
+        counts.blocks = result.styles.size();
+        counts.parsed = result.styles.size();
+        return result;
+    }
+
+    StyleBlockSnapshot reextractDocxStyles(const string& filePath, StyleBlockSnapshot previous,
+                                           IncrementalReport* report) {
+        auto zip = openDocxFile(filePath);
+        const vector<char> part = readStylesXml(zip.get());
+        return extractStyleBlocks(part.data(), part.size(), move(previous), report);
+    }
+
+    StyleSet selectStyles(const StyleBlockSnapshot& snapshot, bool quickFormatOnly) {
+        StyleSet styles;
+        for (const auto& style : snapshot.styles) {
+            // The same test StyleEventBuilder applies; both elements are kept as properties
+            if (quickFormatOnly && (!style.properties.count("qFormat") || style.properties.count("semiHidden"))) {
+                continue;
+            }
+            styles.push_back(copyStyle(style));
+        }
+        return styles;
+    }
+
+    string serializeStyleBlocks(const StyleBlockSnapshot& snapshot) {
+        string out(kBlocksMagic, sizeof(kBlocksMagic));
+        putU32(out, kBlocksVersion);
+        putU32(out, 0);  // Total length, patched below
+        putU64(out, snapshot.contextHash);
+        putU32(out, static_cast<uint32_t>(snapshot.blocks.size()));
+        for (const auto& block : snapshot.blocks) {
+            putU64(out, block.hash);
+            putU32(out, block.length);
+        }
+        out += serializeStyleSet(snapshot.styles);
+        string length;
+        putU32(length, static_cast<uint32_t>(out.size()));
+        out.replace(8, 4, length);
+        return out;
+    }
+
+    StyleBlockSnapshot deserializeStyleBlocks(const char* data, size_t size) {
+        if (size < kBlocksHeaderSize || memcmp(data, kBlocksMagic, sizeof(kBlocksMagic)) != 0) {
+            throw runtime_error("Not a style block snapshot");
+        }
+        if (getLittleEndian(data + 4, 4) != kBlocksVersion) {
+            throw runtime_error("Unsupported style block snapshot version");
+        }
+        if (getLittleEndian(data + 8, 4) != size) {
+            throw runtime_error("Style block snapshot is truncated");
+        }
+        StyleBlockSnapshot snapshot;
+        snapshot.contextHash = getLittleEndian(data + 12, 8);
+        const uint64_t count = getLittleEndian(data + 20, 4);
+        if (count > (size - kBlocksHeaderSize) / 12) {
+            throw runtime_error("Style block snapshot is corrupt");
+        }
+        const char* p = data + kBlocksHeaderSize;
+        snapshot.blocks.resize(count);
+        for (auto& block : snapshot.blocks) {
+            block.hash = getLittleEndian(p, 8);
+            block.length = static_cast<uint32_t>(getLittleEndian(p + 8, 4));
+            p += 12;
+        }
+        snapshot.styles = deserializeStyleSet(p, size - static_cast<size_t>(p - data));
+        if (!snapshot.blocks.empty() && snapshot.blocks.size() != snapshot.styles.size()) {
+            throw runtime_error("Style block snapshot is corrupt");
+        }
+        return snapshot;
+    }
+
+} // namespace DocxParser
@@ -0,0 +1,110 @@
+#ifndef STYLE_BLOCKS_H
+#define STYLE_BLOCKS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "style_snapshot.h"
+
+/**
+ * @brief Incremental re-extraction of a styles part that changed a little
+ *
+ * @details
+ * Editing a template usually changes one or two <w:style> elements, yet a
+ * plain extraction parses all of them again. A StyleBlockSnapshot keeps,
+ * next to the extracted styles, a hash of each style element's raw bytes.
+ * Re-extracting against it, a scanner that only tracks tags finds the
+ * style elements of the new part; styles whose bytes hash the same are
+ * copied from the snapshot and only the others are parsed, together, as
+ * one small synthetic part.
+ *
+ * A style's fields depend on nothing outside its own element (names are
+ * matched without namespace prefixes), so the result is the one a full
+ * extraction would produce, assuming that equal 64-bit hash and length mean
+ * equal bytes. The hash is fast, not cryptographic: an accidental collision
+ * between two elements is about as likely as n^2 / 2^64 for n styles, but
+ * someone who controls both versions of a part can construct one, and the
+ * changed style then keeps its old fields. That only misreports the part
+ * they wrote.
+ *
+ * Anything the scanner does not vouch for falls back to a full extraction:
+ * a changed XML declaration or root tag, a DOCTYPE, a part that is not
+ * UTF-8, or a scan that disagrees with the parser.
+ */
+namespace DocxParser {
+
+/**
+ * @brief Fingerprint of one style element's raw bytes
+ */
+struct StyleBlock {
+    uint64_t hash = 0;    ///< 64-bit hash of the bytes from '<' to the closing '>'
+    uint32_t length = 0;  ///< Byte length, compared along with the hash
+};
+
+/**
+ * @brief Every style of a part plus what is needed to re-extract it incrementally
+ *
+ * styles holds every style element, quick-format or not (filter with
+ * selectStyles()); when blocks is filled, blocks[i] is the element that
+ * styles[i] came from. blocks is empty when the part could not be scanned,
+ * and the next re-extraction is then a full one.
+ */
+struct StyleBlockSnapshot {
+    uint64_t contextHash = 0;  ///< Hash of everything up to the end of the root start tag
+    std::vector<StyleBlock> blocks;
+    StyleSet styles;
+};
+
+/**
+ * @brief What a re-extraction did
+ */
+struct IncrementalReport {
+    size_t blocks = 0;      ///< Style elements in the new part
+    size_t reused = 0;      ///< Taken from the previous snapshot
+    size_t parsed = 0;      ///< Parsed again
+    bool fullRun = false;   ///< No usable snapshot, or the fallback was taken
+};
+
+/**
+ * @brief Extracts a styles part in memory, reusing unchanged styles of previous
+ * @param previous Snapshot of an earlier version of the part; empty for a full run.
+ *        Reused styles are moved out of it, so pass it with std::move when it is
+ *        replaced by the result anyway:
+ *
+ *            snapshot = extractStyleBlocks(data, size, std::move(snapshot));
+ * @throws std::runtime_error if the part is malformed
+ */
+StyleBlockSnapshot extractStyleBlocks(const char* data, size_t size, StyleBlockSnapshot previous = {},
+                                      IncrementalReport* report = nullptr);
+
+/**
+ * @brief Reads styles.xml of a DOCX file and runs extractStyleBlocks() on it
+ * @throws std::runtime_error for any file/parsing errors
+ */
+StyleBlockSnapshot reextractDocxStyles(const std::string& filePath, StyleBlockSnapshot previous = {},
+                                       IncrementalReport* report = nullptr);
+
+/**
+ * @brief Copies the styles a plain extraction returns
+ * @param quickFormatOnly Only visible quick-format styles, as extractDocxStyles(); otherwise
+ *        every style, as extractAllDocxStyles()
+ */
+StyleSet selectStyles(const StyleBlockSnapshot& snapshot, bool quickFormatOnly = true);
+
+/**
+ * @brief Encodes a snapshot: "TSBK" | version | byte length | context hash |
+ *        block count | (hash, length)... | serializeStyleSet() of the styles
+ */
+std::string serializeStyleBlocks(const StyleBlockSnapshot& snapshot);
+
+/**
+ * @brief Decodes serializeStyleBlocks() output
+ * @throws std::runtime_error if the data is not a complete snapshot
+ */
+StyleBlockSnapshot deserializeStyleBlocks(const char* data, size_t size);
+
+} // namespace DocxParser
+
+#endif // STYLE_BLOCKS_H
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include "style_blocks.h"
+
+using namespace DocxParser;
+
+namespace {
+
+std::string sampleStylesXml() {
+    auto zip = openDocxFile("sample.docx");
+    const auto part = readStylesXml(zip.get());
+    return std::string(part.begin(), part.end());
+}
+
+StyleSet fullExtraction(const std::string& part, bool quickFormatOnly) {
+    StreamOptions options;
+    options.quickFormatOnly = quickFormatOnly;
+    StyleSet styles;
+    visitStylesPart(part.data(), part.size(), [&](StyleInfo& style) { styles.push_back(std::move(style)); }, options);
+    return styles;
+}
+
+void expectSameStyles(const StyleSet& actual, const StyleSet& expected) {
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_EQ(actual[i].name, expected[i].name) << i;
+        EXPECT_EQ(actual[i].type, expected[i].type) << i;
+        EXPECT_EQ(actual[i].fontName, expected[i].fontName) << i;
+        EXPECT_EQ(actual[i].fontSize, expected[i].fontSize) << i;
+        EXPECT_EQ(actual[i].properties, expected[i].properties) << i;
+    }
+}
+
+/// Checks a re-extraction of part against previous with a full extraction of part
+StyleBlockSnapshot expectMatchesFullRun(const std::string& part, StyleBlockSnapshot previous,
+                                        IncrementalReport& report) {
+    auto snapshot = extractStyleBlocks(part.data(), part.size(), std::move(previous), &report);
+    expectSameStyles(snapshot.styles, fullExtraction(part, false));
+    expectSameStyles(selectStyles(snapshot), fullExtraction(part, true));
+    return snapshot;
+}
+
+/// Snapshots are move-only, like the styles they hold
+StyleBlockSnapshot copyOf(const StyleBlockSnapshot& snapshot) {
+    const std::string bytes = serializeStyleBlocks(snapshot);
+    return deserializeStyleBlocks(bytes.data(), bytes.size());
+}
+
+void replaceOnce(std::string& text, const std::string& from, const std::string& to) {
+    const size_t at = text.find(from);
+    ASSERT_NE(at, std::string::npos) << from;
+    text.replace(at, from.size(), to);
+}
+
+} // namespace
+
+/**
+ * @brief Only edited, added or moved-in styles are parsed again; the result equals a full run
+ */
+TEST(StyleBlocksTest, ReparsesOnlyChangedStyles) {
+    const std::string original = sampleStylesXml();
+    IncrementalReport report;
+    const auto first = expectMatchesFullRun(original, {}, report);
+    EXPECT_TRUE(report.fullRun);
+    EXPECT_EQ(report.blocks, 36u);
+    ASSERT_EQ(first.blocks.size(), first.styles.size());
+
+    IncrementalReport same;
+    expectMatchesFullRun(original, copyOf(first), same);
+    EXPECT_FALSE(same.fullRun);
+    EXPECT_EQ(same.reused, 36u);
+    EXPECT_EQ(same.parsed, 0u);
+
+    // One edited style, one new style, one removed style
+    std::string edited = original;
+    const size_t heading1 = edited.find("w:styleId=\"Heading1\"");
+    ASSERT_NE(heading1, std::string::npos);
+    const size_t size = edited.find("<w:sz w:val=\"", heading1);
+    ASSERT_NE(size, std::string::npos);
+    edited.replace(size, 13, "<w:sz w:val=\"9");
+    replaceOnce(edited, "</w:styles>",
+                "<w:style w:type=\"character\" w:styleId=\"Added\"><w:name w:val=\"Added &amp; new\"/>"
+                "<w:qFormat/><w:rPr><w:rFonts w:ascii=\"Inter\"/></w:rPr></w:style></w:styles>");
+    const size_t caption = edited.rfind("<w:style ", edited.find("w:styleId=\"Caption\""));
+    edited.erase(caption, edited.find("</w:style>", caption) + 10 - caption);
+
+    IncrementalReport changed;
+    const auto second = expectMatchesFullRun(edited, copyOf(first), changed);
+    EXPECT_FALSE(changed.fullRun);
+    EXPECT_EQ(changed.blocks, 36u);
+    EXPECT_EQ(changed.parsed, 2u);
+    EXPECT_EQ(changed.reused, 34u);
+    EXPECT_EQ(second.styles.back().name, "Added & new");
+}
+
+/**
+ * @brief A changed root tag or a non-UTF-8 part means a full run
+ */
+TEST(StyleBlocksTest, FallsBackToFullRun) {
+    const std::string original = sampleStylesXml();
+    auto first = extractStyleBlocks(original.data(), original.size());
+
+    std::string rootChanged = original;
+    replaceOnce(rootChanged, "<w:styles ", "<w:styles xmlns:x=\"urn:x\" ");
+    IncrementalReport report;
+    const auto second = expectMatchesFullRun(rootChanged, std::move(first), report);
+    EXPECT_TRUE(report.fullRun);
+    EXPECT_EQ(second.blocks.size(), 36u);  // Recorded again for the next run
+
+    const std::string latin1 =
+        "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?><styles><style><name val=\"Caf\xE9\"/></style></styles>";
+    const auto legacy = expectMatchesFullRun(latin1, {}, report);
+    EXPECT_TRUE(legacy.blocks.empty());
+    EXPECT_EQ(legacy.styles.at(0).name, "Caf\xC3\xA9");
+}
+
+/**
+ * @brief Markup that only looks like a style element is not taken for one
+ */
+TEST(StyleBlocksTest, ScannerSkipsCommentsCdataAndQuotedBrackets) {
+    const std::string part =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<w:styles xmlns:w=\"urn:w\">\n"
+        "<!-- <w:style w:styleId=\"Commented\"> -->\n"
+        "<w:latentStyles><w:style w:styleId=\"Nested\"/></w:latentStyles>\n"
+        "<w:style w:styleId=\"A\" w:note='a > b'><w:name w:val=\"A\"/><w:qFormat/>"
+        "<w:caption><![CDATA[</w:style> <x>]]></w:caption></w:style>\n"
+        "<w:style w:styleId=\"B\"/>\n"
+        "</w:styles>\n";
+    IncrementalReport report;
+    const auto first = expectMatchesFullRun(part, {}, report);
+    ASSERT_EQ(first.blocks.size(), 2u);
+    EXPECT_EQ(first.styles[0].properties.at("caption"), "</w:style> <x>");
+
+    std::string edited = part;
+    replaceOnce(edited, "<x>]]>", "<y>]]>");
+    expectMatchesFullRun(edited, copyOf(first), report);
+    EXPECT_EQ(report.parsed, 1u);
+    EXPECT_EQ(report.reused, 1u);
+
+    std::string broken = edited;
+    replaceOnce(broken, "<w:style w:styleId=\"B\"/>", "<w:style w:styleId=\"B\">");
+    EXPECT_THROW(extractStyleBlocks(broken.data(), broken.size(), copyOf(first)), std::runtime_error);
+}
+
+TEST(StyleBlocksTest, SnapshotRoundTrips) {
+    const std::string original = sampleStylesXml();
+    const auto snapshot = extractStyleBlocks(original.data(), original.size());
+    const std::string bytes = serializeStyleBlocks(snapshot);
+    auto decoded = deserializeStyleBlocks(bytes.data(), bytes.size());
+    EXPECT_EQ(decoded.contextHash, snapshot.contextHash);
+    ASSERT_EQ(decoded.blocks.size(), snapshot.blocks.size());
+    EXPECT_EQ(decoded.blocks.back().hash, snapshot.blocks.back().hash);
+    expectSameStyles(decoded.styles, snapshot.styles);
+
+    IncrementalReport report;
+    expectMatchesFullRun(original, std::move(decoded), report);
+    EXPECT_EQ(report.reused, 36u);
+
+    EXPECT_THROW(deserializeStyleBlocks(bytes.data(), bytes.size() - 1), std::runtime_error);
+    EXPECT_THROW(deserializeStyleBlocks(bytes.data() + 1, bytes.size() - 1), std::runtime_error);
+}
@@ -0,0 +1,399 @@
+// Standard C++ headers
+#include <algorithm>  // For sort, lower_bound
+#include <cstring>    // For memcpy
+#include <stdexcept>  // For runtime_error
+
+// Project header
+#include "style_index.h"
+
+using namespace std;
+
+/*
+ * Style Index - Implementation Notes
+ *
+ * The builder keeps one vector of ordinals per term. Because documents and
+ * their styles are added in order, every vector is already sorted, so
+ * writing the index is a single pass: sort the term strings, then encode
+ * each postings list.
+ *
+ * Varint (LEB128) encoding stores 7 bits per byte and uses the high bit as a
+ * "more bytes follow" flag. Deltas between neighbouring ordinals are small,
+ * so most postings take a single byte.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    const char kMagic[4] = {'T', 'S', 'I', 'X'};
+    constexpr uint32_t kVersion = 1;
+
+    // Fixed entry sizes of the on-disk tables
+    constexpr size_t kHeaderSize = 4 + 4 * 4 + 5 * 8;
+    constexpr size_t kDocEntrySize = 12;    // u64 string offset, u32 length
+    constexpr size_t kStyleEntrySize = 16;  // u32 doc, u32 name length, u64 name offset
+    constexpr size_t kTermEntrySize = 32;   // u64 term off, u32 term len, u32 count, u64 postings off, u32 bytes, u32 blocks
+    constexpr size_t kSkipEntrySize = 8;    // u32 first ordinal, u32 byte offset
+
+    void putU32(string& out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    void putU64(string& out, uint64_t v) {
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    uint32_t getU32(const char* p) {
+        const auto* u = reinterpret_cast<const unsigned char*>(p);
+        return uint32_t(u[0]) | uint32_t(u[1]) << 8 | uint32_t(u[2]) << 16 | uint32_t(u[3]) << 24;
+    }
+
+    uint64_t getU64(const char* p) {
+        return uint64_t(getU32(p)) | uint64_t(getU32(p + 4)) << 32;
+    }
+
+    void putVarint(vector<char>& out, uint32_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+
+    // At most 5 bytes for 32 bits, and never past end
+    uint32_t getVarint(const char*& p, const char* end) {
+        uint32_t v = 0;
+        for (int shift = 0; shift < 35 && p != end; shift += 7) {
+            auto byte = static_cast<unsigned char>(*p++);
+            v |= uint32_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return v;
+        }
+        throw runtime_error("Corrupt postings list");
+    }
+
+} // namespace
+
+    vector<string> styleTerms(const StyleInfo& style) {
+        vector<string> terms;
+        terms.reserve(style.properties.size() + 4);
+        if (!style.name.empty()) terms.push_back("name=" + style.name);
+        if (!style.type.empty()) terms.push_back("type=" + style.type);
+        if (!style.fontName.empty()) terms.push_back("font=" + style.fontName);
+        if (!style.fontSize.empty()) terms.push_back("size=" + style.fontSize);
+        for (const auto& prop : style.properties) {
+            terms.push_back(prop.first + "=" + prop.second);
+        }
+        // "name" also appears as a property; keep each term once per style
+        sort(terms.begin(), terms.end());
+        terms.erase(unique(terms.begin(), terms.end()), terms.end());
+        return terms;
+    }
+
+    vector<char> encodePostings(const vector<uint32_t>& ordinals) {
+        const size_t blocks = (ordinals.size() + kPostingsBlockSize - 1) / kPostingsBlockSize;
+
+        // Deltas first, so the skip table can record each block's byte offset
+        vector<char> body;
+        vector<pair<uint32_t, uint32_t>> skips;
+        skips.reserve(blocks);
+        for (size_t i = 0; i < ordinals.size(); ++i) {
+            if (i % kPostingsBlockSize == 0) {
+                // The first ordinal of a block lives in the skip table only
+                skips.emplace_back(ordinals[i], static_cast<uint32_t>(body.size()));
+            } else {
+                putVarint(body, ordinals[i] - ordinals[i - 1]);
+            }
+        }
+
+        string skipTable;
+        skipTable.reserve(blocks * kSkipEntrySize);
+        for (const auto& skip : skips) {
+            putU32(skipTable, skip.first);
+            putU32(skipTable, skip.second);
+        }
+
+        vector<char> out(skipTable.begin(), skipTable.end());
+        out.insert(out.end(), body.begin(), body.end());
+        return out;
+    }
+
+    void StyleIndexBuilder::addTerm(const string& term, uint32_t ordinal) {
+        postings_[term].push_back(ordinal);
+    }
+
+    void StyleIndexBuilder::addDocument(const string& documentPath, const vector<StyleInfo>& styles) {
+        const auto docId = static_cast<uint32_t>(documents_.size());
+        documents_.push_back(documentPath);
+        for (const auto& style : styles) {
+            const auto ordinal = static_cast<uint32_t>(styleDocs_.size());
+            styleDocs_.push_back(docId);
+            styleNames_.push_back(style.name);
+            for (const auto& term : styleTerms(style)) {
+                addTerm(term, ordinal);
+            }
+        }
+    }
+
+    void StyleIndexBuilder::write(const string& indexPath) const {
+        // Sorted term order makes the term table binary-searchable
+        vector<const pair<const string, vector<uint32_t>>*> terms;
+        terms.reserve(postings_.size());
+        for (const auto& entry : postings_) terms.push_back(&entry);
+        sort(terms.begin(), terms.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+        string strings;
+        string docTable;
+        for (const auto& doc : documents_) {
+            putU64(docTable, strings.size());
+            putU32(docTable, static_cast<uint32_t>(doc.size()));
+            strings += doc;
+        }
+
+        string styleTable;
+        for (size_t i = 0; i < styleDocs_.size(); ++i) {
+            putU32(styleTable, styleDocs_[i]);
+            putU32(styleTable, static_cast<uint32_t>(styleNames_[i].size()));
+            putU64(styleTable, strings.size());
+            strings += styleNames_[i];
+        }
+
+        string termTable;
+        vector<char> postings;
+        for (const auto* term : terms) {
+            const vector<uint32_t>& ordinals = term->second;
+            auto encoded = encodePostings(ordinals);
+            putU64(termTable, strings.size());
+            putU32(termTable, static_cast<uint32_t>(term->first.size()));
+            putU32(termTable, static_cast<uint32_t>(ordinals.size()));
+            putU64(termTable, postings.size());
+            putU32(termTable, static_cast<uint32_t>(encoded.size()));
+            putU32(termTable, static_cast<uint32_t>((ordinals.size() + kPostingsBlockSize - 1) / kPostingsBlockSize));
+            strings += term->first;
+            postings.insert(postings.end(), encoded.begin(), encoded.end());
+        }
+
+        const uint64_t docsPos = kHeaderSize;
+        const uint64_t stylesPos = docsPos + docTable.size();
+        const uint64_t termsPos = stylesPos + styleTable.size();
+        const uint64_t stringsPos = termsPos + termTable.size();
+        const uint64_t postingsPos = stringsPos + strings.size();
+
+        string header(kMagic, sizeof(kMagic));
+        putU32(header, kVersion);
+        putU32(header, static_cast<uint32_t>(documents_.size()));
+        putU32(header, static_cast<uint32_t>(styleDocs_.size()));
+        putU32(header, static_cast<uint32_t>(terms.size()));
+        putU64(header, docsPos);
+        putU64(header, stylesPos);
+        putU64(header, termsPos);
+        putU64(header, stringsPos);
+        putU64(header, postingsPos);
+
+        ofstream out(indexPath, ios::binary | ios::trunc);
+        if (!out) {
+            throw runtime_error("Failed to create index file: " + indexPath);
+        }
+        out.write(header.data(), header.size());
+        out.write(docTable.data(), docTable.size());
+        out.write(styleTable.data(), styleTable.size());
+        out.write(termTable.data(), termTable.size());
+        out.write(strings.data(), strings.size());
+        out.write(postings.data(), postings.size());
+        if (!out) {
+            throw runtime_error("Failed to write index file: " + indexPath);
+        }
+    }
+
+    StyleIndexReader::StyleIndexReader(const string& indexPath)
+        : file_(indexPath, ios::binary) {
+        if (!file_) {
+            throw runtime_error("Failed to open index file: " + indexPath);
+        }
+        char header[kHeaderSize];
+        if (!file_.read(header, sizeof(header)) || memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+            throw runtime_error("Not a style index: " + indexPath);
+        }
+        if (getU32(header + 4) != kVersion) {
+            throw runtime_error("Unsupported style index version: " + indexPath);
+        }
+        docCount_ = getU32(header + 8);
+        styleCount_ = getU32(header + 12);
+        termCount_ = getU32(header + 16);
+        docsPos_ = getU64(header + 20);
+        stylesPos_ = getU64(header + 28);
+        termsPos_ = getU64(header + 36);
+        stringsPos_ = getU64(header + 44);
+        postingsPos_ = getU64(header + 52);
+    }
+
+    void StyleIndexReader::readAt(uint64_t offset, void* out, size_t length) {
+        file_.clear();
+        file_.seekg(static_cast<streamoff>(offset));
+        if (!file_.read(static_cast<char*>(out), static_cast<streamsize>(length))) {
+            throw runtime_error("Style index is truncated");
+        }
+    }
+
+    string StyleIndexReader::readString(uint64_t offset, uint32_t length) {
+        string value(length, '\0');
+        if (length) readAt(stringsPos_ + offset, &value[0], length);
+        return value;
+    }
+
+    bool StyleIndexReader::findTerm(const string& term, TermEntry& entry) {
+        // Binary search over the sorted, fixed-size term entries
+        uint32_t lo = 0, hi = termCount_;
+        char raw[kTermEntrySize];
+        while (lo < hi) {
+            const uint32_t mid = lo + (hi - lo) / 2;
+            readAt(termsPos_ + uint64_t(mid) * kTermEntrySize, raw, sizeof(raw));
+            const string candidate = readString(getU64(raw), getU32(raw + 8));
+            const int cmp = candidate.compare(term);
+            if (cmp == 0) {
+                entry.count = getU32(raw + 12);
+                entry.postingsOffset = getU64(raw + 16);
+                entry.postingsBytes = getU32(raw + 24);
+                entry.blockCount = getU32(raw + 28);
+                return true;
+            }
+            if (cmp < 0) lo = mid + 1; else hi = mid;
+        }
+        return false;
+    }
+
+    vector<uint32_t> StyleIndexReader::query(const vector<string>& terms) {
+        vector<PostingsCursor> lists;
+        lists.reserve(terms.size());
+        for (const auto& term : terms) {
+            TermEntry entry;
+            if (!findTerm(term, entry)) {
+                return {};  // One unknown term empties the intersection
+            }
+            vector<char> data(entry.postingsBytes);
+            if (!data.empty()) readAt(postingsPos_ + entry.postingsOffset, data.data(), data.size());
+            lists.emplace_back(move(data), entry.count, entry.blockCount);
+        }
+        return intersectPostings(lists);
+    }
+
+    IndexHit StyleIndexReader::describe(uint32_t ordinal) {
+        if (ordinal >= styleCount_) {
+            throw runtime_error("Style ordinal out of range");
+        }
+        char style[kStyleEntrySize];
+        readAt(stylesPos_ + uint64_t(ordinal) * kStyleEntrySize, style, sizeof(style));
+        char doc[kDocEntrySize];
+        readAt(docsPos_ + uint64_t(getU32(style)) * kDocEntrySize, doc, sizeof(doc));
+
+        IndexHit hit;
+        hit.documentPath = readString(getU64(doc), getU32(doc + 8));
+        hit.styleName = readString(getU64(style + 8), getU32(style + 4));
+        return hit;
+    }
+
+    PostingsCursor::PostingsCursor(vector<char> data, uint32_t count, uint32_t blockCount)
+        : data_(move(data)), count_(count), blockCount_(blockCount) {
+        const uint32_t expectedBlocks = count_ / kPostingsBlockSize + (count_ % kPostingsBlockSize != 0);
+        if (blockCount_ != expectedBlocks || data_.size() < size_t(blockCount_) * kSkipEntrySize) {
+            throw runtime_error("Corrupt postings list");
+        }
+    }
+
+    uint32_t PostingsCursor::blockFirst(uint32_t block) const {
+        return getU32(data_.data() + size_t(block) * kSkipEntrySize);
+    }
+
+    void PostingsCursor::loadBlock(uint32_t block) {
+        currentBlock_ = block;
+        position_ = 0;
+        decoded_.clear();
+
+        const char* skip = data_.data() + size_t(block) * kSkipEntrySize;
+        const size_t bodyStart = size_t(blockCount_) * kSkipEntrySize;
+        const uint32_t offset = getU32(skip + 4);
+        if (offset > data_.size() - bodyStart) {
+            throw runtime_error("Corrupt postings list");
+        }
+        const char* p = data_.data() + bodyStart + offset;
+        const char* end = data_.data() + data_.size();
+        const uint32_t first = block * kPostingsBlockSize;
+        const uint32_t n = min(kPostingsBlockSize, count_ - first);
+
+        uint32_t value = getU32(skip);
+        decoded_.push_back(value);
+        for (uint32_t i = 1; i < n; ++i) {
+            value += getVarint(p, end);
+            decoded_.push_back(value);
+        }
+    }
+
+    uint32_t PostingsCursor::advanceTo(uint32_t target) {
+        if (blockCount_ == 0) return UINT32_MAX;
+
+        // Stay in the current block while it can still contain the target
+        const uint32_t start = currentBlock_ == UINT32_MAX ? 0 : currentBlock_;
+        const bool nextBlockStartsAfterTarget =
+            start + 1 >= blockCount_ || blockFirst(start + 1) > target;
+
+        if (currentBlock_ == UINT32_MAX || !nextBlockStartsAfterTarget) {
+            // Gallop: double the step until we overshoot, then binary search
+            uint32_t lo = start, step = 1, hi = start + 1;
+            while (hi < blockCount_ && blockFirst(hi) <= target) {
+                lo = hi;
+                step *= 2;
+                hi = start + step;
+            }
+            hi = min(hi, blockCount_);
+            // Last block in [lo, hi) whose first ordinal <= target
+            while (hi - lo > 1) {
+                const uint32_t mid = lo + (hi - lo) / 2;
+                if (blockFirst(mid) <= target) lo = mid; else hi = mid;
+            }
+            if (lo != currentBlock_) loadBlock(lo);
+        }
+
+        auto it = lower_bound(decoded_.begin() + position_, decoded_.end(), target);
+        position_ = static_cast<size_t>(it - decoded_.begin());
+        if (it != decoded_.end()) return *it;
+
+        // Target lies past this block; the next block's first ordinal is the answer
+        if (currentBlock_ + 1 >= blockCount_) return UINT32_MAX;
+        loadBlock(currentBlock_ + 1);
+        return decoded_.front();
+    }
+
+    vector<uint32_t> PostingsCursor::decodeAll() {
+        vector<uint32_t> all;
+        all.reserve(count_);
+        for (uint32_t block = 0; block < blockCount_; ++block) {
+            loadBlock(block);
+            all.insert(all.end(), decoded_.begin(), decoded_.end());
+        }
+        currentBlock_ = UINT32_MAX;
+        return all;
+    }
+
+    vector<uint32_t> intersectPostings(vector<PostingsCursor>& lists) {
+        if (lists.empty()) return {};
+
+        // The shortest list drives the intersection; the others are probed
+        sort(lists.begin(), lists.end(),
+             [](const PostingsCursor& a, const PostingsCursor& b) { return a.size() < b.size(); });
+
+        vector<uint32_t> result;
+        for (uint32_t candidate : lists.front().decodeAll()) {
+            bool inAll = true;
+            for (size_t i = 1; i < lists.size(); ++i) {
+                const uint32_t found = lists[i].advanceTo(candidate);
+                if (found == UINT32_MAX) return result;  // A list is exhausted
+                if (found != candidate) {
+                    inAll = false;
+                    break;
+                }
+            }
+            if (inAll) result.push_back(candidate);
+        }
+        return result;
+    }
+
+} // namespace DocxParser
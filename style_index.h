@@ -0,0 +1,187 @@
+#ifndef STYLE_INDEX_H
+#define STYLE_INDEX_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "docx_style_parser.h"
+
+/**
+ * @brief On-disk inverted index over extracted style sets
+ *
+ * The index maps terms to postings lists of style ordinals. Every style of
+ * every indexed document gets a global ordinal (documents are numbered in
+ * insertion order, their styles consecutively), so a postings entry is a
+ * single sorted 32-bit integer that still identifies (document, style).
+ *
+ * Terms are "key=value" strings:
+ * - font=<fontName>, size=<fontSize>, name=<style name>, type=<style type>
+ * - <property>=<value> for every entry of StyleInfo::properties
+ *
+ * File layout (all integers little-endian):
+ *   Header | document entries | style entries | term entries | string pool | postings
+ *
+ * Postings are stored in blocks of kPostingsBlockSize ordinals. Each list
+ * starts with a skip table of (first ordinal, byte offset) pairs followed by
+ * LEB128 varint deltas, so a reader can gallop over the skip table and only
+ * decode the blocks it actually lands in.
+ */
+namespace DocxParser {
+
+constexpr uint32_t kPostingsBlockSize = 128;
+
+/**
+ * @brief One hit of an index query
+ */
+struct IndexHit {
+    std::string documentPath; ///< Path of the document the style belongs to
+    std::string styleName;    ///< Name of the matching style
+};
+
+/**
+ * @brief Builds an index in memory and writes it to disk
+ */
+class StyleIndexBuilder {
+public:
+    /**
+     * @brief Adds the styles of one document to the index
+     * @param documentPath Path recorded for query results
+     * @param styles Styles extracted from the document
+     */
+    void addDocument(const std::string& documentPath, const std::vector<StyleInfo>& styles);
+
+    /**
+     * @brief Serializes the index
+     * @param indexPath Output file path
+     * @throws std::runtime_error if the file cannot be written
+     */
+    void write(const std::string& indexPath) const;
+
+    size_t documentCount() const { return documents_.size(); }
+    size_t styleCount() const { return styleDocs_.size(); }
+
+private:
+    void addTerm(const std::string& term, uint32_t ordinal);
+
+    std::vector<std::string> documents_;
+    std::vector<uint32_t> styleDocs_;   ///< ordinal -> document id
+    std::vector<std::string> styleNames_; ///< ordinal -> style name
+    std::unordered_map<std::string, std::vector<uint32_t>> postings_;
+};
+
+/**
+ * @brief Read-only view of an index file
+ *
+ * Only the fixed-size header is read up front. Term lookups binary-search the
+ * term entry table on disk and only the postings of the queried terms are
+ * loaded, which keeps query latency independent of corpus size.
+ */
+class StyleIndexReader {
+public:
+    /**
+     * @brief Opens an index file
+     * @throws std::runtime_error if the file is missing or not an index
+     */
+    explicit StyleIndexReader(const std::string& indexPath);
+
+    /**
+     * @brief Returns the style ordinals matching all terms
+     * @param terms "key=value" terms; an empty list matches nothing
+     */
+    std::vector<uint32_t> query(const std::vector<std::string>& terms);
+
+    /**
+     * @brief Resolves a style ordinal to its document and style name
+     */
+    IndexHit describe(uint32_t ordinal);
+
+    uint32_t documentCount() const { return docCount_; }
+    uint32_t styleCount() const { return styleCount_; }
+
+private:
+    struct TermEntry {
+        uint64_t postingsOffset = 0;
+        uint32_t postingsBytes = 0;
+        uint32_t count = 0;
+        uint32_t blockCount = 0;
+    };
+
+    bool findTerm(const std::string& term, TermEntry& entry);
+    std::string readString(uint64_t offset, uint32_t length);
+    void readAt(uint64_t offset, void* out, size_t length);
+
+    std::ifstream file_;
+    uint32_t docCount_ = 0;
+    uint32_t styleCount_ = 0;
+    uint32_t termCount_ = 0;
+    uint64_t docsPos_ = 0;
+    uint64_t stylesPos_ = 0;
+    uint64_t termsPos_ = 0;
+    uint64_t stringsPos_ = 0;
+    uint64_t postingsPos_ = 0;
+};
+
+/**
+ * @brief Decoded postings list with block-wise random access
+ *
+ * Exposed so the intersection can be tested without going through a file.
+ */
+class PostingsCursor {
+public:
+    /**
+     * @param data Encoded postings (skip table followed by varint blocks)
+     * @param count Number of ordinals in the list
+     * @param blockCount Number of blocks in the skip table
+     */
+    PostingsCursor(std::vector<char> data, uint32_t count, uint32_t blockCount);
+
+    /**
+     * @brief Returns the first ordinal >= target, or UINT32_MAX if none
+     *
+     * Gallops (exponential then binary search) over the skip table starting at
+     * the current block, so repeated calls with increasing targets cost
+     * O(log distance) instead of a linear scan.
+     */
+    uint32_t advanceTo(uint32_t target);
+
+    /// Decodes the whole list
+    std::vector<uint32_t> decodeAll();
+
+    uint32_t size() const { return count_; }
+
+private:
+    uint32_t blockFirst(uint32_t block) const;
+    void loadBlock(uint32_t block);
+
+    std::vector<char> data_;
+    uint32_t count_;
+    uint32_t blockCount_;
+    uint32_t currentBlock_ = UINT32_MAX;
+    std::vector<uint32_t> decoded_;
+    size_t position_ = 0;
+};
+
+/**
+ * @brief Encodes a sorted ordinal list in the on-disk postings format
+ * @param ordinals Strictly increasing ordinals
+ * @return Encoded bytes; the block count is ceil(size / kPostingsBlockSize)
+ */
+std::vector<char> encodePostings(const std::vector<uint32_t>& ordinals);
+
+/**
+ * @brief Intersects postings lists, smallest first, using galloping search
+ */
+std::vector<uint32_t> intersectPostings(std::vector<PostingsCursor>& lists);
+
+/**
+ * @brief Lists the index terms describing one style
+ */
+std::vector<std::string> styleTerms(const StyleInfo& style);
+
+} // namespace DocxParser
+
+#endif // STYLE_INDEX_H
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include "style_index.h"
+
+using namespace DocxParser;
+
+namespace {
+
+StyleInfo makeStyle(const std::string& name, const std::string& type,
+                    const std::string& font, const std::string& size) {
+    StyleInfo style;
+    style.name = name;
+    style.type = type;
+    style.fontName = font;
+    style.fontSize = size;
+    style.properties["name"] = name;
+    return style;
+}
+
+} // namespace
+
+/**
+ * @brief Galloping must find the same ordinals as a linear scan
+ *
+ * @details
+ * The lists span many postings blocks so advanceTo() has to jump across
+ * block boundaries, both within a block and via the skip table.
+ */
+TEST(StyleIndexTest, IntersectsAcrossBlocks) {
+    std::vector<uint32_t> multiplesOf3, multiplesOf5;
+    for (uint32_t i = 0; i < 5000; ++i) {
+        if (i % 3 == 0) multiplesOf3.push_back(i);
+        if (i % 5 == 0) multiplesOf5.push_back(i);
+    }
+
+    std::vector<PostingsCursor> lists;
+    lists.emplace_back(encodePostings(multiplesOf3), multiplesOf3.size(),
+                       (multiplesOf3.size() + kPostingsBlockSize - 1) / kPostingsBlockSize);
+    lists.emplace_back(encodePostings(multiplesOf5), multiplesOf5.size(),
+                       (multiplesOf5.size() + kPostingsBlockSize - 1) / kPostingsBlockSize);
+
+    auto result = intersectPostings(lists);
+    ASSERT_EQ(result.size(), 334u);  // Multiples of 15 below 5000
+    for (size_t i = 0; i < result.size(); ++i) {
+        EXPECT_EQ(result[i], i * 15);
+    }
+}
+
+/**
+ * @brief Round trip through the on-disk format
+ */
+TEST(StyleIndexTest, QueriesWrittenIndex) {
+    const std::string path = "style_index_test.tsix";
+    {
+        StyleIndexBuilder builder;
+        for (int doc = 0; doc < 300; ++doc) {
+            std::vector<StyleInfo> styles;
+            styles.push_back(makeStyle("Normal", "paragraph", doc % 2 ? "Calibri" : "Arial", "22"));
+            styles.push_back(makeStyle("Strong", "character", "Calibri", "22"));
+            builder.addDocument("doc" + std::to_string(doc) + ".docx", styles);
+        }
+        builder.write(path);
+    }
+
+    StyleIndexReader reader(path);
+    EXPECT_EQ(reader.documentCount(), 300u);
+    EXPECT_EQ(reader.styleCount(), 600u);
+
+    auto hits = reader.query({"font=Calibri", "size=22", "type=paragraph"});
+    ASSERT_EQ(hits.size(), 150u);
+    auto first = reader.describe(hits.front());
+    EXPECT_EQ(first.documentPath, "doc1.docx");
+    EXPECT_EQ(first.styleName, "Normal");
+
+    EXPECT_TRUE(reader.query({"font=Calibri", "type=table"}).empty());
+    EXPECT_TRUE(reader.query({"font=Missing"}).empty());
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Truncated or bit-flipped postings throw instead of reading past the list
+ */
+TEST(StyleIndexTest, RejectsCorruptPostings) {
+    std::vector<uint32_t> ordinals;
+    for (uint32_t i = 0; i < 1000; ++i) ordinals.push_back(i * 300);  // Two-byte deltas
+    const uint32_t blocks = (ordinals.size() + kPostingsBlockSize - 1) / kPostingsBlockSize;
+    const auto encoded = encodePostings(ordinals);
+
+    auto truncated = encoded;
+    truncated.resize(truncated.size() - 3);
+    PostingsCursor shortList(truncated, ordinals.size(), blocks);
+    EXPECT_THROW(shortList.decodeAll(), std::runtime_error);
+
+    auto badOffset = encoded;
+    badOffset[8 * (blocks - 1) + 7] = '\x7F';  // Top byte of the last skip entry's body offset
+    PostingsCursor farList(badOffset, ordinals.size(), blocks);
+    EXPECT_THROW(farList.decodeAll(), std::runtime_error);
+
+    EXPECT_THROW(PostingsCursor(encoded, ordinals.size(), blocks + 1), std::runtime_error);
+}
+
+/**
+ * @brief An index file cut short fails its queries with an error
+ */
+TEST(StyleIndexTest, RejectsTruncatedIndex) {
+    const std::string path = "style_index_truncated.tsix";
+    {
+        StyleIndexBuilder builder;
+        for (int doc = 0; doc < 300; ++doc) {
+            std::vector<StyleInfo> styles;
+            styles.push_back(makeStyle("Normal", "paragraph", "Arial", "22"));
+            builder.addDocument("doc" + std::to_string(doc) + ".docx", styles);
+        }
+        builder.write(path);
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+    try {
+        StyleIndexReader reader(path);
+        reader.query({"font=Arial", "size=22"});
+        FAIL() << "Expected the truncated index to be rejected";
+    } catch (const std::runtime_error&) {
+    }
+    std::remove(path.c_str());
+}
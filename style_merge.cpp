@@ -0,0 +1,341 @@
+// Standard C++ headers
+#include <algorithm>      // For sort, binary_search, transform
+#include <cctype>         // For tolower
+#include <stdexcept>      // For runtime_error
+#include <unordered_set>  // For per-document key de-duplication
+
+// Project headers
+#include "style_merge.h"
+#include "style_provenance.h"  // For isBookkeepingProperty
+#include "typst_generator.h"
+
+using namespace std;
+
+/*
+ * Style Merge - Implementation Notes
+ *
+ * addDocument() works in two phases:
+ *   1. Unlocked: resolveStyleGraph() orders the document's styles parents
+ *      first, so one pass resolves every style as a copy of its parent's
+ *      set with its own properties laid over it. Each set is hashed (FNV-1a
+ *      over "key\0value\0" in key order, which std::map guarantees).
+ *   2. Locked: one lookup per style in the group table, then one in the
+ *      group's hash -> variants table. Equal hashes are confirmed by
+ *      comparing the sets, so a collision costs a comparison, never a
+ *      wrong merge.
+ * A document that defines the same key twice (two names differing in case)
+ * counts once, with its first definition, as Word itself would match it.
+ *
+ * The library keeps basedOn where it is still true: a style stays based on
+ * its parent group's chosen variant only if it resolves every key the
+ * parent does. Otherwise inheriting would add settings the chosen variant
+ * never had, so the style becomes a root with its full set.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    string lowercase(string text) {
+        transform(text.begin(), text.end(), text.begin(),
+                  [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        return text;
+    }
+
+    string property(const StyleInfo& style, const string& key) {
+        auto it = style.properties.find(key);
+        return it == style.properties.end() ? "" : it->second;
+    }
+
+    string groupKey(MergeKey key, const StyleInfo& style) {
+        const string styleId = property(style, "styleId");
+        string id = key == MergeKey::StyleId || style.name.empty() ? styleId : lowercase(style.name);
+        return style.type + '\0' + id;
+    }
+
+    uint64_t canonicalHash(const ResolvedProperties& properties) {
+        uint64_t hash = 14695981039346656037ull;
+        const auto mix = [&hash](const string& text) {
+            for (unsigned char c : text) {
+                hash ^= c;
+                hash *= 1099511628211ull;
+            }
+            hash *= 1099511628211ull;  // The '\0' separator (xor with 0 is a no-op)
+        };
+        for (const auto& [key, value] : properties) {
+            mix(key);
+            mix(value);
+        }
+        return hash;
+    }
+
+    /**
+     * @brief A style of one document, ready to merge
+     */
+    struct Canonical {
+        size_t style;          // Index in the document
+        string key;
+        string parentKey;
+        ResolvedProperties properties;
+        uint64_t hash;
+    };
+
+    vector<Canonical> canonicalize(MergeKey mergeKey, const vector<StyleInfo>& styles) {
+        const StyleGraph graph = resolveStyleGraph(styles);
+        vector<ResolvedProperties> resolved(styles.size());
+        for (size_t i : graph.order) {
+            const StyleInfo& style = styles[i];
+            ResolvedProperties& properties = resolved[i];
+            if (graph.parent[i] != StyleGraph::kNone) properties = resolved[graph.parent[i]];
+            for (const auto& [key, value] : style.properties) {
+                if (!isBookkeepingProperty(key)) properties[key] = value;
+            }
+            if (!style.fontName.empty()) properties["@font"] = style.fontName;
+            if (!style.fontSize.empty()) properties["@size"] = style.fontSize;
+        }
+
+        vector<Canonical> canonical;
+        canonical.reserve(styles.size());
+        unordered_set<string> seen;
+        for (size_t i = 0; i < styles.size(); ++i) {
+            string key = groupKey(mergeKey, styles[i]);
+            if (key.size() == styles[i].type.size() + 1 || !seen.insert(key).second) continue;  // No name, no id
+            string parentKey = graph.parent[i] == StyleGraph::kNone ? "" : groupKey(mergeKey, styles[graph.parent[i]]);
+            const uint64_t hash = canonicalHash(resolved[i]);
+            canonical.push_back({i, move(key), move(parentKey), move(resolved[i]), hash});
+        }
+        return canonical;
+    }
+
+    bool variantBefore(const StyleVariant& a, const StyleVariant& b) {
+        if (a.count() != b.count()) return a.count() > b.count();
+        return a.documents.front() < b.documents.front();
+    }
+
+} // namespace
+
+    struct StyleMerger::Entry {
+        StyleGroup group;
+        size_t firstDocument = 0;
+        size_t firstPosition = 0;
+        unordered_multimap<uint64_t, size_t> byHash;  // Variant indexes
+    };
+
+    StyleMerger::StyleMerger(MergeKey key) : key_(key) {}
+
+    StyleMerger::~StyleMerger() = default;
+
+    void StyleMerger::addDocument(size_t index, const string& path, const vector<StyleInfo>& styles) {
+        vector<Canonical> canonical = canonicalize(key_, styles);
+
+        lock_guard<mutex> lock(lock_);
+        if (!paths_.emplace(index, path).second) {
+            throw runtime_error("Document " + to_string(index) + " was already merged");
+        }
+        for (auto& style : canonical) {
+            auto& slot = groups_[style.key];
+            if (!slot) {
+                slot = make_unique<Entry>();
+                slot->group.key = style.key;
+                slot->firstDocument = index;
+                slot->firstPosition = style.style;
+            }
+            Entry& entry = *slot;
+            // Name, type and id of the earliest document, whatever order documents arrive in
+            const bool earliest = index < entry.firstDocument ||
+                                  (index == entry.firstDocument && style.style <= entry.firstPosition);
+            if (earliest) {
+                const StyleInfo& source = styles[style.style];
+                entry.group.name = source.name;
+                entry.group.type = source.type;
+                entry.group.styleId = property(source, "styleId");
+                entry.firstDocument = index;
+                entry.firstPosition = style.style;
+            }
+
+            StyleVariant* variant = nullptr;
+            auto range = entry.byHash.equal_range(style.hash);
+            for (auto it = range.first; it != range.second && !variant; ++it) {
+                if (entry.group.variants[it->second].properties == style.properties) {
+                    variant = &entry.group.variants[it->second];
+                }
+            }
+            if (!variant) {
+                entry.byHash.emplace(style.hash, entry.group.variants.size());
+                entry.group.variants.emplace_back();
+                variant = &entry.group.variants.back();
+                variant->hash = style.hash;
+                variant->properties = move(style.properties);
+            }
+            // documents stays unsorted until groups(), but its front is the earliest
+            variant->documents.push_back(index);
+            if (variant->documents.size() == 1 || index < variant->documents.front()) {
+                swap(variant->documents.front(), variant->documents.back());
+                variant->parentKey = move(style.parentKey);
+            }
+        }
+    }
+
+    size_t StyleMerger::documents() const {
+        lock_guard<mutex> lock(lock_);
+        return paths_.size();
+    }
+
+    string StyleMerger::documentPath(size_t index) const {
+        lock_guard<mutex> lock(lock_);
+        auto it = paths_.find(index);
+        return it == paths_.end() ? "" : it->second;
+    }
+
+    vector<StyleGroup> StyleMerger::groups() const {
+        lock_guard<mutex> lock(lock_);
+        vector<const Entry*> entries;
+        entries.reserve(groups_.size());
+        for (const auto& [key, entry] : groups_) entries.push_back(entry.get());
+        sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) {
+            if (a->firstDocument != b->firstDocument) return a->firstDocument < b->firstDocument;
+            if (a->firstPosition != b->firstPosition) return a->firstPosition < b->firstPosition;
+            return a->group.key < b->group.key;
+        });
+
+        vector<StyleGroup> groups;
+        groups.reserve(entries.size());
+        for (const Entry* entry : entries) {
+            StyleGroup group;
+            group.key = entry->group.key;
+            group.name = entry->group.name;
+            group.type = entry->group.type;
+            group.styleId = entry->group.styleId;
+            group.variants.reserve(entry->group.variants.size());
+            for (const auto& source : entry->group.variants) {
+                StyleVariant variant;
+                variant.hash = source.hash;
+                variant.properties = source.properties;
+                variant.documents = source.documents;
+                variant.parentKey = source.parentKey;
+                sort(variant.documents.begin(), variant.documents.end());
+                group.variants.push_back(move(variant));
+            }
+            sort(group.variants.begin(), group.variants.end(), variantBefore);
+            groups.push_back(move(group));
+        }
+        return groups;
+    }
+
+    MergedLibrary StyleMerger::library(const vector<StyleGroup>& groups, const MergeChoice& choice) const {
+        // Variant per group: chosen, else the preferred document's, else the majority
+        vector<size_t> picked(groups.size(), 0);
+        if (!choice.preferDocument.empty()) {
+            size_t preferred = SIZE_MAX;
+            {
+                lock_guard<mutex> lock(lock_);
+                for (const auto& [index, path] : paths_) {
+                    if (path == choice.preferDocument) preferred = index;
+                }
+            }
+            if (preferred == SIZE_MAX) {
+                throw runtime_error("Preferred document " + choice.preferDocument + " is not among the merged ones");
+            }
+            for (size_t g = 0; g < groups.size(); ++g) {
+                const auto& variants = groups[g].variants;
+                for (size_t v = 0; v < variants.size(); ++v) {
+                    if (binary_search(variants[v].documents.begin(), variants[v].documents.end(), preferred)) {
+                        picked[g] = v;
+                    }
+                }
+            }
+        }
+        for (const auto& [name, variant] : choice.chosen) {
+            const string wanted = lowercase(name);
+            bool found = false;
+            for (size_t g = 0; g < groups.size(); ++g) {
+                if (lowercase(groups[g].name) != wanted) continue;
+                found = true;
+                if (variant >= groups[g].variants.size()) {
+                    throw runtime_error("Style '" + name + "' has " + to_string(groups[g].variants.size()) +
+                                        " variant(s); variant " + to_string(variant + 1) + " does not exist");
+                }
+                picked[g] = variant;
+            }
+            if (!found) throw runtime_error("No merged style is named '" + name + "'");
+        }
+
+        // Unique styleIds for the library; the first group keeps a contested id
+        unordered_map<string, size_t> groupByKey;
+        unordered_set<string> usedIds;
+        vector<string> ids(groups.size());
+        for (size_t g = 0; g < groups.size(); ++g) {
+            groupByKey.emplace(groups[g].key, g);
+            string base = groups[g].styleId.empty() ? "Style" : groups[g].styleId;
+            string id = base;
+            for (size_t n = 2; !usedIds.insert(id).second; ++n) id = base + to_string(n);
+            ids[g] = move(id);
+        }
+
+        MergedLibrary library;
+        library.variant = picked;
+        auto& sheet = library.sheet;
+        sheet.styles.reserve(groups.size());
+        for (size_t g = 0; g < groups.size(); ++g) {
+            const StyleVariant& variant = groups[g].variants[picked[g]];
+            StyleInfo style;
+            style.name = groups[g].name;
+            style.type = groups[g].type;
+            for (const auto& [key, value] : variant.properties) {
+                if (key == "@font") {
+                    style.fontName = value;
+                } else if (key == "@size") {
+                    style.fontSize = value;
+                } else {
+                    style.properties[key] = value;
+                }
+            }
+            style.properties["styleId"] = ids[g];
+
+            auto parent = variant.parentKey.empty() ? groupByKey.end() : groupByKey.find(variant.parentKey);
+            if (parent != groupByKey.end() && parent->second != g) {
+                const auto& inherited = groups[parent->second].variants[picked[parent->second]].properties;
+                const bool covered = all_of(inherited.begin(), inherited.end(), [&](const auto& entry) {
+                    return variant.properties.count(entry.first) > 0;
+                });
+                if (covered) style.properties["basedOn"] = ids[parent->second];
+            }
+
+            // Heading table as extractDocxStyleSheet() builds it
+            auto level = style.properties.find("outlineLvl");
+            if (style.type == "paragraph" && level != style.properties.end() && level->second.size() == 1 &&
+                level->second[0] >= '0' && level->second[0] <= '8') {
+                const size_t n = static_cast<size_t>(level->second[0] - '0');
+                const string builtIn = "heading " + to_string(n + 1);
+                size_t& slot = sheet.headingLevels[n];
+                if (slot == StyleSheet::kNoStyle ||
+                    (style.name == builtIn && sheet.styles[slot].name != builtIn)) {
+                    slot = sheet.styles.size();
+                }
+            }
+            sheet.styles.push_back(move(style));
+        }
+        return library;
+    }
+
+    vector<string> describeDifferences(const ResolvedProperties& properties, const ResolvedProperties& reference) {
+        vector<string> differences;
+        auto it = properties.begin();
+        auto ref = reference.begin();
+        while (it != properties.end() || ref != reference.end()) {
+            if (ref == reference.end() || (it != properties.end() && it->first < ref->first)) {
+                differences.push_back(it->first + "=" + it->second);
+                ++it;
+            } else if (it == properties.end() || ref->first < it->first) {
+                differences.push_back(ref->first + " unset");
+                ++ref;
+            } else {
+                if (it->second != ref->second) differences.push_back(it->first + "=" + it->second);
+                ++it;
+                ++ref;
+            }
+        }
+        return differences;
+    }
+
+} // namespace DocxParser
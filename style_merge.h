@@ -0,0 +1,148 @@
+#ifndef STYLE_MERGE_H
+#define STYLE_MERGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "docx_style_parser.h"
+
+/**
+ * @brief Merge of many templates' styles into one canonical library
+ *
+ * Templates of one organisation drift apart: "Heading 1" is 16pt Calibri
+ * Light in most of them, 14pt in some, blue in a few. The merger groups
+ * styles across documents (by type and name, or by type and styleId),
+ * resolves each one's basedOn chain within its own document and
+ * canonicalizes the resolved property set to a hash, so equal definitions
+ * fall into one variant however they are spelled (inherited or set
+ * directly, in any element order). Each group then has a list of variants
+ * with the documents that use them, and the library takes one variant per
+ * group: the one chosen explicitly, the one the preferred document uses,
+ * or the majority.
+ *
+ * Work is linear in the total number of styles and their resolved
+ * properties: each document is resolved and hashed on its own (on the
+ * batch worker that extracted it), and merging is one hash lookup per style.
+ */
+namespace DocxParser {
+
+/**
+ * @brief What makes two styles of different documents "the same style"
+ */
+enum class MergeKey {
+    Name,     ///< Type and name, case-insensitive; built-in names are stable, styleIds are localized
+    StyleId,  ///< Type and styleId
+};
+
+/**
+ * @brief Resolved property set of a style: Word properties after basedOn inheritance
+ *
+ * The font and size fields are included as "@font" and "@size". Bookkeeping
+ * that does not change the look (styleId, basedOn, next, link, rsid,
+ * uiPriority, qFormat, semiHidden, ...) is left out.
+ */
+using ResolvedProperties = std::map<std::string, std::string>;
+
+/**
+ * @brief One distinct definition of a style
+ */
+struct StyleVariant {
+    uint64_t hash = 0;                   ///< Canonical hash of properties
+    ResolvedProperties properties;
+    std::vector<size_t> documents;       ///< Indexes of the documents using it, ascending
+    std::string parentKey;               ///< Group key of the basedOn parent where first seen; empty for roots
+
+    size_t count() const { return documents.size(); }
+};
+
+/**
+ * @brief Every variant of one style across the merged documents
+ */
+struct StyleGroup {
+    std::string key;       ///< Grouping key (type, '\0', lowercased name or styleId)
+    std::string name;      ///< Name where first seen
+    std::string type;
+    std::string styleId;   ///< styleId where first seen
+    std::vector<StyleVariant> variants;  ///< Most used first; ties by first document
+};
+
+/**
+ * @brief How the library picks a variant per group
+ */
+struct MergeChoice {
+    /// Variant (0-based, in StyleGroup::variants order) by style name, case-insensitive
+    std::map<std::string, size_t> chosen;
+    /// Document whose variant wins wherever it has the style; empty for none
+    std::string preferDocument;
+};
+
+/**
+ * @brief Library produced by a merge
+ */
+struct MergedLibrary {
+    StyleSheet sheet;               ///< One style per group, with resolved properties
+    std::vector<size_t> variant;    ///< [i] = index of the variant sheet.styles[i] came from
+};
+
+/**
+ * @brief Collects documents' styles and groups their variants
+ *
+ * addDocument() may be called from several threads at once (for instance
+ * from BatchOptions::onItem); resolution and hashing happen outside the
+ * lock, so only the per-style hash lookups are serialized.
+ */
+class StyleMerger {
+public:
+    explicit StyleMerger(MergeKey key = MergeKey::Name);
+    ~StyleMerger();
+
+    /**
+     * @brief Adds one document's styles (all of them: basedOn parents are needed)
+     * @param index Position of the document in the input; decides ties and reporting order
+     */
+    void addDocument(size_t index, const std::string& path, const std::vector<StyleInfo>& styles);
+
+    /// Number of documents added
+    size_t documents() const;
+
+    /// Path of the document added with index, or "" if none was
+    std::string documentPath(size_t index) const;
+
+    /**
+     * @brief Groups in order of first appearance (document index, then position in it)
+     */
+    std::vector<StyleGroup> groups() const;
+
+    /**
+     * @brief Builds the library from groups()
+     * @throws std::runtime_error if choice names an unknown style, a variant out of
+     *         range or a document that was not added
+     */
+    MergedLibrary library(const std::vector<StyleGroup>& groups, const MergeChoice& choice = {}) const;
+
+private:
+    struct Entry;
+
+    MergeKey key_;
+    mutable std::mutex lock_;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> groups_;
+    std::map<size_t, std::string> paths_;
+};
+
+/**
+ * @brief Properties of a resolved set that differ from a reference set
+ *
+ * "key=value" for changed or added keys, "key unset" for missing ones, in key order.
+ */
+std::vector<std::string> describeDifferences(const ResolvedProperties& properties,
+                                             const ResolvedProperties& reference);
+
+} // namespace DocxParser
+
+#endif // STYLE_MERGE_H
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+#include "style_merge.h"
+#include "test_styles.h"
+
+using namespace DocxParser;
+
+namespace {
+
+/// makeStyle() with a display name other than the id and a font size
+StyleInfo namedStyle(const std::string& name, const std::string& id, const std::string& basedOn,
+                     const std::string& size, const std::string& type = "paragraph") {
+    StyleInfo style = makeStyle(id, basedOn, type);
+    style.name = name;
+    style.fontSize = size;
+    return style;
+}
+
+/// Normal (11pt) plus "heading 1" of the given size and colour, based on Normal
+std::vector<StyleInfo> templateStyles(const std::string& headingId, const std::string& headingSize,
+                                      const std::string& color) {
+    std::vector<StyleInfo> styles;
+    styles.push_back(namedStyle("heading 1", headingId, "Normal", headingSize));
+    styles.back().properties["outlineLvl"] = "0";
+    styles.back().properties["rsid"] = headingId;  // Bookkeeping: never makes a variant
+    if (!color.empty()) styles.back().properties["color"] = color;
+    styles.push_back(namedStyle("Normal", "Normal", "", "22"));
+    styles.back().properties["qFormat"] = "";
+    return styles;
+}
+
+const StyleGroup& groupNamed(const std::vector<StyleGroup>& groups, const std::string& name) {
+    for (const auto& group : groups) {
+        if (group.name == name) return group;
+    }
+    throw std::runtime_error("no group " + name);
+}
+
+} // namespace
+
+/**
+ * @brief Styles group by name across localized styleIds; equal resolved sets are one variant
+ */
+TEST(StyleMergeTest, GroupsAndCountsVariants) {
+    StyleMerger merger;
+    merger.addDocument(0, "a.docx", templateStyles("Heading1", "32", "2F5496"));
+    merger.addDocument(1, "b.docx", templateStyles("berschrift1", "32", "2F5496"));
+    merger.addDocument(2, "c.docx", templateStyles("Heading1", "28", ""));
+
+    const auto groups = merger.groups();
+    ASSERT_EQ(groups.size(), 2u);
+    EXPECT_EQ(groups[0].name, "heading 1");
+    EXPECT_EQ(groups[0].styleId, "Heading1");
+    ASSERT_EQ(groups[0].variants.size(), 2u);
+    EXPECT_EQ(groups[0].variants[0].documents, (std::vector<size_t>{0, 1}));
+    EXPECT_EQ(groups[0].variants[1].documents, (std::vector<size_t>{2}));
+    EXPECT_EQ(groups[0].variants[0].properties.at("@size"), "32");
+    EXPECT_EQ(groups[0].variants[0].parentKey, groups[1].key);
+    EXPECT_EQ(groups[1].variants.size(), 1u);
+    EXPECT_EQ(groups[1].variants[0].count(), 3u);
+
+    EXPECT_EQ(describeDifferences(groups[0].variants[1].properties, groups[0].variants[0].properties),
+              (std::vector<std::string>{"@size=28", "color unset"}));
+
+    StyleMerger byId(MergeKey::StyleId);
+    byId.addDocument(0, "a.docx", templateStyles("Heading1", "32", ""));
+    byId.addDocument(1, "b.docx", templateStyles("berschrift1", "32", ""));
+    EXPECT_EQ(byId.groups().size(), 3u);
+}
+
+/**
+ * @brief Inherited and directly set properties canonicalize to the same variant
+ */
+TEST(StyleMergeTest, ComparesResolvedProperties) {
+    std::vector<StyleInfo> inherited;
+    inherited.push_back(namedStyle("Normal", "Normal", "", "22"));
+    inherited.back().fontName = "Calibri";
+    inherited.push_back(namedStyle("Quote", "Quote", "Normal", ""));
+    inherited.back().properties["i"] = "";
+
+    std::vector<StyleInfo> direct;
+    direct.push_back(namedStyle("Quote", "Quote", "", "22"));
+    direct.back().fontName = "Calibri";
+    direct.back().properties["i"] = "";
+    direct.push_back(namedStyle("Normal", "Normal", "", "22"));
+    direct.back().fontName = "Calibri";
+
+    StyleMerger merger;
+    merger.addDocument(0, "inherited.docx", inherited);
+    merger.addDocument(1, "direct.docx", direct);
+    const auto groups = merger.groups();
+    ASSERT_EQ(groups.size(), 2u);
+    EXPECT_EQ(groups[0].name, "Normal");  // First appearance: document 0, position 0
+    EXPECT_EQ(groupNamed(groups, "Quote").variants.size(), 1u);
+    EXPECT_EQ(groupNamed(groups, "Quote").variants[0].count(), 2u);
+}
+
+/**
+ * @brief Majority by default; --prefer and --choose override it; basedOn is kept only where true
+ */
+TEST(StyleMergeTest, BuildsLibraryFromChosenVariants) {
+    StyleMerger merger;
+    merger.addDocument(0, "a.docx", templateStyles("Heading1", "28", ""));
+    merger.addDocument(1, "b.docx", templateStyles("Heading1", "32", "2F5496"));
+    merger.addDocument(2, "c.docx", templateStyles("Heading1", "32", "2F5496"));
+    const auto groups = merger.groups();
+
+    auto library = merger.library(groups);
+    ASSERT_EQ(library.sheet.styles.size(), 2u);
+    const StyleInfo& heading = library.sheet.styles[0];
+    EXPECT_EQ(heading.fontSize, "32");
+    EXPECT_EQ(heading.properties.at("color"), "2F5496");
+    EXPECT_EQ(heading.properties.at("basedOn"), "Normal");
+    EXPECT_EQ(heading.properties.count("rsid"), 0u);
+    EXPECT_EQ(library.sheet.headingLevels[0], 0u);
+    EXPECT_EQ(library.sheet.styles[1].fontSize, "22");
+    EXPECT_EQ(library.sheet.styles[1].properties.count("basedOn"), 0u);
+
+    MergeChoice prefer;
+    prefer.preferDocument = "a.docx";
+    EXPECT_EQ(merger.library(groups, prefer).sheet.styles[0].fontSize, "28");
+
+    MergeChoice choose;
+    choose.preferDocument = "a.docx";
+    choose.chosen["Heading 1"] = 0;
+    EXPECT_EQ(merger.library(groups, choose).sheet.styles[0].fontSize, "32");
+
+    MergeChoice outOfRange;
+    outOfRange.chosen["heading 1"] = 2;
+    EXPECT_THROW(merger.library(groups, outOfRange), std::runtime_error);
+    MergeChoice unknown;
+    unknown.chosen["Title"] = 0;
+    EXPECT_THROW(merger.library(groups, unknown), std::runtime_error);
+    MergeChoice missing;
+    missing.preferDocument = "d.docx";
+    EXPECT_THROW(merger.library(groups, missing), std::runtime_error);
+
+    // A parent variant with a key the child lacks would leak into it: no basedOn then
+    StyleMerger leaky;
+    auto styles = templateStyles("Heading1", "32", "");
+    styles[0].properties["jc"] = "left";
+    leaky.addDocument(0, "a.docx", styles);
+    auto other = templateStyles("Heading1", "32", "");
+    other[1].properties["keepNext"] = "";
+    leaky.addDocument(1, "b.docx", other);
+    leaky.addDocument(2, "c.docx", other);
+    MergeChoice left;
+    left.chosen["heading 1"] = 1;
+    const auto leakyGroups = leaky.groups();
+    const auto leakyLibrary = leaky.library(leakyGroups, left);
+    EXPECT_EQ(leakyLibrary.sheet.styles[0].properties.at("jc"), "left");
+    EXPECT_EQ(leakyLibrary.sheet.styles[0].properties.count("basedOn"), 0u);
+    EXPECT_EQ(leakyLibrary.sheet.styles[1].properties.count("keepNext"), 1u);
+}
+
+/**
+ * @brief Documents added concurrently and out of order merge as if added in order
+ */
+TEST(StyleMergeTest, MergesConcurrently) {
+    StyleMerger merger;
+    constexpr size_t kDocuments = 64;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            // Highest index first, so document 0 comes in last
+            for (size_t n = 0; n < kDocuments / 4; ++n) {
+                const size_t i = kDocuments - 1 - t - 4 * n;
+                merger.addDocument(i, std::to_string(i) + ".docx",
+                                   templateStyles(i % 3 ? "Heading1" : "H1", i % 3 ? "32" : "28", ""));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(merger.documents(), kDocuments);
+    const auto groups = merger.groups();
+    ASSERT_EQ(groups.size(), 2u);
+    EXPECT_EQ(groups[0].styleId, "H1");  // From document 0, whenever it was added
+    ASSERT_EQ(groups[0].variants.size(), 2u);
+    EXPECT_EQ(groups[0].variants[0].count(), 42u);
+    EXPECT_EQ(groups[0].variants[0].documents.front(), 1u);
+    EXPECT_EQ(groups[0].variants[1].count(), 22u);
+    EXPECT_EQ(merger.documentPath(63), "63.docx");
+    EXPECT_THROW(merger.addDocument(5, "again.docx", templateStyles("H1", "28", "")), std::runtime_error);
+}
@@ -0,0 +1,317 @@
+// Standard C++ headers
+#include <algorithm>      // For sort, lower_bound, max
+#include <array>          // For explanation rows
+#include <cctype>         // For tolower
+#include <set>            // For the sorted key table
+#include <stdexcept>      // For runtime_error
+#include <unordered_set>  // For the bookkeeping list
+
+// Third-party library headers
+#include <zip.h>          // For reading the theme part (libzip)
+
+// Project header
+#include "style_provenance.h"
+
+using namespace std;
+
+/*
+ * Style Provenance - Implementation Notes
+ *
+ * Keys are numbered in name order, so a style's origins sorted by key id
+ * are also sorted by name and lookups are a binary search. Styles are
+ * resolved in StyleGraph order (parents first): a style's origins are its
+ * parent's with every style-relative source one level further up, or the
+ * docDefaults origins for a root, merged with its own (own wins). The
+ * lists are built per style and then packed into one array indexed by
+ * per-style offsets.
+ *
+ * Fonts: a level whose rFonts references the theme takes "@font" from the
+ * theme if the theme names that font, else from its own font name, else
+ * from the theme anyway (an unknown typeface, shown as such). So the
+ * nearest "fontTheme" is always the reference a theme origin stands for.
+ * Word merges rFonts attribute by attribute across basedOn; here the
+ * nearest level that names a font wins, which is what matters in practice
+ * and keeps one origin per key.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    const unordered_set<string> kBookkeeping = {
+        "name", "aliases", "styleId", "basedOn", "next", "link", "rsid", "uiPriority", "qFormat",
+        "semiHidden", "unhideWhenUsed", "locked", "autoRedefine", "hidden",
+        "personal", "personalCompose", "personalReply",
+    };
+
+    const string kNoValue;
+
+    string lowercase(string text) {
+        transform(text.begin(), text.end(), text.begin(),
+                  [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        return text;
+    }
+
+    const string& fieldOrProperty(const StyleInfo& style, const string& key) {
+        if (key == "@font") return style.fontName;
+        if (key == "@size") return style.fontSize;
+        auto it = style.properties.find(key);
+        return it == style.properties.end() ? kNoValue : it->second;
+    }
+
+    /**
+     * @brief Reads the typefaces of the font scheme and stops after it
+     */
+    class ThemeFontHandler : public XmlEventHandler {
+    public:
+        explicit ThemeFontHandler(ThemeFonts& fonts) : fonts_(fonts) {}
+
+        void startElement(string_view name, const XmlAttribute* attributes, size_t count) override {
+            if (name == "majorFont" || name == "minorFont") {
+                major_ = name == "majorFont";
+                inFont_ = true;
+                return;
+            }
+            if (!inFont_) return;
+            string* slot = name == "latin" ? (major_ ? &fonts_.majorLatin : &fonts_.minorLatin)
+                         : name == "ea"    ? (major_ ? &fonts_.majorEastAsia : &fonts_.minorEastAsia)
+                         : name == "cs"    ? (major_ ? &fonts_.majorBidi : &fonts_.minorBidi)
+                         : nullptr;
+            for (size_t i = 0; slot && i < count; ++i) {
+                if (attributes[i].name == "typeface") slot->assign(attributes[i].value);
+            }
+        }
+
+        bool endElement(string_view name) override {
+            if (name == "majorFont" || name == "minorFont") inFont_ = false;
+            return name != "fontScheme";  // Nothing after it is needed
+        }
+
+        void characters(string_view) override {}
+
+    private:
+        ThemeFonts& fonts_;
+        bool inFont_ = false;
+        bool major_ = false;
+    };
+
+    class ZipPartSource : public XmlSource {
+    public:
+        explicit ZipPartSource(zip_file_t* file) : file_(file) {}
+
+        size_t read(char* buffer, size_t size) override {
+            const zip_int64_t got = zip_fread(file_, buffer, size);
+            if (got < 0) {
+                throw runtime_error("Failed to read theme part");
+            }
+            return static_cast<size_t>(got);
+        }
+
+    private:
+        zip_file_t* file_;
+    };
+
+} // namespace
+
+    const string& ThemeFonts::typeface(const string& reference) const {
+        const bool major = reference.compare(0, 5, "major") == 0;
+        if (!major && reference.compare(0, 5, "minor") != 0) return kNoValue;
+        const string slot = reference.substr(5);
+        if (slot == "Ascii" || slot == "HAnsi") return major ? majorLatin : minorLatin;
+        if (slot == "EastAsia") return major ? majorEastAsia : minorEastAsia;
+        if (slot == "Bidi") return major ? majorBidi : minorBidi;
+        return kNoValue;
+    }
+
+    ThemeFonts readThemeFonts(zip_t* zip) {
+        ThemeFonts fonts;
+        unique_ptr<zip_file_t, zip_fclose_t> part(zip_fopen(zip, "word/theme/theme1.xml", 0), &zip_fclose);
+        if (!part) return fonts;
+        ZipPartSource source(part.get());
+        ThemeFontHandler handler(fonts);
+        parseXmlEvents(XmlBackend::LibxmlSax, source, handler, XmlParseOptions(), "theme1.xml");
+        return fonts;
+    }
+
+    ThemeFonts readDocxThemeFonts(const string& filePath) {
+        auto zip = openDocxFile(filePath);
+        return readThemeFonts(zip.get());
+    }
+
+    bool isBookkeepingProperty(const string& key) {
+        return kBookkeeping.count(key) > 0;
+    }
+
+    ResolvedStyleSheet::ResolvedStyleSheet(const StyleSheet& sheet, ThemeFonts theme)
+        : sheet_(sheet), theme_(move(theme)), graph_(resolveStyleGraph(sheet.styles)) {
+        const auto& styles = sheet_.styles;
+
+        // Key table in name order
+        set<string> names;
+        const auto collect = [&](const StyleInfo& style) {
+            for (const auto& [key, value] : style.properties) {
+                if (!isBookkeepingProperty(key)) names.insert(key);
+            }
+            if (!style.fontName.empty() || style.properties.count("fontTheme")) names.insert("@font");
+            if (!style.fontSize.empty()) names.insert("@size");
+        };
+        collect(sheet_.docDefaults);
+        for (const auto& style : styles) collect(style);
+        if (names.size() > 0xFFFF) {
+            throw runtime_error("Too many distinct style properties to resolve (" + to_string(names.size()) + ")");
+        }
+        keys_.assign(names.begin(), names.end());
+        for (size_t k = 0; k < keys_.size(); ++k) keyIds_.emplace(keys_[k], static_cast<uint16_t>(k));
+
+        // What a style (or docDefaults) sets itself, sorted by key
+        const auto own = [&](const StyleInfo& style, uint16_t self) {
+            vector<PropertyOrigin> origins;
+            for (const auto& [key, value] : style.properties) {
+                if (!isBookkeepingProperty(key)) origins.push_back({keyIds_.at(key), self});
+            }
+            auto theme = style.properties.find("fontTheme");
+            if (theme != style.properties.end() &&
+                (!theme_.typeface(theme->second).empty() || style.fontName.empty())) {
+                origins.push_back({keyIds_.at("@font"), kTheme});
+            } else if (!style.fontName.empty()) {
+                origins.push_back({keyIds_.at("@font"), self});
+            }
+            if (!style.fontSize.empty()) origins.push_back({keyIds_.at("@size"), self});
+            sort(origins.begin(), origins.end(),
+                 [](const PropertyOrigin& a, const PropertyOrigin& b) { return a.key < b.key; });
+            return origins;
+        };
+
+        const vector<PropertyOrigin> defaults = own(sheet_.docDefaults, kDocDefaults);
+        vector<vector<PropertyOrigin>> lists(styles.size());
+        vector<PropertyOrigin> base;
+        for (size_t i : graph_.order) {
+            if (graph_.depth[i] >= kDocDefaults) {
+                throw runtime_error("basedOn chain too deep to resolve at style " + styles[i].name);
+            }
+            const size_t parent = graph_.parent[i];
+            if (parent != StyleGraph::kNone) {
+                base = lists[parent];
+                for (auto& origin : base) {
+                    if (origin.source < kDocDefaults) ++origin.source;
+                }
+            } else if (styles[i].type != "numbering") {
+                base = defaults;
+            } else {
+                base.clear();
+            }
+
+            const vector<PropertyOrigin> mine = own(styles[i], 0);
+            auto& merged = lists[i];
+            merged.reserve(base.size() + mine.size());
+            auto b = base.begin();
+            auto m = mine.begin();
+            while (b != base.end() || m != mine.end()) {
+                if (m == mine.end() || (b != base.end() && b->key < m->key)) {
+                    merged.push_back(*b++);
+                } else {
+                    if (b != base.end() && b->key == m->key) ++b;
+                    merged.push_back(*m++);
+                }
+            }
+        }
+
+        offsets_.reserve(styles.size() + 1);
+        offsets_.push_back(0);
+        size_t total = 0;
+        for (const auto& list : lists) total += list.size();
+        origins_.reserve(total);
+        for (auto& list : lists) {
+            origins_.insert(origins_.end(), list.begin(), list.end());
+            vector<PropertyOrigin>().swap(list);
+            offsets_.push_back(static_cast<uint32_t>(origins_.size()));
+        }
+    }
+
+    const PropertyOrigin* ResolvedStyleSheet::find(size_t style, const string& key) const {
+        auto id = keyIds_.find(key);
+        if (id == keyIds_.end()) return nullptr;
+        const PropertyOrigin* it = lower_bound(begin(style), end(style), id->second,
+                                               [](const PropertyOrigin& origin, uint16_t k) { return origin.key < k; });
+        return it != end(style) && it->key == id->second ? it : nullptr;
+    }
+
+    size_t ResolvedStyleSheet::sourceStyle(size_t style, uint16_t source) const {
+        if (source >= kDocDefaults) return StyleSheet::kNoStyle;
+        for (uint16_t up = 0; up < source && style != StyleGraph::kNone; ++up) style = graph_.parent[style];
+        return style == StyleGraph::kNone ? StyleSheet::kNoStyle : style;
+    }
+
+    string ResolvedStyleSheet::value(size_t style, const PropertyOrigin& origin) const {
+        const string& key = keys_[origin.key];
+        if (origin.source == kTheme) {
+            const PropertyOrigin* reference = find(style, "fontTheme");
+            return reference ? theme_.typeface(value(style, *reference)) : "";
+        }
+        if (origin.source == kDocDefaults) return fieldOrProperty(sheet_.docDefaults, key);
+        const size_t source = sourceStyle(style, origin.source);
+        return source == StyleSheet::kNoStyle ? "" : fieldOrProperty(sheet_.styles[source], key);
+    }
+
+    size_t ResolvedStyleSheet::findStyle(const string& nameOrId) const {
+        const auto& styles = sheet_.styles;
+        for (size_t i = 0; i < styles.size(); ++i) {
+            if (fieldOrProperty(styles[i], "styleId") == nameOrId) return i;
+        }
+        const string wanted = lowercase(nameOrId);
+        for (size_t i = 0; i < styles.size(); ++i) {
+            if (lowercase(styles[i].name) == wanted) return i;
+        }
+        return StyleSheet::kNoStyle;
+    }
+
+    size_t ResolvedStyleSheet::provenanceBytes() const {
+        return origins_.size() * sizeof(PropertyOrigin) + offsets_.size() * sizeof(uint32_t);
+    }
+
+    string explainStyle(const ResolvedStyleSheet& resolved, const string& nameOrId) {
+        const size_t style = resolved.findStyle(nameOrId);
+        if (style == StyleSheet::kNoStyle) {
+            throw runtime_error("No style named '" + nameOrId + "'");
+        }
+        const auto& styles = resolved.sheet().styles;
+        const StyleInfo& info = styles[style];
+
+        string out = (info.name.empty() ? fieldOrProperty(info, "styleId") : info.name) + " (" + info.type;
+        if (!fieldOrProperty(info, "styleId").empty()) out += ", styleId " + fieldOrProperty(info, "styleId");
+        out += ")";
+        for (size_t up = resolved.graph().parent[style]; up != StyleGraph::kNone; up = resolved.graph().parent[up]) {
+            out += (up == resolved.graph().parent[style] ? ", based on " : " <- ") + styles[up].name;
+        }
+        out += "\n";
+
+        vector<array<string, 3>> rows;
+        size_t keyWidth = 0, valueWidth = 0;
+        for (const PropertyOrigin* origin = resolved.begin(style); origin != resolved.end(style); ++origin) {
+            array<string, 3> row;
+            row[0] = resolved.keys()[origin->key];
+            row[1] = resolved.value(style, *origin);
+            if (origin->source == 0) {
+                row[2] = "itself";
+            } else if (origin->source == ResolvedStyleSheet::kDocDefaults) {
+                row[2] = "docDefaults";
+            } else if (origin->source == ResolvedStyleSheet::kTheme) {
+                const PropertyOrigin* reference = resolved.find(style, "fontTheme");
+                row[2] = "theme (" + (reference ? resolved.value(style, *reference) : string()) + ")";
+                if (row[1].empty()) row[1] = "?";
+            } else {
+                row[2] = styles[resolved.sourceStyle(style, origin->source)].name + " (basedOn, " +
+                         to_string(origin->source) + " up)";
+            }
+            keyWidth = max(keyWidth, row[0].size());
+            valueWidth = max(valueWidth, min<size_t>(row[1].size(), 32));
+            rows.push_back(move(row));
+        }
+        for (const auto& row : rows) {
+            out += "  " + row[0] + string(keyWidth - row[0].size() + 2, ' ') + row[1];
+            out += string(row[1].size() < valueWidth ? valueWidth - row[1].size() + 2 : 2, ' ') + row[2] + "\n";
+        }
+        return out;
+    }
+
+} // namespace DocxParser
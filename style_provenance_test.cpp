@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include "style_provenance.h"
+#include "test_styles.h"
+
+using namespace DocxParser;
+
+namespace {
+
+std::string originValue(const ResolvedStyleSheet& resolved, size_t style, const std::string& key) {
+    const PropertyOrigin* origin = resolved.find(style, key);
+    return origin ? resolved.value(style, *origin) : "(none)";
+}
+
+uint16_t originSource(const ResolvedStyleSheet& resolved, size_t style, const std::string& key) {
+    const PropertyOrigin* origin = resolved.find(style, key);
+    if (!origin) throw std::runtime_error("no " + key);
+    return origin->source;
+}
+
+} // namespace
+
+/**
+ * @brief docDefaults are read on request, theme references are kept, and neither becomes a style
+ */
+TEST(StyleProvenanceTest, ExtractsDefaultsAndThemeReferences) {
+    const std::string part =
+        "<w:styles xmlns:w=\"urn:w\"><w:docDefaults>"
+        "<w:rPrDefault><w:rPr><w:rFonts w:asciiTheme=\"minorHAnsi\" w:hAnsiTheme=\"minorHAnsi\"/>"
+        "<w:sz w:val=\"22\"/><w:lang w:val=\"en-US\"/></w:rPr></w:rPrDefault>"
+        "<w:pPrDefault><w:pPr><w:spacing w:after=\"160\"/></w:pPr></w:pPrDefault></w:docDefaults>"
+        "<w:style w:type=\"paragraph\" w:styleId=\"Title\"><w:name w:val=\"Title\"/><w:qFormat/>"
+        "<w:rPr><w:rFonts w:ascii=\"Cambria\" w:asciiTheme=\"majorHAnsi\"/></w:rPr></w:style></w:styles>";
+    StyleInfo defaults;
+    StreamOptions options;
+    options.docDefaults = &defaults;
+    size_t styles = 0;
+    visitStylesPart(part.data(), part.size(), [&](StyleInfo& style) {
+        ++styles;
+        EXPECT_EQ(style.fontName, "Cambria");
+        EXPECT_EQ(style.properties.at("fontTheme"), "majorHAnsi");
+    }, options);
+    EXPECT_EQ(styles, 1u);
+    EXPECT_EQ(defaults.fontSize, "22");
+    EXPECT_EQ(defaults.properties.at("fontTheme"), "minorHAnsi");
+    EXPECT_EQ(defaults.properties.at("lang"), "en-US");
+    EXPECT_EQ(defaults.properties.at("spacing.after"), "160");
+
+    const auto sheet = extractDocxStyleSheet("sample.docx");
+    EXPECT_EQ(sheet.docDefaults.fontName, "Liberation Serif");
+    EXPECT_EQ(sheet.docDefaults.properties.at("textAlignment"), "baseline");
+
+    const auto theme = readDocxThemeFonts("sample.docx");
+    EXPECT_EQ(theme.majorLatin, "Calibri Light");
+    EXPECT_EQ(theme.typeface("majorHAnsi"), "Calibri Light");
+    EXPECT_EQ(theme.typeface("minorAscii"), theme.minorLatin);
+    EXPECT_EQ(theme.typeface("majorEastAsia"), "");
+    EXPECT_EQ(theme.typeface("bogus"), "");
+}
+
+/**
+ * @brief Every effective property names the style, ancestor, docDefaults or theme that set it
+ */
+TEST(StyleProvenanceTest, RecordsWhereEachPropertyComesFrom) {
+    StyleSheet sheet;
+    sheet.docDefaults.fontSize = "22";
+    sheet.docDefaults.properties["fontTheme"] = "minorHAnsi";
+    sheet.docDefaults.properties["lang"] = "en-US";
+    sheet.styles.push_back(makeStyle("Heading2", "Heading1"));
+    sheet.styles[0].properties["color"] = "2F5496";
+    sheet.styles.push_back(makeStyle("Heading1", "Normal"));
+    sheet.styles[1].properties["fontTheme"] = "majorHAnsi";
+    sheet.styles[1].fontSize = "32";
+    sheet.styles[1].properties["rsid"] = "00AB12";
+    sheet.styles.push_back(makeStyle("Normal", ""));
+    sheet.styles[2].fontName = "Arial";
+    sheet.styles.push_back(makeStyle("List", "", "numbering"));
+
+    ThemeFonts theme;
+    theme.majorLatin = "Calibri Light";
+    theme.minorLatin = "Calibri";
+    const ResolvedStyleSheet resolved(sheet, theme);
+
+    EXPECT_EQ(originSource(resolved, 0, "color"), 0u);
+    EXPECT_EQ(originSource(resolved, 0, "@size"), 1u);
+    EXPECT_EQ(resolved.sourceStyle(0, 1), 1u);
+    EXPECT_EQ(originValue(resolved, 0, "@size"), "32");
+    EXPECT_EQ(originSource(resolved, 0, "@font"), ResolvedStyleSheet::kTheme);
+    EXPECT_EQ(originValue(resolved, 0, "@font"), "Calibri Light");
+    EXPECT_EQ(originSource(resolved, 0, "fontTheme"), 1u);
+    EXPECT_EQ(originSource(resolved, 0, "lang"), ResolvedStyleSheet::kDocDefaults);
+    EXPECT_EQ(originValue(resolved, 0, "lang"), "en-US");
+    EXPECT_EQ(resolved.find(0, "rsid"), nullptr);  // Bookkeeping is not resolved
+
+    EXPECT_EQ(originSource(resolved, 2, "@font"), 0u);  // Explicit font beats the defaults' theme font
+    EXPECT_EQ(originValue(resolved, 2, "@font"), "Arial");
+    EXPECT_EQ(originValue(resolved, 2, "@size"), "22");
+    EXPECT_EQ(resolved.begin(3), resolved.end(3));  // Numbering styles ignore docDefaults
+
+    // Origins are sorted by key name; 4 bytes each plus 4 per style
+    size_t origins = 0;
+    for (size_t s = 0; s < sheet.styles.size(); ++s) {
+        for (const PropertyOrigin* o = resolved.begin(s); o != resolved.end(s); ++o, ++origins) {
+            if (o != resolved.begin(s)) {
+                EXPECT_LT(resolved.keys()[(o - 1)->key], resolved.keys()[o->key]);
+            }
+        }
+    }
+    EXPECT_EQ(resolved.provenanceBytes(), origins * 4 + (sheet.styles.size() + 1) * 4);
+}
+
+TEST(StyleProvenanceTest, ExplainsSampleStyle) {
+    const auto sheet = extractDocxStyleSheet("sample.docx");
+    const ResolvedStyleSheet resolved(sheet, readDocxThemeFonts("sample.docx"));
+    const size_t heading = resolved.findStyle("HEADING 1");
+    ASSERT_NE(heading, StyleSheet::kNoStyle);
+    EXPECT_EQ(resolved.findStyle("Heading1"), heading);
+
+    const std::string text = explainStyle(resolved, "heading 1");
+    EXPECT_EQ(text.rfind("heading 1 (paragraph, styleId Heading1), based on Heading <- Standard\n", 0), 0u) << text;
+    EXPECT_NE(text.find("spacing.before       240           Heading (basedOn, 1 up)\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("lang                 en-GB         docDefaults\n"), std::string::npos) << text;
+    EXPECT_THROW(explainStyle(resolved, "no such style"), std::runtime_error);
+}
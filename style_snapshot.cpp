@@ -0,0 +1,132 @@
+// Standard C++ headers
+#include <cstring>    // For memcmp
+#include <stdexcept>  // For runtime_error
+
+// Project header
+#include "style_snapshot.h"
+
+using namespace std;
+
+namespace DocxParser {
+
+namespace {
+
+    const char kSnapshotMagic[4] = {'T', 'S', 'S', 'N'};
+    // Bumped whenever extraction output changes, not only this layout: snapshots
+    // hold extracted styles, so one from an older extractor would be served stale.
+    // 2: styleId, spacing.* / ind.*, fontTheme and docDefaults properties
+    constexpr uint32_t kSnapshotVersion = 2;
+    constexpr size_t kSnapshotHeaderSize = 16;
+
+    void putU32(string& out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    void putString(string& out, const string& value) {
+        putU32(out, static_cast<uint32_t>(value.size()));
+        out += value;
+    }
+
+    /**
+     * @brief Bounds-checked reader over snapshot bytes
+     */
+    class SnapshotReader {
+    public:
+        SnapshotReader(const char* data, size_t size) : p_(data), end_(data + size) {}
+
+        uint32_t u32() {
+            need(4);
+            const auto* u = reinterpret_cast<const unsigned char*>(p_);
+            p_ += 4;
+            return uint32_t(u[0]) | uint32_t(u[1]) << 8 | uint32_t(u[2]) << 16 | uint32_t(u[3]) << 24;
+        }
+
+        string str() {
+            const uint32_t length = u32();
+            need(length);
+            string value(p_, length);
+            p_ += length;
+            return value;
+        }
+
+    private:
+        void need(size_t n) const {
+            if (static_cast<size_t>(end_ - p_) < n) {
+                throw runtime_error("Style snapshot is truncated");
+            }
+        }
+
+        const char* p_;
+        const char* end_;
+    };
+
+} // namespace
+
+    string serializeStyleSet(const StyleSet& styles) {
+        string out(kSnapshotMagic, sizeof(kSnapshotMagic));
+        putU32(out, kSnapshotVersion);
+        putU32(out, 0);  // Total length, patched below
+        putU32(out, static_cast<uint32_t>(styles.size()));
+        for (const auto& style : styles) {
+            putString(out, style.name);
+            putString(out, style.type);
+            putString(out, style.fontName);
+            putString(out, style.fontSize);
+            putU32(out, static_cast<uint32_t>(style.properties.size()));
+            for (const auto& prop : style.properties) {
+                putString(out, prop.first);
+                putString(out, prop.second);
+            }
+        }
+        string length;
+        putU32(length, static_cast<uint32_t>(out.size()));
+        out.replace(8, 4, length);
+        return out;
+    }
+
+    StyleSet deserializeStyleSet(const char* data, size_t size) {
+        if (size < kSnapshotHeaderSize || memcmp(data, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) {
+            throw runtime_error("Not a style snapshot");
+        }
+        SnapshotReader reader(data + 4, size - 4);
+        if (reader.u32() != kSnapshotVersion) {
+            throw runtime_error("Unsupported style snapshot version");
+        }
+        if (reader.u32() != size) {
+            throw runtime_error("Style snapshot is truncated");
+        }
+
+        // Every style takes at least five length fields; reject absurd counts early
+        const uint32_t count = reader.u32();
+        if (count > size / 20) {
+            throw runtime_error("Style snapshot is corrupt");
+        }
+        StyleSet styles(count);
+        for (auto& style : styles) {
+            style.name = reader.str();
+            style.type = reader.str();
+            style.fontName = reader.str();
+            style.fontSize = reader.str();
+            for (uint32_t count = reader.u32(); count > 0; --count) {
+                string key = reader.str();
+                style.properties.emplace_hint(style.properties.end(), move(key), reader.str());
+            }
+        }
+        return styles;
+    }
+
+    size_t estimateStyleSetBytes(const StyleSet& styles) {
+        // Strings count by capacity; map nodes add roughly four pointers each
+        constexpr size_t kMapNodeOverhead = 4 * sizeof(void*);
+        size_t bytes = sizeof(StyleSet) + styles.capacity() * sizeof(StyleInfo);
+        for (const auto& style : styles) {
+            bytes += style.name.capacity() + style.type.capacity() +
+                     style.fontName.capacity() + style.fontSize.capacity();
+            for (const auto& prop : style.properties) {
+                bytes += kMapNodeOverhead + sizeof(prop) + prop.first.capacity() + prop.second.capacity();
+            }
+        }
+        return bytes;
+    }
+
+} // namespace DocxParser
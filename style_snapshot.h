@@ -0,0 +1,44 @@
+#ifndef STYLE_SNAPSHOT_H
+#define STYLE_SNAPSHOT_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "docx_style_parser.h"
+
+/**
+ * @brief Compact binary form of an extracted style set
+ *
+ * Layout (integers are little-endian u32, strings are length + bytes):
+ *   "TSSN" | version | byte length | style count |
+ *   per style: name, type, fontName, fontSize, property count, (key, value)...
+ *
+ * The byte length lets a reader reject a truncated file before decoding.
+ * Snapshots are plain bytes, so they can be decoded straight from a
+ * memory-mapped file.
+ */
+namespace DocxParser {
+
+using StyleSet = std::vector<StyleInfo>;
+using StyleSetPtr = std::shared_ptr<const StyleSet>;
+
+/**
+ * @brief Encodes a style set into snapshot bytes
+ */
+std::string serializeStyleSet(const StyleSet& styles);
+
+/**
+ * @brief Decodes snapshot bytes
+ * @throws std::runtime_error if the data is not a complete snapshot
+ */
+StyleSet deserializeStyleSet(const char* data, size_t size);
+
+/**
+ * @brief Approximate heap bytes held by a style set (for cache budgeting)
+ */
+size_t estimateStyleSetBytes(const StyleSet& styles);
+
+} // namespace DocxParser
+
+#endif // STYLE_SNAPSHOT_H
@@ -0,0 +1,274 @@
+// Standard C++ headers
+#include <cstring>    // For memset
+#include <mutex>      // For call_once
+#include <stdexcept>  // For runtime_error
+#include <utility>    // For exchange
+
+// Platform socket headers
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>       // For getaddrinfo
+#include <netinet/in.h>  // For sockaddr_in
+#include <netinet/tcp.h> // For TCP_NODELAY
+#include <poll.h>        // For poll
+#include <sys/socket.h>  // For socket, bind, listen, accept
+#include <unistd.h>      // For close
+#endif
+
+// Project header
+#include "tcp_socket.h"
+
+using namespace std;
+
+/*
+ * TCP Socket - Implementation Notes
+ *
+ * - Reads go through buffer_: readLine() pulls 64 KiB chunks and hands out
+ *   complete lines, readBytes() drains the buffer before touching the socket
+ *   and grows its result chunk by chunk as bytes arrive.
+ * - Writes never raise SIGPIPE (MSG_NOSIGNAL / SO_NOSIGPIPE); a peer that
+ *   went away surfaces as an exception instead of killing the process.
+ * - TCP_NODELAY is set on connected sockets: the protocol is request/reply
+ *   with small command lines, which Nagle's algorithm would delay.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    constexpr size_t kReceiveChunk = 64 << 10;
+    constexpr size_t kMaxLineLength = 64 << 10;
+
+#ifdef _WIN32
+    void ensureWinsock() {
+        static once_flag started;
+        call_once(started, [] {
+            WSADATA data;
+            if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+                throw runtime_error("Failed to initialize Winsock");
+            }
+        });
+    }
+
+    int lastError() { return WSAGetLastError(); }
+    int pollSockets(WSAPOLLFD* fds, unsigned long count, int timeoutMs) { return WSAPoll(fds, count, timeoutMs); }
+    using PollFd = WSAPOLLFD;
+    constexpr int kSendFlags = 0;
+#else
+    void ensureWinsock() {}
+    int lastError() { return errno; }
+    int pollSockets(pollfd* fds, nfds_t count, int timeoutMs) { return ::poll(fds, count, timeoutMs); }
+    using PollFd = pollfd;
+#ifdef MSG_NOSIGNAL
+    constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+    constexpr int kSendFlags = 0;
+#endif
+#endif
+
+    [[noreturn]] void fail(const string& what) {
+        throw runtime_error(what + " (error " + to_string(lastError()) + ")");
+    }
+
+    addrinfo* resolve(const string& host, uint16_t port, bool passive) {
+        addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = passive ? AI_PASSIVE : 0;
+        addrinfo* result = nullptr;
+        const string service = to_string(port);
+        if (getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &result) != 0) {
+            throw runtime_error("Cannot resolve host " + host);
+        }
+        return result;
+    }
+
+} // namespace
+
+    TcpSocket::~TcpSocket() {
+        close();
+    }
+
+    TcpSocket::TcpSocket(TcpSocket&& other) noexcept
+        : handle_(exchange(other.handle_, kInvalid)), buffer_(move(other.buffer_)) {}
+
+    TcpSocket& TcpSocket::operator=(TcpSocket&& other) noexcept {
+        if (this != &other) {
+            close();
+            handle_ = exchange(other.handle_, kInvalid);
+            buffer_ = move(other.buffer_);
+        }
+        return *this;
+    }
+
+    void TcpSocket::close() noexcept {
+        if (handle_ == kInvalid) return;
+#ifdef _WIN32
+        closesocket(handle_);
+#else
+        ::close(handle_);
+#endif
+        handle_ = kInvalid;
+    }
+
+    void TcpSocket::shutdown() noexcept {
+        if (handle_ == kInvalid) return;
+#ifdef _WIN32
+        ::shutdown(handle_, SD_BOTH);
+#else
+        ::shutdown(handle_, SHUT_RDWR);
+#endif
+    }
+
+    TcpSocket TcpSocket::connect(const string& host, uint16_t port) {
+        ensureWinsock();
+        addrinfo* addresses = resolve(host, port, false);
+        TcpSocket socket;
+        for (addrinfo* address = addresses; address; address = address->ai_next) {
+            TcpSocket candidate(::socket(address->ai_family, address->ai_socktype, address->ai_protocol));
+            if (!candidate.valid()) continue;
+            if (::connect(candidate.handle_, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0) {
+                socket = move(candidate);
+                break;
+            }
+        }
+        freeaddrinfo(addresses);
+        if (!socket.valid()) {
+            fail("Cannot connect to " + host + ":" + to_string(port));
+        }
+
+        int enable = 1;
+        setsockopt(socket.handle_, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enable), sizeof(enable));
+#ifdef SO_NOSIGPIPE
+        setsockopt(socket.handle_, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+        return socket;
+    }
+
+    TcpSocket TcpSocket::listen(const string& host, uint16_t port) {
+        ensureWinsock();
+        addrinfo* address = resolve(host, port, true);
+        TcpSocket socket(::socket(address->ai_family, address->ai_socktype, address->ai_protocol));
+        if (!socket.valid()) {
+            freeaddrinfo(address);
+            fail("Cannot create socket");
+        }
+#ifndef _WIN32
+        // Lets a restarted coordinator reuse its port while old connections linger
+        int enable = 1;
+        setsockopt(socket.handle_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+#endif
+        const bool bound = ::bind(socket.handle_, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0;
+        freeaddrinfo(address);
+        if (!bound || ::listen(socket.handle_, SOMAXCONN) != 0) {
+            fail("Cannot listen on port " + to_string(port));
+        }
+        return socket;
+    }
+
+    TcpSocket TcpSocket::accept() {
+        TcpSocket client(::accept(handle_, nullptr, nullptr));
+        if (!client.valid()) {
+            fail("Failed to accept connection");
+        }
+        int enable = 1;
+        setsockopt(client.handle_, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enable), sizeof(enable));
+#ifdef SO_NOSIGPIPE
+        setsockopt(client.handle_, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+        return client;
+    }
+
+    bool TcpSocket::waitReadable(int timeoutMs) {
+        if (!buffer_.empty()) return true;
+        PollFd fd;
+        memset(&fd, 0, sizeof(fd));
+        fd.fd = handle_;
+        fd.events = POLLIN;
+        const int ready = pollSockets(&fd, 1, timeoutMs);
+        if (ready < 0) {
+            fail("Failed to poll socket");
+        }
+        return ready > 0;
+    }
+
+    uint16_t TcpSocket::localPort() const {
+        sockaddr_in address;
+        socklen_t length = sizeof(address);
+        if (getsockname(handle_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            fail("Failed to read socket address");
+        }
+        return ntohs(address.sin_port);
+    }
+
+    void TcpSocket::sendAll(const char* data, size_t size) {
+        while (size > 0) {
+            const int chunk = static_cast<int>(size < (1u << 30) ? size : (1u << 30));
+            const auto sent = ::send(handle_, data, chunk, kSendFlags);
+            if (sent <= 0) {
+                fail("Failed to send");
+            }
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+    }
+
+    size_t TcpSocket::receive(char* data, size_t size) {
+        const auto received = ::recv(handle_, data, static_cast<int>(size), 0);
+        if (received < 0) {
+            fail("Failed to receive");
+        }
+        return static_cast<size_t>(received);
+    }
+
+    bool TcpSocket::readLine(string& line) {
+        size_t scanned = 0;
+        while (true) {
+            const size_t newline = buffer_.find('\n', scanned);
+            if (newline != string::npos) {
+                line.assign(buffer_, 0, newline);
+                buffer_.erase(0, newline + 1);
+                return true;
+            }
+            scanned = buffer_.size();
+            if (scanned > kMaxLineLength) {
+                throw runtime_error("Protocol line too long");
+            }
+
+            char chunk[kReceiveChunk];
+            const size_t received = receive(chunk, sizeof(chunk));
+            if (received == 0) {
+                if (buffer_.empty()) return false;
+                throw runtime_error("Connection closed in the middle of a line");
+            }
+            buffer_.append(chunk, received);
+        }
+    }
+
+    string TcpSocket::readBytes(size_t size) {
+        const size_t buffered = buffer_.size() < size ? buffer_.size() : size;
+        string data(buffer_, 0, buffered);
+        buffer_.erase(0, buffered);
+
+        // Grow with what arrives rather than trusting size up front: a peer
+        // that announces more than it sends only costs what it sent
+        size_t filled = buffered;
+        while (filled < size) {
+            const size_t step = size - filled < kReceiveChunk ? size - filled : kReceiveChunk;
+            data.resize(filled + step);
+            const size_t received = receive(&data[filled], step);
+            if (received == 0) {
+                throw runtime_error("Connection closed before the end of a payload");
+            }
+            filled += received;
+        }
+        data.resize(filled);
+        return data;
+    }
+
+} // namespace DocxParser
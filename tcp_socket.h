@@ -0,0 +1,81 @@
+#ifndef TCP_SOCKET_H
+#define TCP_SOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace DocxParser {
+
+/**
+ * @brief Blocking IPv4 TCP socket with line-oriented reads
+ *
+ * @details
+ * Just enough networking for the batch coordinator protocol: text command
+ * lines followed by length-prefixed binary payloads. Uses BSD sockets on
+ * POSIX and Winsock on Windows. Every failure throws std::runtime_error;
+ * end of stream is reported by readLine() returning false.
+ *
+ * shutdown() may be called from another thread to unblock a pending read.
+ */
+class TcpSocket {
+public:
+    TcpSocket() = default;
+    ~TcpSocket();
+
+    TcpSocket(const TcpSocket&) = delete;
+    TcpSocket& operator=(const TcpSocket&) = delete;
+    TcpSocket(TcpSocket&& other) noexcept;
+    TcpSocket& operator=(TcpSocket&& other) noexcept;
+
+    /// @throws std::runtime_error if the host cannot be resolved or reached
+    static TcpSocket connect(const std::string& host, uint16_t port);
+
+    /// Binds and listens; port 0 picks a free port (see localPort())
+    static TcpSocket listen(const std::string& host, uint16_t port);
+
+    /// Waits for the next connection on a listening socket
+    TcpSocket accept();
+
+    /// True if a read (or accept) would not block within timeoutMs
+    bool waitReadable(int timeoutMs);
+
+    uint16_t localPort() const;
+
+    void sendAll(const char* data, size_t size);
+    void sendAll(const std::string& data) { sendAll(data.data(), data.size()); }
+
+    /**
+     * @brief Reads up to the next '\n' (not included)
+     * @return false at end of stream before any byte of a new line
+     */
+    bool readLine(std::string& line);
+
+    /// @throws std::runtime_error if the stream ends first
+    std::string readBytes(size_t size);
+
+    /// Ends both directions; pending reads in other threads return
+    void shutdown() noexcept;
+
+    bool valid() const { return handle_ != kInvalid; }
+
+private:
+#ifdef _WIN32
+    using Handle = uintptr_t;  ///< SOCKET
+    static constexpr Handle kInvalid = ~Handle(0);
+#else
+    using Handle = int;
+    static constexpr Handle kInvalid = -1;
+#endif
+
+    explicit TcpSocket(Handle handle) : handle_(handle) {}
+    size_t receive(char* data, size_t size);
+    void close() noexcept;
+
+    Handle handle_ = kInvalid;
+    std::string buffer_;  ///< Bytes received but not yet consumed
+};
+
+} // namespace DocxParser
+
+#endif // TCP_SOCKET_H
@@ -0,0 +1,25 @@
+#ifndef TEST_DOCX_H
+#define TEST_DOCX_H
+
+#include <string>
+
+#include <gtest/gtest.h>
+#include <zip.h>
+
+/*
+ * Generated DOCX inputs shared by the unit and stress tests
+ */
+
+/// Writes a minimal DOCX containing only word/styles.xml; fails the calling test on libzip errors
+inline void writeDocx(const std::string& path, const std::string& stylesXml) {
+    int error = 0;
+    zip_t* zip = zip_open(path.c_str(), ZIP_CREATE | ZIP_TRUNCATE, &error);
+    ASSERT_NE(zip, nullptr);
+    // The buffer is not copied; stylesXml outlives zip_close below
+    zip_source_t* source = zip_source_buffer(zip, stylesXml.data(), stylesXml.size(), 0);
+    ASSERT_NE(source, nullptr);
+    ASSERT_GE(zip_file_add(zip, "word/styles.xml", source, ZIP_FL_OVERWRITE), 0);
+    ASSERT_EQ(zip_close(zip), 0);
+}
+
+#endif // TEST_DOCX_H
@@ -0,0 +1,22 @@
+#ifndef TEST_STYLES_H
+#define TEST_STYLES_H
+
+#include <string>
+
+#include "docx_style_parser.h"
+
+/*
+ * Style fixtures shared by the unit tests
+ */
+
+/// A style named after its styleId, based on the style with id basedOn unless that is empty
+inline StyleInfo makeStyle(const std::string& id, const std::string& basedOn, const std::string& type = "paragraph") {
+    StyleInfo style;
+    style.name = id;
+    style.type = type;
+    style.properties["styleId"] = id;
+    if (!basedOn.empty()) style.properties["basedOn"] = basedOn;
+    return style;
+}
+
+#endif // TEST_STYLES_H
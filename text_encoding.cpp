@@ -0,0 +1,256 @@
+// Standard C++ headers
+#include <algorithm>  // For min
+#include <cctype>     // For tolower
+#include <cstdint>    // For fixed-width integers
+#include <cstring>    // For memcmp
+
+// SIMD intrinsics, where the target guarantees them
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TYPSTYLE_UTF16_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define TYPSTYLE_UTF16_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Project header
+#include "text_encoding.h"
+
+using namespace std;
+
+/*
+ * Text Encoding - Implementation Notes
+ *
+ * UTF-16 -> UTF-8, vectorized:
+ * - Markup is overwhelmingly ASCII. A block of 16 code units is loaded as
+ *   two 128-bit vectors (byte-swapped first for big-endian input); if no
+ *   unit has a bit above 0x7F set, the block narrows to 16 bytes with one
+ *   saturating pack and is stored directly.
+ * - A block with any non-ASCII unit is encoded unit by unit (surrogate
+ *   pairs included) and the vector loop resumes after it.
+ * Without SSE2/NEON the scalar loop runs for everything; both produce the
+ * same bytes, which the tests check.
+ *
+ * The output is sized for the worst case (3 bytes per unit) up front and
+ * trimmed at the end, so the inner loops never check capacity.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    constexpr size_t kBlockUnits = 16;
+    constexpr uint32_t kReplacement = 0xFFFD;
+
+    // Windows-1252 0x80-0x9F; undefined positions map to U+FFFD
+    const uint16_t kWindows1252High[32] = {
+        0x20AC, 0xFFFD, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+        0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0xFFFD, 0x017D, 0xFFFD,
+        0xFFFD, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+        0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0xFFFD, 0x017E, 0x0178,
+    };
+
+    inline uint16_t unitAt(const unsigned char* p, bool bigEndian) {
+        return bigEndian ? uint16_t(p[0] << 8 | p[1]) : uint16_t(p[0] | p[1] << 8);
+    }
+
+    inline void appendUtf8(uint32_t cp, char*& out) {
+        if (cp < 0x80) {
+            *out++ = static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            *out++ = static_cast<char>(0xC0 | cp >> 6);
+            *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            *out++ = static_cast<char>(0xE0 | cp >> 12);
+            *out++ = static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            *out++ = static_cast<char>(0xF0 | cp >> 18);
+            *out++ = static_cast<char>(0x80 | (cp >> 12 & 0x3F));
+            *out++ = static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // Encodes the code point starting at unit i; returns the index after it
+    inline size_t encodeUnit(const unsigned char* in, size_t units, size_t i, bool bigEndian, char*& out) {
+        uint32_t cp = unitAt(in + 2 * i, bigEndian);
+        ++i;
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+            const uint32_t low = i < units ? unitAt(in + 2 * i, bigEndian) : 0;
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                ++i;
+            } else {
+                cp = kReplacement;
+            }
+        } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+            cp = kReplacement;
+        }
+        appendUtf8(cp, out);
+        return i;
+    }
+
+    // Stores 16 ASCII units at in as 16 bytes at out; false if any unit is not ASCII
+    inline bool narrowAsciiBlock(const unsigned char* in, bool bigEndian, char* out) {
+#if defined(TYPSTYLE_UTF16_SSE2)
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16));
+        if (bigEndian) {
+            a = _mm_or_si128(_mm_slli_epi16(a, 8), _mm_srli_epi16(a, 8));
+            b = _mm_or_si128(_mm_slli_epi16(b, 8), _mm_srli_epi16(b, 8));
+        }
+        const __m128i high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(static_cast<short>(0xFF80)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xFFFF) return false;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(a, b));
+        return true;
+#elif defined(TYPSTYLE_UTF16_NEON)
+        uint8x16_t rawA = vld1q_u8(in);
+        uint8x16_t rawB = vld1q_u8(in + 16);
+        if (bigEndian) {
+            rawA = vrev16q_u8(rawA);
+            rawB = vrev16q_u8(rawB);
+        }
+        const uint16x8_t a = vreinterpretq_u16_u8(rawA);
+        const uint16x8_t b = vreinterpretq_u16_u8(rawB);
+        if (vmaxvq_u16(vorrq_u16(a, b)) >= 0x80) return false;
+        vst1q_u8(reinterpret_cast<uint8_t*>(out), vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+        return true;
+#else
+        (void)in;
+        (void)bigEndian;
+        (void)out;
+        return false;
+#endif
+    }
+
+    string lowercase(string value) {
+        for (auto& c : value) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        return value;
+    }
+
+    // encoding="..." of an ASCII-compatible XML declaration, or ""
+    string declaredEncoding(const char* data, size_t size) {
+        const size_t limit = min<size_t>(size, 256);
+        if (limit < 5 || memcmp(data, "<?xml", 5) != 0) return "";
+        const string head(data, limit);
+        const size_t end = head.find("?>");
+        size_t p = head.find("encoding");
+        if (p == string::npos || (end != string::npos && p > end)) return "";
+        p += 8;
+        while (p < head.size() && isspace(static_cast<unsigned char>(head[p]))) ++p;
+        if (p >= head.size() || head[p] != '=') return "";
+        ++p;
+        while (p < head.size() && isspace(static_cast<unsigned char>(head[p]))) ++p;
+        if (p >= head.size() || (head[p] != '"' && head[p] != '\'')) return "";
+        const size_t close = head.find(head[p], p + 1);
+        return close == string::npos ? "" : head.substr(p + 1, close - p - 1);
+    }
+
+} // namespace
+
+    DetectedEncoding detectXmlEncoding(const char* data, size_t size) {
+        DetectedEncoding detected;
+        const auto* u = reinterpret_cast<const unsigned char*>(data);
+        if (size >= 4 && ((u[0] == 0xFF && u[1] == 0xFE && u[2] == 0 && u[3] == 0) ||
+                          (u[0] == 0 && u[1] == 0 && u[2] == 0xFE && u[3] == 0xFF))) {
+            detected.encoding = TextEncoding::Other;  // UTF-32
+            return detected;
+        }
+        if (size >= 3 && u[0] == 0xEF && u[1] == 0xBB && u[2] == 0xBF) {
+            detected.bomBytes = 3;
+        } else if (size >= 2 && u[0] == 0xFF && u[1] == 0xFE) {
+            detected.encoding = TextEncoding::Utf16LE;
+            detected.bomBytes = 2;
+            return detected;
+        } else if (size >= 2 && u[0] == 0xFE && u[1] == 0xFF) {
+            detected.encoding = TextEncoding::Utf16BE;
+            detected.bomBytes = 2;
+            return detected;
+        } else if (size >= 4 && u[0] == '<' && u[1] == 0 && u[2] == '?' && u[3] == 0) {
+            detected.encoding = TextEncoding::Utf16LE;
+            return detected;
+        } else if (size >= 4 && u[0] == 0 && u[1] == '<' && u[2] == 0 && u[3] == '?') {
+            detected.encoding = TextEncoding::Utf16BE;
+            return detected;
+        }
+
+        detected.declared = declaredEncoding(data + detected.bomBytes, size - detected.bomBytes);
+        if (detected.bomBytes || detected.declared.empty()) return detected;  // A UTF-8 BOM wins
+
+        const string name = lowercase(detected.declared);
+        if (name == "utf-8" || name == "utf8") {
+            detected.encoding = TextEncoding::Utf8;
+        } else if (name == "iso-8859-1" || name == "iso_8859-1" || name == "latin1" || name == "latin-1" ||
+                   name == "us-ascii" || name == "ascii") {
+            detected.encoding = TextEncoding::Latin1;
+        } else if (name == "windows-1252" || name == "cp1252") {
+            detected.encoding = TextEncoding::Windows1252;
+        } else {
+            detected.encoding = TextEncoding::Other;
+        }
+        return detected;
+    }
+
+    bool needsTranscoding(const DetectedEncoding& detected) {
+        return detected.encoding != TextEncoding::Utf8 && detected.encoding != TextEncoding::Other;
+    }
+
+    void utf16ToUtf8Scalar(const char* data, size_t size, bool bigEndian, string& out) {
+        const auto* in = reinterpret_cast<const unsigned char*>(data);
+        const size_t units = size / 2;
+        out.resize(units * 3);
+        char* write = &out[0];
+        for (size_t i = 0; i < units;) i = encodeUnit(in, units, i, bigEndian, write);
+        out.resize(static_cast<size_t>(write - out.data()));
+    }
+
+    void utf16ToUtf8(const char* data, size_t size, bool bigEndian, string& out) {
+        const auto* in = reinterpret_cast<const unsigned char*>(data);
+        const size_t units = size / 2;
+        out.resize(units * 3);
+        char* write = &out[0];
+        size_t i = 0;
+        while (i < units) {
+            while (i + kBlockUnits <= units && narrowAsciiBlock(in + 2 * i, bigEndian, write)) {
+                i += kBlockUnits;
+                write += kBlockUnits;
+            }
+            // At least one unit, at most to the end of the block that failed
+            const size_t stop = min(units, i + kBlockUnits);
+            while (i < stop) i = encodeUnit(in, units, i, bigEndian, write);
+        }
+        out.resize(static_cast<size_t>(write - out.data()));
+    }
+
+    void transcodeToUtf8(const char* data, size_t size, const DetectedEncoding& detected, string& out) {
+        data += detected.bomBytes;
+        size -= detected.bomBytes;
+        switch (detected.encoding) {
+            case TextEncoding::Utf16LE:
+            case TextEncoding::Utf16BE:
+                utf16ToUtf8(data, size, detected.encoding == TextEncoding::Utf16BE, out);
+                return;
+            case TextEncoding::Latin1:
+            case TextEncoding::Windows1252: {
+                out.resize(size * 3);
+                char* write = &out[0];
+                const auto* in = reinterpret_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < size; ++i) {
+                    uint32_t cp = in[i];
+                    if (cp >= 0x80 && cp < 0xA0 && detected.encoding == TextEncoding::Windows1252) {
+                        cp = kWindows1252High[cp - 0x80];
+                    }
+                    appendUtf8(cp, write);
+                }
+                out.resize(static_cast<size_t>(write - out.data()));
+                return;
+            }
+            case TextEncoding::Utf8:
+            case TextEncoding::Other:
+                out.assign(data, size);
+                return;
+        }
+    }
+
+} // namespace DocxParser
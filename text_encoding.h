@@ -0,0 +1,69 @@
+#ifndef TEXT_ENCODING_H
+#define TEXT_ENCODING_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Encoding detection and transcoding of XML parts to UTF-8
+ *
+ * Word writes UTF-8, but some third-party generators write styles.xml as
+ * UTF-16 (with a BOM) or in a legacy 8-bit encoding. libxml2 copes with all
+ * of them through its generic transcoding layer, which is slow. Detecting
+ * the encoding up front and converting to UTF-8 ourselves keeps the parser
+ * on its fast UTF-8 path for every input.
+ */
+namespace DocxParser {
+
+enum class TextEncoding {
+    Utf8,     ///< Also the default when nothing else is detected
+    Utf16LE,
+    Utf16BE,
+    Latin1,   ///< ISO-8859-1 / US-ASCII
+    Windows1252,
+    Other,    ///< Declared encoding we leave to libxml2
+};
+
+struct DetectedEncoding {
+    TextEncoding encoding = TextEncoding::Utf8;
+    size_t bomBytes = 0;   ///< Length of the byte order mark to skip
+    std::string declared;  ///< encoding="..." of the XML declaration, if any
+};
+
+/**
+ * @brief Detects the encoding of an XML document
+ *
+ * @details
+ * Follows XML 1.0 Appendix F: a byte order mark decides; without one, the
+ * first bytes of "<?xml" identify UTF-16 by their zero bytes; otherwise the
+ * encoding pseudo-attribute of the declaration is read.
+ */
+DetectedEncoding detectXmlEncoding(const char* data, size_t size);
+
+/**
+ * @brief True if transcodeToUtf8() handles the encoding (everything but Utf8 and Other)
+ */
+bool needsTranscoding(const DetectedEncoding& detected);
+
+/**
+ * @brief Converts a document to UTF-8, dropping the byte order mark
+ *
+ * out is overwritten but its capacity is reused, so a caller that keeps one
+ * buffer per thread transcodes without allocating in the steady state.
+ * Unpaired surrogates become U+FFFD.
+ */
+void transcodeToUtf8(const char* data, size_t size, const DetectedEncoding& detected, std::string& out);
+
+/**
+ * @brief UTF-16 to UTF-8; vectorized (SSE2/NEON) for ASCII runs where available
+ */
+void utf16ToUtf8(const char* data, size_t size, bool bigEndian, std::string& out);
+
+/**
+ * @brief Reference implementation of utf16ToUtf8 without SIMD
+ */
+void utf16ToUtf8Scalar(const char* data, size_t size, bool bigEndian, std::string& out);
+
+} // namespace DocxParser
+
+#endif // TEXT_ENCODING_H
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <random>
+#include "docx_style_parser.h"
+#include "text_encoding.h"
+
+using namespace DocxParser;
+using namespace std::string_literals;
+
+namespace {
+
+/**
+ * @brief Encodes UTF-8 test strings as UTF-16 (with optional BOM)
+ */
+std::string toUtf16(const std::u16string& text, bool bigEndian, bool bom) {
+    std::string out;
+    auto put = [&](char16_t unit) {
+        const char high = static_cast<char>(unit >> 8);
+        const char low = static_cast<char>(unit & 0xFF);
+        out += bigEndian ? std::string{high, low} : std::string{low, high};
+    };
+    if (bom) put(0xFEFF);
+    for (char16_t unit : text) put(unit);
+    return out;
+}
+
+const char kStylesXml[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-16\" standalone=\"yes\"?>\n"
+    "<w:styles xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\">"
+    "<w:style w:type=\"paragraph\" w:styleId=\"Title\"><w:name w:val=\"Title\"/><w:qFormat/>"
+    "<w:rPr><w:rFonts w:ascii=\"Calibri\"/><w:sz w:val=\"56\"/></w:rPr></w:style>"
+    "</w:styles>";
+
+} // namespace
+
+/**
+ * @brief BOMs, zero-byte patterns and declarations select the encoding
+ */
+TEST(TextEncodingTest, DetectsEncoding) {
+    auto detect = [](const std::string& data) { return detectXmlEncoding(data.data(), data.size()); };
+
+    EXPECT_EQ(detect("\xFF\xFE<\0"s).encoding, TextEncoding::Utf16LE);
+    EXPECT_EQ(detect("\xFF\xFE<\0"s).bomBytes, 2u);
+    EXPECT_EQ(detect("\xFE\xFF\0<"s).encoding, TextEncoding::Utf16BE);
+    EXPECT_EQ(detect("<\0?\0x\0"s).encoding, TextEncoding::Utf16LE);
+    EXPECT_EQ(detect("\0<\0?\0x"s).encoding, TextEncoding::Utf16BE);
+    EXPECT_EQ(detect("\xEF\xBB\xBF<?xml version=\"1.0\"?>").bomBytes, 3u);
+    EXPECT_EQ(detect("<?xml version=\"1.0\" encoding='ISO-8859-1'?>").encoding, TextEncoding::Latin1);
+    EXPECT_EQ(detect("<?xml version=\"1.0\" encoding = \"windows-1252\"?>").encoding, TextEncoding::Windows1252);
+    EXPECT_EQ(detect("<?xml version=\"1.0\" encoding=\"Shift_JIS\"?>").encoding, TextEncoding::Other);
+    EXPECT_EQ(detect("<?xml version=\"1.0\" encoding=\"Shift_JIS\"?>").declared, "Shift_JIS");
+    EXPECT_EQ(detect("<w:styles/>").encoding, TextEncoding::Utf8);
+    EXPECT_FALSE(needsTranscoding(detect("<?xml version=\"1.0\" encoding=\"UTF-8\"?>")));
+}
+
+/**
+ * @brief Multi-byte, astral and unpaired code units transcode correctly in both byte orders
+ */
+TEST(TextEncodingTest, TranscodesUtf16) {
+    const std::u16string text = u"Café 标题 \U0001F600!";
+    const std::string expected = "Caf\xC3\xA9 \xE6\xA0\x87\xE9\xA2\x98 \xF0\x9F\x98\x80!";
+    for (bool bigEndian : {false, true}) {
+        const std::string data = toUtf16(text, bigEndian, true);
+        std::string out;
+        transcodeToUtf8(data.data(), data.size(), detectXmlEncoding(data.data(), data.size()), out);
+        EXPECT_EQ(out, expected);
+    }
+
+    const std::string lone = toUtf16(std::u16string{u'a', char16_t(0xD800), u'b'}, false, false);
+    std::string out;
+    utf16ToUtf8(lone.data(), lone.size(), false, out);
+    EXPECT_EQ(out, "a\xEF\xBF\xBD" "b");
+}
+
+/**
+ * @brief The vectorized path matches the scalar reference at every alignment
+ */
+TEST(TextEncodingTest, SimdMatchesScalar) {
+    std::mt19937 random(7);
+    std::u16string text;
+    for (int i = 0; i < 4000; ++i) {
+        const unsigned pick = random() % 100;
+        if (pick < 90) {
+            text += char16_t(0x20 + random() % 0x5F);          // ASCII runs dominate
+        } else if (pick < 96) {
+            text += char16_t(0xA0 + random() % 0x700);         // 2-byte UTF-8
+        } else if (pick < 99) {
+            text += char16_t(0x4E00 + random() % 0x5000);      // 3-byte UTF-8
+        } else {
+            text += u"\U0001F680";                             // Surrogate pair
+        }
+    }
+    for (bool bigEndian : {false, true}) {
+        const std::string data = toUtf16(text, bigEndian, false);
+        for (size_t skip = 0; skip < 40; skip += 2) {
+            std::string fast;
+            std::string reference;
+            utf16ToUtf8(data.data() + skip, data.size() - skip, bigEndian, fast);
+            utf16ToUtf8Scalar(data.data() + skip, data.size() - skip, bigEndian, reference);
+            ASSERT_EQ(fast, reference) << "offset " << skip;
+        }
+    }
+}
+
+/**
+ * @brief Legacy 8-bit parts become UTF-8
+ */
+TEST(TextEncodingTest, TranscodesLegacyEncodings) {
+    const std::string latin1 = "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?><a>caf\xE9</a>";
+    std::string out;
+    transcodeToUtf8(latin1.data(), latin1.size(), detectXmlEncoding(latin1.data(), latin1.size()), out);
+    EXPECT_NE(out.find("caf\xC3\xA9"), std::string::npos);
+
+    const std::string cp1252 = "<?xml version=\"1.0\" encoding=\"windows-1252\"?><a>\x80</a>";
+    transcodeToUtf8(cp1252.data(), cp1252.size(), detectXmlEncoding(cp1252.data(), cp1252.size()), out);
+    EXPECT_NE(out.find("\xE2\x82\xAC"), std::string::npos);  // Euro sign
+}
+
+/**
+ * @brief A UTF-16 styles part parses to the same styles as its UTF-8 form
+ */
+TEST(TextEncodingTest, ParsesUtf16StylesPart) {
+    std::u16string wide(kStylesXml, kStylesXml + sizeof(kStylesXml) - 1);
+    for (bool bigEndian : {false, true}) {
+        const std::string data = toUtf16(wide, bigEndian, true);
+        for (XmlBackend backend : availableXmlBackends()) {
+            StreamOptions options;
+            options.backend = backend;
+            std::vector<StyleInfo> styles;
+            auto report = visitStylesPart(data.data(), data.size(),
+                                          [&](StyleInfo& style) { styles.push_back(std::move(style)); }, options);
+            EXPECT_TRUE(report.buffered);
+            ASSERT_EQ(styles.size(), 1u) << xmlBackendName(backend);
+            EXPECT_EQ(styles[0].name, "Title");
+            EXPECT_EQ(styles[0].fontName, "Calibri");
+            EXPECT_EQ(styles[0].fontSize, "56");
+        }
+    }
+}
+
+/**
+ * @brief A visitor may parse another UTF-16 part while its own transcoded part is in use
+ */
+TEST(TextEncodingTest, TranscodingBuffersAreReentrant) {
+    std::u16string wide(kStylesXml, kStylesXml + sizeof(kStylesXml) - 1);
+    const std::string data = toUtf16(wide, false, true);
+    for (XmlBackend backend : availableXmlBackends()) {
+        StreamOptions options;
+        options.backend = backend;
+        std::vector<std::string> names;
+        visitStylesPart(data.data(), data.size(), [&](StyleInfo& outer) {
+            visitStylesPart(data.data(), data.size(), [&](StyleInfo& inner) { names.push_back(inner.name); }, options);
+            names.push_back(outer.name);
+        }, options);
+        EXPECT_EQ(names, (std::vector<std::string>{"Title", "Title"})) << xmlBackendName(backend);
+    }
+}
@@ -0,0 +1,279 @@
+// Standard C++ headers
+#include <algorithm>   // For sort
+#include <cstdio>      // For FILE, snprintf
+#include <filesystem>  // For directory scans and atomic renames
+#include <functional>  // For function
+#include <stdexcept>   // For runtime_error
+
+// Platform headers for flushing file contents to disk
+#ifdef _WIN32
+#include <io.h>       // For _commit, _fileno
+#else
+#include <unistd.h>   // For fsync
+#endif
+
+// Project headers
+#include "mapped_file.h"
+#include "tiered_cache.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace DocxParser {
+
+namespace {
+
+    constexpr const char* kSnapshotSuffix = ".tss";
+    constexpr const char* kBlocksSuffix = ".tsb";
+    constexpr const char* kTempSuffix = ".tmp";
+    constexpr size_t kEvictionSamples = 5;
+
+    string snapshotName(const StylesKey& key) {
+        char name[40];
+        snprintf(name, sizeof(name), "%08x-%llx", key.crc, static_cast<unsigned long long>(key.size));
+        return string(name) + kSnapshotSuffix;
+    }
+
+    // FNV-1a of the absolute path; a collision only costs reuse, never correctness
+    string blocksName(const string& path) {
+        error_code error;
+        fs::path absolute = fs::absolute(path, error);
+        const string full = error ? path : absolute.lexically_normal().string();
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (unsigned char c : full) hash = (hash ^ c) * 0x100000001b3ULL;
+        char name[24];
+        snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+        return string(name) + kBlocksSuffix;
+    }
+
+    bool endsWith(const string& value, const string& suffix) {
+        return value.size() >= suffix.size() &&
+               value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // Writes data and forces it to disk before returning
+    bool writeDurably(const string& path, const string& data) {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file) return false;
+        bool ok = fwrite(data.data(), 1, data.size(), file) == data.size() && fflush(file) == 0;
+#ifdef _WIN32
+        ok = ok && _commit(_fileno(file)) == 0;
+#else
+        ok = ok && fsync(fileno(file)) == 0;
+#endif
+        return fclose(file) == 0 && ok;
+    }
+
+} // namespace
+
+    SnapshotStore::SnapshotStore(string directory, uint64_t byteBudget)
+        : directory_(move(directory)), budget_(byteBudget), random_(random_device{}()) {
+        error_code error;
+        fs::create_directories(directory_, error);
+        if (error) {
+            throw runtime_error("Failed to create cache directory " + directory_ + ": " + error.message());
+        }
+
+        // Rebuild the index; interrupted writes left only temp files behind
+        vector<pair<fs::file_time_type, Entry>> found;
+        for (const auto& file : fs::directory_iterator(directory_, error)) {
+            const string name = file.path().filename().string();
+            if (endsWith(name, kTempSuffix)) {
+                fs::remove(file.path(), error);
+            } else if ((endsWith(name, kSnapshotSuffix) || endsWith(name, kBlocksSuffix)) &&
+                       file.is_regular_file(error)) {
+                Entry entry;
+                entry.name = name;
+                entry.bytes = file.file_size(error);
+                found.emplace_back(file.last_write_time(error), move(entry));
+            }
+        }
+
+        // Oldest modification time = least recently used
+        sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        lock_guard<mutex> guard(lock_);
+        for (auto& item : found) {
+            item.second.lastAccess = ++clock_;
+            bytes_ += item.second.bytes;
+            index_[item.second.name] = entries_.size();
+            entries_.push_back(move(item.second));
+        }
+        evictLocked();
+    }
+
+    string SnapshotStore::pathFor(const string& name) const {
+        return (fs::path(directory_) / name).string();
+    }
+
+    bool SnapshotStore::load(const string& name, const function<void(const char*, size_t)>& decode) {
+        const string path = pathFor(name);
+        try {
+            // Another process sharing the directory may have added the file, so try even if unindexed
+            MappedFile mapped(path);
+            try {
+                decode(mapped.data(), mapped.size());
+                lock_guard<mutex> guard(lock_);
+                auto it = index_.find(name);
+                if (it != index_.end()) {
+                    entries_[it->second].lastAccess = ++clock_;
+                } else {
+                    index_[name] = entries_.size();
+                    entries_.push_back(Entry{name, mapped.size(), ++clock_});
+                    bytes_ += mapped.size();
+                }
+                return true;
+            } catch (const runtime_error&) {
+                // Corrupt or from an older version: drop it, indexed or not, so it is rewritten
+                lock_guard<mutex> guard(lock_);
+                error_code error;
+                fs::remove(path, error);
+                auto it = index_.find(name);
+                if (it != index_.end()) removeLocked(it->second);
+            }
+        } catch (const runtime_error&) {
+            // Missing or unreadable
+        }
+        return false;
+    }
+
+    void SnapshotStore::store(const string& name, const string& data) {
+        if (data.size() > budget_) return;
+
+        // Random suffix so concurrent writers (threads or processes) never share a temp file
+        uint64_t token;
+        {
+            lock_guard<mutex> guard(lock_);
+            token = random_();
+        }
+        const string finalPath = pathFor(name);
+        const string tempPath = finalPath + "." + to_string(token) + kTempSuffix;
+        error_code error;
+        if (!writeDurably(tempPath, data)) {
+            fs::remove(tempPath, error);
+            return;
+        }
+        fs::rename(tempPath, finalPath, error);
+        if (error) {
+            fs::remove(tempPath, error);
+            return;
+        }
+
+        lock_guard<mutex> guard(lock_);
+        auto it = index_.find(name);
+        if (it != index_.end()) {
+            Entry& entry = entries_[it->second];
+            bytes_ = bytes_ - entry.bytes + data.size();
+            entry.bytes = data.size();
+            entry.lastAccess = ++clock_;
+        } else {
+            index_[name] = entries_.size();
+            entries_.push_back(Entry{name, data.size(), ++clock_});
+            bytes_ += data.size();
+        }
+        evictLocked();
+    }
+
+    StyleSetPtr SnapshotStore::get(const StylesKey& key) {
+        StyleSetPtr styles;
+        if (load(snapshotName(key), [&](const char* data, size_t size) {
+                styles = make_shared<StyleSet>(deserializeStyleSet(data, size));
+            })) {
+            hits_.fetch_add(1, memory_order_relaxed);
+            return styles;
+        }
+        misses_.fetch_add(1, memory_order_relaxed);
+        return nullptr;
+    }
+
+    void SnapshotStore::put(const StylesKey& key, const StyleSet& styles) {
+        store(snapshotName(key), serializeStyleSet(styles));
+    }
+
+    StyleBlockSnapshot SnapshotStore::getBlocks(const string& path) {
+        StyleBlockSnapshot snapshot;
+        load(blocksName(path), [&](const char* data, size_t size) { snapshot = deserializeStyleBlocks(data, size); });
+        return snapshot;
+    }
+
+    void SnapshotStore::putBlocks(const string& path, const StyleBlockSnapshot& snapshot) {
+        store(blocksName(path), serializeStyleBlocks(snapshot));
+    }
+
+    void SnapshotStore::removeLocked(size_t position) {
+        bytes_ -= entries_[position].bytes;
+        index_.erase(entries_[position].name);
+        if (position + 1 != entries_.size()) {
+            entries_[position] = move(entries_.back());
+            index_[entries_[position].name] = position;
+        }
+        entries_.pop_back();
+    }
+
+    void SnapshotStore::evictLocked() {
+        while (bytes_ > budget_ && !entries_.empty()) {
+            // Sample a few entries and evict the coldest of them
+            size_t victim = uniform_int_distribution<size_t>(0, entries_.size() - 1)(random_);
+            for (size_t i = 1; i < kEvictionSamples && i < entries_.size(); ++i) {
+                const size_t candidate = uniform_int_distribution<size_t>(0, entries_.size() - 1)(random_);
+                if (entries_[candidate].lastAccess < entries_[victim].lastAccess) victim = candidate;
+            }
+            error_code error;
+            fs::remove(pathFor(entries_[victim].name), error);
+            removeLocked(victim);
+            evictions_.fetch_add(1, memory_order_relaxed);
+        }
+    }
+
+    CacheTierStats SnapshotStore::stats() const {
+        CacheTierStats stats;
+        stats.hits = hits_.load(memory_order_relaxed);
+        stats.misses = misses_.load(memory_order_relaxed);
+        stats.evictions = evictions_.load(memory_order_relaxed);
+        lock_guard<mutex> guard(lock_);
+        stats.bytes = bytes_;
+        return stats;
+    }
+
+    TieredStyleCache::TieredStyleCache(const TieredCacheOptions& options)
+        : hot_(options.hotBytes, options.hotShards) {
+        if (!options.warmDirectory.empty()) {
+            warm_ = make_unique<SnapshotStore>(options.warmDirectory, options.warmBytes);
+        }
+    }
+
+    StyleSetPtr TieredStyleCache::get(const StylesKey& key) {
+        if (auto styles = hot_.get(key)) return styles;
+        if (!warm_) return nullptr;
+
+        auto styles = warm_->get(key);
+        if (styles) hot_.put(key, styles, estimateStyleSetBytes(*styles));
+        return styles;
+    }
+
+    void TieredStyleCache::put(const StylesKey& key, const StyleSetPtr& styles) {
+        hot_.put(key, styles, estimateStyleSetBytes(*styles));
+        if (warm_) warm_->put(key, *styles);
+    }
+
+    StyleBlockSnapshot TieredStyleCache::getBlocks(const string& path) {
+        return warm_ ? warm_->getBlocks(path) : StyleBlockSnapshot();
+    }
+
+    void TieredStyleCache::putBlocks(const string& path, const StyleBlockSnapshot& snapshot) {
+        if (warm_) warm_->putBlocks(path, snapshot);
+    }
+
+    CacheTierStats TieredStyleCache::hotStats() const {
+        CacheTierStats stats;
+        stats.hits = hot_.hits();
+        stats.misses = hot_.misses();
+        stats.evictions = hot_.evictions();
+        stats.bytes = hot_.bytes();
+        return stats;
+    }
+
+    CacheTierStats TieredStyleCache::warmStats() const {
+        return warm_ ? warm_->stats() : CacheTierStats();
+    }
+
+} // namespace DocxParser
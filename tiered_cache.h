@@ -0,0 +1,167 @@
+#ifndef TIERED_CACHE_H
+#define TIERED_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sharded_lru_cache.h"
+#include "style_blocks.h"
+#include "style_snapshot.h"
+
+/**
+ * @brief Two-tier cache of decoded style sets
+ *
+ * - Hot tier: in-process ShardedLruCache of decoded StyleSets.
+ * - Warm tier: SnapshotStore, a directory of style snapshots that survives
+ *   restarts and is shared by every process pointing at it.
+ *
+ * A hot miss falls through to the warm tier; a warm hit is decoded from a
+ * memory-mapped snapshot and promoted into the hot tier.
+ *
+ * The warm tier also keeps, per document path, the StyleBlockSnapshot of
+ * the last styles part extracted for it. When a template is edited its key
+ * changes and both tiers miss, but the previous version's snapshot lets the
+ * extraction reparse only the styles that changed.
+ */
+namespace DocxParser {
+
+/**
+ * @brief Identity of a styles part: equal keys mean equal extraction results
+ */
+struct StylesKey {
+    uint32_t crc = 0;
+    uint64_t size = 0;
+
+    bool operator==(const StylesKey& other) const { return crc == other.crc && size == other.size; }
+};
+
+struct StylesKeyHash {
+    size_t operator()(const StylesKey& key) const {
+        return std::hash<uint64_t>{}(key.size * 0x9E3779B97F4A7C15ULL ^ key.crc);
+    }
+};
+
+/**
+ * @brief Counters of one cache tier
+ */
+struct CacheTierStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * @brief Disk tier: one snapshot file per key with a global byte budget
+ *
+ * @details
+ * Block snapshots are files of their own, named by a hash of the document
+ * path, and share the budget and eviction with the style snapshots.
+ *
+ * Crash safety: a snapshot is written to a temporary file, flushed to disk
+ * and then renamed over its final name. Rename is atomic, so readers see
+ * either no file or a complete one; leftovers of interrupted writes are
+ * deleted when the store is opened.
+ *
+ * Eviction is approximate LRU: when the budget is exceeded, a few random
+ * entries are sampled and the least recently used of them is removed. This
+ * avoids keeping a global recency list while still evicting cold entries
+ * with high probability. Access times live in memory and are seeded from the
+ * file modification times at open; hits do not write to the disk, so across
+ * restarts recency is approximated by when a snapshot was last written.
+ */
+class SnapshotStore {
+public:
+    /**
+     * @param directory Cache directory (created if missing)
+     * @param byteBudget Maximum total snapshot bytes on disk
+     * @throws std::runtime_error if the directory cannot be created
+     */
+    SnapshotStore(std::string directory, uint64_t byteBudget);
+
+    /// Decodes the snapshot for key, or returns nullptr
+    StyleSetPtr get(const StylesKey& key);
+
+    /// Writes (or replaces) the snapshot for key; I/O errors are swallowed
+    void put(const StylesKey& key, const StyleSet& styles);
+
+    /// Block snapshot last stored for the document at path; empty (a full run) if none
+    StyleBlockSnapshot getBlocks(const std::string& path);
+
+    /// Writes (or replaces) the block snapshot of the document at path; I/O errors are swallowed
+    void putBlocks(const std::string& path, const StyleBlockSnapshot& snapshot);
+
+    CacheTierStats stats() const;
+
+private:
+    struct Entry {
+        std::string name;
+        uint64_t bytes = 0;
+        uint64_t lastAccess = 0;
+    };
+
+    std::string pathFor(const std::string& name) const;
+    bool load(const std::string& name, const std::function<void(const char*, size_t)>& decode);
+    void store(const std::string& name, const std::string& data);
+    void evictLocked();
+    void removeLocked(size_t index);
+
+    std::string directory_;
+    uint64_t budget_;
+    mutable std::mutex lock_;
+    std::vector<Entry> entries_;                    ///< Dense for random sampling
+    std::unordered_map<std::string, size_t> index_; ///< name -> position in entries_
+    uint64_t bytes_ = 0;
+    uint64_t clock_ = 0;
+    std::mt19937_64 random_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+};
+
+struct TieredCacheOptions {
+    size_t hotBytes = 64u << 20;   ///< In-memory budget (0 disables the hot tier)
+    size_t hotShards = 16;         ///< Lock stripes of the hot tier
+    std::string warmDirectory;     ///< Empty disables the warm tier
+    uint64_t warmBytes = 1ull << 30; ///< On-disk budget
+};
+
+class TieredStyleCache {
+public:
+    explicit TieredStyleCache(const TieredCacheOptions& options);
+
+    /// Hot tier, then warm tier (promoting hits); nullptr on a full miss
+    StyleSetPtr get(const StylesKey& key);
+
+    /// Hot tier only; no counters or recency updates
+    StyleSetPtr peek(const StylesKey& key) const { return hot_.peek(key); }
+
+    /// Stores in both tiers
+    void put(const StylesKey& key, const StyleSetPtr& styles);
+
+    /// False without a warm tier, which is where block snapshots are kept
+    bool keepsBlocks() const { return warm_ != nullptr; }
+
+    /// Warm tier's block snapshot for the document at path; empty if none
+    StyleBlockSnapshot getBlocks(const std::string& path);
+
+    /// Stores a block snapshot in the warm tier, if there is one
+    void putBlocks(const std::string& path, const StyleBlockSnapshot& snapshot);
+
+    CacheTierStats hotStats() const;
+    CacheTierStats warmStats() const;
+
+private:
+    ShardedLruCache<StylesKey, StyleSet, StylesKeyHash> hot_;
+    std::unique_ptr<SnapshotStore> warm_;
+};
+
+} // namespace DocxParser
+
+#endif // TIERED_CACHE_H
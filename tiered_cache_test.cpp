@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include "extraction_service.h"
+#include "test_docx.h"
+#include "tiered_cache.h"
+
+using namespace DocxParser;
+namespace fs = std::filesystem;
+
+namespace {
+
+StyleSet makeStyles(size_t count) {
+    StyleSet styles(count);
+    for (size_t i = 0; i < count; ++i) {
+        styles[i].name = "Style " + std::to_string(i);
+        styles[i].type = "paragraph";
+        styles[i].fontName = "Calibri";
+        styles[i].fontSize = "22";
+        styles[i].properties["outlineLvl"] = std::to_string(i % 9);
+        styles[i].properties["qFormat"] = "";
+    }
+    return styles;
+}
+
+/**
+ * @brief styles.xml with one quick-format style per font
+ */
+std::string fontStylesXml(const std::vector<std::string>& fonts) {
+    std::string part = "<w:styles xmlns:w=\"urn:w\">";
+    for (size_t i = 0; i < fonts.size(); ++i) {
+        part += "<w:style w:type=\"paragraph\" w:styleId=\"S" + std::to_string(i) + "\"><w:name w:val=\"S" +
+                std::to_string(i) + "\"/><w:qFormat/><w:rPr><w:rFonts w:ascii=\"" + fonts[i] +
+                "\"/></w:rPr></w:style>";
+    }
+    return part + "</w:styles>";
+}
+
+fs::path freshDirectory(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() / name;
+    fs::remove_all(dir);
+    return dir;
+}
+
+} // namespace
+
+TEST(StyleSnapshotTest, RoundTripsAndRejectsTruncation) {
+    auto bytes = serializeStyleSet(makeStyles(3));
+    auto styles = deserializeStyleSet(bytes.data(), bytes.size());
+    ASSERT_EQ(styles.size(), 3u);
+    EXPECT_EQ(styles[2].name, "Style 2");
+    EXPECT_EQ(styles[2].properties.at("outlineLvl"), "2");
+    EXPECT_THROW(deserializeStyleSet(bytes.data(), bytes.size() - 1), std::runtime_error);
+}
+
+/**
+ * @brief Snapshots survive a restart; interrupted writes are cleaned up
+ */
+TEST(SnapshotStoreTest, PersistsAcrossInstances) {
+    auto dir = freshDirectory("typstyle_snapshot_store_test");
+    StylesKey key{0x1234, 99};
+    {
+        SnapshotStore store(dir.string(), 1 << 20);
+        EXPECT_EQ(store.get(key), nullptr);
+        store.put(key, makeStyles(4));
+    }
+    std::ofstream(dir / "deadbeef-1.tss.42.tmp") << "partial";
+
+    SnapshotStore reopened(dir.string(), 1 << 20);
+    EXPECT_FALSE(fs::exists(dir / "deadbeef-1.tss.42.tmp"));
+    auto styles = reopened.get(key);
+    ASSERT_NE(styles, nullptr);
+    EXPECT_EQ(styles->size(), 4u);
+    EXPECT_EQ(reopened.stats().hits, 1u);
+    fs::remove_all(dir);
+}
+
+/**
+ * @brief The disk budget is enforced by evicting cold snapshots
+ */
+TEST(SnapshotStoreTest, EvictsOverBudget) {
+    auto dir = freshDirectory("typstyle_snapshot_evict_test");
+    const size_t snapshotBytes = serializeStyleSet(makeStyles(10)).size();
+    SnapshotStore store(dir.string(), snapshotBytes * 3);
+    for (uint32_t i = 0; i < 10; ++i) {
+        store.put(StylesKey{i, 1}, makeStyles(10));
+    }
+    auto stats = store.stats();
+    EXPECT_LE(stats.bytes, snapshotBytes * 3);
+    EXPECT_EQ(stats.evictions, 7u);
+    EXPECT_NE(store.get(StylesKey{9, 1}), nullptr);  // Most recent survives
+    fs::remove_all(dir);
+}
+
+/**
+ * @brief Hits leave the file alone; corrupt snapshots are deleted even if another process wrote them
+ */
+TEST(SnapshotStoreTest, HitsDoNotWriteAndCorruptFilesAreRemoved) {
+    auto dir = freshDirectory("typstyle_snapshot_corrupt_test");
+    SnapshotStore store(dir.string(), 1 << 20);
+    StylesKey key{0x1234, 99};
+    store.put(key, makeStyles(2));
+    const auto file = dir / "00001234-63.tss";
+    ASSERT_TRUE(fs::exists(file));
+    const auto written = fs::file_time_type::clock::now() - std::chrono::hours(1);
+    fs::last_write_time(file, written);
+    EXPECT_NE(store.get(key), nullptr);
+    EXPECT_EQ(fs::last_write_time(file), written);
+
+    // Not in this store's index: appeared after it was opened
+    const auto unindexed = dir / "0000abcd-7.tss";
+    std::ofstream(unindexed) << "TSSN garbage";
+    EXPECT_EQ(store.get(StylesKey{0xabcd, 7}), nullptr);
+    EXPECT_FALSE(fs::exists(unindexed));
+    fs::remove_all(dir);
+}
+
+/**
+ * @brief A fresh service answers from the warm tier without extracting
+ */
+TEST(TieredCacheTest, ServiceReusesWarmTier) {
+    auto dir = freshDirectory("typstyle_tiered_service_test");
+    ServiceOptions options;
+    options.cache.warmDirectory = dir.string();
+    {
+        ExtractionService warmer(options);
+        warmer.extract("sample.docx");
+        EXPECT_EQ(warmer.stats().extractions, 1u);
+    }
+    ExtractionService service(options);
+    auto styles = service.extract("sample.docx");
+    EXPECT_FALSE(styles->empty());
+    auto stats = service.stats();
+    EXPECT_EQ(stats.extractions, 0u);
+    EXPECT_EQ(stats.warm.hits, 1u);
+    service.extract("sample.docx");
+    EXPECT_EQ(service.stats().hot.hits, 1u);  // Promoted into memory
+    fs::remove_all(dir);
+}
+
+/**
+ * @brief An edited template misses the cache but reuses its unchanged styles
+ */
+TEST(TieredCacheTest, ServiceReextractsEditedTemplateIncrementally) {
+    auto dir = freshDirectory("typstyle_tiered_blocks_test");
+    fs::create_directories(dir);
+    const std::string docx = (dir / "template.docx").string();
+    ServiceOptions options;
+    options.cache.warmDirectory = (dir / "cache").string();
+
+    writeDocx(docx, fontStylesXml({"Arial", "Calibri", "Cambria"}));
+    {
+        ExtractionService service(options);
+        service.extract(docx);
+        EXPECT_EQ(service.stats().reusedStyles, 0u);
+    }
+    writeDocx(docx, fontStylesXml({"Arial", "Georgia", "Cambria"}));
+    ExtractionService service(options);
+    auto styles = service.extract(docx);
+    auto stats = service.stats();
+    EXPECT_EQ(stats.extractions, 1u);
+    EXPECT_EQ(stats.reusedStyles, 2u);
+    ASSERT_EQ(styles->size(), 3u);
+    EXPECT_EQ((*styles)[1].fontName, "Georgia");
+    EXPECT_EQ((*styles)[2].fontName, "Cambria");
+    fs::remove_all(dir);
+}
@@ -0,0 +1,332 @@
+// Standard C++ headers
+#include <array>          // For the heading level table
+#include <cctype>         // For isalnum, isalpha
+#include <map>            // For ordered settings
+#include <set>            // For identifier de-duplication
+#include <unordered_map>  // For styleId lookups
+
+// Project header
+#include "typst_generator.h"
+
+using namespace std;
+
+/*
+ * Typst Generator - Implementation Notes
+ *
+ * Word properties are first translated into Typst settings, keyed
+ * "rule.parameter" ("text.size" -> "16pt", "align" -> "center"). Settings
+ * are what gets inherited and compared: a style's resolved settings are its
+ * parent's with its own laid over them, and its delta is every own setting
+ * the parent does not already resolve to the same value. Properties Typst
+ * has no set rule for (rsid, uiPriority, ...) translate to nothing, so they
+ * never appear in the output.
+ *
+ * Composition relies on Typst's scoping: set rules inside a content block
+ * apply to that block only, and the innermost rule wins. heading-2 passes
+ * its own block (its set rules + body) to its parent's function as body,
+ * so heading-2's settings are nested inside the parent's and override them.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    using Settings = map<string, string>;
+
+    const set<string> kReservedNames = {
+        "align", "block", "emph", "figure", "heading", "image", "link", "list", "page",
+        "par", "quote", "raw", "smallcaps", "strike", "strong", "table", "text", "title", "underline",
+    };
+
+    string property(const StyleInfo& style, const string& key) {
+        auto it = style.properties.find(key);
+        return it == style.properties.end() ? "" : it->second;
+    }
+
+    bool hasProperty(const StyleInfo& style, const string& key) {
+        return style.properties.count(key) > 0;
+    }
+
+    // Word toggles (<w:b/>, <w:b w:val="0"/>): present without a value means on
+    bool toggleOn(const string& value) {
+        return value.empty() || value == "1" || value == "true" || value == "on";
+    }
+
+    string quoted(const string& value) {
+        string out = "\"";
+        for (char c : value) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    // Half-points to points: "21" -> "10.5pt"
+    string halfPoints(const string& value) {
+        try {
+            const long halves = stol(value);
+            return to_string(halves / 2) + (halves % 2 ? ".5pt" : "pt");
+        } catch (const exception&) {
+            return "";
+        }
+    }
+
+    // Twentieths of a point to points: "240" -> "12pt", "250" -> "12.5pt"
+    string twips(const string& value) {
+        try {
+            const long twentieths = stol(value);
+            if (twentieths < 0) return "";
+            string points = to_string(twentieths / 20);
+            if (const long hundredths = twentieths % 20 * 5) {
+                points += hundredths % 10 ? "." + to_string(hundredths + 100).substr(1) : "." + to_string(hundredths / 10);
+            }
+            return points + "pt";
+        } catch (const exception&) {
+            return "";
+        }
+    }
+
+    bool isHexColor(const string& value) {
+        if (value.size() != 6) return false;
+        for (char c : value) {
+            if (!isxdigit(static_cast<unsigned char>(c))) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Translates the Word properties a style sets itself into Typst settings
+     */
+    Settings ownSettings(const StyleInfo& style) {
+        Settings settings;
+        if (!style.fontName.empty()) settings["text.font"] = quoted(style.fontName);
+        if (!style.fontSize.empty()) {
+            const string size = halfPoints(style.fontSize);
+            if (!size.empty()) settings["text.size"] = size;
+        }
+        const string color = property(style, "color");
+        if (isHexColor(color)) settings["text.fill"] = "rgb(\"#" + color + "\")";
+        if (hasProperty(style, "b")) settings["text.weight"] = toggleOn(property(style, "b")) ? "\"bold\"" : "\"regular\"";
+        if (hasProperty(style, "i")) settings["text.style"] = toggleOn(property(style, "i")) ? "\"italic\"" : "\"normal\"";
+
+        const string lang = property(style, "lang");
+        if (lang.size() >= 2 && isalpha(static_cast<unsigned char>(lang[0])) &&
+            isalpha(static_cast<unsigned char>(lang[1]))) {
+            settings["text.lang"] = quoted(lang.substr(0, 2));
+            if (lang.size() == 5 && lang[2] == '-') settings["text.region"] = quoted(lang.substr(3));
+        }
+
+        // Paragraph spacing and keep-together behaviour; only used by heading rules
+        const string above = twips(property(style, "spacing.before"));
+        if (!above.empty()) settings["block.above"] = above;
+        const string below = twips(property(style, "spacing.after"));
+        if (!below.empty()) settings["block.below"] = below;
+        if (hasProperty(style, "keepNext")) settings["block.sticky"] = toggleOn(property(style, "keepNext")) ? "true" : "false";
+        if (hasProperty(style, "keepLines")) {
+            settings["block.breakable"] = toggleOn(property(style, "keepLines")) ? "false" : "true";
+        }
+
+        const string justification = property(style, "jc");
+        if (justification == "both" || justification == "distribute") {
+            settings["par.justify"] = "true";
+        } else if (justification == "center") {
+            settings["align"] = "center";
+        } else if (justification == "right" || justification == "end") {
+            settings["align"] = "right";
+        } else if (justification == "left" || justification == "start") {
+            settings["align"] = "left";
+        }
+        return settings;
+    }
+
+    // Block settings describe the paragraph box; a style function cannot apply
+    // them to its caller's paragraph, so only heading show rules use them
+    bool isBlockSetting(const string& key) {
+        return key.compare(0, 6, "block.") == 0;
+    }
+
+    /**
+     * @brief Writes settings as set rules, one per rule name, each line starting with prefix
+     */
+    void appendRules(const Settings& settings, const string& prefix, string& out) {
+        string rule;
+        string arguments;
+        auto flush = [&] {
+            if (!rule.empty()) out += prefix + "set " + rule + "(" + arguments + ")\n";
+            arguments.clear();
+        };
+        for (const auto& setting : settings) {
+            const size_t dot = setting.first.find('.');
+            if (dot == string::npos) {  // Positional: set align(center)
+                flush();
+                rule.clear();
+                out += prefix + "set " + setting.first + "(" + setting.second + ")\n";
+                continue;
+            }
+            const string settingRule = setting.first.substr(0, dot);
+            if (settingRule != rule) {
+                flush();
+                rule = settingRule;
+            }
+            if (!arguments.empty()) arguments += ", ";
+            arguments += setting.first.substr(dot + 1) + ": " + setting.second;
+        }
+        flush();
+    }
+
+    bool isGenerated(const StyleInfo& style) {
+        return style.type == "paragraph" || style.type == "character";
+    }
+
+} // namespace
+
+    StyleGraph resolveStyleGraph(const vector<StyleInfo>& styles) {
+        const size_t count = styles.size();
+        StyleGraph graph;
+        graph.parent.assign(count, StyleGraph::kNone);
+        graph.depth.assign(count, 0);
+        graph.order.reserve(count);
+
+        unordered_map<string, size_t> byId;
+        for (size_t i = 0; i < count; ++i) {
+            const string id = property(styles[i], "styleId");
+            if (!id.empty()) byId.emplace(id, i);  // First definition wins, as in Word
+        }
+        for (size_t i = 0; i < count; ++i) {
+            auto it = byId.find(property(styles[i], "basedOn"));
+            if (it != byId.end() && it->second != i && styles[it->second].type == styles[i].type) {
+                graph.parent[i] = it->second;
+            }
+        }
+
+        // Walk up from every style until a placed one; place the chain root-first
+        enum : char { Unvisited, OnPath, Placed };
+        vector<char> state(count, Unvisited);
+        vector<size_t> path;
+        for (size_t i = 0; i < count; ++i) {
+            path.clear();
+            size_t node = i;
+            while (node != StyleGraph::kNone && state[node] == Unvisited) {
+                state[node] = OnPath;
+                path.push_back(node);
+                node = graph.parent[node];
+            }
+            if (node != StyleGraph::kNone && state[node] == OnPath) {
+                graph.parent[path.back()] = StyleGraph::kNone;  // Closes a cycle; cut it here
+            }
+            for (auto it = path.rbegin(); it != path.rend(); ++it) {
+                const size_t parent = graph.parent[*it];
+                graph.depth[*it] = parent == StyleGraph::kNone ? 0 : graph.depth[parent] + 1;
+                state[*it] = Placed;
+                graph.order.push_back(*it);
+            }
+        }
+        return graph;
+    }
+
+    string typstIdentifier(const string& styleName) {
+        string id;
+        for (char c : styleName) {
+            const auto u = static_cast<unsigned char>(c);
+            if (isalnum(u) && u < 0x80) {
+                id += static_cast<char>(tolower(u));
+            } else if (!id.empty() && id.back() != '-') {
+                id += '-';
+            }
+        }
+        while (!id.empty() && id.back() == '-') id.pop_back();
+        if (id.empty()) return "style";
+        if (isdigit(static_cast<unsigned char>(id[0]))) id = "style-" + id;
+        if (kReservedNames.count(id)) id += "-style";
+        return id;
+    }
+
+namespace {
+
+    // headingLevels may be null: no heading show rules
+    string generateModule(const vector<StyleInfo>& styles, const TypstOptions& options,
+                          const array<size_t, 9>* headingLevels) {
+        const StyleGraph graph = resolveStyleGraph(styles);
+
+        // Identifiers in input order, so renames do not depend on the graph
+        vector<string> ids(styles.size());
+        set<string> taken;
+        for (size_t i = 0; i < styles.size(); ++i) {
+            if (!isGenerated(styles[i])) continue;
+            const string base = typstIdentifier(styles[i].name.empty() ? property(styles[i], "styleId")
+                                                                       : styles[i].name);
+            string id = base;
+            for (int n = 2; taken.count(id); ++n) id = base + "-" + to_string(n);
+            taken.insert(id);
+            ids[i] = id;
+        }
+
+        string out = options.flatten
+            ? "// Generated by TypStyle: every style with its fully resolved settings\n\n"
+            : "// Generated by TypStyle: each style wraps its basedOn parent and sets only its overrides\n\n";
+
+        vector<Settings> resolved(styles.size());
+        for (size_t i : graph.order) {
+            if (!isGenerated(styles[i])) continue;
+            const size_t parent = graph.parent[i];
+            const Settings own = ownSettings(styles[i]);
+            if (parent != StyleGraph::kNone) resolved[i] = resolved[parent];
+
+            Settings delta;
+            for (const auto& setting : own) {
+                auto inherited = resolved[i].find(setting.first);
+                if ((inherited == resolved[i].end() || inherited->second != setting.second) &&
+                    !isBlockSetting(setting.first)) {
+                    delta.insert(setting);
+                }
+                resolved[i][setting.first] = setting.second;
+            }
+
+            const string& id = ids[i];
+            if (options.flatten || parent == StyleGraph::kNone) {
+                Settings settings;
+                for (const auto& setting : options.flatten ? resolved[i] : delta) {
+                    if (!isBlockSetting(setting.first)) settings.insert(setting);
+                }
+                if (settings.empty()) {
+                    out += "#let " + id + "(body) = body\n\n";
+                } else {
+                    out += "#let " + id + "(body) = {\n";
+                    appendRules(settings, "  ", out);
+                    out += "  body\n}\n\n";
+                }
+            } else if (delta.empty()) {
+                out += "#let " + id + " = " + ids[parent] + "\n\n";
+            } else {
+                out += "#let " + id + "(body) = " + ids[parent] + "({\n";
+                appendRules(delta, "  ", out);
+                out += "  body\n})\n\n";
+            }
+        }
+
+        if (headingLevels) {
+            bool first = true;
+            for (size_t level = 0; level < headingLevels->size(); ++level) {
+                const size_t index = (*headingLevels)[level];
+                if (index == StyleSheet::kNoStyle || index >= styles.size() || resolved[index].empty()) continue;
+                if (first) {
+                    out += "// Heading levels (w:outlineLvl), with fully resolved settings\n";
+                    first = false;
+                }
+                appendRules(resolved[index], "#show heading.where(level: " + to_string(level + 1) + "): ", out);
+            }
+        }
+        return out;
+    }
+
+} // namespace
+
+    string generateTypst(const vector<StyleInfo>& styles, const TypstOptions& options) {
+        return generateModule(styles, options, nullptr);
+    }
+
+    string generateTypst(const StyleSheet& sheet, const TypstOptions& options) {
+        return generateModule(sheet.styles, options, &sheet.headingLevels);
+    }
+
+} // namespace DocxParser
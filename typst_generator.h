@@ -0,0 +1,84 @@
+#ifndef TYPST_GENERATOR_H
+#define TYPST_GENERATOR_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "docx_style_parser.h"
+
+/**
+ * @brief Generation of Typst style functions from extracted DOCX styles
+ *
+ * Every paragraph and character style becomes one Typst function that takes
+ * the content to style:
+ *
+ *     #let heading-2(body) = normal({
+ *       set text(size: 16pt, fill: rgb("#2F5496"))
+ *       body
+ *     })
+ *
+ * A style wraps the function of its basedOn parent and sets only what it
+ * changes relative to that parent, mirroring how Word stores the sheet. The
+ * module then grows with the number of overrides, not with styles times
+ * inheritance depth, and Typst evaluates each inherited setting once per
+ * level instead of once per descendant.
+ */
+namespace DocxParser {
+
+/**
+ * @brief Resolved basedOn relation of a style list
+ */
+struct StyleGraph {
+    static constexpr size_t kNone = static_cast<size_t>(-1);
+
+    std::vector<size_t> parent;  ///< Index of the basedOn style, or kNone for roots
+    std::vector<size_t> order;   ///< Every style after its parent; input order otherwise
+    std::vector<size_t> depth;   ///< 0 for roots
+};
+
+/**
+ * @brief Resolves basedOn references (by styleId) into a graph
+ *
+ * @details
+ * References to unknown styles, to styles of another type and edges that
+ * would close a cycle are dropped, so the result is always a forest.
+ */
+StyleGraph resolveStyleGraph(const std::vector<StyleInfo>& styles);
+
+struct TypstOptions {
+    /// Emit every style with its fully resolved settings instead of as a
+    /// delta over its parent (for comparison; output grows with depth)
+    bool flatten = false;
+};
+
+/**
+ * @brief Typst identifier for a style name ("heading 1" -> "heading-1")
+ *
+ * Names that would shadow Typst built-ins (quote, title, ...) get a
+ * "-style" suffix.
+ */
+std::string typstIdentifier(const std::string& styleName);
+
+/**
+ * @brief Generates a Typst module with one function per paragraph and character style
+ */
+std::string generateTypst(const std::vector<StyleInfo>& styles, const TypstOptions& options = {});
+
+/**
+ * @brief Also emits a show rule per heading level of the sheet's level table
+ *
+ * @details
+ * Each level becomes show-set rules with the heading style's fully resolved
+ * settings (fonts, size, colour, alignment) plus its paragraph box: spacing
+ * above and below, keep-with-next (block sticky) and keep-lines (block not
+ * breakable):
+ *
+ *     #show heading.where(level: 1): set text(font: "Cambria", size: 16pt)
+ *     #show heading.where(level: 1): set block(above: 12pt, below: 6pt, sticky: true)
+ */
+std::string generateTypst(const StyleSheet& sheet, const TypstOptions& options = {});
+
+} // namespace DocxParser
+
+#endif // TYPST_GENERATOR_H
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "docx_style_parser.h"
+#include "typst_generator.h"
+#include "test_styles.h"
+
+using namespace DocxParser;
+
+namespace {
+
+size_t countOf(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) ++count;
+    return count;
+}
+
+} // namespace
+
+/**
+ * @brief Parents come first; unknown, cross-type and cyclic references become roots
+ */
+TEST(TypstGeneratorTest, ResolvesStyleGraph) {
+    std::vector<StyleInfo> styles;
+    styles.push_back(makeStyle("H2", "H1"));
+    styles.push_back(makeStyle("H1", "Normal"));
+    styles.push_back(makeStyle("Normal", ""));
+    styles.push_back(makeStyle("Orphan", "Missing"));
+    styles.push_back(makeStyle("Char", "Normal", "character"));
+    styles.push_back(makeStyle("A", "B"));
+    styles.push_back(makeStyle("B", "A"));
+
+    const auto graph = resolveStyleGraph(styles);
+    EXPECT_EQ(graph.order, (std::vector<size_t>{2, 1, 0, 3, 4, 6, 5}));
+    EXPECT_EQ(graph.parent[0], 1u);
+    EXPECT_EQ(graph.depth[0], 2u);
+    EXPECT_EQ(graph.parent[3], StyleGraph::kNone);
+    EXPECT_EQ(graph.parent[4], StyleGraph::kNone);
+    EXPECT_EQ(graph.parent[6], StyleGraph::kNone);  // Cycle cut at B
+    EXPECT_EQ(graph.parent[5], 6u);
+}
+
+TEST(TypstGeneratorTest, MakesIdentifiers) {
+    EXPECT_EQ(typstIdentifier("heading 1"), "heading-1");
+    EXPECT_EQ(typstIdentifier("Intense Emphasis"), "intense-emphasis");
+    EXPECT_EQ(typstIdentifier("Quote"), "quote-style");
+    EXPECT_EQ(typstIdentifier("1st level"), "style-1st-level");
+    EXPECT_EQ(typstIdentifier("***"), "style");
+}
+
+/**
+ * @brief sample.docx headings wrap their hidden "Heading" base and set only what they change
+ */
+TEST(TypstGeneratorTest, ComposesSampleStyles) {
+    const auto typst = generateTypst(extractAllDocxStyles("sample.docx"));
+    EXPECT_NE(typst.find("#let heading-style(body) = standard({\n  set text(size: 14pt)\n  body\n})"),
+              std::string::npos)
+        << typst;
+    EXPECT_NE(typst.find("#let heading-2(body) = heading-style({\n  set text(fill: rgb(\"#ED7D31\"), "
+                         "font: \"Sarasa UI SC\", size: 16pt, weight: \"bold\")\n  body\n})"),
+              std::string::npos);
+    EXPECT_NE(typst.find("#let text-body = standard\n"), std::string::npos);  // Nothing of its own
+    EXPECT_EQ(countOf(typst, "Sarasa Gothic SC"), 1u);  // Inherited, never repeated
+    EXPECT_EQ(typst.find("table-normal"), std::string::npos);  // Table styles are not generated
+}
+
+/**
+ * @brief Composed output grows with overrides, flattened output with styles times depth
+ */
+TEST(TypstGeneratorTest, ComposedOutputStaysSmallForDeepChains) {
+    std::vector<StyleInfo> styles;
+    styles.push_back(makeStyle("Base", ""));
+    styles[0].fontName = "Calibri";
+    styles[0].properties["color"] = "1F3864";
+    styles[0].properties["lang"] = "en-GB";
+    styles[0].properties["jc"] = "both";
+    for (int level = 1; level <= 40; ++level) {
+        styles.push_back(makeStyle("Level" + std::to_string(level), "Level" + std::to_string(level - 1)));
+        styles.back().fontSize = std::to_string(60 - level);
+    }
+    styles[1].properties["basedOn"] = "Base";
+
+    TypstOptions flatten;
+    flatten.flatten = true;
+    const auto composed = generateTypst(styles);
+    const auto flat = generateTypst(styles, flatten);
+    EXPECT_EQ(countOf(composed, "Calibri"), 1u);
+    EXPECT_EQ(countOf(flat, "Calibri"), 41u);
+    EXPECT_LT(composed.size() * 2, flat.size());
+    EXPECT_NE(composed.find("#let level40(body) = level39({\n  set text(size: 10pt)\n  body\n})"),
+              std::string::npos);
+}
+
+/**
+ * @brief Outline levels map to heading show rules with the resolved paragraph box
+ */
+TEST(TypstGeneratorTest, EmitsHeadingShowRules) {
+    const auto sheet = extractDocxStyleSheet("sample.docx");
+    ASSERT_NE(sheet.headingLevels[0], StyleSheet::kNoStyle);
+    EXPECT_EQ(sheet.styles[sheet.headingLevels[0]].name, "heading 1");
+    EXPECT_EQ(sheet.headingLevels[3], StyleSheet::kNoStyle);
+
+    const auto typst = generateTypst(sheet);
+    EXPECT_NE(typst.find("#show heading.where(level: 2): set text(fill: rgb(\"#ED7D31\"), "
+                         "font: \"Sarasa UI SC\", size: 16pt, weight: \"bold\")\n"),
+              std::string::npos)
+        << typst;
+    EXPECT_NE(typst.find("#show heading.where(level: 2): set block(above: 10pt, below: 6pt, sticky: true)\n"),
+              std::string::npos);
+    EXPECT_EQ(typst.find("heading.where(level: 4)"), std::string::npos);
+    EXPECT_EQ(typst.find("  set block("), std::string::npos);  // Functions never set the paragraph box
+}
+
+TEST(TypstGeneratorTest, ConvertsParagraphSpacing) {
+    std::vector<StyleInfo> styles;
+    styles.push_back(makeStyle("Title", ""));
+    styles[0].properties["spacing.before"] = "250";
+    styles[0].properties["spacing.after"] = "7";
+    styles[0].properties["keepLines"] = "";
+    StyleSheet sheet;
+    sheet.styles = std::move(styles);
+    sheet.headingLevels[0] = 0;
+    EXPECT_NE(generateTypst(sheet).find("set block(above: 12.5pt, below: 0.35pt, breakable: false)"),
+              std::string::npos);
+}
@@ -0,0 +1,606 @@
+// Standard C++ headers
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// Platform headers for page cache eviction, process start-up timing and peak RSS
+#ifndef _WIN32
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#else
+#define NOMINMAX
+#include <windows.h>
+#endif
+// libzip for writing generated archives
+#include <zip.h>
+// libxml2 for the untranscoded baseline
+#include <libxml/parser.h>
+// Project headers
+#include "batch_runner.h"
+#include "docx_style_parser.h"
+#include "readahead.h"
+#include "style_blocks.h"
+#include "text_encoding.h"
+
+namespace fs = std::filesystem;
+
+/*
+ * TypStyle benchmark suite
+ *
+ * Usage: TypStyleBench [benchmark...] [--key value]...
+ *
+ * Runs every benchmark (or the named ones) and prints one line per variant:
+ *   benchmark  variant  median ms  per-item us  items
+ *
+ * Each variant runs --repeat times (default 3) and the median is reported,
+ * which is robust against one run hitting a background flush.
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Command line flags as strings, with typed lookups
+ */
+struct BenchArgs {
+    std::map<std::string, std::string> flags;
+    std::string program;  ///< argv[0], to find the sibling TypStyle binary
+
+    std::string get(const std::string& key, const std::string& fallback) const {
+        auto it = flags.find(key);
+        return it == flags.end() ? fallback : it->second;
+    }
+
+    size_t number(const std::string& key, size_t fallback) const {
+        auto it = flags.find(key);
+        return it == flags.end() ? fallback : std::stoul(it->second);
+    }
+};
+
+double medianOf(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples.empty() ? 0 : samples[samples.size() / 2];
+}
+
+void printResult(const std::string& benchmark, const std::string& variant, double ms, size_t items) {
+    std::printf("%-12s %-28s %10.2f ms %10.2f us/item %8zu items\n", benchmark.c_str(), variant.c_str(), ms,
+                items ? ms * 1000.0 / items : 0.0, items);
+    std::fflush(stdout);
+}
+
+/**
+ * @brief Times fn --repeat times after running setup before each run
+ */
+double measure(const BenchArgs& args, const std::function<void()>& setup, const std::function<void()>& fn) {
+    std::vector<double> samples;
+    for (size_t r = 0; r < std::max<size_t>(1, args.number("--repeat", 3)); ++r) {
+        setup();
+        const auto start = Clock::now();
+        fn();
+        samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return medianOf(samples);
+}
+
+/**
+ * @brief Drops the cached pages of a file so the next read goes to the device
+ *
+ * Works without privileges for clean pages on local filesystems; tmpfs and
+ * some network filesystems ignore it (the run is then effectively warm).
+ */
+void evictFromPageCache(const std::string& path) {
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+#else
+    (void)path;
+#endif
+}
+
+/**
+ * @brief Writes a DOCX-like archive: styles, a document body and an incompressible "image"
+ */
+void writeSyntheticDocx(const std::string& path, int styleCount, size_t mediaBytes, std::mt19937& random) {
+    std::string styles =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+        "<w:styles xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\">\n";
+    for (int i = 0; i < styleCount; ++i) {
+        const std::string id = std::to_string(i);
+        styles += "<w:style w:type=\"paragraph\" w:styleId=\"S" + id + "\"><w:name w:val=\"Style " + id +
+                  "\"/><w:qFormat/><w:rPr><w:sz w:val=\"" + std::to_string(20 + i % 10) + "\"/></w:rPr></w:style>\n";
+    }
+    styles += "</w:styles>\n";
+    const std::string document =
+        "<?xml version=\"1.0\"?><w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\">"
+        "<w:body><w:p><w:r><w:t>Benchmark</w:t></w:r></w:p></w:body></w:document>";
+    std::string media(mediaBytes, '\0');
+    for (auto& byte : media) byte = static_cast<char>(random());
+
+    int error = 0;
+    zip_t* zip = zip_open(path.c_str(), ZIP_CREATE | ZIP_TRUNCATE, &error);
+    if (!zip) throw std::runtime_error("Cannot create " + path);
+    // Media first, styles last: like real files, the styles entry is far from the start
+    const std::pair<const char*, const std::string*> parts[] = {
+        {"word/media/image1.bin", &media}, {"word/document.xml", &document}, {"word/styles.xml", &styles}};
+    for (const auto& part : parts) {
+        zip_source_t* source = zip_source_buffer(zip, part.second->data(), part.second->size(), 0);
+        if (!source || zip_file_add(zip, part.first, source, ZIP_FL_OVERWRITE) < 0) {
+            zip_discard(zip);
+            throw std::runtime_error("Cannot add " + std::string(part.first) + " to " + path);
+        }
+    }
+    if (zip_close(zip) != 0) throw std::runtime_error("Cannot write " + path);
+}
+
+/**
+ * @brief Inputs from --dir, or a generated corpus in a temp directory
+ */
+std::vector<std::string> benchCorpus(const BenchArgs& args, const std::string& name) {
+    std::vector<std::string> paths;
+    const std::string dir = args.get("--dir", "");
+    if (!dir.empty()) {
+        for (const auto& entry : fs::recursive_directory_iterator(dir)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".docx") paths.push_back(entry.path().string());
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    const auto directory = fs::temp_directory_path() / ("typstyle_bench_" + name);
+    fs::create_directories(directory);
+    std::mt19937 random(42);
+    const size_t files = args.number("--files", 200);
+    const size_t mediaBytes = args.number("--media-kb", 512) << 10;
+    for (size_t i = 0; i < files; ++i) {
+        const auto path = (directory / ("doc" + std::to_string(i) + ".docx")).string();
+        if (!fs::exists(path)) writeSyntheticDocx(path, 20 + int(i % 80), mediaBytes, random);
+        paths.push_back(path);
+    }
+    return paths;
+}
+
+/**
+ * @brief Batch extraction from a cold page cache with and without readahead
+ *
+ * Flags: --files N, --media-kb N, --dir DIR (existing corpus), --threads N, --window N
+ */
+void benchReadahead(const BenchArgs& args) {
+    const auto paths = benchCorpus(args, "readahead");
+    const size_t window = args.number("--window", 32);
+
+    struct Variant {
+        std::string name;
+        DocxParser::ReadaheadOptions readahead;
+    };
+    const Variant variants[] = {
+        {"cold, no readahead", {0, true}},
+        {"cold, readahead ranges", {window, true}},
+        {"cold, readahead whole", {window, false}},
+    };
+    for (const auto& variant : variants) {
+        DocxParser::BatchOptions options;
+        options.threads = args.number("--threads", 4);
+        options.policy = DocxParser::SchedulePolicy::Fifo;
+        options.readahead = variant.readahead;
+        DocxParser::ReadaheadStats stats;
+        const double ms = measure(
+            args, [&] { for (const auto& path : paths) evictFromPageCache(path); },
+            [&] {
+                DocxParser::BatchRunner runner(options);
+                runner.run(paths);
+                stats = runner.report().readahead;
+            });
+        printResult("readahead", variant.name, ms, paths.size());
+        if (variant.readahead.maxWindow > 0) {
+            std::printf("%-12s   window up to %zu, %.0f us mean prefetch I/O\n", "", stats.largestWindow,
+                        stats.meanIoMicros);
+        }
+    }
+}
+
+/**
+ * @brief styles.xml with spacing, fonts and sizes per style
+ *
+ * Mostly ASCII markup with some non-Latin names, like real localized templates.
+ */
+std::string localizedStylesXml(size_t styleCount) {
+    std::string utf8 =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+        "<w:styles xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\">\n";
+    for (size_t i = 0; i < styleCount; ++i) {
+        const std::string id = std::to_string(i);
+        const std::string name = i % 4 == 0 ? "\xE6\xA0\x87\xE9\xA2\x98 " + id : "Heading " + id;
+        utf8 += "<w:style w:type=\"paragraph\" w:styleId=\"S" + id + "\"><w:name w:val=\"" + name +
+                "\"/><w:qFormat/><w:pPr><w:spacing w:before=\"240\" w:after=\"60\"/></w:pPr>"
+                "<w:rPr><w:rFonts w:ascii=\"Calibri Light\"/><w:sz w:val=\"32\"/></w:rPr></w:style>\n";
+    }
+    return utf8 + "</w:styles>\n";
+}
+
+/**
+ * @brief Parsing a UTF-16 styles part: libxml2's transcoder vs our UTF-8 fast path
+ *
+ * Flags: --styles N (styles in the part), --iterations N
+ */
+void benchUtf16(const BenchArgs& args) {
+    const size_t styleCount = args.number("--styles", 2000);
+    const size_t iterations = args.number("--iterations", 50);
+    const std::string utf8 = localizedStylesXml(styleCount);
+
+    // UTF-8 -> UTF-16LE with BOM (the names above are all in the BMP)
+    std::string source = utf8;
+    source.replace(source.find("UTF-8"), 5, "UTF-16");
+    std::string utf16 = "\xFF\xFE";
+    for (size_t i = 0; i < source.size();) {
+        const auto c = static_cast<unsigned char>(source[i]);
+        uint32_t cp = c;
+        size_t length = 1;
+        if (c >= 0xE0) {
+            cp = (c & 0x0F) << 12 | (source[i + 1] & 0x3F) << 6 | (source[i + 2] & 0x3F);
+            length = 3;
+        } else if (c >= 0xC0) {
+            cp = (c & 0x1F) << 6 | (source[i + 1] & 0x3F);
+            length = 2;
+        }
+        utf16 += static_cast<char>(cp & 0xFF);
+        utf16 += static_cast<char>(cp >> 8);
+        i += length;
+    }
+    // Both parts go through a libxml2 tree, as the untranscoded baseline does
+    StreamOptions dom;
+    dom.backend = DocxParser::XmlBackend::LibxmlDom;
+    auto parse = [&](const std::string& part) {
+        DocxParser::visitStylesPart(part.data(), part.size(), [](StyleInfo&) {}, dom);
+    };
+    auto noSetup = [] {};
+
+    const double utf8Ms = measure(args, noSetup, [&] {
+        for (size_t i = 0; i < iterations; ++i) parse(utf8);
+    });
+    printResult("utf16", "parse UTF-8 part (reference)", utf8Ms, iterations);
+
+    DocxParser::initializeParser();
+    const double libxmlMs = measure(args, noSetup, [&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            xmlFreeDoc(xmlReadMemory(utf16.data(), static_cast<int>(utf16.size()), "styles.xml", NULL,
+                                     XML_PARSE_NONET));
+        }
+    });
+    printResult("utf16", "parse UTF-16, libxml2 decoder", libxmlMs, iterations);
+
+    const double fastMs = measure(args, noSetup, [&] {
+        for (size_t i = 0; i < iterations; ++i) parse(utf16);
+    });
+    printResult("utf16", "parse UTF-16, transcode first", fastMs, iterations);
+
+    std::string out;
+    const double simdMs = measure(args, noSetup, [&] {
+        for (size_t i = 0; i < iterations; ++i) DocxParser::utf16ToUtf8(utf16.data() + 2, utf16.size() - 2, false, out);
+    });
+    printResult("utf16", "transcode only, SIMD", simdMs, iterations);
+    const double scalarMs = measure(args, noSetup, [&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            DocxParser::utf16ToUtf8Scalar(utf16.data() + 2, utf16.size() - 2, false, out);
+        }
+    });
+    printResult("utf16", "transcode only, scalar", scalarMs, iterations);
+    std::printf("%-12s   part %.1f KiB; transcode %.0f MiB/s SIMD, %.0f MiB/s scalar\n", "",
+                utf16.size() / 1024.0, utf16.size() * iterations / 1048576.0 / (simdMs / 1000.0),
+                utf16.size() * iterations / 1048576.0 / (scalarMs / 1000.0));
+}
+
+/**
+ * @brief Peak resident set size of this process so far, in KiB (0 where unsupported)
+ */
+long peakRssKib() {
+#ifndef _WIN32
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief One large styles part: whole-part inflate-then-parse vs the streaming path
+ *
+ * Flags: --styles N (styles in the part, default 50000), --chunk-kb N (64)
+ *
+ * Streaming runs first: peak RSS only ever grows, so the growth measured
+ * after each variant is that variant's own high-water mark.
+ */
+void benchStream(const BenchArgs& args) {
+    const auto path = (fs::temp_directory_path() / "typstyle_bench_stream.docx").string();
+    std::mt19937 random(42);
+    writeSyntheticDocx(path, static_cast<int>(args.number("--styles", 50000)), 0, random);
+    StreamOptions options;
+    options.chunkBytes = args.number("--chunk-kb", 64) << 10;
+    options.backend = DocxParser::XmlBackend::LibxmlSax;
+    auto noSetup = [] {};
+
+    size_t styles = 0;
+    double firstStyleMs = 0;
+    long rss = peakRssKib();
+    const double streamMs = measure(args, noSetup, [&] {
+        const auto start = Clock::now();
+        styles = 0;
+        DocxParser::streamDocxStyles(path, [&](StyleInfo&&) {
+            if (styles++ == 0) firstStyleMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }, options);
+    });
+    printResult("stream", "streaming, " + std::to_string(options.chunkBytes >> 10) + " KiB chunks", streamMs, styles);
+    std::printf("%-12s   first style after %.2f ms, peak RSS +%ld KiB\n", "", firstStyleMs, peakRssKib() - rss);
+
+    rss = peakRssKib();
+    options.backend = DocxParser::XmlBackend::LibxmlDom;
+    const double bufferedMs = measure(args, noSetup, [&] {
+        const auto start = Clock::now();
+        styles = 0;
+        DocxParser::streamDocxStyles(path, [&](StyleInfo&&) {
+            if (styles++ == 0) firstStyleMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }, options);
+    });
+    printResult("stream", "inflate whole part, then parse", bufferedMs, styles);
+    std::printf("%-12s   first style after %.2f ms, peak RSS +%ld KiB\n", "", firstStyleMs, peakRssKib() - rss);
+    fs::remove(path);
+}
+
+/**
+ * @brief Every XML backend on small, medium and large styles parts
+ *
+ * Flags: --mb N (MiB parsed per variant, default 64)
+ *
+ * Parts are in memory, so only parsing and style building are timed. The
+ * fastest backend per workload is what StreamOptions::backend = Auto
+ * should pick.
+ */
+void benchBackends(const BenchArgs& args) {
+    const size_t budget = args.number("--mb", 64) << 20;
+    const std::pair<const char*, size_t> workloads[] = {{"small", 150}, {"medium", 1500}, {"large", 50000}};
+    auto noSetup = [] {};
+    for (const auto& workload : workloads) {
+        const std::string part = localizedStylesXml(workload.second);
+        const size_t iterations = std::max<size_t>(1, budget / part.size());
+        std::string fastest;
+        double fastestMs = 0;
+        for (auto backend : DocxParser::availableXmlBackends()) {
+            StreamOptions options;
+            options.backend = backend;
+            options.quickFormatOnly = false;
+            size_t styles = 0;
+            const double ms = measure(args, noSetup, [&] {
+                styles = 0;
+                for (size_t i = 0; i < iterations; ++i) {
+                    DocxParser::visitStylesPart(part.data(), part.size(), [&](StyleInfo&) { ++styles; }, options);
+                }
+            });
+            printResult("backends", std::string(workload.first) + ", " + DocxParser::xmlBackendName(backend), ms,
+                        styles);
+            if (fastest.empty() || ms < fastestMs) {
+                fastest = DocxParser::xmlBackendName(backend);
+                fastestMs = ms;
+            }
+        }
+        std::printf("%-12s   %s part %.0f KiB: fastest %s, %.0f MiB/s\n", "", workload.first, part.size() / 1024.0,
+                    fastest.c_str(), part.size() * iterations / 1048576.0 / (fastestMs / 1000.0));
+    }
+}
+
+/**
+ * @brief Re-extracting a part with one edited style: full parse vs snapshot reuse
+ *
+ * The baseline collects every style like a snapshot does; the incremental
+ * run hands its snapshot from one iteration to the next.
+ *
+ * Flags: --mb N (MiB of parts processed per variant, default 64)
+ */
+void benchIncremental(const BenchArgs& args) {
+    const size_t budget = args.number("--mb", 64) << 20;
+    const std::pair<const char*, size_t> workloads[] = {{"small", 150}, {"medium", 1500}, {"large", 50000}};
+    auto noSetup = [] {};
+    for (const auto& workload : workloads) {
+        const std::string original = localizedStylesXml(workload.second);
+        std::string edited = original;
+        const size_t middle = edited.find("w:styleId=\"S" + std::to_string(workload.second / 2) + "\"");
+        edited.replace(edited.find("w:before=\"240\"", middle) + 10, 3, "360");
+        const size_t iterations = std::max<size_t>(1, budget / edited.size());
+        // Alternate between the two versions, as a template edited back and forth
+        auto version = [&](size_t i) -> const std::string& { return i % 2 ? original : edited; };
+
+        StreamOptions all;
+        all.quickFormatOnly = false;
+        size_t styles = 0;
+        const double fullMs = measure(args, noSetup, [&] {
+            for (size_t i = 0; i < iterations; ++i) {
+                DocxParser::StyleSet parsed;
+                DocxParser::visitStylesPart(version(i).data(), version(i).size(),
+                                            [&](StyleInfo& style) { parsed.push_back(std::move(style)); }, all);
+                styles = parsed.size();
+            }
+        });
+        printResult("incremental", std::string(workload.first) + ", full", fullMs, styles * iterations);
+        DocxParser::StyleBlockSnapshot snapshot;
+        DocxParser::IncrementalReport report;
+        const double incrementalMs = measure(args, [&] {
+            snapshot = DocxParser::extractStyleBlocks(original.data(), original.size());
+        }, [&] {
+            for (size_t i = 0; i < iterations; ++i) {
+                snapshot = DocxParser::extractStyleBlocks(version(i).data(), version(i).size(), std::move(snapshot),
+                                                          &report);
+            }
+        });
+        printResult("incremental", std::string(workload.first) + ", 1 changed", incrementalMs,
+                    snapshot.styles.size() * iterations);
+        std::printf("%-12s   %s part %.0f KiB: %zu reused, %zu parsed, %.1fx faster\n", "", workload.first,
+                    edited.size() / 1024.0, report.reused, report.parsed, fullMs / incrementalMs);
+    }
+}
+
+/**
+ * @brief Runs a command to completion with its output discarded
+ * @return Wall time from spawn to exit in milliseconds
+ */
+double timeProcess(const std::vector<std::string>& command) {
+    const auto start = Clock::now();
+#ifndef _WIN32
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    std::vector<char*> argv;
+    for (const auto& arg : command) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    pid_t pid = 0;
+    const int spawned = posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (spawned != 0) throw std::runtime_error("Cannot start " + command[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    const bool succeeded = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#else
+    std::string line;
+    for (const auto& arg : command) line += "\"" + arg + "\" ";
+    SECURITY_ATTRIBUTES inherit = {sizeof(inherit), nullptr, TRUE};
+    HANDLE nul = CreateFileA("NUL", GENERIC_WRITE, FILE_SHARE_WRITE, &inherit, OPEN_EXISTING, 0, nullptr);
+    STARTUPINFOA startup = {};
+    startup.cb = sizeof(startup);
+    startup.dwFlags = STARTF_USESTDHANDLES;
+    startup.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+    startup.hStdOutput = nul;
+    startup.hStdError = nul;
+    PROCESS_INFORMATION process = {};
+    if (!CreateProcessA(nullptr, &line[0], nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startup, &process)) {
+        CloseHandle(nul);
+        throw std::runtime_error("Cannot start " + command[0]);
+    }
+    WaitForSingleObject(process.hProcess, INFINITE);
+    DWORD exitCode = 1;
+    GetExitCodeProcess(process.hProcess, &exitCode);
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+    CloseHandle(nul);
+    const bool succeeded = exitCode == 0;
+#endif
+    if (!succeeded) throw std::runtime_error(command[0] + " " + (command.size() > 1 ? command[1] : "") + " failed");
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Process start-to-exit time of one-shot invocations against a budget
+ *
+ * Flags: --binary (default: TypStyle next to this executable), --docx
+ * (sample.docx), --iterations (50), --budget-ms (5), --enforce 1 to fail
+ * when the fast path's median misses the budget.
+ */
+void benchStartup(const BenchArgs& args) {
+#ifdef _WIN32
+    const char* executable = "TypStyle.exe";
+#else
+    const char* executable = "TypStyle";
+#endif
+    const std::string binary = args.get("--binary", (fs::path(args.program).parent_path() / executable).string());
+    const std::string docx = args.get("--docx", "sample.docx");
+    const size_t iterations = std::max<size_t>(1, args.number("--iterations", 50));
+    const double budgetMs = std::stod(args.get("--budget-ms", "5"));
+    if (!fs::exists(binary)) throw std::runtime_error(binary + " not found; pass --binary");
+
+    struct Variant {
+        const char* name;
+        std::vector<std::string> command;
+    };
+    std::vector<Variant> variants;
+#ifndef _WIN32
+    variants.push_back({"process floor (/bin/true)", {"/bin/true"}});
+#endif
+    variants.push_back({"styles (one-shot fast path)", {binary, "styles", docx}});
+    variants.push_back({"batch --threads 1 (full CLI)", {binary, "batch", "--threads", "1", docx}});
+
+    timeProcess(variants.back().command);  // Binary, libraries and input in the page cache
+    double fastMedian = 0;
+    double fastP95 = 0;
+    double batchMedian = 0;
+    for (const auto& variant : variants) {
+        std::vector<double> samples;
+        for (size_t i = 0; i < iterations; ++i) samples.push_back(timeProcess(variant.command));
+        // One line per run time, not the sum: a process start is the unit here
+        std::sort(samples.begin(), samples.end());
+        const double median = samples[samples.size() / 2];
+        const double p95 = samples[std::min(samples.size() - 1, samples.size() * 95 / 100)];
+        std::printf("%-12s %-28s %10.2f ms median %8.2f ms p95 %6zu runs\n", "startup", variant.name, median, p95,
+                    iterations);
+        if (variant.command.size() > 1 && variant.command[1] == "styles") {
+            fastMedian = median;
+            fastP95 = p95;
+        } else if (variant.command.size() > 1 && variant.command[1] == "batch") {
+            batchMedian = median;
+        }
+    }
+    const bool met = fastMedian <= budgetMs;
+    std::printf("%-12s   styles: median %.2f ms, p95 %.2f ms, %.2f ms under batch; budget %.1f ms %s\n", "",
+                fastMedian, fastP95, batchMedian - fastMedian, budgetMs, met ? "met" : "MISSED");
+    if (!met && args.number("--enforce", 0)) {
+        throw std::runtime_error("Cold-start budget missed");
+    }
+}
+
+struct Benchmark {
+    const char* name;
+    const char* description;
+    void (*run)(const BenchArgs&);
+};
+
+const Benchmark kBenchmarks[] = {
+    {"readahead", "batch extraction from a cold page cache, readahead off/ranges/whole", benchReadahead},
+    {"utf16", "parsing a UTF-16 styles part: libxml2 transcoding vs the UTF-8 fast path", benchUtf16},
+    {"stream", "one large styles part: inflate-then-parse vs overlapped streaming", benchStream},
+    {"backends", "every XML backend on small, medium and large styles parts", benchBackends},
+    {"incremental", "re-extracting a part with one edited style: full parse vs snapshot reuse", benchIncremental},
+    {"startup", "process start-to-exit of one-shot TypStyle invocations vs the cold-start budget", benchStartup},
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchArgs args;
+    args.program = argv[0];
+    std::vector<std::string> selected;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--", 0) == 0 && i + 1 < argc) {
+            args.flags[arg] = argv[++i];
+        } else if (arg == "--list" || arg == "-l") {
+            for (const auto& bench : kBenchmarks) std::cout << bench.name << "\t" << bench.description << "\n";
+            return 0;
+        } else {
+            selected.push_back(arg);
+        }
+    }
+
+    try {
+        for (const auto& bench : kBenchmarks) {
+            if (selected.empty() || std::find(selected.begin(), selected.end(), bench.name) != selected.end()) {
+                bench.run(args);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,935 @@
+// Standard C++ headers
+#include <algorithm>  // For min, max
+#include <climits>    // For INT_MAX
+#include <cstring>    // For memchr, memcmp, memcpy, memset
+#include <deque>      // For attribute values that need stable addresses
+#include <exception>  // For exception_ptr
+#include <memory>     // For unique_ptr
+#include <stdexcept>  // For runtime_error
+#include <utility>    // For pair
+
+// Third-party library headers
+#include <libxml/parser.h>     // For the SAX2 push parser and trees (libxml2)
+#include <libxml/tree.h>       // For walking trees
+#include <libxml/xmlreader.h>  // For the pull reader
+#ifdef TYPSTYLE_WITH_EXPAT
+#include <expat.h>             // For the expat backend
+#endif
+
+// Project headers
+#include "docx_style_parser.h"  // For initializeParser
+#include "scratch_buffer.h"
+#include "xml_backend.h"
+
+using namespace std;
+
+/*
+ * XML Backends - Implementation Notes
+ *
+ * All backends must produce the same events for the same document, which
+ * the tests check against LibxmlDom. The details that make them agree:
+ * - Text: line ends are normalized to \n; CDATA sections are plain text;
+ *   comments and processing instructions produce nothing. (libxml2's push
+ *   mode, so SAX and the reader, leaves CR LF inside CDATA as it is; Word
+ *   does not write CDATA in styles.)
+ * - Attribute values: entities are decoded and tab, CR and LF become
+ *   spaces (XML 1.0 3.3.3); character references are not normalized.
+ * - libxml2's SAX2 interface passes "&#38;" for an '&' in an attribute
+ *   value (it expects the tree builder to decode it), so SAX undoes that.
+ *
+ * Exceptions must not unwind through libxml2's or expat's C frames: the
+ * callbacks catch them, stop the parser and rethrow once it has returned.
+ * The reader and in-situ backends call the handler from their own loop.
+ *
+ * The in-situ parser accepts what Word and other generators write:
+ * declaration, comments, processing instructions, elements, CDATA and the
+ * predefined and numeric entities. A DOCTYPE, an undeclared entity or
+ * mismatched tags fail the parse like a well-formedness error in libxml2.
+ *
+ * Namespace errors fail every backend alike: an undeclared prefix, or an
+ * attribute given twice (by name, or by namespace and local name). libxml2
+ * only flags them (nsWellFormed), and the reader does not expose the flag,
+ * so it checks prefixes itself; expat and in-situ track declarations in a
+ * NamespaceScope.
+ */
+
+namespace DocxParser {
+
+namespace {
+
+    constexpr size_t kMaxPooledBuffer = 4u << 20;
+
+    struct BackendName {
+        XmlBackend backend;
+        const char* name;
+    };
+
+    const BackendName kBackendNames[] = {
+        {XmlBackend::Auto, "auto"},
+        {XmlBackend::LibxmlSax, "libxml-sax"},
+        {XmlBackend::LibxmlDom, "libxml-dom"},
+        {XmlBackend::LibxmlReader, "libxml-reader"},
+        {XmlBackend::Expat, "expat"},
+        {XmlBackend::InSitu, "in-situ"},
+    };
+
+    [[noreturn]] void parseError(const char* documentName) {
+        throw runtime_error(string("Failed to parse ") + documentName + " content");
+    }
+
+    string_view view(const xmlChar* text) {
+        return text ? string_view(reinterpret_cast<const char*>(text)) : string_view();
+    }
+
+    string_view localName(string_view qualified) {
+        const size_t colon = qualified.find(':');
+        return colon == string_view::npos ? qualified : qualified.substr(colon + 1);
+    }
+
+    bool isNamespaceDeclaration(string_view qualified) {
+        return qualified == "xmlns" || qualified.substr(0, 6) == "xmlns:";
+    }
+
+    /**
+     * @brief Namespace declarations in scope, for backends that only see qualified names
+     *
+     * Catches what libxml2 flags as namespace errors: an undeclared prefix,
+     * and one attribute given under two prefixes of the same namespace. (The
+     * same qualified name twice is a well-formedness error, caught by the
+     * parser itself.) Nearly every name in a part has the same prefix, so
+     * the last resolution is cached.
+     */
+    class NamespaceScope {
+    public:
+        /// Enters an element; false on a namespace error
+        bool open(string_view qualified, const XmlAttribute* attributes, size_t count) {
+            scopes_.push_back(bindings_.size());
+            for (size_t i = 0; i < count; ++i) {
+                const string_view name = attributes[i].name;
+                if (!isNamespaceDeclaration(name)) continue;
+                bindings_.emplace_back(name.size() > 5 ? name.substr(6) : string_view(), attributes[i].value);
+                cached_ = nullptr;
+            }
+            const size_t colon = qualified.find(':');
+            if (colon != string_view::npos && !resolve(qualified.substr(0, colon))) return false;
+
+            for (size_t i = 0; i < count; ++i) {
+                const string_view name = attributes[i].name;
+                const size_t colon = name.find(':');
+                if (colon == string_view::npos || isNamespaceDeclaration(name)) continue;
+                const string* uri = resolve(name.substr(0, colon));
+                if (!uri) return false;
+                for (size_t j = 0; j < i; ++j) {
+                    const string_view other = attributes[j].name;
+                    const size_t otherColon = other.find(':');
+                    if (otherColon == string_view::npos || isNamespaceDeclaration(other) ||
+                        other.substr(otherColon) != name.substr(colon)) {
+                        continue;
+                    }
+                    if (*resolve(other.substr(0, otherColon)) == *uri) return false;
+                }
+            }
+            return true;
+        }
+
+        /// Leaves the element entered last
+        void close() {
+            const size_t bindings = scopes_.back();
+            scopes_.pop_back();
+            if (bindings_.size() == bindings) return;
+            bindings_.resize(bindings);
+            cached_ = nullptr;
+        }
+
+    private:
+        // URI bound to prefix, or nullptr if it is undeclared
+        const string* resolve(string_view prefix) {
+            static const string xmlNamespace = "http://www.w3.org/XML/1998/namespace";
+            if (cached_ && prefix == cached_->first) return &cached_->second;
+            for (size_t i = bindings_.size(); i-- > 0;) {
+                if (bindings_[i].first == prefix) {
+                    cached_ = &bindings_[i];
+                    return &cached_->second;
+                }
+            }
+            return prefix == "xml" ? &xmlNamespace : nullptr;
+        }
+
+        vector<pair<string, string>> bindings_;  ///< Prefix ("" for the default namespace) and URI
+        vector<size_t> scopes_;                  ///< bindings_ size when each open element was entered
+        const pair<string, string>* cached_ = nullptr;
+    };
+
+    int libxmlOptions(const XmlParseOptions& options) {
+        int flags = XML_PARSE_NONET;
+        if (options.utf8) flags |= XML_PARSE_IGNORE_ENC;
+        if (options.huge) flags |= XML_PARSE_HUGE;
+        return flags;
+    }
+
+    void readAll(XmlSource& source, vector<char>& buffer, size_t chunkBytes) {
+        const size_t chunk = max<size_t>(chunkBytes, 64 * 1024);
+        buffer.clear();
+        for (;;) {
+            const size_t used = buffer.size();
+            buffer.resize(used + chunk);
+            const size_t got = source.read(buffer.data() + used, chunk);
+            buffer.resize(used + got);
+            if (got == 0) return;
+        }
+    }
+
+    // This thread's whole-part buffer, or a private one if a handler re-enters the parser
+    using PartBuffer = ScratchBuffer<struct PartBufferTag>;
+
+    // ---- libxml2 SAX2 push parser ----
+
+    struct SaxState {
+        XmlEventHandler* handler = nullptr;
+        xmlParserCtxtPtr context = nullptr;
+        vector<XmlAttribute> attributes;
+        deque<string> decoded;  // Attribute values that contained "&#38;"
+        bool stopped = false;
+        exception_ptr error;
+
+        void stop() {
+            stopped = true;
+            xmlStopParser(context);
+        }
+    };
+
+    void saxStartElement(void* data, const xmlChar* localname, const xmlChar*, const xmlChar*, int,
+                         const xmlChar**, int count, int, const xmlChar** attributes) {
+        auto& state = *static_cast<SaxState*>(data);
+        if (state.stopped) return;
+        try {
+            state.attributes.clear();
+            size_t decoded = 0;
+            for (int i = 0; i < count; ++i) {
+                const xmlChar** attribute = attributes + 5 * i;  // localname, prefix, URI, value, end
+                string_view value(reinterpret_cast<const char*>(attribute[3]), attribute[4] - attribute[3]);
+                if (value.find('&') != string_view::npos) {
+                    if (state.decoded.size() <= decoded) state.decoded.emplace_back();
+                    string& out = state.decoded[decoded++];
+                    out.clear();
+                    for (size_t pos = 0; pos < value.size();) {
+                        if (value.compare(pos, 5, "&#38;") == 0) {
+                            out += '&';
+                            pos += 5;
+                        } else {
+                            out += value[pos++];
+                        }
+                    }
+                    value = out;
+                }
+                state.attributes.push_back({view(attribute[0]), value});
+            }
+            state.handler->startElement(view(localname), state.attributes.data(), state.attributes.size());
+        } catch (...) {
+            state.error = current_exception();
+            state.stop();
+        }
+    }
+
+    void saxEndElement(void* data, const xmlChar* localname, const xmlChar*, const xmlChar*) {
+        auto& state = *static_cast<SaxState*>(data);
+        if (state.stopped) return;
+        try {
+            if (!state.handler->endElement(view(localname))) state.stop();
+        } catch (...) {
+            state.error = current_exception();
+            state.stop();
+        }
+    }
+
+    void saxCharacters(void* data, const xmlChar* text, int length) {
+        auto& state = *static_cast<SaxState*>(data);
+        if (state.stopped) return;
+        try {
+            state.handler->characters(string_view(reinterpret_cast<const char*>(text), static_cast<size_t>(length)));
+        } catch (...) {
+            state.error = current_exception();
+            state.stop();
+        }
+    }
+
+    bool parseWithLibxmlSax(XmlSource& source, XmlEventHandler& handler, const XmlParseOptions& options,
+                            const char* documentName) {
+        xmlSAXHandler sax;
+        memset(&sax, 0, sizeof(sax));
+        sax.initialized = XML_SAX2_MAGIC;
+        sax.startElementNs = saxStartElement;
+        sax.endElementNs = saxEndElement;
+        sax.characters = saxCharacters;
+        sax.cdataBlock = saxCharacters;
+        sax.ignorableWhitespace = saxCharacters;
+
+        SaxState state;
+        state.handler = &handler;
+        unique_ptr<xmlParserCtxt, void (*)(xmlParserCtxtPtr)> context(
+            xmlCreatePushParserCtxt(&sax, &state, nullptr, 0, documentName), xmlFreeParserCtxt);
+        if (!context) {
+            throw runtime_error("Failed to create XML parser context");
+        }
+        state.context = context.get();
+        xmlCtxtUseOptions(context.get(), libxmlOptions(options));
+
+        vector<char> chunk(max<size_t>(options.chunkBytes, 1));
+        for (;;) {
+            const size_t size = source.read(chunk.data(), chunk.size());
+            const int status = xmlParseChunk(context.get(), chunk.data(), static_cast<int>(size), size == 0);
+            if (state.error) rethrow_exception(state.error);
+            if (state.stopped) return false;
+            if (status != 0 || !context->wellFormed || !context->nsWellFormed) parseError(documentName);
+            if (size == 0) return true;
+        }
+    }
+
+    // ---- libxml2 tree ----
+
+    class TreeWalker {
+    public:
+        explicit TreeWalker(XmlEventHandler& handler) : handler_(handler) {}
+
+        bool walk(xmlNodePtr node) {
+            for (; node; node = node->next) {
+                switch (node->type) {
+                    case XML_ELEMENT_NODE:
+                        attributes_.clear();
+                        joined_.clear();
+                        for (xmlAttr* attr = node->properties; attr; attr = attr->next) {
+                            xmlNodePtr text = attr->children;
+                            if (text && !text->next && text->type == XML_TEXT_NODE) {
+                                attributes_.push_back({view(attr->name), view(text->content)});
+                                continue;
+                            }
+                            // Values with entity references are split over several nodes
+                            xmlChar* value = xmlNodeListGetString(node->doc, attr->children, 1);
+                            joined_.emplace_back(value ? reinterpret_cast<const char*>(value) : "");
+                            xmlFree(value);
+                            attributes_.push_back({view(attr->name), joined_.back()});
+                        }
+                        handler_.startElement(view(node->name), attributes_.data(), attributes_.size());
+                        if (!walk(node->children) || !handler_.endElement(view(node->name))) return false;
+                        break;
+                    case XML_TEXT_NODE:
+                    case XML_CDATA_SECTION_NODE:
+                        handler_.characters(view(node->content));
+                        break;
+                    default:
+                        break;  // Comments, processing instructions, the DTD
+                }
+            }
+            return true;
+        }
+
+    private:
+        XmlEventHandler& handler_;
+        vector<XmlAttribute> attributes_;
+        deque<string> joined_;
+    };
+
+    bool parseWithLibxmlDom(XmlSource& source, XmlEventHandler& handler, const XmlParseOptions& options,
+                            const char* documentName) {
+        unique_ptr<xmlParserCtxt, void (*)(xmlParserCtxtPtr)> context(xmlNewParserCtxt(), xmlFreeParserCtxt);
+        if (!context) {
+            throw runtime_error("Failed to create XML parser context");
+        }
+        unique_ptr<xmlDoc, void (*)(xmlDocPtr)> doc(nullptr, xmlFreeDoc);
+        {
+            // The buffer is released before the walk, so handlers may parse again
+            PartBuffer scratch(kMaxPooledBuffer);
+            vector<char>& buffer = scratch.get();
+            readAll(source, buffer, options.chunkBytes);
+            if (buffer.size() > INT_MAX) parseError(documentName);
+            doc.reset(xmlCtxtReadMemory(context.get(), buffer.data(), static_cast<int>(buffer.size()), documentName,
+                                        options.utf8 ? "UTF-8" : nullptr, libxmlOptions(options)));
+        }
+        if (!doc || !context->nsWellFormed) parseError(documentName);
+        return TreeWalker(handler).walk(doc->children);
+    }
+
+    // ---- libxml2 pull reader ----
+
+    struct ReaderInput {
+        XmlSource* source = nullptr;
+        exception_ptr error;
+    };
+
+    int readerRead(void* context, char* buffer, int length) {
+        auto& input = *static_cast<ReaderInput*>(context);
+        try {
+            return static_cast<int>(input.source->read(buffer, static_cast<size_t>(length)));
+        } catch (...) {
+            input.error = current_exception();
+            return -1;
+        }
+    }
+
+    // The reader recovers from an undeclared prefix by keeping "p:name" as a name without namespace
+    bool unboundPrefix(xmlTextReaderPtr reader) {
+        return !xmlTextReaderConstNamespaceUri(reader) &&
+               view(xmlTextReaderConstLocalName(reader)).find(':') != string_view::npos;
+    }
+
+    bool parseWithLibxmlReader(XmlSource& source, XmlEventHandler& handler, const XmlParseOptions& options,
+                               const char* documentName) {
+        ReaderInput input;
+        input.source = &source;
+        unique_ptr<xmlTextReader, void (*)(xmlTextReaderPtr)> reader(
+            xmlReaderForIO(readerRead, nullptr, &input, documentName, options.utf8 ? "UTF-8" : nullptr,
+                           libxmlOptions(options)),
+            xmlFreeTextReader);
+        if (input.error) rethrow_exception(input.error);
+        if (!reader) {
+            throw runtime_error("Failed to create XML reader");
+        }
+
+        vector<XmlAttribute> attributes;
+        deque<string> values;  // Attribute values may live in the reader's scratch buffer
+        vector<XmlAttribute> namespaced;  // URI and local name of the current element's prefixed attributes
+        int status;
+        while ((status = xmlTextReaderRead(reader.get())) == 1) {
+            switch (xmlTextReaderNodeType(reader.get())) {
+                case XML_READER_TYPE_ELEMENT: {
+                    if (unboundPrefix(reader.get())) parseError(documentName);
+                    const string_view name = view(xmlTextReaderConstLocalName(reader.get()));
+                    const bool empty = xmlTextReaderIsEmptyElement(reader.get()) == 1;
+                    attributes.clear();
+                    namespaced.clear();
+                    size_t count = 0;
+                    while (xmlTextReaderMoveToNextAttribute(reader.get()) == 1) {
+                        if (xmlTextReaderIsNamespaceDecl(reader.get()) == 1) continue;
+                        if (unboundPrefix(reader.get())) parseError(documentName);
+                        const string_view local = view(xmlTextReaderConstLocalName(reader.get()));
+                        if (const xmlChar* uri = xmlTextReaderConstNamespaceUri(reader.get())) {
+                            // The same namespace and local name under two prefixes
+                            const XmlAttribute expanded{view(uri), local};
+                            for (const auto& other : namespaced) {
+                                if (other.name == expanded.name && other.value == expanded.value) parseError(documentName);
+                            }
+                            namespaced.push_back(expanded);
+                        }
+                        if (values.size() <= count) values.emplace_back();
+                        values[count] = view(xmlTextReaderConstValue(reader.get()));
+                        attributes.push_back({local, values[count++]});
+                    }
+                    xmlTextReaderMoveToElement(reader.get());
+                    handler.startElement(name, attributes.data(), attributes.size());
+                    if (empty && !handler.endElement(name)) return false;
+                    break;
+                }
+                case XML_READER_TYPE_END_ELEMENT:
+                    if (!handler.endElement(view(xmlTextReaderConstLocalName(reader.get())))) return false;
+                    break;
+                case XML_READER_TYPE_TEXT:
+                case XML_READER_TYPE_CDATA:
+                case XML_READER_TYPE_WHITESPACE:
+                case XML_READER_TYPE_SIGNIFICANT_WHITESPACE:
+                    handler.characters(view(xmlTextReaderConstValue(reader.get())));
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (input.error) rethrow_exception(input.error);
+        if (status != 0) parseError(documentName);
+        return true;
+    }
+
+#ifdef TYPSTYLE_WITH_EXPAT
+    // ---- expat ----
+
+    static_assert(sizeof(XML_Char) == 1, "expat must be built with UTF-8 XML_Char");
+
+    struct ExpatState {
+        XmlEventHandler* handler = nullptr;
+        XML_Parser parser = nullptr;
+        const char* documentName = nullptr;
+        NamespaceScope namespaces;
+        vector<XmlAttribute> qualified;
+        vector<XmlAttribute> attributes;
+        bool stopped = false;
+        exception_ptr error;
+
+        void stop() {
+            stopped = true;
+            XML_StopParser(parser, XML_FALSE);
+        }
+    };
+
+    void XMLCALL expatStartElement(void* data, const XML_Char* name, const XML_Char** attributes) {
+        auto& state = *static_cast<ExpatState*>(data);
+        if (state.stopped) return;
+        try {
+            // Namespace mode would check prefixes too, but concatenates a URI into every name
+            state.qualified.clear();
+            for (const XML_Char** attribute = attributes; *attribute; attribute += 2) {
+                state.qualified.push_back({attribute[0], attribute[1]});
+            }
+            if (!state.namespaces.open(name, state.qualified.data(), state.qualified.size())) {
+                parseError(state.documentName);
+            }
+            state.attributes.clear();
+            for (const auto& attribute : state.qualified) {
+                if (isNamespaceDeclaration(attribute.name)) continue;
+                state.attributes.push_back({localName(attribute.name), attribute.value});
+            }
+            state.handler->startElement(localName(name), state.attributes.data(), state.attributes.size());
+        } catch (...) {
+            state.error = current_exception();
+            state.stop();
+        }
+    }
+
+    void XMLCALL expatEndElement(void* data, const XML_Char* name) {
+        auto& state = *static_cast<ExpatState*>(data);
+        if (state.stopped) return;
+        try {
+            state.namespaces.close();
+            if (!state.handler->endElement(localName(name))) state.stop();
+        } catch (...) {
+            state.error = current_exception();
+            state.stop();
+        }
+    }
+
+    void XMLCALL expatCharacters(void* data, const XML_Char* text, int length) {
+        auto& state = *static_cast<ExpatState*>(data);
+        if (state.stopped) return;
+        try {
+            state.handler->characters(string_view(text, static_cast<size_t>(length)));
+        } catch (...) {
+            state.error = current_exception();
+            state.stop();
+        }
+    }
+
+    bool parseWithExpat(XmlSource& source, XmlEventHandler& handler, const XmlParseOptions& options,
+                        const char* documentName) {
+        unique_ptr<XML_ParserStruct, void (*)(XML_Parser)> parser(
+            XML_ParserCreate(options.utf8 ? "UTF-8" : nullptr), XML_ParserFree);
+        if (!parser) {
+            throw runtime_error("Failed to create XML parser context");
+        }
+        ExpatState state;
+        state.handler = &handler;
+        state.parser = parser.get();
+        state.documentName = documentName;
+        XML_SetUserData(parser.get(), &state);
+        XML_SetElementHandler(parser.get(), expatStartElement, expatEndElement);
+        XML_SetCharacterDataHandler(parser.get(), expatCharacters);
+
+        const int chunk = static_cast<int>(min<size_t>(max<size_t>(options.chunkBytes, 1), INT_MAX));
+        for (;;) {
+            void* buffer = XML_GetBuffer(parser.get(), chunk);
+            if (!buffer) {
+                throw runtime_error("Failed to allocate XML parser buffer");
+            }
+            const size_t size = source.read(static_cast<char*>(buffer), static_cast<size_t>(chunk));
+            const XML_Status status = XML_ParseBuffer(parser.get(), static_cast<int>(size), size == 0);
+            if (state.error) rethrow_exception(state.error);
+            if (state.stopped) return false;
+            if (status != XML_STATUS_OK) parseError(documentName);
+            if (size == 0) return true;
+        }
+    }
+#endif
+
+    // ---- In-situ ----
+
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    char* encodeUtf8(uint32_t cp, char* out) {
+        if (cp < 0x80) {
+            *out++ = static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            *out++ = static_cast<char>(0xC0 | cp >> 6);
+            *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            *out++ = static_cast<char>(0xE0 | cp >> 12);
+            *out++ = static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            *out++ = static_cast<char>(0xF0 | cp >> 18);
+            *out++ = static_cast<char>(0x80 | (cp >> 12 & 0x3F));
+            *out++ = static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        return out;
+    }
+
+    bool isXmlChar(uint32_t cp) {
+        if (cp < 0x20) return cp == '\t' || cp == '\n' || cp == '\r';
+        return cp <= 0x10FFFF && (cp < 0xD800 || cp > 0xDFFF) && cp != 0xFFFE && cp != 0xFFFF;
+    }
+
+    /**
+     * @brief Whether [p, end) is well-formed UTF-8 made of XML characters only
+     *
+     * Rejects overlong forms, surrogates, truncated sequences and controls
+     * other than tab, LF and CR, as the libxml2 and expat backends do. Runs of
+     * printable ASCII are checked eight bytes at a time.
+     */
+    bool isXmlText(const unsigned char* p, const unsigned char* end) {
+        constexpr uint64_t kHighBits = 0x8080808080808080ull;
+        constexpr uint64_t kSpaces = 0x2020202020202020ull;
+        while (p < end) {
+            if (end - p >= 8) {
+                uint64_t word;
+                memcpy(&word, p, 8);
+                // A high bit set in either term flags a non-ASCII byte or one below 0x20
+                if (((word | ((word - kSpaces) & ~word)) & kHighBits) == 0) {
+                    p += 8;
+                    continue;
+                }
+            }
+            const unsigned char lead = *p;
+            if (lead < 0x80) {
+                if (!isXmlChar(lead)) return false;
+                ++p;
+                continue;
+            }
+            ptrdiff_t length;
+            uint32_t cp, least;
+            if ((lead & 0xE0) == 0xC0) {
+                length = 2;
+                cp = lead & 0x1Fu;
+                least = 0x80;
+            } else if ((lead & 0xF0) == 0xE0) {
+                length = 3;
+                cp = lead & 0x0Fu;
+                least = 0x800;
+            } else if ((lead & 0xF8) == 0xF0) {
+                length = 4;
+                cp = lead & 0x07u;
+                least = 0x10000;
+            } else {
+                return false;
+            }
+            if (end - p < length) return false;
+            for (ptrdiff_t i = 1; i < length; ++i) {
+                if ((p[i] & 0xC0) != 0x80) return false;
+                cp = cp << 6 | (p[i] & 0x3Fu);
+            }
+            if (cp < least || !isXmlChar(cp)) return false;
+            p += length;
+        }
+        return true;
+    }
+
+    // XML 1.0 name characters for ASCII; non-ASCII bytes are accepted as part
+    // of a name once the text has passed isXmlText()
+    bool isNameChar(char c, bool first) {
+        const unsigned char u = static_cast<unsigned char>(c);
+        if (u >= 0x80 || (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || u == '_' || u == ':') return true;
+        return !first && ((u >= '0' && u <= '9') || u == '-' || u == '.');
+    }
+
+    /**
+     * @brief Destructive parser over a mutable UTF-8 buffer
+     *
+     * Decoding never lengthens text (the shortest reference, "&#N;", is four
+     * bytes for one), so it happens in place and every event is a view into
+     * the buffer. Open element names are views as well.
+     */
+    class InSituParser {
+    public:
+        InSituParser(char* begin, char* end, XmlEventHandler& handler, const char* documentName)
+            : p_(begin), end_(end), handler_(handler), documentName_(documentName) {}
+
+        bool parse() {
+            if (end_ - p_ >= 3 && memcmp(p_, "\xEF\xBB\xBF", 3) == 0) p_ += 3;
+            // Checking encoding and characters up front (NUL included) keeps the scans below simple
+            if (!isXmlText(reinterpret_cast<const unsigned char*>(p_), reinterpret_cast<const unsigned char*>(end_))) fail();
+            bool seenRoot = false;
+            while (p_ < end_) {
+                if (*p_ != '<') {
+                    char* start = p_;
+                    char* next = static_cast<char*>(memchr(p_, '<', static_cast<size_t>(end_ - p_)));
+                    p_ = next ? next : end_;
+                    if (open_.empty()) {
+                        // Only whitespace may surround the root element
+                        for (const char* c = start; c < p_; ++c) {
+                            if (!isSpace(*c)) fail();
+                        }
+                    } else {
+                        handler_.characters(decode(start, p_, false));
+                    }
+                    continue;
+                }
+                if (startsWith("<?")) {
+                    p_ = skipPast(p_ + 2, "?>");
+                } else if (startsWith("<!--")) {
+                    p_ = skipPast(p_ + 4, "-->");
+                } else if (startsWith("<![CDATA[")) {
+                    if (open_.empty()) fail();
+                    char* start = p_ + 9;
+                    p_ = skipPast(start, "]]>");
+                    handler_.characters(normalizeLineEnds(start, p_ - 3));
+                } else if (startsWith("<!")) {
+                    fail();  // DOCTYPE
+                } else if (startsWith("</")) {
+                    if (!endTag()) return false;
+                } else {
+                    if (seenRoot && open_.empty()) fail();  // A second root element
+                    seenRoot = true;
+                    if (!startTag()) return false;
+                }
+            }
+            if (!seenRoot || !open_.empty()) fail();
+            return true;
+        }
+
+    private:
+        [[noreturn]] void fail() const { parseError(documentName_); }
+
+        bool startsWith(const char* prefix) const {
+            const size_t length = strlen(prefix);
+            return static_cast<size_t>(end_ - p_) >= length && memcmp(p_, prefix, length) == 0;
+        }
+
+        // Position after the first terminator at or after from
+        char* skipPast(char* from, const char* terminator) const {
+            const size_t length = strlen(terminator);
+            for (char* c = from; end_ - c >= static_cast<ptrdiff_t>(length); ++c) {
+                c = static_cast<char*>(memchr(c, terminator[0], static_cast<size_t>(end_ - c)));
+                if (!c || end_ - c < static_cast<ptrdiff_t>(length)) break;
+                if (memcmp(c, terminator, length) == 0) return c + length;
+            }
+            fail();
+        }
+
+        void skipSpaces() {
+            while (p_ < end_ && isSpace(*p_)) ++p_;
+        }
+
+        string_view name() {
+            char* start = p_;
+            if (p_ >= end_ || !isNameChar(*p_, true)) fail();
+            ++p_;
+            while (p_ < end_ && isNameChar(*p_, false)) ++p_;
+            return string_view(start, static_cast<size_t>(p_ - start));
+        }
+
+        bool startTag() {
+            ++p_;
+            const string_view qualified = name();
+            pending_.clear();
+            for (;;) {
+                skipSpaces();
+                if (p_ >= end_) fail();
+                if (*p_ == '>' || *p_ == '/') break;
+                const string_view attribute = name();
+                skipSpaces();
+                if (p_ >= end_ || *p_ != '=') fail();
+                ++p_;
+                skipSpaces();
+                if (p_ >= end_ || (*p_ != '"' && *p_ != '\'')) fail();
+                const char quote = *p_++;
+                char* valueEnd = static_cast<char*>(memchr(p_, quote, static_cast<size_t>(end_ - p_)));
+                if (!valueEnd || memchr(p_, '<', static_cast<size_t>(valueEnd - p_))) fail();
+                const string_view value = decode(p_, valueEnd, true);
+                p_ = valueEnd + 1;
+                // Attributes must be separated by whitespace
+                if (p_ < end_ && !isSpace(*p_) && *p_ != '>' && *p_ != '/') fail();
+                for (const auto& other : pending_) {
+                    if (other.name == attribute) fail();  // Given twice
+                }
+                pending_.push_back({attribute, value});
+            }
+            const bool empty = *p_ == '/';
+            if (empty && (end_ - p_ < 2 || p_[1] != '>')) fail();
+            p_ += empty ? 2 : 1;
+
+            if (!namespaces_.open(qualified, pending_.data(), pending_.size())) fail();
+            attributes_.clear();
+            for (const auto& attribute : pending_) {
+                if (!isNamespaceDeclaration(attribute.name)) attributes_.push_back({localName(attribute.name), attribute.value});
+            }
+
+            if (empty) {
+                handler_.startElement(localName(qualified), attributes_.data(), attributes_.size());
+                namespaces_.close();
+                return handler_.endElement(localName(qualified));
+            }
+            open_.push_back(qualified);
+            handler_.startElement(localName(qualified), attributes_.data(), attributes_.size());
+            return true;
+        }
+
+        bool endTag() {
+            p_ += 2;
+            const string_view qualified = name();
+            skipSpaces();
+            if (p_ >= end_ || *p_ != '>') fail();
+            ++p_;
+            if (open_.empty() || open_.back() != qualified) fail();
+            open_.pop_back();
+            namespaces_.close();
+            return handler_.endElement(localName(qualified));
+        }
+
+        string_view normalizeLineEnds(char* begin, char* end) const {
+            char* in = static_cast<char*>(memchr(begin, '\r', static_cast<size_t>(end - begin)));
+            if (!in) return string_view(begin, static_cast<size_t>(end - begin));
+            char* out = in;
+            while (in < end) {
+                if (*in == '\r') {
+                    *out++ = '\n';
+                    in += (end - in > 1 && in[1] == '\n') ? 2 : 1;
+                } else {
+                    *out++ = *in++;
+                }
+            }
+            return string_view(begin, static_cast<size_t>(out - begin));
+        }
+
+        // Decodes references and normalizes whitespace of [begin, end) in place
+        string_view decode(char* begin, char* end, bool attribute) const {
+            auto special = [attribute](char c) {
+                return c == '&' || c == '\r' || (attribute && (c == '\n' || c == '\t'));
+            };
+            char* in = begin;
+            while (in < end && !special(*in)) ++in;
+            char* out = in;
+            while (in < end) {
+                const char c = *in;
+                if (c == '&') {
+                    char* semicolon = static_cast<char*>(memchr(in, ';', static_cast<size_t>(end - in)));
+                    if (!semicolon) fail();
+                    const string_view entity(in + 1, static_cast<size_t>(semicolon - in - 1));
+                    in = semicolon + 1;
+                    if (entity == "lt") {
+                        *out++ = '<';
+                    } else if (entity == "gt") {
+                        *out++ = '>';
+                    } else if (entity == "amp") {
+                        *out++ = '&';
+                    } else if (entity == "quot") {
+                        *out++ = '"';
+                    } else if (entity == "apos") {
+                        *out++ = '\'';
+                    } else if (entity.size() > 1 && entity[0] == '#') {
+                        const bool hex = entity[1] == 'x';
+                        const string_view digits = entity.substr(hex ? 2 : 1);
+                        if (digits.empty() || digits.size() > 8) fail();
+                        uint32_t cp = 0;
+                        for (char digit : digits) {
+                            uint32_t value;
+                            if (digit >= '0' && digit <= '9') {
+                                value = static_cast<uint32_t>(digit - '0');
+                            } else if (hex && digit >= 'a' && digit <= 'f') {
+                                value = static_cast<uint32_t>(digit - 'a' + 10);
+                            } else if (hex && digit >= 'A' && digit <= 'F') {
+                                value = static_cast<uint32_t>(digit - 'A' + 10);
+                            } else {
+                                fail();
+                            }
+                            cp = cp * (hex ? 16 : 10) + value;
+                        }
+                        if (!isXmlChar(cp)) fail();
+                        out = encodeUtf8(cp, out);
+                    } else {
+                        fail();  // Undeclared entity
+                    }
+                } else if (c == '\r') {
+                    *out++ = attribute ? ' ' : '\n';
+                    in += (end - in > 1 && in[1] == '\n') ? 2 : 1;
+                } else if (attribute && (c == '\n' || c == '\t')) {
+                    *out++ = ' ';
+                    ++in;
+                } else {
+                    *out++ = c;
+                    ++in;
+                }
+            }
+            return string_view(begin, static_cast<size_t>(out - begin));
+        }
+
+        char* p_;
+        char* end_;
+        XmlEventHandler& handler_;
+        const char* documentName_;
+        vector<string_view> open_;
+        NamespaceScope namespaces_;
+        vector<XmlAttribute> pending_;  ///< Qualified attributes of the tag being read
+        vector<XmlAttribute> attributes_;
+    };
+
+    bool parseInSitu(XmlSource& source, XmlEventHandler& handler, const XmlParseOptions& options,
+                     const char* documentName) {
+        PartBuffer scratch(kMaxPooledBuffer);
+        vector<char>& buffer = scratch.get();
+        readAll(source, buffer, options.chunkBytes);
+        return InSituParser(buffer.data(), buffer.data() + buffer.size(), handler, documentName).parse();
+    }
+
+} // namespace
+
+    const char* xmlBackendName(XmlBackend backend) {
+        for (const auto& entry : kBackendNames) {
+            if (entry.backend == backend) return entry.name;
+        }
+        return "unknown";
+    }
+
+    XmlBackend xmlBackendFromName(const string& name) {
+        for (const auto& entry : kBackendNames) {
+            if (name != entry.name) continue;
+            const auto available = availableXmlBackends();
+            if (entry.backend != XmlBackend::Auto &&
+                find(available.begin(), available.end(), entry.backend) == available.end()) {
+                throw runtime_error("XML backend not available in this build: " + name);
+            }
+            return entry.backend;
+        }
+        throw runtime_error("Unknown XML backend: " + name);
+    }
+
+    vector<XmlBackend> availableXmlBackends() {
+        return {
+            XmlBackend::LibxmlSax,
+            XmlBackend::LibxmlDom,
+            XmlBackend::LibxmlReader,
+#ifdef TYPSTYLE_WITH_EXPAT
+            XmlBackend::Expat,
+#endif
+            XmlBackend::InSitu,
+        };
+    }
+
+    bool xmlBackendStreams(XmlBackend backend) {
+        return backend != XmlBackend::LibxmlDom && backend != XmlBackend::InSitu;
+    }
+
+    bool xmlBackendLimitedEncodings(XmlBackend backend) {
+        return backend == XmlBackend::Expat || backend == XmlBackend::InSitu;
+    }
+
+    bool parseXmlEvents(XmlBackend backend, XmlSource& source, XmlEventHandler& handler,
+                        const XmlParseOptions& options, const char* documentName) {
+        initializeParser();
+        switch (backend) {
+            case XmlBackend::Auto:
+            case XmlBackend::LibxmlSax:
+                return parseWithLibxmlSax(source, handler, options, documentName);
+            case XmlBackend::LibxmlDom:
+                return parseWithLibxmlDom(source, handler, options, documentName);
+            case XmlBackend::LibxmlReader:
+                return parseWithLibxmlReader(source, handler, options, documentName);
+            case XmlBackend::Expat:
+#ifdef TYPSTYLE_WITH_EXPAT
+                return parseWithExpat(source, handler, options, documentName);
+#else
+                break;
+#endif
+            case XmlBackend::InSitu:
+                return parseInSitu(source, handler, options, documentName);
+        }
+        throw runtime_error(string("XML backend not available in this build: ") + xmlBackendName(backend));
+    }
+
+} // namespace DocxParser
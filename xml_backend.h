@@ -0,0 +1,109 @@
+#ifndef XML_BACKEND_H
+#define XML_BACKEND_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Interchangeable XML parsers behind one event interface
+ *
+ * The style extractor only needs element starts (with attributes), element
+ * ends and text, in document order. Every backend turns its parser's own
+ * model into exactly those events, so the extractor is written once and
+ * the parser can be chosen per workload:
+ *
+ * - LibxmlSax: libxml2 push parser with SAX2 callbacks; streams, no tree.
+ * - LibxmlDom: libxml2 tree of the whole part, walked afterwards.
+ * - LibxmlReader: libxml2 pull reader (xmlTextReader); streams.
+ * - Expat: expat push parser; streams. Only with TYPSTYLE_WITH_EXPAT.
+ * - InSitu: destructive parser over the part's own buffer: entities are
+ *   decoded in place and names, values and text are views into the buffer,
+ *   so nothing is copied or allocated per node. UTF-8 only.
+ *
+ * Names are local names: prefixes are dropped and namespace declarations
+ * are not reported as attributes. An undeclared prefix, an attribute given
+ * twice, a mismatched end tag, malformed UTF-8, a character XML does not
+ * allow (NUL and other controls included) or an invalid name fails the parse
+ * with every backend.
+ */
+namespace DocxParser {
+
+enum class XmlBackend {
+    Auto,          ///< Let the caller pick per input (see StreamOptions)
+    LibxmlSax,
+    LibxmlDom,
+    LibxmlReader,
+    Expat,
+    InSitu,
+};
+
+/// "auto", "libxml-sax", "libxml-dom", "libxml-reader", "expat", "in-situ"
+const char* xmlBackendName(XmlBackend backend);
+
+/**
+ * @brief Backend for a name as printed by xmlBackendName()
+ * @throws std::runtime_error for unknown names and backends not compiled in
+ */
+XmlBackend xmlBackendFromName(const std::string& name);
+
+/// Backends compiled into this build, Auto excluded
+std::vector<XmlBackend> availableXmlBackends();
+
+/// True for backends that parse while reading; the others read the input whole first
+bool xmlBackendStreams(XmlBackend backend);
+
+/// True for backends that only accept UTF-8, UTF-16 and Latin-1 (not libxml2's full set)
+bool xmlBackendLimitedEncodings(XmlBackend backend);
+
+struct XmlAttribute {
+    std::string_view name;   ///< Local name
+    std::string_view value;  ///< Entities decoded, whitespace normalized
+};
+
+/**
+ * @brief Receiver of parse events
+ *
+ * Views are valid during the call only. Text may arrive in several pieces.
+ */
+class XmlEventHandler {
+public:
+    virtual ~XmlEventHandler() = default;
+    virtual void startElement(std::string_view name, const XmlAttribute* attributes, size_t count) = 0;
+    /// @return false to stop parsing; the rest of the input is not read
+    virtual bool endElement(std::string_view name) = 0;
+    virtual void characters(std::string_view text) = 0;
+};
+
+/**
+ * @brief Input of a parse
+ */
+class XmlSource {
+public:
+    virtual ~XmlSource() = default;
+    /// Reads up to size bytes; 0 at the end. @throws std::runtime_error if the input cannot be read
+    virtual size_t read(char* buffer, size_t size) = 0;
+};
+
+struct XmlParseOptions {
+    size_t chunkBytes = 64 * 1024;  ///< Read size of the streaming backends
+    bool utf8 = false;              ///< Input was transcoded to UTF-8: ignore the declared encoding
+    bool huge = false;              ///< Lift libxml2's size limits (flat XML with embedded media)
+};
+
+/**
+ * @brief Parses source with backend, calling handler for every event
+ * @param documentName Used in error messages ("Failed to parse <name> content")
+ * @return false if the handler stopped the parse
+ * @throws std::runtime_error if the input is not well-formed or the backend
+ *         is not compiled in; exceptions from the handler propagate unchanged
+ *
+ * Auto means LibxmlSax here.
+ */
+bool parseXmlEvents(XmlBackend backend, XmlSource& source, XmlEventHandler& handler,
+                    const XmlParseOptions& options, const char* documentName) noexcept(false);
+
+} // namespace DocxParser
+
+#endif // XML_BACKEND_H
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "xml_backend.h"
+
+using namespace DocxParser;
+
+namespace {
+
+/**
+ * @brief Serves a string in reads of at most maxRead bytes
+ */
+class StringSource : public XmlSource {
+public:
+    StringSource(const std::string& data, size_t maxRead) : data_(data), maxRead_(maxRead) {}
+
+    size_t read(char* buffer, size_t size) override {
+        const size_t n = std::min({size, maxRead_, data_.size() - pos_});
+        memcpy(buffer, data_.data() + pos_, n);
+        pos_ += n;
+        return n;
+    }
+
+private:
+    std::string data_;
+    size_t maxRead_;
+    size_t pos_ = 0;
+};
+
+/**
+ * @brief Logs events one per line; text pieces are joined, as backends split text differently
+ */
+class EventLog : public XmlEventHandler {
+public:
+    std::string log;
+    std::string stopAfter;  ///< Stop at the end of the first element with this name
+    std::string throwAt;    ///< Throw at the start of the first element with this name
+
+    void startElement(std::string_view name, const XmlAttribute* attributes, size_t count) override {
+        flushText();
+        if (name == throwAt) throw std::logic_error("handler failed");
+        log += "<" + std::string(name);
+        for (size_t i = 0; i < count; ++i) {
+            log += " " + std::string(attributes[i].name) + "=[" + std::string(attributes[i].value) + "]";
+        }
+        log += ">\n";
+    }
+
+    bool endElement(std::string_view name) override {
+        flushText();
+        log += "</" + std::string(name) + ">\n";
+        return name != stopAfter;
+    }
+
+    void characters(std::string_view text) override { text_ += text; }
+
+    std::string finish() {
+        flushText();
+        return log;
+    }
+
+private:
+    void flushText() {
+        if (!text_.empty()) log += "\"" + text_ + "\"\n";
+        text_.clear();
+    }
+
+    std::string text_;
+};
+
+const std::string kTrickyXml =
+    "\xEF\xBB\xBF<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\r\n"
+    "<!-- leading comment -->\n"
+    "<?mso-application progid=\"Word.Document\"?>\n"
+    "<w:root xmlns:w=\"urn:w\" xmlns=\"urn:default\">\n"
+    "  <w:a w:val=\"x &amp; y &lt;z&gt; &quot;q&quot; &apos;s&apos; &#38; &#x41;&#66;\" plain='single \"q\"'>"
+    "text &amp; more &#x20AC; &#128512;</w:a>\n"
+    "  <b>line1\r\nline2\rline3</b>\n"
+    "  <c attr=\"tab\there\r\nnew\nline &#9;kept\"/>\n"
+    "  <![CDATA[ <not a tag> & ]]>\n"
+    "  <d><!-- inner comment --><e/><?pi data?>caf\xC3\xA9</d >\n"
+    "  <w:f w:val=\"1\"></w:f>\n"
+    "</w:root>\n"
+    "<!-- trailing comment -->\n";
+
+std::string parseLog(XmlBackend backend, const std::string& xml, size_t maxRead) {
+    StringSource source(xml, maxRead);
+    EventLog log;
+    XmlParseOptions options;
+    options.chunkBytes = maxRead;
+    EXPECT_TRUE(parseXmlEvents(backend, source, log, options, "test.xml")) << xmlBackendName(backend);
+    return log.finish();
+}
+
+} // namespace
+
+/**
+ * @brief Every backend reports the same events as the libxml2 tree, for any read size
+ */
+TEST(XmlBackendTest, BackendsAgreeWithTree) {
+    const std::string expected = parseLog(XmlBackend::LibxmlDom, kTrickyXml, 1 << 20);
+    EXPECT_NE(expected.find("<a val=[x & y <z> \"q\" 's' & AB] plain=[single \"q\"]>"), std::string::npos) << expected;
+    EXPECT_NE(expected.find("\"line1\nline2\nline3\""), std::string::npos) << expected;
+    EXPECT_NE(expected.find("attr=[tab here new line \tkept]"), std::string::npos) << expected;
+    EXPECT_EQ(expected.find("xmlns"), std::string::npos) << expected;
+
+    for (XmlBackend backend : availableXmlBackends()) {
+        for (size_t maxRead : {size_t(1), size_t(3), size_t(64), size_t(1) << 20}) {
+            EXPECT_EQ(parseLog(backend, kTrickyXml, maxRead), expected) << xmlBackendName(backend) << " " << maxRead;
+        }
+    }
+}
+
+TEST(XmlBackendTest, RejectsMalformedInput) {
+    const std::string malformed[] = {
+        "",
+        "<a><b></a></b>",
+        "<a><b></b>",
+        "<a/><b/>",
+        "<a/>trailing",
+        "<a>&undeclared;</a>",
+        "<a x=1/>",
+        "<a x=\"1\"",
+        "<a x=\"1\"y=\"2\"/>",
+        "<a x=\"1\" x=\"2\"/>",
+        "<a xmlns:p=\"urn:p\" p:x=\"1\" p:x=\"2\"/>",
+        "<a xmlns:p=\"urn:p\" xmlns:q=\"urn:p\" p:x=\"1\" q:x=\"2\"/>",
+        "<a xmlns:p=\"urn:p\" xmlns:p=\"urn:q\"/>",
+        "<p:a/>",
+        "<a><p:b/></a>",
+        "<a p:x=\"1\"/>",
+        "<a><b xmlns:p=\"urn:p\"/><p:c/></a>",
+        std::string("<a>x\0y</a>", 9),
+        std::string("<a x=\"\0\"/>", 10),
+        std::string("<a\0/>", 5),
+        "<a>\xC3</a>",                  // Truncated UTF-8 sequence
+        "<a>\xC3(</a>",                 // Bad continuation byte
+        "<a>\xC0\xAF</a>",              // Overlong encoding
+        "<a>\xED\xA0\x80</a>",          // UTF-16 surrogate
+        "<a>\xF4\x90\x80\x80</a>",      // Beyond U+10FFFF
+        "<a x=\"\xFF\"/>",
+        "<a\xFF/>",
+        "<a>\x01</a>",                  // Control character
+        "<a>\xEF\xBF\xBE</a>",          // U+FFFE
+        "<a>&#1;</a>",
+        "<a>&#xFFFF;</a>",
+        "<1a/>",
+        "<-a/>",
+        "<a\"b/>",
+        "<a><b></c></a>",
+        "<a 1x=\"1\"/>",
+    };
+    for (XmlBackend backend : availableXmlBackends()) {
+        for (const std::string& xml : malformed) {
+            EXPECT_THROW(parseLog(backend, xml, 7), std::runtime_error) << xmlBackendName(backend) << ": " << xml;
+        }
+    }
+}
+
+/**
+ * @brief Returning false from endElement stops the parse; handler exceptions propagate
+ */
+TEST(XmlBackendTest, HandlerStopsAndThrows) {
+    std::string xml = "<list>";
+    for (int i = 0; i < 1000; ++i) xml += "<item n=\"" + std::to_string(i) + "\"/>";
+    xml += "</list>";
+
+    for (XmlBackend backend : availableXmlBackends()) {
+        StringSource source(xml, 256);
+        EventLog log;
+        log.stopAfter = "item";
+        XmlParseOptions options;
+        options.chunkBytes = 256;
+        EXPECT_FALSE(parseXmlEvents(backend, source, log, options, "list.xml")) << xmlBackendName(backend);
+        EXPECT_EQ(log.finish(), "<list>\n<item n=[0]>\n</item>\n") << xmlBackendName(backend);
+
+        StringSource again(xml, 256);
+        EventLog failing;
+        failing.throwAt = "item";
+        EXPECT_THROW(parseXmlEvents(backend, again, failing, options, "list.xml"), std::logic_error)
+            << xmlBackendName(backend);
+    }
+}
+
+TEST(XmlBackendTest, NamesRoundTrip) {
+    for (XmlBackend backend : availableXmlBackends()) {
+        EXPECT_EQ(xmlBackendFromName(xmlBackendName(backend)), backend);
+    }
+    EXPECT_EQ(xmlBackendFromName("auto"), XmlBackend::Auto);
+    EXPECT_THROW(xmlBackendFromName("msxml"), std::runtime_error);
+}